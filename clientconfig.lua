@@ -1,4 +1,5 @@
 Debug = {
+	ReconciliationStatsInterval = 0, -- seconds, periodically logs client prediction replay cost (0 to disable)
 	SendServerState = false,
 	ShowConnectionData = "ping", -- ping|download|upload|usage
 	ShowServerGhosts = false,
@@ -7,6 +8,11 @@ Debug = {
 GameSettings = {
 	TickRate = 33,
 }
+Network = {
+	InterpolationDelay = -1, -- seconds, remote entities are rendered this far in the past to smooth out jitter (negative: two server state intervals, 0 to disable)
+	MaxExtrapolation = 0.1, -- seconds, how long remote entities keep moving when server states are late
+	ScopedReconciliation = true -- only resimulate controlled entities and what's around them when correcting a misprediction
+}
 Resources = {
 	AssetDirectory = "assets",
 	ScriptDirectory  = "scripts"
@@ -27,6 +27,8 @@ namespace bw
 			void PreFrameUpdate(float elapsedTime);
 			void PostFrameUpdate(float elapsedTime);
 
+			void ReplayTickUpdate(float elapsedTime, const Ndk::EntityList& entities) override;
+
 			void TickUpdate(float elapsedTime) override;
 
 			ClientEditorLayer& operator=(const ClientEditorLayer&) = delete;
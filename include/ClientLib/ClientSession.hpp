@@ -68,7 +68,9 @@ namespace bw
 			NazaraSignal(OnEntitiesAnimation,            ClientSession* /*session*/, const Packets::EntitiesAnimation&            /*data*/);
 			NazaraSignal(OnEntitiesDeath,                ClientSession* /*session*/, const Packets::EntitiesDeath&                /*data*/);
 			NazaraSignal(OnEntitiesInputs,               ClientSession* /*session*/, const Packets::EntitiesInputs&               /*data*/);
+			NazaraSignal(OnEntitiesPhysics,              ClientSession* /*session*/, const Packets::EntitiesPhysics&              /*data*/);
 			NazaraSignal(OnEntitiesScale,                ClientSession* /*session*/, const Packets::EntitiesScale&                /*data*/);
+			NazaraSignal(OnEntitiesWeapon,               ClientSession* /*session*/, const Packets::EntitiesWeapon&               /*data*/);
 			NazaraSignal(OnEntityPhysics,                ClientSession* /*session*/, const Packets::EntityPhysics&                /*data*/);
 			NazaraSignal(OnEntityWeapon,                 ClientSession* /*session*/, const Packets::EntityWeapon&                 /*data*/);
 			NazaraSignal(OnHealthUpdate,                 ClientSession* /*session*/, const Packets::HealthUpdate&                 /*data*/);
@@ -52,6 +52,6 @@ namespace bw
 		m_commandStore.SerializePacket(data, packet);
 
 		const auto& command = m_commandStore.GetOutgoingCommand<T>();
-		m_bridge->SendPacket(command.channelId, command.flags, std::move(data));
+		m_bridge->SendPacket(command.channelId, command.flags, data);
 	}
 }
@@ -0,0 +1,60 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CLIENTLIB_COMPONENTS_SNAPSHOTINTERPOLATIONCOMPONENT_HPP
+#define BURGWAR_CLIENTLIB_COMPONENTS_SNAPSHOTINTERPOLATIONCOMPONENT_HPP
+
+#include <ClientLib/Export.hpp>
+#include <Nazara/Math/Angle.hpp>
+#include <Nazara/Math/Vector2.hpp>
+#include <NDK/Component.hpp>
+#include <array>
+
+namespace bw
+{
+	/*!
+	* \brief Stores the last states received from the server for an entity which isn't simulated locally
+	*
+	* States are kept in a fixed-size ring (no allocation once the component is created) and sampled at a point in the past
+	* by the SnapshotInterpolationSystem.
+	*/
+	class BURGWAR_CLIENTLIB_API SnapshotInterpolationComponent : public Ndk::Component<SnapshotInterpolationComponent>
+	{
+		public:
+			inline SnapshotInterpolationComponent();
+			~SnapshotInterpolationComponent() = default;
+
+			inline void Clear();
+
+			inline std::size_t GetSnapshotCount() const;
+
+			void PushSnapshot(Nz::UInt16 serverTick, const Nz::Vector2f& position, const Nz::RadianAnglef& rotation);
+
+			bool Sample(Nz::UInt16 renderTick, float tickFraction, float maxExtrapolation, Nz::Vector2f* position, Nz::RadianAnglef* rotation) const;
+
+			static constexpr std::size_t MaxSnapshotCount = 16;
+
+			static Ndk::ComponentIndex componentIndex;
+
+		private:
+			struct Snapshot
+			{
+				Nz::RadianAnglef rotation;
+				Nz::Vector2f position;
+				Nz::UInt16 serverTick;
+			};
+
+			inline const Snapshot& GetSnapshot(std::size_t index) const;
+
+			std::array<Snapshot, MaxSnapshotCount> m_snapshots;
+			std::size_t m_firstSnapshot;
+			std::size_t m_snapshotCount;
+	};
+}
+
+#include <ClientLib/Components/SnapshotInterpolationComponent.inl>
+
+#endif
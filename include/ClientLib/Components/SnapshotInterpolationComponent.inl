@@ -0,0 +1,35 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <ClientLib/Components/SnapshotInterpolationComponent.hpp>
+#include <cassert>
+
+namespace bw
+{
+	inline SnapshotInterpolationComponent::SnapshotInterpolationComponent() :
+	m_firstSnapshot(0),
+	m_snapshotCount(0)
+	{
+	}
+
+	inline void SnapshotInterpolationComponent::Clear()
+	{
+		m_firstSnapshot = 0;
+		m_snapshotCount = 0;
+	}
+
+	inline std::size_t SnapshotInterpolationComponent::GetSnapshotCount() const
+	{
+		return m_snapshotCount;
+	}
+
+	/*!
+	* \brief Returns a snapshot by its age, zero being the oldest one
+	*/
+	inline auto SnapshotInterpolationComponent::GetSnapshot(std::size_t index) const -> const Snapshot&
+	{
+		assert(index < m_snapshotCount);
+		return m_snapshots[(m_firstSnapshot + index) % MaxSnapshotCount];
+	}
+}
@@ -72,10 +72,14 @@ namespace bw
 			void HandlePacket(const Packets::EntitiesAnimation::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::EntitiesDeath::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::EntitiesInputs::Entity* entities, std::size_t entityCount);
+			void HandlePacket(const Packets::EntitiesPhysics::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::EntitiesScale::Entity* entities, std::size_t entityCount);
+			void HandlePacket(const Packets::EntitiesWeapon::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::EntityPhysics& packet);
 			void HandlePacket(const Packets::EntityWeapon& packet);
 			void HandlePacket(const Packets::HealthUpdate::Entity* entities, std::size_t entityCount);
+			void UpdateEntityPhysics(Nz::UInt32 entityId, bool asleep, float mass, float momentOfInertia, const std::optional<Packets::Helper::PlayerMovementProperties>& playerMovement);
+			void UpdateEntityWeapon(Nz::UInt32 entityId, Nz::UInt32 weaponEntityId);
 
 			struct EntityData
 			{
@@ -11,6 +11,7 @@
 #include <CoreLib/PropertyValues.hpp>
 #include <CoreLib/SharedMatch.hpp>
 #include <CoreLib/SharedLayer.hpp>
+#include <CoreLib/Protocol/MatchStateQuantizer.hpp>
 #include <CoreLib/Protocol/Packets.hpp>
 #include <CoreLib/Scripting/ScriptingContext.hpp>
 #include <CoreLib/Utility/AverageValues.hpp>
@@ -31,6 +32,7 @@
 #include <Nazara/Renderer/RenderWindow.hpp>
 #include <Nazara/Network/UdpSocket.hpp>
 #include <NDK/Canvas.hpp>
+#include <NDK/EntityList.hpp>
 #include <NDK/EntityOwner.hpp>
 #include <tsl/hopscotch_map.h>
 #include <tsl/hopscotch_set.h>
@@ -54,6 +56,8 @@ namespace bw
 		friend ClientSession;
 
 		public:
+			struct ReconciliationStatistics;
+
 			LocalMatch(ClientEditorApp& burgApp, Nz::RenderWindow* window, Nz::RenderTarget* renderTarget, Ndk::Canvas* canvas, ClientSession& session, const Packets::AuthSuccess& authSuccess, const Packets::MatchData& matchData);
 			LocalMatch(const LocalMatch&) = delete;
 			LocalMatch(LocalMatch&&) = delete;
@@ -63,6 +67,8 @@ namespace bw
 
 			inline EntityId AllocateClientUniqueId();
 
+			inline void EnableScopedReconciliation(bool enable = true);
+
 			Nz::UInt64 EstimateServerTick() const;
 
 			void ForEachEntity(std::function<void(const Ndk::EntityHandle& entity)> func) override;
@@ -84,6 +90,7 @@ namespace bw
 			inline ParticleRegistry& GetParticleRegistry();
 			inline const ParticleRegistry& GetParticleRegistry() const;
 			inline LocalPlayer* GetPlayerByIndex(Nz::UInt16 playerIndex);
+			inline const ReconciliationStatistics& GetReconciliationStatistics() const;
 			inline Ndk::World& GetRenderWorld();
 			std::shared_ptr<const SharedGamemode> GetSharedGamemode() const override;
 			ClientWeaponStore& GetWeaponStore() override;
@@ -91,11 +98,17 @@ namespace bw
 
 			void InitDebugGhosts();
 
+			inline bool IsScopedReconciliationEnabled() const;
+
 			void LoadAssets(std::shared_ptr<VirtualDirectory> assetDir);
 			void LoadScripts(const std::shared_ptr<VirtualDirectory>& scriptDir);
 
 			inline void Quit();
 
+			inline void ResetReconciliationStatistics();
+
+			inline void SetSnapshotInterpolation(float interpolationDelay, float maxExtrapolation);
+
 			void RegisterEntity(EntityId uniqueId, LocalLayerEntityHandle entity);
 			
 			const Ndk::EntityHandle& RetrieveEntityByUniqueId(EntityId uniqueId) const override;
@@ -108,6 +121,16 @@ namespace bw
 			LocalMatch& operator=(const LocalMatch&) = delete;
 			LocalMatch& operator=(LocalMatch&&) = delete;
 
+			struct ReconciliationStatistics
+			{
+				Nz::UInt64 reconciliationCount = 0;
+				Nz::UInt64 replayedInputCount = 0;
+				Nz::UInt64 frozenBodyCount = 0;   //< Bodies kept at their authoritative state, summed over every reconciliation
+				Nz::UInt64 replayedBodyCount = 0; //< Awake dynamic bodies resimulated, summed over every reconciliation
+				Nz::UInt64 maxReplayTime = 0;     //< in microseconds
+				Nz::UInt64 totalReplayTime = 0;   //< in microseconds
+			};
+
 		private:
 			struct ServerEntity;
 
@@ -125,7 +148,9 @@ namespace bw
 				Packets::EntitiesAnimation,
 				Packets::EntitiesDeath,
 				Packets::EntitiesInputs,
+				Packets::EntitiesPhysics,
 				Packets::EntitiesScale,
+				Packets::EntitiesWeapon,
 				Packets::EntityPhysics,
 				Packets::EntityWeapon,
 				Packets::HealthUpdate,
@@ -134,9 +159,14 @@ namespace bw
 				Packets::PlayerWeapons
 			>;
 
+			void AcknowledgeMatchState(Nz::UInt16 stateTick);
+			void BeginReconciliation(std::size_t replayedInputCount);
 			void BindEscapeMenu();
 			void BindPackets();
 			void BindSignals(ClientEditorApp& burgApp, Nz::RenderWindow* window, Ndk::Canvas* canvas);
+			bool DecodeMatchState(Packets::MatchState& matchState);
+			void EndReconciliation();
+			float GetInterpolationDelay() const;
 			void HandleChatMessage(const Packets::ChatMessage& packet);
 			void HandleConsoleAnswer(const Packets::ConsoleAnswer& packet);
 			void HandleEntityCreated(LocalLayer* layer, LocalLayerEntity& entity);
@@ -157,7 +187,9 @@ namespace bw
 			void HandleTickPacket(Packets::EntitiesAnimation&& packet);
 			void HandleTickPacket(Packets::EntitiesDeath&& packet);
 			void HandleTickPacket(Packets::EntitiesInputs&& packet);
+			void HandleTickPacket(Packets::EntitiesPhysics&& packet);
 			void HandleTickPacket(Packets::EntitiesScale&& packet);
+			void HandleTickPacket(Packets::EntitiesWeapon&& packet);
 			void HandleTickPacket(Packets::EntityPhysics&& packet);
 			void HandleTickPacket(Packets::EntityWeapon&& packet);
 			void HandleTickPacket(Packets::HealthUpdate&& packet);
@@ -167,10 +199,22 @@ namespace bw
 			void HandleTickError(Nz::UInt16 serverTick, Nz::Int32 tickError);
 			void InitializeRemoteConsole();
 			void InitializeScoreboard();
+			inline bool IsInReconciliationScope(EntityId uniqueId) const;
 			void OnTick(bool lastTick) override;
+			void PrepareReplay();
+			void PushSnapshots(const Packets::MatchState& packet);
 			void PushTickPacket(Nz::UInt16 tick, const TickPacketContent& packet);
 			bool SendInputs(Nz::UInt16 serverTick, bool force);
 
+			struct FrozenBody
+			{
+				Ndk::EntityHandle entity;
+				Nz::RadianAnglef angularVelocity;
+				Nz::Vector2f linearVelocity;
+				float mass;
+				float momentOfInertia;
+			};
+
 			struct LocalPlayerData
 			{
 				LocalPlayerData(Nz::UInt8 localIndex) :
@@ -233,6 +277,12 @@ namespace bw
 				std::vector<LayerData> layers;
 			};
 
+			struct ReceivedMatchState
+			{
+				std::optional<Nz::UInt16> stateTick;
+				tsl::hopscotch_map<Nz::UInt64 /*layerId|entityId*/, MatchStateQuantizer::EntityState> entities;
+			};
+
 			struct TickPrediction
 			{
 				Nz::UInt16 serverTick;
@@ -245,6 +295,8 @@ namespace bw
 				TickPacketContent content;
 			};
 
+			static constexpr float ReconciliationScopeRadius = 512.f; //< in pixels, on top of the distance controlled entities can travel during the replay
+
 			NazaraSlot(Nz::RenderTarget, OnRenderTargetSizeChange, m_onRenderTargetSizeChange);
 			NazaraSlot(Nz::EventHandler, OnGainedFocus, m_onGainedFocus);
 			NazaraSlot(Nz::EventHandler, OnLostFocus, m_onLostFocus);
@@ -262,14 +314,18 @@ namespace bw
 			std::optional<Console> m_remoteConsole;
 			std::optional<Debug> m_debug;
 			std::optional<LocalConsole> m_localConsole;
+			std::optional<MatchStateQuantizer> m_matchStateQuantizer;
+			std::optional<Nz::UInt16> m_lastMatchStateTick;
 			std::optional<ParticleRegistry> m_particleRegistry;
 			std::shared_ptr<ClientGamemode> m_gamemode;
 			std::shared_ptr<ScriptingContext> m_scriptingContext;
 			std::string m_gamemodeName;
 			std::vector<std::unique_ptr<LocalLayer>> m_layers;
 			std::vector<LocalPlayerData> m_localPlayers;
+			std::vector<Ndk::EntityList> m_replayedEntities; //< Entities of the reconciliation scope, by layer index
 			std::vector<std::optional<LocalPlayer>> m_matchPlayers;
 			std::vector<PredictedInput> m_predictedInputs;
+			std::vector<ReceivedMatchState> m_receivedMatchStates;
 			std::vector<TickPacket> m_tickedPackets;
 			std::vector<TickPrediction> m_tickPredictions;
 			Ndk::Canvas* m_canvas;
@@ -283,8 +339,11 @@ namespace bw
 			tsl::hopscotch_map<EntityId, LocalLayerEntityHandle> m_entitiesByUniqueId;
 			tsl::hopscotch_map<EntityId, std::size_t> m_playerEntitiesByUniqueId;
 			tsl::hopscotch_set<EntityId> m_inactiveEntities;
+			tsl::hopscotch_set<EntityId> m_reconciliationScope;
+			std::vector<FrozenBody> m_frozenBodies;
 			AnimationManager m_animationManager;
 			AverageValues<Nz::Int32> m_averageTickError;
+			AverageValues<float> m_matchStateInterval;
 			Chatbox m_chatBox;
 			ClientEditorApp& m_application;
 			ClientSession& m_session;
@@ -292,9 +351,15 @@ namespace bw
 			PropertyValueMap m_gamemodeProperties;
 			Scoreboard* m_scoreboard;
 			Packets::PlayersInput m_inputPacket;
+			ReconciliationStatistics m_reconciliationStatistics;
+			Nz::UInt64 m_reconciliationStartTime;
 			bool m_hasFocus;
 			bool m_isLeavingMatch;
+			bool m_isReconciliationScoped;
+			bool m_isScopedReconciliationEnabled;
 			float m_errorCorrectionTimer;
+			float m_interpolationDelay;
+			float m_maxExtrapolation;
 			float m_playerEntitiesTimer;
 			float m_playerInputTimer;
 			float m_timeSinceLastInputSending;
@@ -29,6 +29,17 @@ namespace bw
 		return m_freeClientId--;
 	}
 
+	/*!
+	* \brief Enables or disables scoped reconciliation
+	*
+	* When enabled, reconciliation only resimulates the controlled entities and the physical entities around them (a region large enough for them to interact with during the replayed inputs).
+	* Other bodies are frozen at their authoritative state instead of being replayed along, see PrepareReplay.
+	*/
+	inline void LocalMatch::EnableScopedReconciliation(bool enable)
+	{
+		m_isScopedReconciliationEnabled = enable;
+	}
+
 	inline Nz::UInt16 LocalMatch::GetActiveLayer()
 	{
 		return m_activeLayerIndex;
@@ -85,13 +96,47 @@ namespace bw
 		return &m_matchPlayers[playerIndex].value();
 	}
 
+	inline auto LocalMatch::GetReconciliationStatistics() const -> const ReconciliationStatistics&
+	{
+		return m_reconciliationStatistics;
+	}
+
 	inline Ndk::World& LocalMatch::GetRenderWorld()
 	{
 		return m_renderWorld;
 	}
 
+	inline bool LocalMatch::IsScopedReconciliationEnabled() const
+	{
+		return m_isScopedReconciliationEnabled;
+	}
+
+	inline bool LocalMatch::IsInReconciliationScope(EntityId uniqueId) const
+	{
+		return !m_isReconciliationScoped || m_reconciliationScope.find(uniqueId) != m_reconciliationScope.end();
+	}
+
 	inline void LocalMatch::Quit()
 	{
 		m_isLeavingMatch = true;
 	}
+
+	inline void LocalMatch::ResetReconciliationStatistics()
+	{
+		m_reconciliationStatistics = ReconciliationStatistics{};
+	}
+
+	/*!
+	* \brief Renders entities which aren't controlled by a local player by interpolating between the states received from the server
+	*
+	* Those entities are rendered interpolationDelay seconds in the past (on top of the jitter buffer) and can be extrapolated for maxExtrapolation seconds when states are late.
+	* A negative interpolation delay is sized from the tick duration and the interval between received states (two intervals), zero disables snapshot interpolation.
+	*
+	* \remark This should be called before receiving any match state
+	*/
+	inline void LocalMatch::SetSnapshotInterpolation(float interpolationDelay, float maxExtrapolation)
+	{
+		m_interpolationDelay = interpolationDelay;
+		m_maxExtrapolation = maxExtrapolation;
+	}
 }
@@ -40,7 +40,7 @@ namespace bw
 
 		private:
 			void HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data);
-			void HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data);
+			void HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data, DisconnectionCause cause);
 			void HandlePeerPacket(std::size_t peerId, Nz::NetPacket& packet);
 
 			std::vector<std::unique_ptr<NetworkReactor>> m_reactors;
@@ -10,7 +10,6 @@
 #include <ClientLib/ClientSession.hpp>
 #include <ClientLib/DownloadManager.hpp>
 #include <ClientLib/Export.hpp>
-#include <Nazara/Core/Bitset.hpp>
 #include <Nazara/Core/File.hpp>
 #include <Nazara/Core/AbstractHash.hpp>
 #include <filesystem>
@@ -33,14 +32,20 @@ namespace bw
 			void Update() override;
 
 		private:
+			void FailDownload(std::size_t fileIndex, Error error);
+			void FinishDownload(std::size_t fileIndex);
 			void HandlePacket(const Packets::DownloadClientFileFragment& packet);
 			void HandlePacket(const Packets::DownloadClientFileResponse& packet);
 			void RequestNextFile();
 
 			struct PendingFile : FileEntry
 			{
-				Nz::Bitset<Nz::UInt64> receivedFragment;
-				Nz::UInt64 fragmentSize;
+				Nz::UInt32 fragmentCount = 0;
+				Nz::UInt32 receivedFragmentCount = 0;
+				Nz::UInt64 fragmentSize = 0;
+				Nz::UInt64 receivedSize = 0;
+				bool hasFailed = false;
+				bool isComplete = false;
 			};
 
 			Nz::ByteArray m_byteArray;
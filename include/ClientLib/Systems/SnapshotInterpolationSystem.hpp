@@ -0,0 +1,37 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CLIENTLIB_SYSTEMS_SNAPSHOTINTERPOLATIONSYSTEM_HPP
+#define BURGWAR_CLIENTLIB_SYSTEMS_SNAPSHOTINTERPOLATIONSYSTEM_HPP
+
+#include <ClientLib/Export.hpp>
+#include <NDK/System.hpp>
+
+namespace bw
+{
+	class BURGWAR_CLIENTLIB_API SnapshotInterpolationSystem : public Ndk::System<SnapshotInterpolationSystem>
+	{
+		public:
+			SnapshotInterpolationSystem();
+			~SnapshotInterpolationSystem() = default;
+
+			inline void SetMaxExtrapolation(float maxExtrapolation);
+			inline void SetRenderTick(Nz::UInt16 renderTick, float tickFraction);
+
+			static Ndk::SystemIndex systemIndex;
+
+		private:
+			void OnUpdate(float elapsedTime) override;
+
+			Nz::UInt16 m_renderTick;
+			float m_maxExtrapolation;
+			float m_tickFraction;
+	};
+}
+
+#include <ClientLib/Systems/SnapshotInterpolationSystem.inl>
+
+#endif
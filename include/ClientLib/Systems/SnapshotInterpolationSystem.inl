@@ -0,0 +1,25 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <ClientLib/Systems/SnapshotInterpolationSystem.hpp>
+
+namespace bw
+{
+	/*!
+	* \brief Sets for how many ticks entities can be extrapolated past their most recent snapshot
+	*/
+	inline void SnapshotInterpolationSystem::SetMaxExtrapolation(float maxExtrapolation)
+	{
+		m_maxExtrapolation = maxExtrapolation;
+	}
+
+	/*!
+	* \brief Sets the server time at which entities will be rendered on next update
+	*/
+	inline void SnapshotInterpolationSystem::SetRenderTick(Nz::UInt16 renderTick, float tickFraction)
+	{
+		m_renderTick = renderTick;
+		m_tickFraction = tickFraction;
+	}
+}
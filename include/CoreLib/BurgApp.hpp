@@ -11,6 +11,7 @@
 #include <CoreLib/LogSystem/Enums.hpp>
 #include <CoreLib/LogSystem/Logger.hpp>
 #include <Nazara/Prerequisites.hpp>
+#include <atomic>
 
 namespace bw
 {
@@ -34,7 +35,7 @@ namespace bw
 		protected:
 			const ConfigFile& m_config;
 
-			Nz::UInt64 m_appTime;
+			std::atomic<Nz::UInt64> m_appTime; //< Read by match threads on servers hosting multiple matches
 			Nz::UInt64 m_lastTime;
 	};
 }
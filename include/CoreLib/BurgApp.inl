@@ -11,7 +11,7 @@ namespace bw
 {
 	inline Nz::UInt64 BurgApp::GetAppTime() const
 	{
-		return m_appTime;
+		return m_appTime.load(std::memory_order_relaxed);
 	}
 
 	inline const ConfigFile& BurgApp::GetConfig() const
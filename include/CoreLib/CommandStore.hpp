@@ -37,7 +37,7 @@ namespace bw
 
 			bool UnserializePacket(PeerRef peer, Nz::NetPacket& packet) const;
 
-			using UnserializeFunction = std::function<void(PeerRef peer, Nz::NetPacket& packet)>;
+			using UnserializeFunction = std::function<bool(PeerRef peer, Nz::NetPacket& packet)>;
 
 			struct IncomingCommand
 			{
@@ -59,7 +59,7 @@ namespace bw
 			template<typename T> void RegisterOutgoingCommand(const char* name, Nz::ENetPacketFlags flags, Nz::UInt8 channelId);
 
 		private:
-			using HandleFunction = std::function<void(Nz::NetPacket& packet)>;
+			template<typename T, typename CB> bool UnserializeInto(PeerRef peer, Nz::NetPacket& packet, const char* name, T& data, CB& callback) const;
 
 			std::vector<IncomingCommand> m_incomingCommands;
 			std::vector<OutgoingCommand> m_outgoingCommands;
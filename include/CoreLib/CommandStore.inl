@@ -5,6 +5,7 @@
 #include <CoreLib/CommandStore.hpp>
 #include <CoreLib/LogSystem/Logger.hpp>
 #include <CoreLib/Protocol/Packets.hpp>
+#include <Nazara/Core/CallOnExit.hpp>
 #include <cassert>
 
 namespace bw
@@ -52,23 +53,20 @@ namespace bw
 
 		IncomingCommand& newCommand = m_incomingCommands[packetId];
 		newCommand.enabled = true;
-		newCommand.unserialize = [this, cb = std::forward<CB>(callback)](PeerRef peer, Nz::NetPacket& packet)
+		// Packets of a given type are always unserialized in the same object, which keeps its buffers (vectors, strings) from one packet to the next
+		newCommand.unserialize = [this, cb = std::forward<CB>(callback), data = T{}, isHandling = false, name](PeerRef peer, Nz::NetPacket& packet) mutable
 		{
-			T data;
-			try
+			// Callback may end up receiving a packet of the same type while it's still using the reused one
+			if (isHandling)
 			{
-				PacketSerializer serializer(packet, false);
-
-				Packets::Serialize(serializer, data);
-			}
-			catch (const std::exception&)
-			{
-				bwLog(m_logger, LogLevel::Error, "Failed to unserialize packet");
-				return false;
+				T packetData;
+				return UnserializeInto(peer, packet, name, packetData, cb);
 			}
 
-			cb(peer, std::move(data));
-			return true;
+			isHandling = true;
+			Nz::CallOnExit resetHandling([&] { isHandling = false; });
+
+			return UnserializeInto(peer, packet, name, data, cb);
 		};
 		newCommand.name = name;
 	}
@@ -109,11 +107,7 @@ namespace bw
 	bool CommandStore<Peer>::UnserializePacket(PeerRef peer, Nz::NetPacket& packet) const
 	{
 		Nz::UInt8 opcode;
-		try
-		{
-			packet >> opcode;
-		}
-		catch (const std::exception&)
+		if (packet.Read(&opcode, sizeof(opcode)) != sizeof(opcode))
 		{
 			bwLog(m_logger, LogLevel::Error, "Failed to unserialize opcode");
 			return false;
@@ -125,7 +119,32 @@ namespace bw
 			return false;
 		}
 
-		m_incomingCommands[opcode].unserialize(peer, packet);
+		return m_incomingCommands[opcode].unserialize(peer, packet);
+	}
+
+	template<typename Peer>
+	template<typename T, typename CB>
+	bool CommandStore<Peer>::UnserializeInto(PeerRef peer, Nz::NetPacket& packet, const char* name, T& data, CB& callback) const
+	{
+		try
+		{
+			PacketSerializer serializer(packet, false);
+			Packets::Serialize(serializer, data);
+
+			if (!serializer.IsValid())
+			{
+				bwLog(m_logger, LogLevel::Error, "Failed to unserialize {} packet: not enough data", name);
+				return false;
+			}
+		}
+		catch (const std::exception& e)
+		{
+			// Only unexpected errors (such as allocation failures) end up here, truncated packets are reported through the serializer
+			bwLog(m_logger, LogLevel::Error, "Failed to unserialize {} packet: {}", name, e.what());
+			return false;
+		}
+
+		callback(peer, data);
 		return true;
 	}
 }
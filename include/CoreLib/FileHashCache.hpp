@@ -0,0 +1,74 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_FILEHASHCACHE_HPP
+#define BURGWAR_CORELIB_FILEHASHCACHE_HPP
+
+#include <CoreLib/Export.hpp>
+#include <Nazara/Core/ByteArray.hpp>
+#include <tsl/hopscotch_map.h>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bw
+{
+	class BURGWAR_CORELIB_API FileHashCache
+	{
+		public:
+			struct FileHash;
+			struct Statistics;
+
+			FileHashCache(std::filesystem::path manifestPath = {});
+			FileHashCache(const FileHashCache&) = delete;
+			FileHashCache(FileHashCache&&) = delete;
+			~FileHashCache() = default;
+
+			std::vector<std::optional<FileHash>> ComputeHashes(const std::vector<std::filesystem::path>& filePaths, Statistics* statistics = nullptr);
+
+			inline const std::filesystem::path& GetManifestPath() const;
+
+			bool Load();
+			bool Save();
+
+			FileHashCache& operator=(const FileHashCache&) = delete;
+			FileHashCache& operator=(FileHashCache&&) = delete;
+
+			struct FileHash
+			{
+				Nz::ByteArray checksum; //< SHA1
+				Nz::UInt64 size;
+			};
+
+			struct Statistics
+			{
+				std::size_t cachedFileCount = 0;
+				std::size_t hashedFileCount = 0;
+				Nz::UInt64 hashedByteCount = 0;
+			};
+
+			static constexpr unsigned int ManifestVersion = 1;
+
+		private:
+			struct Entry
+			{
+				Nz::ByteArray checksum;
+				Nz::Int64 modificationTime;
+				Nz::UInt64 size;
+			};
+
+			std::filesystem::path m_manifestPath;
+			std::mutex m_mutex;
+			tsl::hopscotch_map<std::string, Entry> m_entries;
+			bool m_isModified;
+	};
+}
+
+#include <CoreLib/FileHashCache.inl>
+
+#endif
@@ -4,17 +4,17 @@
 
 #pragma once
 
-#ifndef BURGWAR_CLIENTLIB_LOCALPLAYERBRIDGE_HPP
-#define BURGWAR_CLIENTLIB_LOCALPLAYERBRIDGE_HPP
+#ifndef BURGWAR_CORELIB_LOCALSESSIONBRIDGE_HPP
+#define BURGWAR_CORELIB_LOCALSESSIONBRIDGE_HPP
 
 #include <CoreLib/SessionBridge.hpp>
-#include <ClientLib/Export.hpp>
+#include <CoreLib/Export.hpp>
 
 namespace bw
 {
 	class LocalSessionManager;
 
-	class BURGWAR_CLIENTLIB_API LocalSessionBridge : public SessionBridge
+	class BURGWAR_CORELIB_API LocalSessionBridge : public SessionBridge
 	{
 		public:
 			LocalSessionBridge(LocalSessionManager& sessionManager, std::size_t peerId, bool isServer);
@@ -28,7 +28,7 @@ namespace bw
 
 			void QueryInfo(std::function<void(const SessionInfo& info)> callback) const override;
 
-			void SendPacket(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet) override;
+			void SendPacket(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, const Nz::NetPacket& packet) override;
 
 		private:
 			std::size_t m_peerId;
@@ -39,6 +39,6 @@ namespace bw
 	};
 }
 
-#include <ClientLib/LocalSessionBridge.inl>
+#include <CoreLib/LocalSessionBridge.inl>
 
 #endif
@@ -4,11 +4,11 @@
 
 #pragma once
 
-#ifndef BURGWAR_CLIENTLIB_LOCALSESSIONMANAGER_HPP
-#define BURGWAR_CLIENTLIB_LOCALSESSIONMANAGER_HPP
+#ifndef BURGWAR_CORELIB_LOCALSESSIONMANAGER_HPP
+#define BURGWAR_CORELIB_LOCALSESSIONMANAGER_HPP
 
 #include <CoreLib/SessionManager.hpp>
-#include <ClientLib/Export.hpp>
+#include <CoreLib/Export.hpp>
 #include <Nazara/Core/MemoryPool.hpp>
 #include <optional>
 #include <vector>
@@ -19,7 +19,7 @@ namespace bw
 	class MatchClientSession;
 	class MatchSessions;
 
-	class BURGWAR_CLIENTLIB_API LocalSessionManager : public SessionManager
+	class BURGWAR_CORELIB_API LocalSessionManager : public SessionManager
 	{
 		friend LocalSessionBridge;
 
@@ -54,6 +54,6 @@ namespace bw
 	};
 }
 
-#include <CoreLib/NetworkSessionManager.inl>
+#include <CoreLib/LocalSessionManager.inl>
 
 #endif
@@ -0,0 +1,90 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_LOGSYSTEM_ASYNCSINK_HPP
+#define BURGWAR_CORELIB_LOGSYSTEM_ASYNCSINK_HPP
+
+#include <CoreLib/Export.hpp>
+#include <CoreLib/LogSystem/Enums.hpp>
+#include <CoreLib/LogSystem/LogSink.hpp>
+#include <Nazara/Prerequisites.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bw
+{
+	/*!
+	* \brief Sink forwarding messages to other sinks from a single background thread
+	*
+	* Messages are copied into a fixed-size lock-free ring buffer, logging threads never wait on the wrapped sinks unless the buffer is full and the overflow policy is Block.
+	* Wrap every sink of a logger in one AsyncSink rather than one AsyncSink per sink, each AsyncSink owns a thread.
+	*/
+	class BURGWAR_CORELIB_API AsyncSink : public LogSink
+	{
+		public:
+			enum class OverflowPolicy
+			{
+				Block, //< Wait for the background thread to make some room
+				Drop   //< Discard the message (a warning with the number of discarded messages is written afterwards)
+			};
+
+			AsyncSink(std::vector<std::shared_ptr<LogSink>> sinks, std::size_t capacity = DefaultCapacity, OverflowPolicy overflowPolicy = OverflowPolicy::Block);
+			AsyncSink(const AsyncSink&) = delete;
+			AsyncSink(AsyncSink&&) = delete;
+			~AsyncSink();
+
+			inline std::size_t GetCapacity() const;
+			inline Nz::UInt64 GetDroppedMessageCount() const;
+
+			void Write(const LogContext& context, std::string_view content) override;
+
+			AsyncSink& operator=(const AsyncSink&) = delete;
+			AsyncSink& operator=(AsyncSink&&) = delete;
+
+			static constexpr std::size_t DefaultCapacity = 4096;
+
+		private:
+			bool FlushEntries();
+			bool HasPendingEntry() const;
+			bool TryPush(const LogContext& context, std::string_view content);
+			void WakeUp();
+			void WriterThread();
+
+			struct Entry
+			{
+				std::atomic<std::size_t> sequence;
+				std::string content; //< Capacity is kept between messages, preventing most allocations once warm
+				LogLevel level;
+				LogSide side;
+				float elapsedTime;
+			};
+
+			// Producer and consumer indices are written by different threads, keep them on different cache lines
+			alignas(64) std::atomic<std::size_t> m_writeIndex;
+			alignas(64) std::size_t m_readIndex;
+			std::atomic<Nz::UInt64> m_droppedMessageCount;
+			std::atomic_bool m_isWriterSleeping;
+			std::atomic_bool m_running;
+			std::condition_variable m_wakeUpSignal;
+			std::mutex m_wakeUpMutex;
+			std::vector<std::shared_ptr<LogSink>> m_sinks;
+			std::size_t m_capacityMask;
+			std::thread m_writerThread;
+			std::unique_ptr<Entry[]> m_entries;
+			float m_lastElapsedTime;
+			Nz::UInt64 m_reportedDroppedMessageCount;
+			OverflowPolicy m_overflowPolicy;
+	};
+}
+
+#include <CoreLib/LogSystem/AsyncSink.inl>
+
+#endif
@@ -0,0 +1,21 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/LogSystem/AsyncSink.hpp>
+
+namespace bw
+{
+	inline std::size_t AsyncSink::GetCapacity() const
+	{
+		return m_capacityMask + 1;
+	}
+
+	/*!
+	* \brief Returns the number of messages discarded because the buffer was full (always zero with the Block policy)
+	*/
+	inline Nz::UInt64 AsyncSink::GetDroppedMessageCount() const
+	{
+		return m_droppedMessageCount.load(std::memory_order_relaxed);
+	}
+}
@@ -7,6 +7,8 @@
 #ifndef BURGWAR_CORELIB_LOGSYSTEM_ENUMS_HPP
 #define BURGWAR_CORELIB_LOGSYSTEM_ENUMS_HPP
 
+#include <CoreLib/Export.hpp>
+
 namespace bw
 {
 	enum class LogLevel
@@ -25,6 +27,8 @@ namespace bw
 		Editor,
 		Server
 	};
+
+	BURGWAR_CORELIB_API const char* ToString(LogLevel level);
 }
 
 #endif
@@ -0,0 +1,51 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_LOGSYSTEM_FILESINK_HPP
+#define BURGWAR_CORELIB_LOGSYSTEM_FILESINK_HPP
+
+#include <CoreLib/Export.hpp>
+#include <CoreLib/LogSystem/LogSink.hpp>
+#include <Nazara/Prerequisites.hpp>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace bw
+{
+	class BURGWAR_CORELIB_API FileSink : public LogSink
+	{
+		public:
+			FileSink(std::filesystem::path filePath, Nz::UInt64 maxFileSize = 0, std::size_t maxBackupCount = 0);
+			FileSink(const FileSink&) = delete;
+			FileSink(FileSink&&) = delete;
+			~FileSink() = default;
+
+			inline const std::filesystem::path& GetFilePath() const;
+
+			inline bool IsOpen() const;
+
+			void Write(const LogContext& context, std::string_view content) override;
+
+			FileSink& operator=(const FileSink&) = delete;
+			FileSink& operator=(FileSink&&) = delete;
+
+		private:
+			void Open();
+			void Rotate();
+
+			std::filesystem::path m_filePath;
+			std::mutex m_mutex;
+			std::ofstream m_file;
+			std::size_t m_maxBackupCount;
+			Nz::UInt64 m_fileSize;
+			Nz::UInt64 m_maxFileSize;
+	};
+}
+
+#include <CoreLib/LogSystem/FileSink.inl>
+
+#endif
@@ -0,0 +1,18 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/LogSystem/FileSink.hpp>
+
+namespace bw
+{
+	inline const std::filesystem::path& FileSink::GetFilePath() const
+	{
+		return m_filePath;
+	}
+
+	inline bool FileSink::IsOpen() const
+	{
+		return m_file.is_open();
+	}
+}
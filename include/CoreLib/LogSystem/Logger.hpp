@@ -18,12 +18,18 @@
 #include <memory>
 #include <vector>
 
+// Level is checked first so filtered out statements don't allocate a context nor format their arguments
 #define bwLog(logObject, lvl, ...) do \
 { \
-	auto _bwLogContext = (logObject).PushContext(); \
-	_bwLogContext->level = lvl; \
-	if ((logObject).ShouldLog(*_bwLogContext)) \
-		(logObject).LogFormat(*_bwLogContext, __VA_ARGS__); \
+	auto&& _bwLogger = (logObject); \
+	bw::LogLevel _bwLogLevel = lvl; \
+	if (_bwLogger.IsLevelEnabled(_bwLogLevel)) \
+	{ \
+		auto _bwLogContext = _bwLogger.PushContext(); \
+		_bwLogContext->level = _bwLogLevel; \
+		if (_bwLogger.ShouldLog(*_bwLogContext)) \
+			_bwLogger.LogFormat(*_bwLogContext, __VA_ARGS__); \
+	} \
 } \
 while (false)
 
@@ -46,6 +52,10 @@ namespace bw
 
 			template<typename... Args> void LogFormat(const LogContext& context, Args&& ... args) const;
 
+			inline void ClearSinks();
+
+			bool IsLevelEnabled(LogLevel level) const override;
+
 			void Log(const LogContext& context, std::string content) const override;
 			void LogRaw(const LogContext& context, std::string_view content) const override;
 
@@ -22,6 +22,11 @@ namespace bw
 		m_logParent = &logParent;
 	}
 
+	inline void Logger::ClearSinks()
+	{
+		m_sinks.clear();
+	}
+
 	template<typename... Args>
 	void Logger::LogFormat(const LogContext& context, Args&&... args) const
 	{
@@ -24,6 +24,8 @@ namespace bw
 
 			template<typename... Args> void LogFormat(const LogContext& context, Args&& ... args) const;
 
+			bool IsLevelEnabled(LogLevel level) const override;
+
 			void Log(const LogContext& context, std::string content) const override;
 			void LogRaw(const LogContext& context, std::string_view content) const override;
 
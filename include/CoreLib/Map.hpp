@@ -20,6 +20,11 @@
 #include <filesystem>
 #include <vector>
 
+namespace Nz
+{
+	class ByteStream;
+}
+
 namespace bw
 {
 	struct MapInfo
@@ -137,6 +142,8 @@ namespace bw
 		private:
 			bool CheckEntityIndices() const;
 			void LoadFromBinaryInternal(const std::filesystem::path& mapFile);
+			void LoadFromBinaryV1(Nz::ByteStream& stream, Nz::UInt16 fileVersion);
+			void LoadFromBinaryV2(const std::vector<Nz::UInt8>& content);
 			void LoadFromTextInternal(const std::filesystem::path& mapFolder);
 			inline void RegisterEntity(EntityId uniqueId, LayerIndex layerIndex, std::size_t entityIndex);
 			void Sanitize();
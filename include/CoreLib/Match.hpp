@@ -9,6 +9,7 @@
 
 #include <CoreLib/AssetStore.hpp>
 #include <CoreLib/Export.hpp>
+#include <CoreLib/FileHashCache.hpp>
 #include <CoreLib/Map.hpp>
 #include <CoreLib/MatchSessions.hpp>
 #include <CoreLib/Player.hpp>
@@ -25,6 +26,7 @@
 #include <Nazara/Core/ObjectHandle.hpp>
 #include <Nazara/Network/UdpSocket.hpp>
 #include <tsl/hopscotch_map.h>
+#include <filesystem>
 #include <memory>
 #include <optional>
 #include <string>
@@ -53,6 +55,7 @@ namespace bw
 			struct ClientScript;
 			struct MatchSettings;
 			struct GamemodeSettings;
+			struct TickProfilerSettings;
 
 			Match(BurgApp& app, MatchSettings matchSettings, GamemodeSettings gamemodeSettings);
 			Match(const Match&) = delete;
@@ -67,6 +70,8 @@ namespace bw
 			void BuildClientAssetListPacket(Packets::MatchData& clientAsset) const;
 			void BuildClientScriptListPacket(Packets::MatchData& clientScript) const;
 
+			std::optional<std::filesystem::path> DumpTickProfile();
+
 			Player* CreatePlayer(MatchClientSession& session, Nz::UInt8 localIndex, std::string name);
 
 			void ForEachEntity(std::function<void(const Ndk::EntityHandle& entity)> func) override;
@@ -77,13 +82,16 @@ namespace bw
 			bool GetClientAsset(const std::string& filePath, const ClientAsset** clientScriptData);
 			bool GetClientScript(const std::string& filePath, const ClientScript** clientScriptData);
 			ServerEntityStore& GetEntityStore() override;
+			inline const std::optional<float>& GetInterestRadius() const;
 			const ServerEntityStore& GetEntityStore() const override;
+			inline Nz::UInt64 GetFileTransferRate() const;
 			inline const std::shared_ptr<ServerGamemode>& GetGamemode();
 			TerrainLayer& GetLayer(LayerIndex layerIndex) override;
 			const TerrainLayer& GetLayer(LayerIndex layerIndex) const override;
 			LayerIndex GetLayerCount() const override;
 			inline sol::state& GetLuaState();
 			inline const Packets::MatchData& GetMatchData() const;
+			inline const std::optional<Packets::Helper::MatchStateQuantization>& GetMatchStateQuantization() const;
 			const NetworkStringStore& GetNetworkStringStore() const override;
 			inline Player* GetPlayerByIndex(Nz::UInt16 playerIndex);
 			inline MatchSessions& GetSessions();
@@ -98,6 +106,7 @@ namespace bw
 			void InitDebugGhosts();
 
 			void RegisterClientAsset(std::string assetPath);
+			void RegisterClientAssets(std::vector<std::string> assetPaths);
 			void RegisterClientScript(std::string scriptPath);
 			void RegisterEntity(EntityId uniqueId, Ndk::EntityHandle entity);
 			void RegisterNetworkString(std::string string);
@@ -125,15 +134,38 @@ namespace bw
 			struct ClientScript
 			{
 				Nz::ByteArray checksum;
-				std::vector<Nz::UInt8> content;
+				Nz::UInt64 size;
+				std::filesystem::path realPath;
+			};
+
+			struct QuantizationSettings
+			{
+				float angularVelocityPrecision;
+				float linearVelocityPrecision;
+				float positionPrecision;
+				Nz::UInt8 rotationBits;
+			};
+
+			struct TickProfilerSettings
+			{
+				std::filesystem::path dumpFolder = "profiles";
+				bool enable = false;
+				float dumpInterval = 0.f; //< Seconds between automatic dumps (0 to dump only on request)
 			};
 
 			struct MatchSettings
 			{
+				std::optional<float> interestRadius; //< Only entities within this radius of a player are sent to its client
+				std::optional<QuantizationSettings> matchStateQuantization;
+				std::shared_ptr<FileHashCache> fileHashCache; //< Can be shared between matches, a private in-memory cache is used if null
+				std::shared_ptr<ScriptBytecodeCache> scriptBytecodeCache; //< Can be shared between matches, a private in-memory cache is used if null
+				std::size_t layerWorkerCount = 0; //< Extra threads used to update layers in parallel (0 to update them sequentially)
+				Nz::UInt64 fileTransferRate = 1024 * 1024; //< Bytes per second sent to each client downloading files
 				std::size_t maxPlayerCount;
 				std::string name;
 				Map map;
 				float tickDuration;
+				TickProfilerSettings tickProfiler;
 			};
 
 			struct GamemodeSettings
@@ -144,6 +176,7 @@ namespace bw
 
 		private:
 			void BuildMatchData();
+			void HashPendingClientScripts();
 			void OnPlayerReady(Player* player);
 			void OnTick(bool lastTick) override;
 			void RegisterClientAssetInternal(std::string assetPath, Nz::UInt64 assetSize, Nz::ByteArray assetChecksum, std::filesystem::path realPath);
@@ -164,30 +197,40 @@ namespace bw
 				NazaraSlot(Ndk::Entity, OnEntityDestruction, onDestruction);
 			};
 
+			std::shared_ptr<ScriptBytecodeCache> m_scriptBytecodeCache;
 			std::shared_ptr<ScriptingContext> m_scriptingContext; //< Must be over script based classes
 			std::optional<AssetStore> m_assetStore;
 			std::optional<Debug> m_debug;
+			std::optional<float> m_interestRadius;
+			std::optional<Packets::Helper::MatchStateQuantization> m_matchStateQuantization;
 			std::optional<ServerEntityStore> m_entityStore;
 			std::optional<ServerWeaponStore> m_weaponStore;
 			std::size_t m_maxPlayerCount;
+			std::shared_ptr<FileHashCache> m_fileHashCache;
 			std::shared_ptr<ServerGamemode> m_gamemode;
 			std::shared_ptr<ServerScriptingLibrary> m_scriptingLibrary;
 			std::string m_name;
 			std::unique_ptr<Terrain> m_terrain;
 			std::vector<std::unique_ptr<Player>> m_players;
+			std::vector<std::string> m_pendingClientScripts; //< Registered client scripts which haven't been hashed yet
 			mutable Packets::MatchData m_matchData;
+			FileHashCache::Statistics m_scriptHashStatistics;
 			tsl::hopscotch_map<std::string, ClientAsset> m_clientAssets;
 			tsl::hopscotch_map<std::string, ClientScript> m_clientScripts;
 			tsl::hopscotch_map<EntityId, Entity> m_entitiesByUniqueId;
 			Nz::Bitset<> m_freePlayerId;
 			EntityId m_nextUniqueId;
+			Nz::UInt64 m_fileTransferRate;
 			Nz::UInt64 m_lastPingUpdate;
+			Nz::UInt64 m_lastTickProfileDump;
 			BurgApp& m_app;
 			GamemodeSettings m_gamemodeSettings;
 			Map m_map;
 			MatchSessions m_sessions;
 			NetworkStringStore m_networkStringStore;
+			TickProfilerSettings m_tickProfilerSettings;
 			bool m_disableWhenEmpty;
+			bool m_isLoadingScripts;
 	};
 }
 
@@ -43,11 +43,21 @@ namespace bw
 		return *m_assetStore;
 	}
 
+	inline Nz::UInt64 Match::GetFileTransferRate() const
+	{
+		return m_fileTransferRate;
+	}
+
 	inline const std::shared_ptr<ServerGamemode>& Match::GetGamemode()
 	{
 		return m_gamemode;
 	}
 
+	inline const std::optional<float>& Match::GetInterestRadius() const
+	{
+		return m_interestRadius;
+	}
+
 	inline sol::state& Match::GetLuaState()
 	{
 		return m_scriptingContext->GetLuaState();
@@ -59,6 +69,11 @@ namespace bw
 		return m_matchData;
 	}
 
+	inline const std::optional<Packets::Helper::MatchStateQuantization>& Match::GetMatchStateQuantization() const
+	{
+		return m_matchStateQuantization;
+	}
+
 	inline Player* Match::GetPlayerByIndex(Nz::UInt16 playerIndex)
 	{
 		if (playerIndex >= m_players.size() || m_freePlayerId.Test(playerIndex))
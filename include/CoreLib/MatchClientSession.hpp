@@ -12,8 +12,13 @@
 #include <CoreLib/SessionBridge.hpp>
 #include <CoreLib/Protocol/Packets.hpp>
 #include <CoreLib/Utility/CircularBuffer.hpp>
+#include <Nazara/Core/ByteArray.hpp>
+#include <Nazara/Core/File.hpp>
 #include <Nazara/Core/HandledObject.hpp>
 #include <Nazara/Core/ObjectHandle.hpp>
+#include <Nazara/Network/NetPacket.hpp>
+#include <array>
+#include <deque>
 #include <filesystem>
 #include <memory>
 #include <vector>
@@ -61,6 +66,8 @@ namespace bw
 			MatchClientSession& operator=(const MatchClientSession&) = delete;
 			MatchClientSession& operator=(MatchClientSession&&) = delete;
 
+			static constexpr std::size_t MaxLocalPlayerCount = 7; //< Players sharing a single client
+
 		private:
 			void HandleIncomingPacket(const Packets::Auth& packet);
 			void HandleIncomingPacket(const Packets::DownloadClientFileRequest& packet);
@@ -72,22 +79,25 @@ namespace bw
 			void HandleIncomingPacket(const Packets::ScriptPacket& packet);
 			void HandleIncomingPacket(Packets::UpdatePlayerName&& packet);
 			void SendClientFile(const std::filesystem::path& filePath);
-			void SendClientFile(const std::vector<Nz::UInt8>& content);
+			void SendClientScript(const std::filesystem::path& filePath, Nz::UInt64 expectedSize, const Nz::ByteArray& expectedChecksum);
+			void SendFileFragments(float elapsedTime);
 			void UpdatePeerInfo(const SessionBridge::SessionInfo& sessionInfo);
 
 			struct Input
 			{
-				std::vector<std::optional<PlayerInputData>> inputs;
+				// Fixed-size so queuing inputs doesn't allocate
+				std::array<std::optional<PlayerInputData>, MaxLocalPlayerCount> inputs;
 				Nz::UInt16 inputTick;
 			};
 
-			/*struct PendingAssetRequest
+			struct PendingFileTransfer
 			{
-				std::size_t fragmentCount;
-				std::size_t currentFragmentIndex;
-				std::filesystem::path filePath;
-				Nz::UInt64 fragmentSize;
-			};*/
+				std::unique_ptr<Nz::File> file; //< Assets are streamed from disk
+				std::vector<Nz::UInt8> content; //< Client scripts are sent from a verified copy
+				Nz::UInt32 fragmentCount;
+				Nz::UInt32 nextFragmentIndex = 0;
+				Nz::UInt64 size;
+			};
 
 			CircularBuffer<Input> m_queuedInputs;
 			Match& m_match;
@@ -95,10 +105,13 @@ namespace bw
 			std::size_t m_sessionId;
 			std::shared_ptr<SessionBridge> m_bridge;
 			std::unique_ptr<MatchClientVisibility> m_visibility;
-			//std::vector<PendingAssetRequest> m_pendingAssetRequest;
+			std::deque<PendingFileTransfer> m_pendingFileTransfers;
 			std::vector<PlayerHandle> m_players;
+			Nz::NetPacket m_outgoingPacket;
 			Nz::UInt16 m_lastInputTick;
 			Nz::UInt32 m_ping;
+			Nz::UInt64 m_fileTransferBudget;
+			Nz::UInt64 m_reliableBytesInFlight; //< Last reported by the bridge, plus fragments sent since then
 			float m_peerInfoUpdateCounter;
 	};
 }
@@ -50,10 +50,11 @@ namespace bw
 	template<typename T>
 	void MatchClientSession::SendPacket(const T& packet)
 	{
-		Nz::NetPacket data;
-		m_commandStore.SerializePacket(data, packet);
+		// Every packet is serialized in the same buffer, which keeps its capacity instead of growing again for each packet
+		m_outgoingPacket.Reset();
+		m_commandStore.SerializePacket(m_outgoingPacket, packet);
 
 		const auto& command = m_commandStore.GetOutgoingCommand<T>();
-		m_bridge->SendPacket(command.channelId, command.flags, std::move(data));
+		m_bridge->SendPacket(command.channelId, command.flags, m_outgoingPacket);
 	}
 }
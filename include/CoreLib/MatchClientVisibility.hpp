@@ -11,16 +11,21 @@
 #include <CoreLib/LayerIndex.hpp>
 #include <CoreLib/Match.hpp>
 #include <CoreLib/MatchClientSession.hpp>
+#include <CoreLib/Protocol/MatchStateBuilder.hpp>
+#include <CoreLib/Protocol/MatchStateQuantizer.hpp>
 #include <CoreLib/Protocol/Packets.hpp>
+#include <CoreLib/Utils.hpp>
 #include <CoreLib/Components/HealthComponent.hpp>
 #include <CoreLib/Systems/NetworkSyncSystem.hpp>
 #include <Nazara/Core/Bitset.hpp>
 #include <Nazara/Core/Flags.hpp>
 #include <Nazara/Core/Signal.hpp>
+#include <Nazara/Network/ENetProtocol.hpp>
 #include <NDK/EntityList.hpp>
 #include <tsl/hopscotch_map.h>
 #include <tsl/hopscotch_set.h>
 #include <limits>
+#include <optional>
 #include <vector>
 
 namespace bw
@@ -62,8 +67,13 @@ namespace bw
 			MatchClientVisibility(MatchClientVisibility&&) noexcept = default;
 			~MatchClientVisibility() = default;
 
+			void AcknowledgeStateTick(Nz::UInt16 stateTick, Nz::UInt32 previousStatesMask);
+
 			inline void ClearLayers();
 
+			inline void EnableBatchedEntityEvents(bool enable = true);
+			void EnableMatchStateQuantization(const Packets::Helper::MatchStateQuantization& quantization);
+
 			inline void HideLayer(LayerIndex layerIndex);
 
 			inline bool IsLayerVisible(LayerIndex layerIndex) const;
@@ -86,15 +96,29 @@ namespace bw
 			{
 				Nz::UInt8 priorityAccumulator;
 				LayerIndex layerIndex;
-				NetworkSyncSystem::EntityMovement movementData;
+				const NetworkSyncSystem::EntityMovement* movementData;
 				bool staticEntity;
 			};
 
+			struct Layer;
+			struct SentMatchState;
+
 			void BuildMovementPacket(Packets::MatchState::Entity& packetData, const NetworkSyncSystem::EntityMovement& eventData);
-			void FillEntityData(const NetworkSyncSystem::EntityCreation& creationEvent, Packets::Helper::EntityData& entityData);
+			Nz::UInt8 ComputeMovementPriority(const Layer& layer, const Nz::Vector2f& position) const;
 			void HandleEntityCreation(LayerIndex layerIndex, const NetworkSyncSystem::EntityCreation& eventData);
 			void HandleEntityRemove(LayerIndex layerIndex, Ndk::EntityId entityId, bool deathEvent);
+			void HandleLostMatchState(SentMatchState& sentState);
+			bool IsEntityRelevant(const Layer& layer, const NetworkSyncSystem::EntityCreation& entityCreation) const;
+			bool IsInInterestArea(const Layer& layer, const Nz::Vector2f& position, float radius) const;
+			template<typename T, typename E, typename F> void SendBatchedEntityEvents(T& packet, Nz::UInt16 networkTick, std::size_t maxEntitySize, tsl::hopscotch_map<Nz::UInt32, E> Layer::* layerEvents, F&& fillEntity);
 			void SendMatchState();
+			void UpdateInterestAreas();
+			void UpdateViewpoints();
+
+			static constexpr float InterestLeaveFactor = 1.25f; //< prevents entities at the edge of the interest area from being created/destroyed repeatedly
+			static constexpr std::size_t MatchStateHistorySize = MatchStateQuantizer::BaselineHistorySize;
+			static constexpr std::size_t MaxBatchedEventsPacketSize = Nz::ENetConstants::ENetHost_DefaultMTU - sizeof(Nz::ENetProtocolHeader) - sizeof(Nz::ENetProtocolSendReliable);
+			static constexpr std::size_t MaxMatchStatePacketSize = Nz::ENetConstants::ENetHost_DefaultMTU - sizeof(Nz::ENetProtocolHeader) - sizeof(Nz::ENetProtocolSendFragment);
 
 			using EntityPacketSendFunction = std::function<void()>;
 			using PendingCreationEventMap = tsl::hopscotch_map<Nz::UInt32 /*entityId*/, std::optional<NetworkSyncSystem::EntityCreation>>;
@@ -105,6 +129,22 @@ namespace bw
 				LayerIndex layerIndex;
 			};
 
+			struct SentMatchState
+			{
+				struct Entity
+				{
+					std::optional<NetworkSyncSystem::EntityMovement> staticMovement;
+					LayerIndex layerIndex;
+					Nz::UInt32 entityId;
+					Nz::UInt8 priorityAccumulator;
+				};
+
+				std::optional<Nz::UInt16> stateTick;
+				std::vector<Entity> entities;
+				tsl::hopscotch_map<Nz::UInt64 /*layerId|entityId*/, MatchStateQuantizer::EntityState> quantizedStates;
+				bool isAcknowledged = false;
+			};
+
 			struct PendingMultipleEntities
 			{
 				LayerIndex layerIndex;
@@ -116,6 +156,7 @@ namespace bw
 			{
 				struct VisibleEntityData
 				{
+					std::optional<Nz::UInt16> lastSentTick;
 					Nz::UInt8 priorityAccumulator = 0;
 				};
 
@@ -132,6 +173,8 @@ namespace bw
 				tsl::hopscotch_map<Nz::UInt32 /*entityId*/, VisibleEntityData> visibleEntities;
 				tsl::hopscotch_set<Nz::UInt32 /*entityId*/> deathEvents;
 				tsl::hopscotch_set<Nz::UInt32 /*entityId*/> destructionEvents;
+				tsl::hopscotch_set<Nz::UInt32 /*entityId*/> interestEntities; //< visible entities subject to interest management
+				std::vector<Nz::Vector2f> viewpoints;
 
 				NazaraSlot(NetworkSyncSystem, OnEntityCreated,         onEntityCreatedSlot);
 				NazaraSlot(NetworkSyncSystem, OnEntityDeath,           onEntityDeath);
@@ -152,11 +195,17 @@ namespace bw
 			tsl::hopscotch_map<LayerIndex /*layerId*/, std::unique_ptr<Layer>> m_layers;
 			tsl::hopscotch_map<Nz::UInt64 /*layerId|entityId*/, std::vector<EntityPacketSendFunction>> m_pendingEntitiesEvent;
 			tsl::hopscotch_set<Nz::UInt64 /*layerId|entityId*/> m_controlledEntities;
+			std::vector<Ndk::EntityId> m_interestUpdateEntities;
 			std::vector<PendingLayerUpdate> m_pendingLayerUpdates;
 			std::vector<PendingMultipleEntities> m_multiplePendingEntitiesEvent;
 			std::vector<PriorityMovementData> m_priorityMovementData;
+			std::vector<SentMatchState> m_sentMatchStates;
+			std::optional<MatchStateQuantizer> m_matchStateQuantizer;
+			std::optional<Nz::UInt16> m_acknowledgedStateTick;
 			Match& m_match;
 			MatchClientSession& m_session;
+			MatchStateBuilder m_matchStateBuilder;
+			bool m_batchedEntityEvents;
 
 			Packets::CreateEntities    m_createEntitiesPacket;
 			Packets::DeleteEntities    m_deleteEntitiesPacket;
@@ -164,7 +213,9 @@ namespace bw
 			Packets::EntitiesAnimation m_entitiesAnimationPacket;
 			Packets::EntitiesDeath     m_entitiesDeathPacket;
 			Packets::EntitiesInputs    m_inputUpdatePacket;
+			Packets::EntitiesPhysics   m_physicsUpdatePacket;
 			Packets::EntitiesScale     m_scaleUpdatePacket;
+			Packets::EntitiesWeapon    m_weaponUpdatePacket;
 			Packets::MatchState        m_matchStatePacket;
 	};
 }
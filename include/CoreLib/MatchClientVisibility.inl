@@ -25,8 +25,11 @@ namespace bw
 	}
 
 	inline MatchClientVisibility::MatchClientVisibility(Match& match, MatchClientSession& session) :
+	m_sentMatchStates(MatchStateHistorySize),
 	m_match(match),
-	m_session(session)
+	m_session(session),
+	m_matchStateBuilder(MaxMatchStatePacketSize),
+	m_batchedEntityEvents(false)
 	{
 	}
 
@@ -43,6 +46,14 @@ namespace bw
 		m_layers.clear();
 	}
 
+	/*!
+	* \brief Sends physics and weapon updates as multi-entity packets (EntitiesPhysics/EntitiesWeapon) instead of one packet per entity
+	*/
+	inline void MatchClientVisibility::EnableBatchedEntityEvents(bool enable)
+	{
+		m_batchedEntityEvents = enable;
+	}
+
 	inline void MatchClientVisibility::HideLayer(LayerIndex layerIndex)
 	{
 		auto it = m_layers.find(layerIndex);
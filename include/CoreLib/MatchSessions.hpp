@@ -34,6 +34,7 @@ namespace bw
 			template<typename T, typename... Args> T* CreateSessionManager(Args&&... args);
 			void DeleteSession(MatchClientSession* session);
 
+			void Flush();
 			template<typename F> void ForEachSession(F&& cb);
 
 			inline Match& GetMatch();
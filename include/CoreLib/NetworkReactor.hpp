@@ -8,16 +8,28 @@
 #define BURGWAR_CORELIB_NETWORK_REACTOR_HPP
 
 #include <CoreLib/Export.hpp>
+#include <Nazara/Core/Bitset.hpp>
 #include <Nazara/Core/Thread.hpp>
 #include <Nazara/Network/ENetHost.hpp>
+#include <Nazara/Network/ENetPacket.hpp>
 #include <concurrentqueue/concurrentqueue.h>
 #include <atomic>
 #include <functional>
+#include <mutex>
+#include <optional>
 #include <variant>
 #include <vector>
 
 namespace bw
 {
+	enum class DisconnectionCause
+	{
+		Closed,            // Connection closed by either side, or timed out
+		ConnectionAborted, // Connection attempt cancelled by DisconnectPeer, the peer was never connected
+		ConnectionFailed,  // Every connection attempt failed, the peer was never connected
+		Kicked             // Connection closed by DisconnectPeer with DisconnectionType::Kick
+	};
+
 	enum class DisconnectionType
 	{
 		Kick,   // DisconnectNow
@@ -29,6 +41,7 @@ namespace bw
 	{
 		public:
 			struct PeerInfo;
+			struct SendStatistics;
 			using PeerInfoCallback = std::function<void(PeerInfo& peerInfo)>;
 
 			NetworkReactor(std::size_t firstId, Nz::NetProtocol protocol, Nz::UInt16 port, std::size_t maxClient);
@@ -39,13 +52,22 @@ namespace bw
 			std::size_t ConnectTo(Nz::IpAddress address, Nz::UInt32 data = 0);
 			void DisconnectPeer(std::size_t peerId, Nz::UInt32 data = 0, DisconnectionType type = DisconnectionType::Normal);
 
+			void EnableOutgoingBatching(bool enable);
+
+			void FlushOutgoing();
+
 			template<typename ConnectCB, typename DisconnectCB, typename DataCB>
 			void Poll(ConnectCB&& onConnection, DisconnectCB&& onDisconnection, DataCB&& onData);
 
 			inline Nz::NetProtocol GetProtocol() const;
+			SendStatistics GetSendStatistics() const;
+
+			inline bool IsOutgoingBatchingEnabled() const;
 
 			void QueryInfo(std::size_t peerId, PeerInfoCallback callback);
 
+			void ResetSendStatistics();
+
 			void SendData(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet);
 
 			NetworkReactor& operator=(const NetworkReactor&) = delete;
@@ -60,23 +82,54 @@ namespace bw
 				Nz::UInt32 totalPacketSent;
 				Nz::UInt64 totalByteReceived;
 				Nz::UInt64 totalByteSent;
+				Nz::UInt64 reliableBytesInFlight; //< Reliable data given to ENet and not acknowledged yet
+			};
+
+			struct SendStatistics
+			{
+				Nz::UInt64 packetCount = 0;    //< Packets put on the wire
+				Nz::UInt64 maxSendDelay = 0;   //< in microseconds, from SendData to the ENet flush which sent the packet
+				Nz::UInt64 totalSendDelay = 0; //< in microseconds
 			};
 
 			static constexpr std::size_t InvalidPeerId = std::numeric_limits<std::size_t>::max();
 	
 		private:
+			struct OutgoingEvent;
+
+			std::size_t AllocateSlot();
+			Nz::UInt64 CountReliableBytesInFlight(std::size_t slot);
+			void EnqueueOutgoing(OutgoingEvent&& outgoingEvent);
 			void EnsureProperDisconnection(const moodycamel::ProducerToken& producterToken, moodycamel::ConsumerToken& token);
-			void HandleConnectionRequests(moodycamel::ConsumerToken& token);
+			void FailConnectionAttempt(const moodycamel::ProducerToken& producterToken, std::size_t slot);
+			void ForgetAcknowledgedPackets(std::size_t slot);
+			void HandleConnectionRequests(const moodycamel::ProducerToken& producterToken);
+			void HandleOutgoingEvent(const moodycamel::ProducerToken& producterToken, OutgoingEvent& outEvent);
 			void ReceivePackets(const moodycamel::ProducerToken& producterToken);
+			void ReleasePeer(Nz::ENetPeer* peer);
+			void ReleaseSlot(std::size_t slot);
 			void SendPackets(const moodycamel::ProducerToken& producterToken, moodycamel::ConsumerToken& token);
+			void StartConnectionAttempt(const moodycamel::ProducerToken& producterToken, std::size_t slot);
+			Nz::UInt32 GetServiceTimeout() const;
+			void ServiceWakeUpHost();
+			void UpdateConnectionAttempts(const moodycamel::ProducerToken& producterToken);
+			void UpdateSendStatistics();
+			void WakeUp();
 			void WorkerThread();
 
-			struct ConnectionRequest
+			struct ConnectionAttempt
 			{
-				using Callback = std::function<void(std::size_t clientId)>;
+				Nz::IpAddress remoteAddress;
+				Nz::UInt64 nextEventTime; //< timeout of the current attempt if connecting, time of the next attempt otherwise
+				Nz::UInt32 data;
+				unsigned int remainingAttempts;
+				bool isConnecting;
+			};
 
-				Callback callback;
+			struct ConnectionRequest
+			{
 				Nz::IpAddress remoteAddress;
+				std::size_t slot;
 				Nz::UInt32 data;
 			};
 
@@ -90,6 +143,7 @@ namespace bw
 
 				struct DisconnectEvent
 				{
+					DisconnectionCause cause;
 					Nz::UInt32 data;
 				};
 
@@ -121,6 +175,7 @@ namespace bw
 					Nz::ENetPacketFlags flags;
 					Nz::UInt8 channelId;
 					Nz::NetPacket packet;
+					Nz::UInt64 sendTime; //< in microseconds, when SendData was called
 				};
 
 				struct QueryPeerInfo 
@@ -132,15 +187,44 @@ namespace bw
 				std::variant<DisconnectEvent, PacketEvent, QueryPeerInfo> data;
 			};
 
+			static constexpr std::size_t OutgoingBulkSize = 128;
+			static constexpr unsigned int ConnectionAttemptCount = 3;
+			static constexpr Nz::UInt64 ConnectionAttemptTimeout = 5000; //< in milliseconds
+			static constexpr Nz::UInt64 ConnectionRetryDelay = 1000; //< in milliseconds
+			static constexpr Nz::UInt32 MaxServiceTimeout = 50; //< in milliseconds
+			static constexpr Nz::UInt32 UnsignaledServiceTimeout = 5; //< in milliseconds, used while the wake-up connection isn't established
+
+			std::atomic_bool m_isWakeUpRequested;
 			std::atomic_bool m_running;
+			mutable std::mutex m_statisticsMutex;
+			std::mutex m_slotMutex;
+			std::mutex m_wakeUpMutex;
 			std::size_t m_firstId;
-			std::vector<Nz::ENetPeer*> m_clients;
+			std::size_t m_pendingConnectionCount; //< Reactor thread only
+			std::size_t m_wakeUpPeerId; //< Reactor thread only, ENet peer id of the wake-up connection on m_host
+			std::vector<std::optional<ConnectionAttempt>> m_connectionAttempts; //< Reactor thread only, indexed by slot
+			std::vector<std::size_t> m_peerSlots; //< Reactor thread only, slot of each ENet peer
+			std::vector<Nz::ENetPeer*> m_clients; //< Reactor thread only, indexed by slot
+			std::vector<OutgoingEvent> m_outgoingBuffer; //< Reactor thread only
+			std::vector<OutgoingEvent> m_pendingOutgoingEvents; //< Caller thread only, sent by FlushOutgoing when batching is enabled
+			std::vector<Nz::UInt64> m_unflushedSendTimes; //< Reactor thread only, SendData times of packets waiting for the next flush
 			moodycamel::ConcurrentQueue<ConnectionRequest> m_connectionRequests;
 			moodycamel::ConcurrentQueue<IncomingEvent> m_incomingQueue;
 			moodycamel::ConcurrentQueue<OutgoingEvent> m_outgoingQueue;
+			moodycamel::ConsumerToken m_connectionConsumerToken; //< Reactor thread only
+			moodycamel::ProducerToken m_outgoingProducerToken;
+			Nz::Bitset<> m_freeSlots; //< Protected by m_slotMutex
 			Nz::ENetHost m_host;
+			Nz::ENetHost m_wakeUpHost; //< Protected by m_wakeUpMutex
+			std::vector<std::vector<Nz::ENetPacketRef>> m_reliablePackets; //< Reactor thread only, indexed by slot, must be destroyed before m_host which owns the packets
+			Nz::ENetPeer* m_wakeUpPeer; //< Protected by m_wakeUpMutex, end of the wake-up connection on m_wakeUpHost
+			Nz::IpAddress m_hostLoopbackAddress; //< Loopback address of m_host, the only one allowed to connect to m_wakeUpHost
+			Nz::IpAddress m_wakeUpAddress; //< Bound address of m_wakeUpHost
 			Nz::NetProtocol m_protocol;
 			Nz::Thread m_thread;
+			SendStatistics m_sendStatistics; //< Protected by m_statisticsMutex
+			bool m_isBatchingOutgoing;
+			bool m_isWakeUpConnected; //< Reactor thread only
 	};
 }
 
@@ -22,7 +22,10 @@ namespace bw
 				}
 				else if constexpr (std::is_same_v<T, IncomingEvent::DisconnectEvent>)
 				{
-					onDisconnection(inEvent.peerId, arg.data);
+					onDisconnection(inEvent.peerId, arg.data, arg.cause);
+
+					// The peer id can only be reused once the disconnection has been handled
+					ReleaseSlot(inEvent.peerId - m_firstId);
 				}
 				else if constexpr (std::is_same_v<T, IncomingEvent::PacketEvent>)
 				{
@@ -43,4 +46,9 @@ namespace bw
 	{
 		return m_protocol;
 	}
+
+	inline bool NetworkReactor::IsOutgoingBatchingEnabled() const
+	{
+		return m_isBatchingOutgoing;
+	}
 }
@@ -24,11 +24,13 @@ namespace bw
 			NetworkSessionManager(MatchSessions* owner, Nz::UInt16 port, std::size_t maxClient);
 			~NetworkSessionManager();
 
+			void Flush() override;
+
 			void Poll() override;
 
 		private:
 			void HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data);
-			void HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data);
+			void HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data, DisconnectionCause cause);
 			void HandlePeerPacket(std::size_t peerId, Nz::NetPacket&& packet);
 
 			std::vector<MatchClientSession*> m_peerIdToSession;
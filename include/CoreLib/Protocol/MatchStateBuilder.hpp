@@ -0,0 +1,61 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_NETWORK_MATCHSTATEBUILDER_HPP
+#define BURGWAR_CORELIB_NETWORK_MATCHSTATEBUILDER_HPP
+
+#include <CoreLib/Export.hpp>
+#include <CoreLib/LayerIndex.hpp>
+#include <CoreLib/Protocol/Packets.hpp>
+#include <vector>
+
+namespace bw
+{
+	// Builds a MatchState packet in linear time, keeping track of its estimated size while entities are pushed
+	class BURGWAR_CORELIB_API MatchStateBuilder
+	{
+		public:
+			inline MatchStateBuilder(std::size_t maxPacketSize);
+			~MatchStateBuilder() = default;
+
+			void Build(Packets::MatchState& packet);
+
+			inline void Clear(bool isQuantized = false);
+
+			inline std::size_t GetEntityCount() const;
+			inline std::size_t GetEstimatedSize() const;
+
+			bool PushEntity(LayerIndex layerIndex, Packets::MatchState::Entity&& entity);
+
+		private:
+			struct LayerData
+			{
+				LayerIndex layerIndex;
+				Nz::UInt32 entityCount;
+				std::size_t entityOffset;
+			};
+
+			struct PendingEntity
+			{
+				std::size_t layerDataIndex;
+				Packets::MatchState::Entity entity;
+			};
+
+			std::size_t EstimateSize(std::size_t layerCount, std::size_t entityCount, std::size_t playerEntityCount, std::size_t physicalEntityCount, std::size_t quantizedDataSize) const;
+
+			std::size_t m_maxPacketSize;
+			std::size_t m_physicalEntityCount;
+			std::size_t m_playerEntityCount;
+			std::size_t m_quantizedDataSize;
+			std::vector<LayerData> m_layers;
+			std::vector<PendingEntity> m_pendingEntities;
+			bool m_isQuantized;
+	};
+}
+
+#include <CoreLib/Protocol/MatchStateBuilder.inl>
+
+#endif
@@ -0,0 +1,34 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Protocol/MatchStateBuilder.hpp>
+
+namespace bw
+{
+	inline MatchStateBuilder::MatchStateBuilder(std::size_t maxPacketSize) :
+	m_maxPacketSize(maxPacketSize)
+	{
+		Clear();
+	}
+
+	inline void MatchStateBuilder::Clear(bool isQuantized)
+	{
+		m_isQuantized = isQuantized;
+		m_physicalEntityCount = 0;
+		m_playerEntityCount = 0;
+		m_quantizedDataSize = 0;
+		m_layers.clear();
+		m_pendingEntities.clear();
+	}
+
+	inline std::size_t MatchStateBuilder::GetEntityCount() const
+	{
+		return m_pendingEntities.size();
+	}
+
+	inline std::size_t MatchStateBuilder::GetEstimatedSize() const
+	{
+		return EstimateSize(m_layers.size(), m_pendingEntities.size(), m_playerEntityCount, m_physicalEntityCount, m_quantizedDataSize);
+	}
+}
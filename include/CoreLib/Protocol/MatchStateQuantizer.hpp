@@ -0,0 +1,54 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_NETWORK_MATCHSTATEQUANTIZER_HPP
+#define BURGWAR_CORELIB_NETWORK_MATCHSTATEQUANTIZER_HPP
+
+#include <CoreLib/Export.hpp>
+#include <CoreLib/Protocol/Packets.hpp>
+
+namespace bw
+{
+	// Converts MatchState entities from/to their quantized representation, optionally relative to a baseline state
+	class BURGWAR_CORELIB_API MatchStateQuantizer
+	{
+		public:
+			struct EntityState;
+
+			inline MatchStateQuantizer(const Packets::Helper::MatchStateQuantization& settings);
+			~MatchStateQuantizer() = default;
+
+			bool Decode(Packets::MatchState::Entity& entity, const EntityState* baseline, EntityState& state) const;
+			void Encode(Packets::MatchState::Entity& entity, const EntityState* baseline, EntityState& state) const;
+
+			inline const Packets::Helper::MatchStateQuantization& GetSettings() const;
+
+			static constexpr std::size_t BaselineHistorySize = 32; //< must divide 65536 to stay consistent when network ticks wrap around
+
+			struct EntityState
+			{
+				Nz::Int32 angularVelocity = 0;
+				Nz::Int32 linearVelocityX = 0;
+				Nz::Int32 linearVelocityY = 0;
+				Nz::Int32 positionX = 0;
+				Nz::Int32 positionY = 0;
+				Nz::Int32 rotation = 0;
+			};
+
+		private:
+			EntityState Quantize(const Packets::MatchState::Entity& entity) const;
+
+			static Nz::Int32 QuantizeValue(float value, float precision);
+
+			Packets::Helper::MatchStateQuantization m_settings;
+			Nz::Int32 m_rotationMask;
+			Nz::Int32 m_rotationSteps;
+	};
+}
+
+#include <CoreLib/Protocol/MatchStateQuantizer.inl>
+
+#endif
@@ -0,0 +1,26 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Protocol/MatchStateQuantizer.hpp>
+#include <cassert>
+
+namespace bw
+{
+	inline MatchStateQuantizer::MatchStateQuantizer(const Packets::Helper::MatchStateQuantization& settings) :
+	m_settings(settings)
+	{
+		assert(m_settings.rotationBits > 0 && m_settings.rotationBits <= 16);
+		assert(m_settings.angularVelocityPrecision > 0.f);
+		assert(m_settings.linearVelocityPrecision > 0.f);
+		assert(m_settings.positionPrecision > 0.f);
+
+		m_rotationSteps = Nz::Int32(1) << m_settings.rotationBits;
+		m_rotationMask = m_rotationSteps - 1;
+	}
+
+	inline auto MatchStateQuantizer::GetSettings() const -> const Packets::Helper::MatchStateQuantization&
+	{
+		return m_settings;
+	}
+}
@@ -8,7 +8,10 @@
 #define BURGWAR_CORELIB_NETWORK_PACKETSERIALIZER_HPP
 
 #include <CoreLib/Export.hpp>
+#include <CoreLib/Protocol/CompressedInteger.hpp>
 #include <Nazara/Core/ByteStream.hpp>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace bw
@@ -19,8 +22,11 @@ namespace bw
 			inline PacketSerializer(Nz::ByteStream& packetBuffer, bool isWriting);
 			~PacketSerializer() = default;
 
+			template<typename T> bool CheckArraySize(std::size_t arraySize);
+
 			inline void Read(void* ptr, std::size_t size);
 
+			inline bool IsValid() const;
 			inline bool IsWriting() const;
 
 			inline void Write(const void* ptr, std::size_t size);
@@ -39,8 +45,20 @@ namespace bw
 			template<typename DataType> void operator&=(DataType& data);
 			template<typename DataType> void operator&=(const DataType& data) const;
 
+			static constexpr std::size_t MaxArraySize = 1 << 20;
+			static constexpr std::size_t MaxStringSize = 256 * 1024;
+
 		private:
+			inline bool CanRead(std::size_t size);
+			inline std::size_t GetRemainingSize() const;
+			template<typename T> void ReadCompressed(CompressedSigned<T>& value);
+			template<typename T> void ReadCompressed(CompressedUnsigned<T>& value);
+			inline void ReadString(std::string& str);
+			inline void WriteString(const std::string& str) const;
+
 			Nz::ByteStream& m_buffer;
+			Nz::UInt8 m_remainingBoolBits;
+			bool m_isValid;
 			bool m_isWriting;
 	};
 }
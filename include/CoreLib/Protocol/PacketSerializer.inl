@@ -3,22 +3,142 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/Protocol/PacketSerializer.hpp>
-#include <CoreLib/Protocol/CompressedInteger.hpp>
+#include <Nazara/Core/Color.hpp>
+#include <Nazara/Math/Angle.hpp>
+#include <Nazara/Math/Vector2.hpp>
+#include <Nazara/Math/Vector3.hpp>
+#include <Nazara/Math/Vector4.hpp>
 #include <cassert>
+#include <climits>
 #include <stdexcept>
 
 namespace bw
 {
+	namespace Detail
+	{
+		// Minimum number of bits a value takes once serialized, unknown types take at least one bit
+		template<typename T>
+		struct SerializedBits
+		{
+			static constexpr std::size_t Min = (std::is_arithmetic_v<T>) ? sizeof(T) * CHAR_BIT : 1;
+		};
+
+		template<>
+		struct SerializedBits<bool>
+		{
+			static constexpr std::size_t Min = 1;
+		};
+
+		template<>
+		struct SerializedBits<std::string>
+		{
+			static constexpr std::size_t Min = sizeof(Nz::UInt32) * CHAR_BIT;
+		};
+
+		template<>
+		struct SerializedBits<Nz::Color>
+		{
+			static constexpr std::size_t Min = 4 * sizeof(Nz::UInt8) * CHAR_BIT;
+		};
+
+		template<Nz::AngleUnit Unit, typename T>
+		struct SerializedBits<Nz::Angle<Unit, T>>
+		{
+			static constexpr std::size_t Min = SerializedBits<T>::Min;
+		};
+
+		template<typename T>
+		struct SerializedBits<CompressedSigned<T>>
+		{
+			static constexpr std::size_t Min = CHAR_BIT;
+		};
+
+		template<typename T>
+		struct SerializedBits<CompressedUnsigned<T>>
+		{
+			static constexpr std::size_t Min = CHAR_BIT;
+		};
+
+		template<typename T>
+		struct SerializedBits<Nz::Vector2<T>>
+		{
+			static constexpr std::size_t Min = 2 * SerializedBits<T>::Min;
+		};
+
+		template<typename T>
+		struct SerializedBits<Nz::Vector3<T>>
+		{
+			static constexpr std::size_t Min = 3 * SerializedBits<T>::Min;
+		};
+
+		template<typename T>
+		struct SerializedBits<Nz::Vector4<T>>
+		{
+			static constexpr std::size_t Min = 4 * SerializedBits<T>::Min;
+		};
+
+		template<typename T>
+		struct IsCompressedInteger : std::false_type {};
+
+		template<typename T>
+		struct IsCompressedInteger<CompressedSigned<T>> : std::true_type {};
+
+		template<typename T>
+		struct IsCompressedInteger<CompressedUnsigned<T>> : std::true_type {};
+	}
+
 	inline PacketSerializer::PacketSerializer(Nz::ByteStream& packetBuffer, bool isWriting) :
 	m_buffer(packetBuffer),
+	m_remainingBoolBits(0),
+	m_isValid(true),
 	m_isWriting(isWriting)
 	{
 	}
 
+	/*!
+	* \brief Checks an array size read from the packet before anything gets allocated for it
+	*
+	* Sizes above MaxArraySize, or sizes which can't fit in the rest of the packet (based on the minimum serialized size of T), invalidate the serializer.
+	*
+	* \return True if the array can be allocated and read
+	*/
+	template<typename T>
+	bool PacketSerializer::CheckArraySize(std::size_t arraySize)
+	{
+		if (!m_isValid)
+			return false;
+
+		constexpr std::size_t MinElementBits = Detail::SerializedBits<T>::Min;
+
+		std::size_t remainingBits = GetRemainingSize() * CHAR_BIT + m_remainingBoolBits;
+		if (arraySize > MaxArraySize || arraySize > remainingBits / MinElementBits)
+		{
+			m_isValid = false;
+			return false;
+		}
+
+		return true;
+	}
+
 	inline void PacketSerializer::Read(void* ptr, std::size_t size)
 	{
+		m_remainingBoolBits = 0;
+
+		if (!CanRead(size))
+			return;
+
 		if (m_buffer.Read(ptr, size) != size)
-			throw std::runtime_error("failed to read");
+			m_isValid = false;
+	}
+
+	/*!
+	* \brief Returns false if a read went past the end of the packet or if a size read from it was out of bounds
+	*
+	* Reading stops at the first failure, the content of the unserialized data is unspecified in that case.
+	*/
+	inline bool PacketSerializer::IsValid() const
+	{
+		return m_isValid;
 	}
 
 	inline bool PacketSerializer::IsWriting() const
@@ -36,7 +156,40 @@ namespace bw
 	void PacketSerializer::Serialize(DataType& data)
 	{
 		if (!IsWriting())
-			m_buffer >> data;
+		{
+			if constexpr (std::is_same_v<DataType, bool>)
+			{
+				// Booleans are packed as bits, a new byte is only read once the previous one has been used
+				if (m_remainingBoolBits == 0)
+				{
+					if (!CanRead(1))
+						return;
+
+					m_remainingBoolBits = CHAR_BIT;
+				}
+				else if (!m_isValid)
+					return;
+
+				m_remainingBoolBits--;
+				m_buffer >> data;
+			}
+			else if constexpr (std::is_same_v<DataType, std::string>)
+				ReadString(data);
+			else if constexpr (Detail::IsCompressedInteger<DataType>::value)
+				ReadCompressed(data);
+			else
+			{
+				// Reading anything else than a boolean starts from the next byte
+				m_remainingBoolBits = 0;
+
+				if (!CanRead((Detail::SerializedBits<DataType>::Min + CHAR_BIT - 1) / CHAR_BIT))
+					return;
+
+				m_buffer >> data;
+			}
+		}
+		else if constexpr (std::is_same_v<DataType, std::string>)
+			WriteString(data);
 		else
 			m_buffer << data;
 	}
@@ -54,7 +207,10 @@ namespace bw
 	{
 		assert(IsWriting());
 
-		m_buffer << data;
+		if constexpr (std::is_same_v<DataType, std::string>)
+			WriteString(data);
+		else
+			m_buffer << data;
 	}
 
 	template<typename PacketType, typename DataType>
@@ -63,9 +219,10 @@ namespace bw
 		if (!IsWriting())
 		{
 			PacketType packetData;
-			m_buffer >> packetData;
+			Serialize(packetData);
 
-			data = static_cast<DataType>(packetData);
+			if (m_isValid)
+				data = static_cast<DataType>(packetData);
 		}
 		else
 			m_buffer << static_cast<PacketType>(data);
@@ -84,12 +241,20 @@ namespace bw
 	{
 		CompressedUnsigned<Nz::UInt32> arraySize;
 		if (IsWriting())
+		{
+			if (array.size() > MaxArraySize)
+				throw std::runtime_error("array is too big to be serialized");
+
 			arraySize = Nz::UInt32(array.size());
+		}
 
 		Serialize(arraySize);
 
 		if (!IsWriting())
-			array.resize(arraySize);
+		{
+			bool isValidSize = CheckArraySize<typename T::value_type>(static_cast<Nz::UInt32>(arraySize));
+			array.resize((isValidSize) ? static_cast<Nz::UInt32>(arraySize) : 0);
+		}
 	}
 
 	template<typename T>
@@ -97,6 +262,9 @@ namespace bw
 	{
 		assert(IsWriting());
 
+		if (array.size() > MaxArraySize)
+			throw std::runtime_error("array is too big to be serialized");
+
 		CompressedUnsigned<Nz::UInt32> arraySize(Nz::UInt32(array.size()));
 		Serialize(arraySize);
 	}
@@ -109,10 +277,111 @@ namespace bw
 		else
 		{
 			UT v;
-			m_buffer >> v;
+			Serialize(v);
+
+			if (m_isValid)
+				enumValue = static_cast<E>(v);
+		}
+	}
+
+	inline bool PacketSerializer::CanRead(std::size_t size)
+	{
+		if (!m_isValid)
+			return false;
+
+		if (GetRemainingSize() < size)
+		{
+			m_isValid = false;
+			return false;
+		}
+
+		return true;
+	}
+
+	inline std::size_t PacketSerializer::GetRemainingSize() const
+	{
+		const Nz::Stream* stream = m_buffer.GetStream();
+		if (!stream)
+			return 0;
+
+		return static_cast<std::size_t>(stream->GetSize() - stream->GetCursorPos());
+	}
+
+	template<typename T>
+	void PacketSerializer::ReadCompressed(CompressedSigned<T>& value)
+	{
+		using UnsignedT = std::make_unsigned_t<T>;
+
+		CompressedUnsigned<UnsignedT> compressedValue;
+		ReadCompressed(compressedValue);
+
+		if (!m_isValid)
+			return;
 
-			enumValue = static_cast<E>(v);
+		// ZigZag decoding, as Nz::Unserialize does
+		UnsignedT unsignedValue = compressedValue;
+		unsignedValue = (unsignedValue >> 1) - (unsignedValue & 1) * unsignedValue;
+
+		value = reinterpret_cast<T&>(unsignedValue);
+	}
+
+	template<typename T>
+	void PacketSerializer::ReadCompressed(CompressedUnsigned<T>& value)
+	{
+		// Same encoding as Nz::Unserialize, but every byte is checked and encodings longer than the integer type are rejected
+		constexpr std::size_t MaxByteCount = (sizeof(T) * CHAR_BIT + 6) / 7;
+
+		T integerValue = 0;
+		for (std::size_t i = 0;; ++i)
+		{
+			if (i >= MaxByteCount)
+			{
+				m_isValid = false;
+				return;
+			}
+
+			Nz::UInt8 byteValue;
+			Serialize(byteValue);
+
+			if (!m_isValid)
+				return;
+
+			integerValue |= T(byteValue & 0x7F) << 7 * i;
+			if ((byteValue & 0x80) == 0)
+				break;
+		}
+
+		value = integerValue;
+	}
+
+	inline void PacketSerializer::ReadString(std::string& str)
+	{
+		Nz::UInt32 size;
+		Serialize(size);
+
+		if (!m_isValid)
+			return;
+
+		// Checked before allocating, a string can't be bigger than the rest of the packet
+		if (size > MaxStringSize || size > GetRemainingSize())
+		{
+			m_isValid = false;
+			return;
 		}
+
+		str.resize(size);
+		Read(str.data(), size);
+	}
+
+	inline void PacketSerializer::WriteString(const std::string& str) const
+	{
+		if (str.size() > MaxStringSize)
+			throw std::runtime_error("string is too big to be serialized");
+
+		// Same layout as Nazara strings (32bits size followed by content), read back by ReadString
+		m_buffer << Nz::UInt32(str.size());
+		if (m_buffer.Write(str.data(), str.size()) != str.size())
+			throw std::runtime_error("failed to write");
 	}
 
 	template<typename DataType>
@@ -14,7 +14,9 @@
 #include <CoreLib/Protocol/CompressedInteger.hpp>
 #include <CoreLib/Protocol/PacketSerializer.hpp>
 #include <Nazara/Prerequisites.hpp>
+#include <Nazara/Core/ByteArray.hpp>
 #include <Nazara/Core/Color.hpp>
+#include <Nazara/Core/Flags.hpp>
 #include <Nazara/Core/String.hpp>
 #include <Nazara/Math/Angle.hpp>
 #include <Nazara/Math/Box.hpp>
@@ -22,6 +24,7 @@
 #include <Nazara/Math/Vector3.hpp>
 #include <Nazara/Network/NetPacket.hpp>
 #include <array>
+#include <memory>
 #include <optional>
 #include <variant>
 #include <vector>
@@ -69,9 +72,35 @@ namespace bw
 		PlayerWeapons,
 		Ready,
 		ScriptPacket,
-		UpdatePlayerName
+		UpdatePlayerName,
+
+		// Appended to keep the opcodes of older clients valid
+		EntitiesPhysics,
+		EntitiesWeapon
 	};
 
+	enum class ProtocolFeature
+	{
+		QuantizedMatchState,
+		BatchedEntityEvents,
+
+		Max = BatchedEntityEvents
+	};
+}
+
+namespace Nz
+{
+	template<>
+	struct EnumAsFlags<bw::ProtocolFeature>
+	{
+		static constexpr bw::ProtocolFeature max = bw::ProtocolFeature::Max;
+	};
+}
+
+namespace bw
+{
+	using ProtocolFeatures = Nz::Flags<ProtocolFeature>;
+
 	template<PacketType PT> struct PacketTag
 	{
 		static constexpr PacketType Type = PT;
@@ -87,6 +116,15 @@ namespace bw
 				CompressedUnsigned<Nz::UInt32> entityId;
 			};
 
+			struct MatchStateQuantization
+			{
+				Nz::Vector2f positionOrigin;
+				float angularVelocityPrecision;
+				float linearVelocityPrecision;
+				float positionPrecision;
+				Nz::UInt8 rotationBits;
+			};
+
 			struct HealthData
 			{
 				Nz::UInt16 maxHealth;
@@ -98,6 +136,13 @@ namespace bw
 				bool isFacingRight;
 			};
 
+			struct PlayerMovementProperties
+			{
+				float movementSpeed;
+				float jumpHeight;
+				float jumpHeightBoost;
+			};
+
 			struct PhysicsProperties
 			{
 				Nz::RadianAnglef angularVelocity;
@@ -139,6 +184,7 @@ namespace bw
 			};
 
 			std::vector<Player> players;
+			ProtocolFeatures supportedFeatures;
 		};
 
 		DeclarePacket(AuthFailure)
@@ -153,6 +199,7 @@ namespace bw
 			};
 
 			std::vector<Player> players;
+			std::optional<Helper::MatchStateQuantization> matchStateQuantization;
 		};
 
 		DeclarePacket(ChatMessage)
@@ -209,6 +256,7 @@ namespace bw
 			{
 				CompressedUnsigned<Nz::UInt32> id;
 				Helper::EntityData data;
+				std::shared_ptr<const Nz::ByteArray> encodedData; //< Written instead of data if set
 			};
 
 			struct Layer
@@ -286,6 +334,7 @@ namespace bw
 			{
 				CompressedUnsigned<Nz::UInt32> id;
 				Helper::EntityData data;
+				std::shared_ptr<const Nz::ByteArray> encodedData; //< Written instead of data if set
 			};
 
 			Nz::UInt16 stateTick;
@@ -330,6 +379,28 @@ namespace bw
 			std::vector<Layer> layers;
 		};
 
+		DeclarePacket(EntitiesPhysics)
+		{
+			struct Entity
+			{
+				CompressedUnsigned<Nz::UInt32> id;
+				bool asleep;
+				float mass;
+				float momentOfInertia;
+				std::optional<Helper::PlayerMovementProperties> playerMovement;
+			};
+
+			struct Layer
+			{
+				CompressedUnsigned<LayerIndex> layerIndex;
+				CompressedUnsigned<Nz::UInt32> entityCount;
+			};
+
+			Nz::UInt16 stateTick;
+			std::vector<Entity> entities;
+			std::vector<Layer> layers;
+		};
+
 		DeclarePacket(EntitiesScale)
 		{
 			struct Entity
@@ -368,15 +439,31 @@ namespace bw
 			std::vector<Layer> layers;
 		};
 
-		DeclarePacket(EntityPhysics)
+		DeclarePacket(EntitiesWeapon)
 		{
-			struct PlayerMovement
+			struct Entity
 			{
-				float movementSpeed;
-				float jumpHeight;
-				float jumpHeightBoost;
+				CompressedUnsigned<Nz::UInt32> id;
+				CompressedUnsigned<Nz::UInt32> weaponEntityId;
 			};
 
+			struct Layer
+			{
+				CompressedUnsigned<LayerIndex> layerIndex;
+				CompressedUnsigned<Nz::UInt32> entityCount;
+			};
+
+			Nz::UInt16 stateTick;
+			std::vector<Entity> entities;
+			std::vector<Layer> layers;
+
+			static constexpr Nz::UInt32 NoWeapon = 0xFFFFFFFF;
+		};
+
+		DeclarePacket(EntityPhysics)
+		{
+			using PlayerMovement = Helper::PlayerMovementProperties;
+
 			Nz::UInt16 stateTick;
 			Helper::EntityId entityId;
 			bool asleep;
@@ -456,6 +543,18 @@ namespace bw
 				Nz::Vector2f linearVelocity;
 			};
 
+			// Only sent when the MatchState is quantized, values are absolute or relative to the baseline state
+			struct QuantizedData
+			{
+				bool isDelta = false;
+				CompressedSigned<Nz::Int32> positionX;
+				CompressedSigned<Nz::Int32> positionY;
+				CompressedSigned<Nz::Int32> rotation;
+				CompressedSigned<Nz::Int32> angularVelocity;
+				CompressedSigned<Nz::Int32> linearVelocityX;
+				CompressedSigned<Nz::Int32> linearVelocityY;
+			};
+
 			struct Entity
 			{
 				CompressedUnsigned<Nz::UInt32> id;
@@ -463,6 +562,7 @@ namespace bw
 				Nz::Vector2f position;
 				std::optional<PlayerMovementData> playerMovement;
 				std::optional<PhysicsProperties> physicsProperties;
+				QuantizedData quantized;
 			};
 
 			struct Layer
@@ -471,6 +571,8 @@ namespace bw
 				CompressedUnsigned<Nz::UInt32> entityCount;
 			};
 
+			bool isQuantized = false;
+			std::optional<Nz::UInt16> baselineTick;
 			Nz::UInt16 lastInputTick;
 			Nz::UInt16 stateTick;
 			std::vector<Entity> entities;
@@ -538,6 +640,8 @@ namespace bw
 
 		DeclarePacket(PlayersInput)
 		{
+			std::optional<Nz::UInt16> acknowledgedStateTick;
+			Nz::UInt32 acknowledgedStateMask = 0; //< bit N set if state acknowledgedStateTick - N - 1 was received
 			Nz::UInt16 estimatedServerTick;
 			Nz::UInt16 inputTick;
 			std::vector<std::optional<PlayerInputData>> inputs;
@@ -579,6 +683,9 @@ namespace bw
 
 		// Compute size
 		BURGWAR_CORELIB_API std::size_t EstimateSize(const MatchState& matchState);
+		BURGWAR_CORELIB_API std::size_t EstimateMatchStateSize(std::size_t layerCount, std::size_t entityCount, std::size_t playerEntityCount, std::size_t physicalEntityCount);
+		BURGWAR_CORELIB_API std::size_t EstimateQuantizedEntitySize(const MatchState::Entity& entity);
+		BURGWAR_CORELIB_API std::size_t EstimateQuantizedMatchStateSize(std::size_t layerCount, std::size_t entityCount, std::size_t playerEntityCount, std::size_t entityDataSize);
 
 		// Packets serializer
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, Auth& data);
@@ -599,7 +706,9 @@ namespace bw
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, EntitiesAnimation& data);
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, EntitiesDeath& data);
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, EntitiesInputs& data);
+		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, EntitiesPhysics& data);
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, EntitiesScale& data);
+		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, EntitiesWeapon& data);
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, EntityPhysics& data);
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, EntityWeapon& data);
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, HealthUpdate& data);
@@ -626,6 +735,8 @@ namespace bw
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, PlayerInputData& data);
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, Helper::EntityData& data);
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, Helper::EntityId& data);
+		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, Helper::MatchStateQuantization& data);
+		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, Helper::PlayerMovementProperties& data);
 		BURGWAR_CORELIB_API void Serialize(PacketSerializer& serializer, Helper::Property& data);
 	}
 }
@@ -0,0 +1,72 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_SCRIPTING_SCRIPTBYTECODECACHE_HPP
+#define BURGWAR_CORELIB_SCRIPTING_SCRIPTBYTECODECACHE_HPP
+
+#include <CoreLib/Export.hpp>
+#include <Nazara/Prerequisites.hpp>
+#include <tsl/hopscotch_map.h>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace bw
+{
+	class BURGWAR_CORELIB_API ScriptBytecodeCache
+	{
+		public:
+			using Bytecode = std::shared_ptr<const std::string>;
+
+			ScriptBytecodeCache(std::filesystem::path cacheFolder = {}, std::size_t maxMemoryUsage = DefaultMaxMemoryUsage);
+			ScriptBytecodeCache(const ScriptBytecodeCache&) = delete;
+			ScriptBytecodeCache(ScriptBytecodeCache&&) = delete;
+			~ScriptBytecodeCache() = default;
+
+			void Clear();
+
+			Bytecode Find(const std::string& key);
+
+			inline const std::filesystem::path& GetCacheFolder() const;
+			inline std::size_t GetMaxMemoryUsage() const;
+			std::size_t GetMemoryUsage();
+
+			void Store(const std::string& key, std::string bytecode);
+
+			ScriptBytecodeCache& operator=(const ScriptBytecodeCache&) = delete;
+			ScriptBytecodeCache& operator=(ScriptBytecodeCache&&) = delete;
+
+			static std::string BuildKey(std::string_view source, std::string_view chunkName);
+
+			static constexpr std::size_t DefaultMaxMemoryUsage = 32 * 1024 * 1024;
+			static constexpr Nz::UInt32 FileVersion = 1;
+
+		private:
+			Bytecode Insert(const std::string& key, Bytecode bytecode);
+			Bytecode ReadFile(const std::string& key);
+			void WriteFile(const std::string& key, const std::string& bytecode);
+
+			struct Entry
+			{
+				Bytecode bytecode;
+				std::list<std::string>::iterator usageIt;
+			};
+
+			std::filesystem::path m_cacheFolder;
+			std::list<std::string> m_usageOrder; //< Most recently used keys first, protected by m_mutex
+			std::mutex m_mutex;
+			std::size_t m_maxMemoryUsage;
+			std::size_t m_memoryUsage; //< Protected by m_mutex
+			tsl::hopscotch_map<std::string, Entry> m_bytecodes; //< Protected by m_mutex
+	};
+}
+
+#include <CoreLib/Scripting/ScriptBytecodeCache.inl>
+
+#endif
@@ -0,0 +1,18 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Scripting/ScriptBytecodeCache.hpp>
+
+namespace bw
+{
+	inline const std::filesystem::path& ScriptBytecodeCache::GetCacheFolder() const
+	{
+		return m_cacheFolder;
+	}
+
+	inline std::size_t ScriptBytecodeCache::GetMaxMemoryUsage() const
+	{
+		return m_maxMemoryUsage;
+	}
+}
@@ -9,6 +9,7 @@
 
 #include <CoreLib/Export.hpp>
 #include <CoreLib/Scripting/AbstractScriptingLibrary.hpp>
+#include <CoreLib/Scripting/ScriptBytecodeCache.hpp>
 #include <CoreLib/Utility/VirtualDirectory.hpp>
 #include <sol/sol.hpp>
 #include <filesystem>
@@ -37,6 +38,7 @@ namespace bw
 			inline const std::filesystem::path& GetCurrentFolder() const;
 			inline sol::state& GetLuaState();
 			inline const sol::state& GetLuaState() const;
+			inline const std::shared_ptr<ScriptBytecodeCache>& GetBytecodeCache() const;
 			inline const std::shared_ptr<VirtualDirectory>& GetScriptDirectory() const;
 
 			std::optional<sol::object> Load(const std::filesystem::path& file);
@@ -48,6 +50,7 @@ namespace bw
 
 			void ReloadLibraries();
 
+			inline void SetBytecodeCache(std::shared_ptr<ScriptBytecodeCache> bytecodeCache);
 			inline void SetPrintFunction(PrintFunction function);
 
 			void Update();
@@ -63,6 +66,7 @@ namespace bw
 		private:
 			sol::thread& CreateThread();
 
+			sol::load_result LoadChunk(const std::string_view& content, const std::string& chunkName);
 			std::optional<sol::object> LoadFile(std::filesystem::path path, const VirtualDirectory::FileContentEntry& entry);
 			std::optional<FileLoadCoroutine> LoadFile(std::filesystem::path path, const VirtualDirectory::FileContentEntry& entry, Async);
 			std::optional<sol::object> LoadFile(std::filesystem::path path, const VirtualDirectory::PhysicalFileEntry& entry);
@@ -75,6 +79,7 @@ namespace bw
 			std::filesystem::path m_currentFile;
 			std::filesystem::path m_currentFolder;
 			PrintFunction m_printFunction;
+			std::shared_ptr<ScriptBytecodeCache> m_bytecodeCache;
 			std::shared_ptr<VirtualDirectory> m_scriptDirectory;
 			std::vector<std::shared_ptr<AbstractScriptingLibrary>> m_libraries;
 			std::vector<sol::thread> m_availableThreads;
@@ -53,6 +53,14 @@ namespace bw
 		return m_currentFolder;
 	}
 
+	/*!
+	* \brief Returns the cache used to skip compilation of unchanged scripts
+	*/
+	inline const std::shared_ptr<ScriptBytecodeCache>& ScriptingContext::GetBytecodeCache() const
+	{
+		return m_bytecodeCache;
+	}
+
 	inline sol::state& ScriptingContext::GetLuaState()
 	{
 		return m_luaState;
@@ -73,6 +81,15 @@ namespace bw
 		m_printFunction(str, color);
 	}
 
+	/*!
+	* \brief Sets the bytecode cache to use, which can be shared with other scripting contexts (but not null)
+	*/
+	inline void ScriptingContext::SetBytecodeCache(std::shared_ptr<ScriptBytecodeCache> bytecodeCache)
+	{
+		assert(bytecodeCache);
+		m_bytecodeCache = std::move(bytecodeCache);
+	}
+
 	inline void ScriptingContext::SetPrintFunction(PrintFunction function)
 	{
 		m_printFunction = std::move(function);
@@ -36,7 +36,7 @@ namespace bw
 
 			virtual void QueryInfo(std::function<void(const SessionInfo& info)> callback) const = 0;
 
-			virtual void SendPacket(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& data) = 0;
+			virtual void SendPacket(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, const Nz::NetPacket& data) = 0;
 
 			NazaraSignal(OnConnected, Nz::UInt32 /*data*/);
 			NazaraSignal(OnDisconnected, Nz::UInt32 /*data*/);
@@ -51,6 +51,7 @@ namespace bw
 				Nz::UInt32 totalPacketSent;
 				Nz::UInt64 totalByteReceived;
 				Nz::UInt64 totalByteSent;
+				Nz::UInt64 reliableBytesInFlight; //< Reliable data sent and not acknowledged yet
 			};
 
 		private:
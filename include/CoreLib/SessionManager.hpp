@@ -25,6 +25,8 @@ namespace bw
 			SessionManager(SessionManager&&) = delete;
 			virtual ~SessionManager();
 
+			virtual void Flush();
+
 			inline MatchSessions* GetOwner();
 
 			virtual void Poll() = 0;
@@ -9,7 +9,11 @@
 
 #include <CoreLib/Export.hpp>
 #include <CoreLib/LayerIndex.hpp>
+#include <NDK/EntityList.hpp>
 #include <NDK/World.hpp>
+#include <tsl/hopscotch_map.h>
+#include <optional>
+#include <vector>
 
 namespace bw
 {
@@ -27,18 +31,55 @@ namespace bw
 
 			inline LayerIndex GetLayerIndex() const;
 			inline SharedMatch& GetMatch();
+			inline std::size_t GetUpdateStepCount() const;
 			Ndk::World& GetWorld();
 			const Ndk::World& GetWorld() const;
 
+			inline bool IsParallelUpdateEnabled() const;
+
+			void EnableParallelUpdate(bool enable);
+
+			virtual void ReplayTickUpdate(float elapsedTime, const Ndk::EntityList& entities);
+
 			virtual void TickUpdate(float elapsedTime);
 
+			void UpdateStep(std::size_t stepIndex, float elapsedTime);
+
 			SharedLayer& operator=(const SharedLayer&) = delete;
 			SharedLayer& operator=(SharedLayer&&) = delete;
 
+			static constexpr bool IsParallelUpdateStep(std::size_t stepIndex);
+
 		private:
+			void GetOrderedSystems(std::vector<Ndk::BaseSystem*>& systems);
+			bool IsCollisionAllowed(const Ndk::EntityHandle& first, const Ndk::EntityHandle& second) const;
+			void ProcessDeferredCollisions();
+			void UpdateWorld(float elapsedTime);
+
+			static Nz::UInt64 BuildCollisionKey(const Ndk::EntityHandle& first, const Ndk::EntityHandle& second);
+			static bool HandleScriptCollision(const Ndk::EntityHandle& first, const Ndk::EntityHandle& second);
+
+			struct CollisionDecision
+			{
+				std::optional<bool> shouldCollide; //< Unset until the script callback has been executed
+				std::size_t contactCount = 0;
+			};
+
+			struct DeferredCollision
+			{
+				Ndk::EntityHandle first;
+				Ndk::EntityHandle second;
+			};
+
 			SharedMatch& m_match;
 			Ndk::World m_world;
+			std::vector<DeferredCollision> m_deferredCollisions;
+			std::vector<Ndk::BaseSystem*> m_profiledSystems;
+			std::vector<std::vector<Ndk::BaseSystem*>> m_updateSteps;
+			tsl::hopscotch_map<Nz::UInt64, CollisionDecision> m_collisionDecisions;
 			LayerIndex m_layerIndex;
+			bool m_isParallelUpdateEnabled;
+			bool m_isRunningParallelUpdate;
 	};
 }
 
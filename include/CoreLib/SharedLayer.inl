@@ -33,4 +33,22 @@ namespace bw
 	{
 		return m_world;
 	}
+
+	/*!
+	* \brief Returns the number of update steps, or zero if parallel update is disabled
+	*/
+	inline std::size_t SharedLayer::GetUpdateStepCount() const
+	{
+		return m_updateSteps.size();
+	}
+
+	inline bool SharedLayer::IsParallelUpdateEnabled() const
+	{
+		return m_isParallelUpdateEnabled;
+	}
+
+	constexpr bool SharedLayer::IsParallelUpdateStep(std::size_t stepIndex)
+	{
+		return stepIndex % 2 == 1;
+	}
 }
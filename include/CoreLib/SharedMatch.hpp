@@ -9,6 +9,7 @@
 
 #include <CoreLib/Export.hpp>
 #include <CoreLib/SharedLayer.hpp>
+#include <CoreLib/TickProfiler.hpp>
 #include <CoreLib/TimerManager.hpp>
 #include <CoreLib/LogSystem/MatchLogger.hpp>
 #include <CoreLib/Protocol/NetworkStringStore.hpp>
@@ -27,6 +28,8 @@ namespace bw
 	class BURGWAR_CORELIB_API SharedMatch
 	{
 		public:
+			struct TickStatistics;
+
 			SharedMatch(BurgApp& app, LogSide side, std::string matchName, float tickDuration);
 			SharedMatch(const SharedMatch&) = delete;
 			SharedMatch(SharedMatch&&) = delete;
@@ -43,6 +46,8 @@ namespace bw
 			virtual const SharedLayer& GetLayer(LayerIndex layerIndex) const = 0;
 			virtual LayerIndex GetLayerCount() const = 0;
 			inline const std::string& GetName() const;
+			inline TickProfiler& GetProfiler();
+			inline const TickProfiler& GetProfiler() const;
 			virtual const NetworkStringStore& GetNetworkStringStore() const = 0;
 			inline Nz::UInt16 GetNetworkTick() const;
 			inline Nz::UInt16 GetNetworkTick(Nz::UInt64 tick) const;
@@ -50,9 +55,13 @@ namespace bw
 			inline const ScriptHandlerRegistry& GetScriptPacketHandlerRegistry() const;
 			virtual std::shared_ptr<const SharedGamemode> GetSharedGamemode() const = 0;
 			inline float GetTickDuration() const;
+			inline const TickStatistics& GetTickStatistics() const;
 			inline TimerManager& GetTimerManager();
 			virtual SharedWeaponStore& GetWeaponStore() = 0;
 			virtual const SharedWeaponStore& GetWeaponStore() const = 0;
+			inline float GetTimeUntilNextTick() const;
+
+			inline void ResetTickStatistics();
 
 			virtual const Ndk::EntityHandle& RetrieveEntityByUniqueId(EntityId uniqueId) const = 0;
 			virtual EntityId RetrieveUniqueIdByEntity(const Ndk::EntityHandle& entity) const = 0;
@@ -62,6 +71,15 @@ namespace bw
 			SharedMatch& operator=(const SharedMatch&) = delete;
 			SharedMatch& operator=(SharedMatch&&) = delete;
 
+			struct TickStatistics
+			{
+				Nz::UInt64 droppedTickCount = 0; //< Ticks discarded because the match couldn't keep up
+				Nz::UInt64 lateTickCount = 0;    //< Ticks executed while at least one more tick was already due
+				Nz::UInt64 tickCount = 0;
+				float maxTickDelay = 0.f;        //< Worst delay between a tick deadline and its execution (in seconds)
+				float totalTickDelay = 0.f;
+			};
+
 		protected:
 			virtual void OnTick(bool lastTick) = 0;
 
@@ -69,6 +87,8 @@ namespace bw
 			std::string m_name;
 			MatchLogger m_logger;
 			ScriptHandlerRegistry m_scriptPacketHandler;
+			TickProfiler m_profiler;
+			TickStatistics m_tickStatistics;
 			TimerManager m_timerManager;
 			Nz::UInt64 m_currentTick;
 			Nz::UInt64 m_currentTime;
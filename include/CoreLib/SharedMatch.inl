@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/SharedMatch.hpp>
+#include <algorithm>
 #include <cassert>
 
 namespace bw
@@ -27,6 +28,16 @@ namespace bw
 		return m_name;
 	}
 
+	inline TickProfiler& SharedMatch::GetProfiler()
+	{
+		return m_profiler;
+	}
+
+	inline const TickProfiler& SharedMatch::GetProfiler() const
+	{
+		return m_profiler;
+	}
+
 	inline Nz::UInt16 SharedMatch::GetNetworkTick() const
 	{
 		return GetNetworkTick(m_currentTick);
@@ -52,8 +63,26 @@ namespace bw
 		return m_tickDuration;
 	}
 
+	inline auto SharedMatch::GetTickStatistics() const -> const TickStatistics&
+	{
+		return m_tickStatistics;
+	}
+
 	inline TimerManager& SharedMatch::GetTimerManager()
 	{
 		return m_timerManager;
 	}
+
+	/*!
+	* \brief Returns the time (in seconds) left before the next tick is due
+	*/
+	inline float SharedMatch::GetTimeUntilNextTick() const
+	{
+		return std::max(m_tickDuration - m_tickTimer, 0.f);
+	}
+
+	inline void SharedMatch::ResetTickStatistics()
+	{
+		m_tickStatistics = TickStatistics{};
+	}
 }
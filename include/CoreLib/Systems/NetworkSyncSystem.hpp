@@ -15,11 +15,14 @@
 #include <CoreLib/Components/NetworkSyncComponent.hpp>
 #include <CoreLib/Components/WeaponWielderComponent.hpp>
 #include <CoreLib/Scripting/ScriptedElement.hpp>
+#include <CoreLib/Utility/SpatialGrid.hpp>
+#include <Nazara/Core/ByteArray.hpp>
 #include <Nazara/Core/Signal.hpp>
 #include <Nazara/Math/Angle.hpp>
 #include <Nazara/Math/Vector2.hpp>
 #include <NDK/System.hpp>
 #include <tsl/hopscotch_map.h>
+#include <memory>
 #include <optional>
 #include <string>
 #include <variant>
@@ -35,17 +38,21 @@ namespace bw
 			struct EntityCreation;
 			struct EntityDestruction;
 			struct EntityMovement;
+			struct InterestSnapshot;
+			struct MovementSnapshot;
 
 			NetworkSyncSystem(TerrainLayer& layer);
 			~NetworkSyncSystem() = default;
 
 			void CreateEntities(const std::function<void(const EntityCreation* entityCreation, std::size_t entityCount)>& callback) const;
+			void CreateEntities(const Ndk::EntityId* entityIds, std::size_t entityCount, const std::function<void(const EntityCreation* entityCreation, std::size_t entityCount)>& callback) const;
 			void DeleteEntities(const std::function<void(const EntityDestruction* entityDestruction, std::size_t entityCount)>& callback) const;
 			
+			std::shared_ptr<const Nz::ByteArray> GetEncodedEntityData(const EntityCreation& creationEvent) const;
 			inline TerrainLayer& GetLayer();
 			inline const TerrainLayer& GetLayer() const;
-			
-			void MoveEntities(const std::function<void(const EntityMovement* entityMovement, std::size_t entityCount)>& callback) const;
+			const InterestSnapshot& GetInterestSnapshot(float cellSize) const;
+			const MovementSnapshot& GetMovementSnapshot() const;
 
 			void NotifyPhysicsUpdate(const Ndk::EntityHandle& entity);
 			void NotifyScaleUpdate(const Ndk::EntityHandle& entity);
@@ -156,6 +163,27 @@ namespace bw
 				std::optional<PhysicsProperties> physicsProperties;
 			};
 
+			// Movement of every awake entity of the layer, built once per tick and shared by all sessions
+			struct MovementSnapshot
+			{
+				Nz::UInt64 tick;
+				std::vector<EntityMovement> entities;
+			};
+
+			// Position of every physical entity without parent (the ones subject to interest management) along with their descendants, built once per tick and shared by all sessions
+			struct InterestSnapshot
+			{
+				struct Entity
+				{
+					Nz::Vector2f position;
+					std::vector<Ndk::EntityId> descendants;
+				};
+
+				Nz::UInt64 tick;
+				SpatialGrid<Ndk::EntityId> grid;
+				tsl::hopscotch_map<Ndk::EntityId, Entity> entities;
+			};
+
 			NazaraSignal(OnEntityCreated, NetworkSyncSystem* /*emitter*/, const EntityCreation& /*event*/);
 			NazaraSignal(OnEntityDeath, NetworkSyncSystem* /*emitter*/, const EntityDeath& /*event*/);
 			NazaraSignal(OnEntityDeleted, NetworkSyncSystem* /*emitter*/, const EntityDestruction& /*event*/);
@@ -199,12 +227,17 @@ namespace bw
 			Ndk::EntityList m_weaponUpdateEntities;
 			mutable std::vector<EntityCreation> m_creationEvents;
 			mutable std::vector<EntityDestruction> m_destructionEvents;
+			mutable tsl::hopscotch_map<Ndk::EntityId, std::shared_ptr<const Nz::ByteArray>> m_encodedEntityData;
 			std::vector<EntityHealth> m_healthEvents;
 			std::vector<EntityInputs> m_inputEvents;
 			std::vector<EntityPhysics> m_physicsEvent;
 			std::vector<EntityScale> m_scaleEvent;
 			std::vector<EntityWeapon> m_weaponEvents;
-			mutable std::vector<EntityMovement> m_movementEvents;
+			mutable InterestSnapshot m_interestSnapshot;
+			mutable MovementSnapshot m_movementSnapshot;
+			mutable Nz::UInt64 m_encodedEntityDataTick;
+			mutable bool m_isInterestSnapshotValid;
+			mutable bool m_isMovementSnapshotValid;
 			TerrainLayer& m_layer;
 	};
 }
@@ -8,6 +8,7 @@
 #define BURGWAR_CLIENTLIB_SYSTEMS_PLAYERMOVEMENT_HPP
 
 #include <CoreLib/Export.hpp>
+#include <NDK/EntityList.hpp>
 #include <NDK/System.hpp>
 #include <vector>
 
@@ -19,12 +20,15 @@ namespace bw
 			PlayerMovementSystem();
 			~PlayerMovementSystem() = default;
 
+			void UpdateEntities(const Ndk::EntityList& entities);
+
 			static Ndk::SystemIndex systemIndex;
 
 		private:
 			void OnEntityAdded(Ndk::Entity* entity) override;
 			void OnEntityRemoved(Ndk::Entity* entity) override;
 			void OnUpdate(float elapsedTime) override;
+			void UpdateEntity(const Ndk::EntityHandle& entity);
 	};
 }
 
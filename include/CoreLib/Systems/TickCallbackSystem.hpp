@@ -22,12 +22,15 @@ namespace bw
 			TickCallbackSystem(SharedMatch& match);
 			~TickCallbackSystem() = default;
 
+			void UpdateEntities(float elapsedTime, const Ndk::EntityList& entities);
+
 			static Ndk::SystemIndex systemIndex;
 
 		private:
 			void OnEntityRemoved(Ndk::Entity* entity) override;
 			void OnEntityValidation(Ndk::Entity* entity, bool justAdded) override;
 			void OnUpdate(float elapsedTime) override;
+			void UpdateEntity(float elapsedTime, const Ndk::EntityHandle& entity);
 
 			Ndk::EntityList m_tickableEntities;
 			SharedMatch& m_match;
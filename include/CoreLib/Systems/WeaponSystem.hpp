@@ -22,10 +22,13 @@ namespace bw
 			WeaponSystem(SharedMatch& match);
 			~WeaponSystem() = default;
 
+			void UpdateEntities(const Ndk::EntityList& entities);
+
 			static Ndk::SystemIndex systemIndex;
 
 		private:
 			void OnUpdate(float elapsedTime) override;
+			void UpdateEntity(const Ndk::EntityHandle& weapon);
 
 			SharedMatch& m_match;
 	};
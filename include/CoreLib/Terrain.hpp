@@ -10,6 +10,8 @@
 #include <CoreLib/Export.hpp>
 #include <CoreLib/Map.hpp>
 #include <CoreLib/TerrainLayer.hpp>
+#include <CoreLib/Utility/WorkerPool.hpp>
+#include <optional>
 #include <vector>
 
 namespace bw
@@ -28,6 +30,8 @@ namespace bw
 			inline LayerIndex GetLayerCount() const;
 			inline const Map& GetMap() const;
 
+			void EnableParallelUpdate(std::size_t workerCount);
+
 			void Initialize(Match& match);
 
 			void Update(float elapsedTime);
@@ -35,6 +39,7 @@ namespace bw
 			Terrain& operator=(const Terrain&) = delete;
 
 		private:
+			std::optional<WorkerPool> m_workerPool;
 			Map& m_map;
 			std::vector<TerrainLayer> m_layers; //< Shouldn't resize because of raw pointer in Player
 	};
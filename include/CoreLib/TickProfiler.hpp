@@ -0,0 +1,114 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_TICKPROFILER_HPP
+#define BURGWAR_CORELIB_TICKPROFILER_HPP
+
+#include <CoreLib/Export.hpp>
+#include <CoreLib/LayerIndex.hpp>
+#include <Nazara/Prerequisites.hpp>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace bw
+{
+	enum class ProfileCategory : Nz::UInt8
+	{
+		Network,
+		Physics,
+		Script,
+		Simulation
+	};
+
+	class BURGWAR_CORELIB_API TickProfiler
+	{
+		public:
+			class Scope;
+
+			TickProfiler(std::size_t historySize = DefaultHistorySize);
+			TickProfiler(const TickProfiler&) = delete;
+			TickProfiler(TickProfiler&&) = delete;
+			~TickProfiler() = default;
+
+			void BeginTick(Nz::UInt64 tick);
+
+			std::string BuildSummary() const;
+
+			void Clear();
+
+			void Enable(bool enable = true);
+			void EndTick();
+
+			bool ExportChromeTrace(const std::filesystem::path& filePath) const;
+
+			inline std::size_t GetRecordedTickCount() const;
+
+			inline bool IsEnabled() const;
+			inline bool IsRecording() const;
+
+			TickProfiler& operator=(const TickProfiler&) = delete;
+			TickProfiler& operator=(TickProfiler&&) = delete;
+
+			static constexpr std::size_t DefaultHistorySize = 512;
+
+		private:
+			std::size_t BeginEvent(const char* name, ProfileCategory category, LayerIndex layerIndex);
+			void EndEvent(std::size_t eventIndex);
+			template<typename F> void ForEachRecordedTick(F&& callback) const;
+
+			static constexpr std::size_t InvalidEvent = std::numeric_limits<std::size_t>::max();
+
+			struct Event
+			{
+				const char* name;
+				Nz::UInt64 startTime;
+				Nz::UInt64 endTime;
+				LayerIndex layerIndex;
+				ProfileCategory category;
+				bool isOutermostScript;
+			};
+
+			struct TickRecord
+			{
+				std::vector<Event> events;
+				Nz::UInt64 scriptTime;
+				Nz::UInt64 startTime;
+				Nz::UInt64 endTime;
+				Nz::UInt64 tick;
+			};
+
+			std::size_t m_currentTick;
+			std::size_t m_recordedTickCount;
+			std::vector<TickRecord> m_ticks;
+			Nz::UInt8 m_scriptDepth;
+			bool m_isEnabled;
+			bool m_isRecording;
+	};
+
+	class TickProfiler::Scope
+	{
+		public:
+			inline Scope(TickProfiler& profiler, const char* name, ProfileCategory category, LayerIndex layerIndex = NoLayer);
+			Scope(const Scope&) = delete;
+			Scope(Scope&&) = delete;
+			inline ~Scope();
+
+			Scope& operator=(const Scope&) = delete;
+			Scope& operator=(Scope&&) = delete;
+
+		private:
+			TickProfiler& m_profiler;
+			std::size_t m_eventIndex;
+	};
+
+	BURGWAR_CORELIB_API const char* ToString(ProfileCategory category);
+}
+
+#include <CoreLib/TickProfiler.inl>
+
+#endif
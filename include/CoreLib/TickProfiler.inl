@@ -0,0 +1,47 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/TickProfiler.hpp>
+
+namespace bw
+{
+	inline std::size_t TickProfiler::GetRecordedTickCount() const
+	{
+		return m_recordedTickCount;
+	}
+
+	inline bool TickProfiler::IsEnabled() const
+	{
+		return m_isEnabled;
+	}
+
+	/*!
+	* \brief Returns true if a tick is currently being recorded (scopes are only recorded in that case)
+	*/
+	inline bool TickProfiler::IsRecording() const
+	{
+		return m_isRecording;
+	}
+
+	template<typename F>
+	void TickProfiler::ForEachRecordedTick(F&& callback) const
+	{
+		// Oldest tick first
+		std::size_t firstTick = (m_currentTick + m_ticks.size() - m_recordedTickCount) % m_ticks.size();
+		for (std::size_t i = 0; i < m_recordedTickCount; ++i)
+			callback(m_ticks[(firstTick + i) % m_ticks.size()]);
+	}
+
+	inline TickProfiler::Scope::Scope(TickProfiler& profiler, const char* name, ProfileCategory category, LayerIndex layerIndex) :
+	m_profiler(profiler)
+	{
+		m_eventIndex = (profiler.IsRecording()) ? profiler.BeginEvent(name, category, layerIndex) : InvalidEvent;
+	}
+
+	inline TickProfiler::Scope::~Scope()
+	{
+		if (m_eventIndex != InvalidEvent)
+			m_profiler.EndEvent(m_eventIndex);
+	}
+}
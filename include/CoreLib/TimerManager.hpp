@@ -9,6 +9,7 @@
 
 #include <CoreLib/Export.hpp>
 #include <Nazara/Prerequisites.hpp>
+#include <tsl/hopscotch_map.h>
 #include <functional>
 #include <vector>
 
@@ -20,24 +21,35 @@ namespace bw
 	{
 		public:
 			using Callback = std::function<void()>;
+			using TimerId = Nz::UInt64;
 
-			TimerManager() = default;
+			TimerManager();
 			~TimerManager() = default;
 
+			bool Cancel(TimerId timerId);
 			inline void Clear();
 
-			inline void PushCallback(Nz::UInt64 expirationTime, Callback finish);
+			inline std::size_t GetPendingTimerCount() const;
 
-			inline void Update(Nz::UInt64 now);
+			TimerId PushCallback(Nz::UInt64 expirationTime, Callback callback);
+
+			void Update(Nz::UInt64 now);
 
 		private:
-			struct Timer
+			void Compact();
+
+			// Heap entries are kept small, callbacks are stored separately so canceling a timer doesn't require to find it in the heap
+			struct QueuedTimer
 			{
-				Callback callback;
 				Nz::UInt64 expirationTime;
+				TimerId timerId;
+
+				inline bool operator>(const QueuedTimer& rhs) const;
 			};
 
-			std::vector<Timer> m_pendingTimers;
+			std::vector<QueuedTimer> m_timerQueue; //< min-heap on (expirationTime, timerId)
+			tsl::hopscotch_map<TimerId, Callback> m_pendingCallbacks;
+			TimerId m_nextTimerId;
 	};
 }
 
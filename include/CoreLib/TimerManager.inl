@@ -8,34 +8,21 @@ namespace bw
 {
 	inline void TimerManager::Clear()
 	{
-		m_pendingTimers.clear();
+		m_pendingCallbacks.clear();
+		m_timerQueue.clear();
 	}
 
-	inline void TimerManager::PushCallback(Nz::UInt64 expirationTime, Callback callback)
+	inline std::size_t TimerManager::GetPendingTimerCount() const
 	{
-		Timer& timer = m_pendingTimers.emplace_back();
-		timer.callback = std::move(callback);
-		timer.expirationTime = expirationTime;
-
-		//TODO: Insertion sort
+		return m_pendingCallbacks.size();
 	}
 
-	inline void TimerManager::Update(Nz::UInt64 now)
+	inline bool TimerManager::QueuedTimer::operator>(const QueuedTimer& rhs) const
 	{
-		// Use index instead of iterator because callback may push new timers
-		for (std::size_t i = 0; i < m_pendingTimers.size();)
-		{
-			if (now > m_pendingTimers[i].expirationTime)
-			{
-				auto it = m_pendingTimers.begin() + i;
-
-				Timer timer = std::move(*it);
-				m_pendingTimers.erase(it);
+		// Timer ids are increasing, using them as a tie-breaker keeps timers expiring at the same time in insertion order
+		if (expirationTime != rhs.expirationTime)
+			return expirationTime > rhs.expirationTime;
 
-				timer.callback();
-			}
-			else
-				++i;
-		}
+		return timerId > rhs.timerId;
 	}
 }
@@ -0,0 +1,48 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_SPATIALGRID_HPP
+#define BURGWAR_CORELIB_SPATIALGRID_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Math/Vector2.hpp>
+#include <tsl/hopscotch_map.h>
+#include <utility>
+#include <vector>
+
+namespace bw
+{
+	// Uniform grid hashing 2D positions to square cells, to query values near a point without iterating over all of them
+	template<typename T>
+	class SpatialGrid
+	{
+		public:
+			SpatialGrid(float cellSize = 1.f);
+			~SpatialGrid() = default;
+
+			void Clear();
+
+			float GetCellSize() const;
+
+			void Insert(const Nz::Vector2f& position, T value);
+
+			template<typename F> void Query(const Nz::Vector2f& center, float radius, F&& callback) const;
+
+			void SetCellSize(float cellSize);
+
+		private:
+			Nz::Int32 ComputeCoordinate(float value) const;
+
+			static Nz::UInt64 ComputeCellKey(Nz::Int32 x, Nz::Int32 y);
+
+			tsl::hopscotch_map<Nz::UInt64 /*cellKey*/, std::vector<std::pair<Nz::Vector2f, T>>> m_cells;
+			float m_cellSize;
+	};
+}
+
+#include <CoreLib/Utility/SpatialGrid.inl>
+
+#endif
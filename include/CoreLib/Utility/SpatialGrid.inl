@@ -0,0 +1,86 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Utility/SpatialGrid.hpp>
+#include <cassert>
+#include <cmath>
+
+namespace bw
+{
+	template<typename T>
+	SpatialGrid<T>::SpatialGrid(float cellSize) :
+	m_cellSize(cellSize)
+	{
+		assert(m_cellSize > 0.f);
+	}
+
+	template<typename T>
+	void SpatialGrid<T>::Clear()
+	{
+		// Keep cells (and their memory) around, grids are usually refilled every tick with similar positions
+		for (auto it = m_cells.begin(); it != m_cells.end(); ++it)
+			it.value().clear();
+	}
+
+	template<typename T>
+	float SpatialGrid<T>::GetCellSize() const
+	{
+		return m_cellSize;
+	}
+
+	template<typename T>
+	void SpatialGrid<T>::Insert(const Nz::Vector2f& position, T value)
+	{
+		Nz::UInt64 cellKey = ComputeCellKey(ComputeCoordinate(position.x), ComputeCoordinate(position.y));
+		m_cells[cellKey].emplace_back(position, std::move(value));
+	}
+
+	template<typename T>
+	template<typename F>
+	void SpatialGrid<T>::Query(const Nz::Vector2f& center, float radius, F&& callback) const
+	{
+		Nz::Int32 minX = ComputeCoordinate(center.x - radius);
+		Nz::Int32 maxX = ComputeCoordinate(center.x + radius);
+		Nz::Int32 minY = ComputeCoordinate(center.y - radius);
+		Nz::Int32 maxY = ComputeCoordinate(center.y + radius);
+
+		float squaredRadius = radius * radius;
+		for (Nz::Int32 y = minY; y <= maxY; ++y)
+		{
+			for (Nz::Int32 x = minX; x <= maxX; ++x)
+			{
+				auto it = m_cells.find(ComputeCellKey(x, y));
+				if (it == m_cells.end())
+					continue;
+
+				for (const auto& [position, value] : it->second)
+				{
+					if (center.SquaredDistance(position) <= squaredRadius)
+						callback(position, value);
+				}
+			}
+		}
+	}
+
+	template<typename T>
+	void SpatialGrid<T>::SetCellSize(float cellSize)
+	{
+		assert(cellSize > 0.f);
+
+		m_cellSize = cellSize;
+		m_cells.clear();
+	}
+
+	template<typename T>
+	Nz::Int32 SpatialGrid<T>::ComputeCoordinate(float value) const
+	{
+		return static_cast<Nz::Int32>(std::floor(value / m_cellSize));
+	}
+
+	template<typename T>
+	Nz::UInt64 SpatialGrid<T>::ComputeCellKey(Nz::Int32 x, Nz::Int32 y)
+	{
+		return Nz::UInt64(Nz::UInt32(x)) << 32 | Nz::UInt32(y);
+	}
+}
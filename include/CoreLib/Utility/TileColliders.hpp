@@ -0,0 +1,20 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_UTILITY_TILECOLLIDERS_HPP
+#define BURGWAR_CORELIB_UTILITY_TILECOLLIDERS_HPP
+
+#include <CoreLib/Export.hpp>
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Math/Rect.hpp>
+#include <vector>
+
+namespace bw
+{
+	BURGWAR_CORELIB_API std::vector<Nz::Rectui> BuildTileColliders(std::size_t width, std::size_t height, const std::vector<bool>& solidCells);
+}
+
+#endif
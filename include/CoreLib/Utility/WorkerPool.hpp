@@ -0,0 +1,55 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_UTILITY_WORKERPOOL_HPP
+#define BURGWAR_CORELIB_UTILITY_WORKERPOOL_HPP
+
+#include <CoreLib/Export.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bw
+{
+	class BURGWAR_CORELIB_API WorkerPool
+	{
+		public:
+			WorkerPool(std::size_t workerCount);
+			WorkerPool(const WorkerPool&) = delete;
+			WorkerPool(WorkerPool&&) = delete;
+			~WorkerPool();
+
+			inline std::size_t GetWorkerCount() const;
+
+			void ParallelFor(std::size_t taskCount, const std::function<void(std::size_t taskIndex)>& task);
+
+			WorkerPool& operator=(const WorkerPool&) = delete;
+			WorkerPool& operator=(WorkerPool&&) = delete;
+
+		private:
+			std::size_t RunTasks();
+			void WorkerThread();
+
+			const std::function<void(std::size_t taskIndex)>* m_task;
+			std::atomic_size_t m_nextTaskIndex;
+			std::condition_variable m_taskSignal;
+			std::condition_variable m_doneSignal;
+			std::mutex m_mutex;
+			std::size_t m_activeWorkerCount;
+			std::size_t m_generation;
+			std::size_t m_remainingTaskCount;
+			std::size_t m_taskCount;
+			std::vector<std::thread> m_workers;
+			bool m_running;
+	};
+}
+
+#include <CoreLib/Utility/WorkerPool.inl>
+
+#endif
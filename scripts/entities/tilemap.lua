@@ -101,31 +101,7 @@ entity:On("init", function (self)
 	local content = self:GetProperty("content")
 
 	if (self:GetProperty("physical")) then
-		local colliders = {}
-		local y = 0
-
-		while (y < mapSize.y) do
-			local x = 0
-			while (x < mapSize.x) do
-				if (content[y * mapSize.x + x + 1] ~= 0) then
-					local startX = x
-					x = x + 1
-
-					while (x < mapSize.x and content[y * mapSize.x + x + 1] ~= 0) do
-						x = x + 1
-					end
-
-					local mins = Vec2(startX * cellSize.x, y * cellSize.y)
-					local maxs = mins + Vec2((x - startX) * cellSize.x, cellSize.y)
-
-					table.insert(colliders, Rect(mins, maxs))
-				end
-
-				x = x + 1
-			end
-
-			y = y + 1
-		end
+		local colliders = physics.BuildTilemapColliders(mapSize, cellSize, content)
 
 		if (#colliders > 0) then
 			self:SetColliders(colliders)
@@ -1,12 +1,40 @@
 Debug = {
-	SendServerState = true
+	AsyncLogging = true, -- write logs from a background thread instead of the thread logging them
+	LogBufferSize = 4096, -- messages waiting to be written when AsyncLogging is enabled
+	LogFile = "", -- also write logs to this file (empty to disable)
+	LogFileBackupCount = 3, -- rotated log files to keep (server.log.1, server.log.2, ...)
+	LogFileMaxSize = 16 * 1024 * 1024, -- bytes, log file is rotated when reaching this size (0 to disable rotation)
+	LogLevel = "debug", -- debug, info, warning or error
+	LogOverflowPolicy = "block", -- what to do when the log buffer is full: "block" (wait) or "drop" (discard messages)
+	SendServerState = true,
+	TickProfiler = false, -- record per-tick phase timings (dumped with match.DumpTickProfile() or periodically)
+	TickProfilerDumpInterval = 0, -- seconds between automatic dumps (0 to disable)
+	TickProfilerFolder = "profiles"
 }
 GameSettings = {
 	Gamemode = "deathmatch",
+	LayerWorkerCount = 0, -- extra threads used to update map layers in parallel (0 to update them sequentially)
 	MapFile = "beta_map.bmap",
 	TickRate = 33,
 }
+Network = {
+	QuantizeMatchState = false, -- quantize and delta-encode match states (opt-in, uses the precisions below)
+	AngularVelocityPrecision = 1 / 1024, -- rad/s
+	FileTransferRate = 1024 * 1024, -- bytes/s sent to each client downloading assets and scripts
+	InterestRadius = 0, -- px, only send entities near players (0 to send the whole layer)
+	LinearVelocityPrecision = 1 / 16, -- px/s
+	PositionPrecision = 1 / 32, -- px
+	RotationBits = 16 -- 12 to 16
+}
 Resources = {
 	AssetDirectory = "assets",
+	BytecodeCacheDirectory = "", -- folder of compiled scripts, to skip compilation of unchanged scripts on startup (empty to disable, must not be writable by untrusted users as bytecode is not verified by Lua)
+	HashCacheFile = ".hashcache.json", -- checksums of client files, to skip hashing unchanged files on startup (empty to disable)
 	ScriptDirectory  = "scripts"
 }
+Server = {
+	MatchCount = 1, -- independent matches hosted by this process, each one listening on its own port (Port, Port + 1, ...)
+	MatchThreadCount = 0, -- threads updating matches (0 to update them on the main thread)
+	MaxPlayerCount = 64, -- per match
+	Port = 14768
+}
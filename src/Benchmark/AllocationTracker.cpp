@@ -0,0 +1,103 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Global operator new/delete are replaced to track heap usage of the whole process (including CoreLib when the platform resolves its allocations to ours)
+namespace
+{
+	// Allocation size is stored before the returned pointer, keeping its alignment
+	constexpr std::size_t HeaderSize = alignof(std::max_align_t);
+
+	std::atomic<Nz::UInt64> s_allocationCount(0);
+	std::atomic<Nz::UInt64> s_currentUsage(0);
+	std::atomic<Nz::UInt64> s_peakUsage(0);
+
+	Nz::UInt64 s_trackingAllocationCount = 0;
+	Nz::UInt64 s_trackingBaseUsage = 0;
+
+	void* Allocate(std::size_t size)
+	{
+		void* ptr = std::malloc(HeaderSize + size);
+		if (!ptr)
+			throw std::bad_alloc();
+
+		*static_cast<std::size_t*>(ptr) = size;
+
+		s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+		Nz::UInt64 usage = s_currentUsage.fetch_add(size, std::memory_order_relaxed) + size;
+		Nz::UInt64 peakUsage = s_peakUsage.load(std::memory_order_relaxed);
+		while (usage > peakUsage && !s_peakUsage.compare_exchange_weak(peakUsage, usage, std::memory_order_relaxed));
+
+		return static_cast<char*>(ptr) + HeaderSize;
+	}
+
+	void Free(void* ptr) noexcept
+	{
+		if (!ptr)
+			return;
+
+		void* basePtr = static_cast<char*>(ptr) - HeaderSize;
+		s_currentUsage.fetch_sub(*static_cast<std::size_t*>(basePtr), std::memory_order_relaxed);
+
+		std::free(basePtr);
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	return Allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	Free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	Free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+	Free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t /*size*/) noexcept
+{
+	Free(ptr);
+}
+
+namespace bw
+{
+	void BeginMemoryTracking()
+	{
+		s_trackingAllocationCount = s_allocationCount.load(std::memory_order_relaxed);
+		s_trackingBaseUsage = s_currentUsage.load(std::memory_order_relaxed);
+		s_peakUsage.store(s_trackingBaseUsage, std::memory_order_relaxed);
+	}
+
+	MemoryUsage EndMemoryTracking()
+	{
+		Nz::UInt64 currentUsage = s_currentUsage.load(std::memory_order_relaxed);
+
+		MemoryUsage memoryUsage;
+		memoryUsage.allocationCount = s_allocationCount.load(std::memory_order_relaxed) - s_trackingAllocationCount;
+		memoryUsage.peakUsage = s_peakUsage.load(std::memory_order_relaxed) - s_trackingBaseUsage;
+		memoryUsage.retainedUsage = (currentUsage > s_trackingBaseUsage) ? currentUsage - s_trackingBaseUsage : 0;
+
+		return memoryUsage;
+	}
+}
@@ -0,0 +1,33 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <fmt/format.h>
+
+namespace bw
+{
+	void PrintBenchmarkHeader(std::string_view suiteName)
+	{
+		fmt::print("\n== {} ==\n", suiteName);
+		fmt::print("{:<56}{:>10}{:>12}{:>12}{:>12}{:>14}\n", "Benchmark", "Elements", "Median(us)", "Min(us)", "Max(us)", "ns/element");
+	}
+
+	void PrintBenchmarkResult(std::string_view name, std::size_t elementCount, const BenchmarkResult& result)
+	{
+		double nsPerElement = (elementCount > 0) ? result.medianTime * 1000.0 / elementCount : 0.0;
+		fmt::print("{:<56}{:>10}{:>12}{:>12}{:>12}{:>14.1f}\n", name, elementCount, result.medianTime, result.minTime, result.maxTime, nsPerElement);
+	}
+
+	void PrintMemoryUsage(std::string_view name, const MemoryUsage& memoryUsage)
+	{
+		// Allocations from shared libraries aren't seen on platforms where they don't resolve to our operator new
+		if (memoryUsage.allocationCount == 0)
+		{
+			fmt::print("{:<56}{:>10}    not tracked\n", name, 0);
+			return;
+		}
+
+		fmt::print("{:<56}{:>10} allocations, peak {} KiB, retained {} KiB\n", name, memoryUsage.allocationCount, memoryUsage.peakUsage / 1024, memoryUsage.retainedUsage / 1024);
+	}
+}
@@ -0,0 +1,56 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_BENCHMARK_HPP
+#define BURGWAR_BENCHMARK_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <string_view>
+
+namespace bw
+{
+	struct BenchmarkSettings
+	{
+		std::size_t iterationCount = 20; //< Every benchmark is measured this many times, the median is reported
+		Nz::UInt16 networkPort = 14790; //< Listening port of network benchmarks
+	};
+
+	struct BenchmarkResult
+	{
+		Nz::UInt64 maxTime;    //< in microseconds
+		Nz::UInt64 medianTime; //< in microseconds
+		Nz::UInt64 minTime;    //< in microseconds
+	};
+
+	struct MemoryUsage
+	{
+		Nz::UInt64 allocationCount;
+		Nz::UInt64 peakUsage;     //< in bytes, above what was allocated when tracking began
+		Nz::UInt64 retainedUsage; //< in bytes, still allocated when tracking ended
+	};
+
+	void BeginMemoryTracking();
+	MemoryUsage EndMemoryTracking();
+
+	template<typename F> BenchmarkResult MeasureBenchmark(std::size_t iterationCount, F&& func);
+	template<typename F> MemoryUsage MeasureMemoryUsage(F&& func);
+
+	void PrintBenchmarkHeader(std::string_view suiteName);
+	void PrintBenchmarkResult(std::string_view name, std::size_t elementCount, const BenchmarkResult& result);
+	void PrintMemoryUsage(std::string_view name, const MemoryUsage& memoryUsage);
+
+	bool RunBytecodeBenchmark(const BenchmarkSettings& settings);
+	bool RunLogBenchmark(const BenchmarkSettings& settings);
+	bool RunMapBenchmark(const BenchmarkSettings& settings);
+	bool RunMatchStateBenchmark(const BenchmarkSettings& settings);
+	bool RunReactorBenchmark(const BenchmarkSettings& settings);
+	bool RunSerializerBenchmark(const BenchmarkSettings& settings);
+	bool RunTimerBenchmark(const BenchmarkSettings& settings);
+}
+
+#include <Benchmark/Benchmark.inl>
+
+#endif
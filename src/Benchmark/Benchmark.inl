@@ -0,0 +1,56 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace bw
+{
+	/*!
+	* \brief Calls func iterationCount times and returns its timings
+	*
+	* func is called once more beforehand to warm caches and allocations up, that call isn't measured.
+	*/
+	template<typename F>
+	BenchmarkResult MeasureBenchmark(std::size_t iterationCount, F&& func)
+	{
+		assert(iterationCount > 0);
+
+		func();
+
+		std::vector<Nz::UInt64> durations(iterationCount);
+		for (Nz::UInt64& duration : durations)
+		{
+			Nz::UInt64 startTime = Nz::GetElapsedMicroseconds();
+			func();
+			duration = Nz::GetElapsedMicroseconds() - startTime;
+		}
+
+		std::sort(durations.begin(), durations.end());
+
+		BenchmarkResult result;
+		result.maxTime = durations.back();
+		result.medianTime = durations[durations.size() / 2];
+		result.minTime = durations.front();
+
+		return result;
+	}
+
+	/*!
+	* \brief Calls func once and returns the heap memory it allocated
+	*
+	* Heap usage of every thread is tracked, func should be the only thing running.
+	*/
+	template<typename F>
+	MemoryUsage MeasureMemoryUsage(F&& func)
+	{
+		BeginMemoryTracking();
+		func();
+
+		return EndMemoryTracking();
+	}
+}
@@ -0,0 +1,214 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <CoreLib/Scripting/ScriptBytecodeCache.hpp>
+#include <fmt/format.h>
+#include <sol/sol.hpp>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bw
+{
+	namespace
+	{
+		struct Chunk
+		{
+			std::string name;
+			std::string source;
+		};
+
+		// Cache key as it was built before SHA1 (64bits FNV-1a and source size)
+		std::string BuildReferenceKey(std::string_view source, std::string_view chunkName)
+		{
+			Nz::UInt64 hash = 14695981039346656037ULL;
+			auto Hash = [&](std::string_view str)
+			{
+				for (char c : str)
+				{
+					hash ^= static_cast<Nz::UInt8>(c);
+					hash *= 1099511628211ULL;
+				}
+			};
+
+			Hash(chunkName);
+			Hash(std::string_view("\0", 1));
+			Hash(source);
+
+			return fmt::format("{:016x}{:08x}", hash, source.size());
+		}
+
+		// Looks like an entity script: a table with a few properties and callbacks
+		std::vector<Chunk> GenerateChunks(std::size_t chunkCount)
+		{
+			std::vector<Chunk> chunks(chunkCount);
+			for (std::size_t i = 0; i < chunkCount; ++i)
+			{
+				Chunk& chunk = chunks[i];
+				chunk.name = fmt::format("@entities/entity_{}/shared.lua", i);
+
+				chunk.source = fmt::format("local ENTITY = {{ Name = \"entity_{}\", MaxHealth = {}, Properties = {{}} }}\n", i, 100 + i);
+				for (std::size_t j = 0; j < 16; ++j)
+				{
+					chunk.source += fmt::format(R"(
+function ENTITY:Callback{0}(other, damage)
+	local health = self:GetHealth() - damage * {0}
+	for i = 1, 10 do
+		if other and other.Name == "entity_{1}" then
+			health = health + i
+		end
+	end
+	return math.max(health, 0), "callback{0}"
+end
+)", j, i);
+				}
+
+				chunk.source += "\nreturn ENTITY\n";
+			}
+
+			return chunks;
+		}
+
+		// Same steps as ScriptingContext::LoadChunk
+		bool LoadChunk(sol::state& state, ScriptBytecodeCache& cache, const Chunk& chunk)
+		{
+			std::string cacheKey = ScriptBytecodeCache::BuildKey(chunk.source, chunk.name);
+			if (ScriptBytecodeCache::Bytecode bytecode = cache.Find(cacheKey))
+			{
+				sol::load_result result = state.load(std::string_view(*bytecode), chunk.name, sol::load_mode::binary);
+				if (result.valid())
+					return true;
+			}
+
+			sol::load_result result = state.load(chunk.source, chunk.name);
+			if (!result.valid())
+				return false;
+
+			std::string compiledChunk;
+			auto ChunkWriter = [](lua_State* /*L*/, const void* data, std::size_t size, void* userdata) -> int
+			{
+				static_cast<std::string*>(userdata)->append(static_cast<const char*>(data), size);
+				return 0;
+			};
+
+			lua_State* L = state.lua_state();
+			lua_pushvalue(L, result.stack_index());
+			int dumpError = lua_dump(L, ChunkWriter, &compiledChunk, 0);
+			lua_pop(L, 1);
+
+			if (dumpError == 0)
+				cache.Store(cacheKey, std::move(compiledChunk));
+
+			return true;
+		}
+
+		bool LoadChunks(sol::state& state, ScriptBytecodeCache& cache, const std::vector<Chunk>& chunks)
+		{
+			for (const Chunk& chunk : chunks)
+			{
+				if (!LoadChunk(state, cache, chunk))
+					return false;
+			}
+
+			return true;
+		}
+	}
+
+	/*!
+	* \brief Compares script loading without cache, from the in-memory cache and from the disk cache, and cache keys to their previous FNV-1a implementation
+	*
+	* Disk cache files are written in a temporary folder, removed afterwards.
+	*/
+	bool RunBytecodeBenchmark(const BenchmarkSettings& settings)
+	{
+		PrintBenchmarkHeader("Script bytecode cache");
+
+		std::filesystem::path cacheFolder = std::filesystem::temp_directory_path() / "burgwar_bytecode_benchmark";
+
+		bool success = true;
+		for (std::size_t chunkCount : { 10, 100, 1'000 })
+		{
+			std::vector<Chunk> chunks = GenerateChunks(chunkCount);
+
+			std::size_t sourceSize = 0;
+			for (const Chunk& chunk : chunks)
+				sourceSize += chunk.source.size();
+
+			fmt::print("{} chunks, {} bytes of source\n", chunkCount, sourceSize);
+
+			sol::state state;
+
+			BenchmarkResult referenceKeyResult = MeasureBenchmark(settings.iterationCount, [&]
+			{
+				for (const Chunk& chunk : chunks)
+					BuildReferenceKey(chunk.source, chunk.name);
+			});
+			PrintBenchmarkResult("Previous cache key (FNV-1a)", chunkCount, referenceKeyResult);
+
+			BenchmarkResult keyResult = MeasureBenchmark(settings.iterationCount, [&]
+			{
+				for (const Chunk& chunk : chunks)
+					ScriptBytecodeCache::BuildKey(chunk.source, chunk.name);
+			});
+			PrintBenchmarkResult("Cache key (SHA1)", chunkCount, keyResult);
+
+			ScriptBytecodeCache memoryCache;
+			BenchmarkResult compileResult = MeasureBenchmark(settings.iterationCount, [&]
+			{
+				memoryCache.Clear();
+				success = LoadChunks(state, memoryCache, chunks) && success;
+			});
+			PrintBenchmarkResult("Compilation (cache miss)", chunkCount, compileResult);
+
+			BenchmarkResult memoryResult = MeasureBenchmark(settings.iterationCount, [&]
+			{
+				success = LoadChunks(state, memoryCache, chunks) && success;
+			});
+			PrintBenchmarkResult("Load from memory cache", chunkCount, memoryResult);
+
+			// Fill the disk cache, then use a new cache object every time so bytecode comes from disk
+			std::error_code err;
+			std::filesystem::remove_all(cacheFolder, err);
+
+			{
+				ScriptBytecodeCache diskCache(cacheFolder);
+				success = LoadChunks(state, diskCache, chunks) && success;
+			}
+
+			BenchmarkResult diskResult = MeasureBenchmark(settings.iterationCount, [&]
+			{
+				ScriptBytecodeCache diskCache(cacheFolder);
+				success = LoadChunks(state, diskCache, chunks) && success;
+
+				if (diskCache.GetMemoryUsage() == 0)
+					success = false; //< Nothing was read from disk
+			});
+			PrintBenchmarkResult("Load from disk cache (verified)", chunkCount, diskResult);
+
+			// A memory limit below the total bytecode size evicts chunks, which are then compiled again
+			ScriptBytecodeCache boundedCache({}, memoryCache.GetMemoryUsage() / 2);
+			BenchmarkResult boundedResult = MeasureBenchmark(settings.iterationCount, [&]
+			{
+				success = LoadChunks(state, boundedCache, chunks) && success;
+
+				if (boundedCache.GetMemoryUsage() > boundedCache.GetMaxMemoryUsage())
+					success = false;
+			});
+			PrintBenchmarkResult("Load with half the bytecode in memory", chunkCount, boundedResult);
+
+			if (!success)
+			{
+				fmt::print("script loading failed with {} chunks\n", chunkCount);
+				break;
+			}
+		}
+
+		std::error_code err;
+		std::filesystem::remove_all(cacheFolder, err);
+
+		return success;
+	}
+}
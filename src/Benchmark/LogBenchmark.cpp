@@ -0,0 +1,191 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <CoreLib/LogSystem/AsyncSink.hpp>
+#include <CoreLib/LogSystem/FileSink.hpp>
+#include <CoreLib/LogSystem/LogContext.hpp>
+#include <fmt/format.h>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace bw
+{
+	namespace
+	{
+		constexpr std::size_t MessageCount = 100'000;
+		constexpr float MessageElapsedTime = 42.f;
+
+		class CountingSink : public LogSink
+		{
+			public:
+				CountingSink() :
+				m_invalidContextCount(0),
+				m_messageCount(0),
+				m_warningCount(0)
+				{
+				}
+
+				std::size_t GetInvalidContextCount() const
+				{
+					return m_invalidContextCount.load();
+				}
+
+				std::size_t GetMessageCount() const
+				{
+					return m_messageCount.load();
+				}
+
+				std::size_t GetWarningCount() const
+				{
+					return m_warningCount.load();
+				}
+
+				void Write(const LogContext& context, std::string_view /*content*/) override
+				{
+					// Dropped message warnings use the time of the last written message, or zero if there was none
+					if (context.level == LogLevel::Warning)
+					{
+						if (context.elapsedTime != MessageElapsedTime && context.elapsedTime != 0.f)
+							m_invalidContextCount++;
+
+						m_warningCount++;
+					}
+					else
+					{
+						if (context.elapsedTime != MessageElapsedTime)
+							m_invalidContextCount++;
+
+						m_messageCount++;
+					}
+				}
+
+			private:
+				std::atomic<std::size_t> m_invalidContextCount;
+				std::atomic<std::size_t> m_messageCount;
+				std::atomic<std::size_t> m_warningCount;
+		};
+
+		// Writes MessageCount messages split between threadCount threads, as match threads would
+		void WriteMessages(LogSink& sink, std::size_t threadCount)
+		{
+			auto WriteRange = [&](std::size_t threadIndex, std::size_t messageCount)
+			{
+				LogContext context;
+				context.elapsedTime = MessageElapsedTime;
+				context.level = LogLevel::Info;
+				context.side = LogSide::Server;
+
+				// Formatted as Logger::LogFormat does
+				for (std::size_t i = 0; i < messageCount; ++i)
+					sink.Write(context, fmt::format("[Match] thread #{0} - entity #{1} spawned at {2};{3}", threadIndex, i, 128.5f, -64.f));
+			};
+
+			if (threadCount == 1)
+			{
+				WriteRange(0, MessageCount);
+				return;
+			}
+
+			std::vector<std::thread> threads;
+			for (std::size_t i = 0; i < threadCount; ++i)
+				threads.emplace_back(WriteRange, i, MessageCount / threadCount);
+
+			for (std::thread& thread : threads)
+				thread.join();
+		}
+	}
+
+	/*!
+	* \brief Compares writing logs to a file synchronously (as loggers did before AsyncSink) and through an AsyncSink
+	*
+	* AsyncSink results measure logging threads only, and then logging threads plus the time to flush every message.
+	* Log files are written in a temporary folder, removed afterwards.
+	*/
+	bool RunLogBenchmark(const BenchmarkSettings& settings)
+	{
+		PrintBenchmarkHeader("Logging");
+
+		std::filesystem::path logFolder = std::filesystem::temp_directory_path() / "burgwar_log_benchmark";
+
+		std::error_code err;
+		std::filesystem::remove_all(logFolder, err);
+		std::filesystem::create_directories(logFolder, err);
+
+		bool success = true;
+		for (std::size_t threadCount : { 1, 4 })
+		{
+			{
+				FileSink fileSink(logFolder / "sync.log");
+				if (!fileSink.IsOpen())
+				{
+					fmt::print("failed to open {}\n", (logFolder / "sync.log").generic_u8string());
+					success = false;
+					break;
+				}
+
+				BenchmarkResult syncResult = MeasureBenchmark(settings.iterationCount, [&] { WriteMessages(fileSink, threadCount); });
+				PrintBenchmarkResult(fmt::format("FileSink, synchronous ({} threads)", threadCount), MessageCount, syncResult);
+			}
+
+			{
+				auto fileSink = std::make_shared<FileSink>(logFolder / "async.log");
+				AsyncSink asyncSink({ fileSink });
+
+				BenchmarkResult enqueueResult = MeasureBenchmark(settings.iterationCount, [&] { WriteMessages(asyncSink, threadCount); });
+				PrintBenchmarkResult(fmt::format("AsyncSink to FileSink, enqueue ({} threads)", threadCount), MessageCount, enqueueResult);
+			}
+
+			// Every message must reach every wrapped sink with the block policy
+			{
+				auto fileSink = std::make_shared<FileSink>(logFolder / "async_flush.log");
+				auto firstSink = std::make_shared<CountingSink>();
+				auto secondSink = std::make_shared<CountingSink>();
+
+				BenchmarkResult flushResult = MeasureBenchmark(settings.iterationCount, [&]
+				{
+					AsyncSink asyncSink({ fileSink, firstSink, secondSink });
+					WriteMessages(asyncSink, threadCount);
+				});
+				PrintBenchmarkResult(fmt::format("AsyncSink to FileSink, enqueue and flush ({} threads)", threadCount), MessageCount, flushResult);
+
+				std::size_t expectedMessageCount = (MessageCount / threadCount) * threadCount * settings.iterationCount;
+				for (const auto& sinkPtr : { firstSink, secondSink })
+				{
+					if (sinkPtr->GetMessageCount() != expectedMessageCount || sinkPtr->GetWarningCount() != 0 || sinkPtr->GetInvalidContextCount() != 0)
+					{
+						fmt::print("block policy delivered {} messages out of {} with {} warnings and {} invalid contexts\n", sinkPtr->GetMessageCount(), expectedMessageCount, sinkPtr->GetWarningCount(), sinkPtr->GetInvalidContextCount());
+						success = false;
+					}
+				}
+			}
+
+			// With the drop policy, messages are either delivered or counted as dropped, and the dropped message warning has a valid context
+			{
+				auto countingSink = std::make_shared<CountingSink>();
+				Nz::UInt64 droppedMessageCount;
+				{
+					AsyncSink asyncSink({ countingSink }, 16, AsyncSink::OverflowPolicy::Drop);
+					WriteMessages(asyncSink, threadCount);
+
+					droppedMessageCount = asyncSink.GetDroppedMessageCount();
+				}
+
+				std::size_t expectedMessageCount = (MessageCount / threadCount) * threadCount;
+				if (countingSink->GetMessageCount() + droppedMessageCount != expectedMessageCount || (droppedMessageCount > 0) != (countingSink->GetWarningCount() > 0) || countingSink->GetInvalidContextCount() != 0)
+				{
+					fmt::print("drop policy delivered {} messages and dropped {} out of {}, with {} warnings and {} invalid contexts\n", countingSink->GetMessageCount(), droppedMessageCount, expectedMessageCount, countingSink->GetWarningCount(), countingSink->GetInvalidContextCount());
+					success = false;
+				}
+			}
+		}
+
+		std::filesystem::remove_all(logFolder, err);
+
+		return success;
+	}
+}
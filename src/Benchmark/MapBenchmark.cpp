@@ -0,0 +1,260 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <CoreLib/Map.hpp>
+#include <CoreLib/Version.hpp>
+#include <CoreLib/Protocol/CompressedInteger.hpp>
+#include <Nazara/Core/ByteStream.hpp>
+#include <Nazara/Core/File.hpp>
+#include <fmt/format.h>
+#include <array>
+#include <filesystem>
+#include <optional>
+#include <random>
+
+namespace bw
+{
+	namespace
+	{
+		constexpr LayerIndex LayerCount = 8;
+
+		// Map::Compile as it was before the v2 format
+		bool CompileV1(const Map& map, const std::filesystem::path& outputPath)
+		{
+			Nz::File infoFile(outputPath.generic_u8string(), Nz::OpenMode_WriteOnly | Nz::OpenMode_Truncate);
+			if (!infoFile.IsOpen())
+				return false;
+
+			Nz::ByteStream stream(&infoFile);
+			stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+			stream.Write("Burgrmap", 8);
+			stream << Nz::UInt16(1);
+
+			const MapInfo& mapInfo = map.GetMapInfo();
+			stream << mapInfo.name << mapInfo.author << mapInfo.description;
+
+			stream << Nz::UInt32(BURGWAR_VERSION);
+
+			CompressedUnsigned<Nz::UInt16> layerCount(Nz::UInt16(map.GetLayerCount()));
+			stream << layerCount;
+
+			for (const Map::Layer& layer : map.GetLayers())
+			{
+				stream << layer.name;
+				stream << layer.backgroundColor;
+
+				CompressedUnsigned<Nz::UInt16> entityCount(Nz::UInt16(layer.entities.size()));
+				stream << entityCount;
+
+				for (const Map::Entity& entity : layer.entities)
+				{
+					stream << entity.entityType;
+					stream << entity.name;
+					stream << entity.position.x << entity.position.y;
+					stream << entity.rotation.ToDegrees();
+
+					CompressedSigned<EntityId> compressedUniqueId(entity.uniqueId);
+					stream << compressedUniqueId;
+
+					CompressedUnsigned<Nz::UInt16> propertyCount(Nz::UInt16(entity.properties.size()));
+					stream << propertyCount;
+
+					for (const auto& [key, value] : entity.properties)
+					{
+						stream << key;
+
+						auto [P, isArray] = ExtractPropertyType(value);
+
+						Nz::UInt8 propertyType = Nz::UInt8(P);
+						stream << propertyType;
+
+						stream << isArray;
+
+						std::visit([&](auto&& propertyValue)
+						{
+							using T = std::decay_t<decltype(propertyValue)>;
+							using TypeExtractor = PropertyTypeExtractor<T>;
+							constexpr bool IsArray = TypeExtractor::IsArray;
+
+							if constexpr (IsArray)
+							{
+								CompressedUnsigned<Nz::UInt32> arraySize(Nz::UInt32(propertyValue.size()));
+
+								stream << arraySize;
+								for (const auto& element : propertyValue)
+									stream << element;
+							}
+							else
+								stream << propertyValue.value;
+
+						}, value);
+					}
+				}
+			}
+
+			// Scripts
+			CompressedUnsigned<Nz::UInt32> empty(0);
+			stream << empty;
+
+			CompressedUnsigned<Nz::UInt32> assetCount(Nz::UInt32(map.GetAssets().size()));
+			stream << assetCount;
+
+			for (const Map::Asset& asset : map.GetAssets())
+			{
+				stream << asset.filepath;
+				stream << asset.size;
+				stream.Write(asset.sha1Checksum.data(), asset.sha1Checksum.size());
+			}
+
+			return true;
+		}
+
+		// Entities look like those of the bundled maps: a few entity types, and properties of various types
+		Map GenerateMap(std::mt19937& randomEngine, std::size_t entityCount)
+		{
+			constexpr std::array<const char*, 6> EntityTypes = { "entity_block", "entity_spawnpoint", "entity_weapon_spawner", "entity_tilemap", "entity_text", "entity_box" };
+
+			std::uniform_int_distribution<LayerIndex> layerDistribution(0, LayerCount - 1);
+			std::uniform_int_distribution<std::size_t> typeDistribution(0, EntityTypes.size() - 1);
+			std::uniform_real_distribution<float> positionDistribution(-10'000.f, 10'000.f);
+			std::uniform_int_distribution<Nz::Int64> integerDistribution(0, 1'000);
+
+			MapInfo mapInfo;
+			mapInfo.author = "Benchmark";
+			mapInfo.description = "Generated map";
+			mapInfo.name = "benchmark_map";
+
+			Map map(std::move(mapInfo));
+			for (LayerIndex i = 0; i < LayerCount; ++i)
+			{
+				Map::Layer& layer = map.AddLayer();
+				layer.name = fmt::format("layer_{}", i);
+			}
+
+			for (std::size_t i = 0; i < entityCount; ++i)
+			{
+				Map::Entity& entity = map.AddEntity(layerDistribution(randomEngine));
+				entity.entityType = EntityTypes[typeDistribution(randomEngine)];
+				entity.name = (i % 10 == 0) ? fmt::format("named_entity_{}", i) : std::string{};
+				entity.position = Nz::Vector2f(positionDistribution(randomEngine), positionDistribution(randomEngine));
+				entity.rotation = Nz::DegreeAnglef(positionDistribution(randomEngine) / 100.f);
+
+				entity.properties.emplace("health", PropertySingleValue<PropertyType::Integer>(integerDistribution(randomEngine)));
+				entity.properties.emplace("mass", PropertySingleValue<PropertyType::Float>(positionDistribution(randomEngine)));
+				entity.properties.emplace("size", PropertySingleValue<PropertyType::FloatSize>(Nz::Vector2f(64.f, 32.f)));
+				entity.properties.emplace("texture", PropertySingleValue<PropertyType::Texture>("dirt/dirt.png"));
+				entity.properties.emplace("visible", PropertySingleValue<PropertyType::Bool>(i % 2 == 0));
+
+				if (entity.entityType == "entity_tilemap")
+				{
+					PropertyArrayValue<PropertyType::Integer> tiles(256);
+					for (Nz::Int64& tile : tiles)
+						tile = integerDistribution(randomEngine);
+
+					entity.properties.emplace("content", std::move(tiles));
+				}
+			}
+
+			return map;
+		}
+
+		bool IsSameMap(const Map& lhs, const Map& rhs)
+		{
+			if (lhs.GetLayerCount() != rhs.GetLayerCount())
+				return false;
+
+			for (LayerIndex layerIndex = 0; layerIndex < lhs.GetLayerCount(); ++layerIndex)
+			{
+				const Map::Layer& lhsLayer = lhs.GetLayer(layerIndex);
+				const Map::Layer& rhsLayer = rhs.GetLayer(layerIndex);
+				if (lhsLayer.name != rhsLayer.name || lhsLayer.entities.size() != rhsLayer.entities.size())
+					return false;
+
+				for (std::size_t i = 0; i < lhsLayer.entities.size(); ++i)
+				{
+					const Map::Entity& lhsEntity = lhsLayer.entities[i];
+					const Map::Entity& rhsEntity = rhsLayer.entities[i];
+					if (lhsEntity.entityType != rhsEntity.entityType || lhsEntity.name != rhsEntity.name || lhsEntity.uniqueId != rhsEntity.uniqueId || lhsEntity.position != rhsEntity.position)
+						return false;
+
+					if (lhsEntity.properties.size() != rhsEntity.properties.size())
+						return false;
+
+					for (const auto& [key, value] : lhsEntity.properties)
+					{
+						auto it = rhsEntity.properties.find(key);
+						if (it == rhsEntity.properties.end() || ExtractPropertyType(value) != ExtractPropertyType(it->second))
+							return false;
+					}
+				}
+			}
+
+			return true;
+		}
+	}
+
+	/*!
+	* \brief Compares load time and heap usage of the same generated map compiled to the v1 and v2 binary formats
+	*
+	* Map files are written in a temporary folder, removed afterwards.
+	*/
+	bool RunMapBenchmark(const BenchmarkSettings& settings)
+	{
+		PrintBenchmarkHeader("Map loading");
+
+		std::filesystem::path mapFolder = std::filesystem::temp_directory_path() / "burgwar_map_benchmark";
+
+		std::error_code err;
+		std::filesystem::remove_all(mapFolder, err);
+		std::filesystem::create_directories(mapFolder, err);
+
+		std::mt19937 randomEngine(42);
+
+		bool success = true;
+		// v1 stores entity counts per layer on 16 bits, which limits it to 65535 entities per layer
+		for (std::size_t entityCount : { 100, 10'000, 100'000 })
+		{
+			Map map = GenerateMap(randomEngine, entityCount);
+
+			std::filesystem::path v1Path = mapFolder / fmt::format("map_{}_v1.bmap", entityCount);
+			std::filesystem::path v2Path = mapFolder / fmt::format("map_{}_v2.bmap", entityCount);
+			if (!CompileV1(map, v1Path) || !map.Compile(v2Path))
+			{
+				fmt::print("failed to compile map with {} entities\n", entityCount);
+				success = false;
+				break;
+			}
+
+			fmt::print("{} entities: v1 file is {} KiB, v2 file is {} KiB\n", entityCount, std::filesystem::file_size(v1Path, err) / 1024, std::filesystem::file_size(v2Path, err) / 1024);
+
+			BenchmarkResult v1Result = MeasureBenchmark(settings.iterationCount, [&] { Map::LoadFromBinary(v1Path); });
+			PrintBenchmarkResult("Load v1", entityCount, v1Result);
+
+			BenchmarkResult v2Result = MeasureBenchmark(settings.iterationCount, [&] { Map::LoadFromBinary(v2Path); });
+			PrintBenchmarkResult("Load v2", entityCount, v2Result);
+
+			// Retained usage is the size of the loaded map, peak usage includes the file content and temporaries
+			std::optional<Map> v1Map;
+			MemoryUsage v1Memory = MeasureMemoryUsage([&] { v1Map = Map::LoadFromBinary(v1Path); });
+			PrintMemoryUsage("Load v1, memory", v1Memory);
+
+			std::optional<Map> v2Map;
+			MemoryUsage v2Memory = MeasureMemoryUsage([&] { v2Map = Map::LoadFromBinary(v2Path); });
+			PrintMemoryUsage("Load v2, memory", v2Memory);
+
+			if (!IsSameMap(map, *v1Map) || !IsSameMap(map, *v2Map))
+			{
+				fmt::print("loaded map differs from the compiled one with {} entities\n", entityCount);
+				success = false;
+				break;
+			}
+		}
+
+		std::filesystem::remove_all(mapFolder, err);
+
+		return success;
+	}
+}
@@ -0,0 +1,158 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <CoreLib/Protocol/MatchStateBuilder.hpp>
+#include <fmt/format.h>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace bw
+{
+	namespace
+	{
+		using EntityList = std::vector<std::pair<LayerIndex, Packets::MatchState::Entity>>;
+
+		// MatchState building as it was done before MatchStateBuilder (entities inserted in their layer range, packet size recomputed after every insertion)
+		void BuildReferenceMatchState(Packets::MatchState& packet, const EntityList& entities, std::size_t maxPacketSize)
+		{
+			packet.entities.clear();
+			packet.layers.clear();
+
+			for (const auto& [layerIndex, entity] : entities)
+			{
+				std::size_t entityIndex = 0;
+
+				std::size_t layerDataIndex = 0;
+				std::size_t layerCount = packet.layers.size();
+				for (; layerDataIndex < layerCount; ++layerDataIndex)
+				{
+					auto& layer = packet.layers[layerDataIndex];
+					entityIndex += layer.entityCount;
+
+					if (layer.layerIndex == layerIndex)
+					{
+						layer.entityCount++;
+						break;
+					}
+				}
+
+				if (layerDataIndex == layerCount)
+				{
+					auto& layer = packet.layers.emplace_back();
+					layer.entityCount = 1;
+					layer.layerIndex = layerIndex;
+				}
+
+				auto entityIt = packet.entities.insert(packet.entities.begin() + entityIndex, entity);
+				if (packet.entities.size() > 1 && Packets::EstimateSize(packet) > maxPacketSize)
+				{
+					packet.entities.erase(entityIt);
+
+					auto& layer = packet.layers[layerDataIndex];
+					if (--layer.entityCount == 0)
+						packet.layers.pop_back();
+
+					break;
+				}
+			}
+		}
+
+		void BuildMatchState(MatchStateBuilder& builder, Packets::MatchState& packet, const EntityList& entities)
+		{
+			builder.Clear();
+			for (const auto& [layerIndex, entity] : entities)
+			{
+				Packets::MatchState::Entity entityCopy = entity;
+				if (!builder.PushEntity(layerIndex, std::move(entityCopy)))
+					break;
+			}
+
+			builder.Build(packet);
+		}
+
+		EntityList GenerateEntities(std::mt19937& randomEngine, std::size_t entityCount, LayerIndex layerCount)
+		{
+			std::uniform_int_distribution<LayerIndex> layerDistribution(0, layerCount - 1);
+			std::uniform_real_distribution<float> positionDistribution(-10'000.f, 10'000.f);
+			std::bernoulli_distribution flagDistribution(0.5);
+
+			EntityList entities(entityCount);
+			for (std::size_t i = 0; i < entityCount; ++i)
+			{
+				auto& [layerIndex, entity] = entities[i];
+				layerIndex = layerDistribution(randomEngine);
+
+				entity.id = static_cast<Nz::UInt32>(i);
+				entity.position = Nz::Vector2f(positionDistribution(randomEngine), positionDistribution(randomEngine));
+				entity.rotation = Nz::RadianAnglef(0.5f);
+
+				if (flagDistribution(randomEngine))
+					entity.playerMovement = Packets::MatchState::PlayerMovementData{ true };
+
+				if (flagDistribution(randomEngine))
+					entity.physicsProperties = Packets::MatchState::PhysicsProperties{ Nz::RadianAnglef(1.f), Nz::Vector2f(10.f, -5.f) };
+			}
+
+			return entities;
+		}
+
+		bool IsSamePacket(const Packets::MatchState& lhs, const Packets::MatchState& rhs)
+		{
+			if (lhs.entities.size() != rhs.entities.size() || lhs.layers.size() != rhs.layers.size())
+				return false;
+
+			for (std::size_t i = 0; i < lhs.layers.size(); ++i)
+			{
+				if (lhs.layers[i].layerIndex != rhs.layers[i].layerIndex || lhs.layers[i].entityCount != rhs.layers[i].entityCount)
+					return false;
+			}
+
+			for (std::size_t i = 0; i < lhs.entities.size(); ++i)
+			{
+				if (lhs.entities[i].id != rhs.entities[i].id)
+					return false;
+			}
+
+			return true;
+		}
+	}
+
+	/*!
+	* \brief Compares MatchStateBuilder to the previous building algorithm, with an unbounded packet size to show how both scale with the entity count
+	*/
+	bool RunMatchStateBenchmark(const BenchmarkSettings& settings)
+	{
+		PrintBenchmarkHeader("MatchState building");
+
+		constexpr LayerIndex LayerCount = 8;
+		constexpr std::size_t MaxPacketSize = std::numeric_limits<std::size_t>::max();
+
+		std::mt19937 randomEngine(42);
+		MatchStateBuilder builder(MaxPacketSize);
+		Packets::MatchState builderPacket;
+		Packets::MatchState referencePacket;
+
+		for (std::size_t entityCount : { 100, 1'000, 10'000 })
+		{
+			EntityList entities = GenerateEntities(randomEngine, entityCount, LayerCount);
+
+			BenchmarkResult referenceResult = MeasureBenchmark(settings.iterationCount, [&] { BuildReferenceMatchState(referencePacket, entities, MaxPacketSize); });
+			PrintBenchmarkResult(fmt::format("Previous algorithm ({} layers)", LayerCount), entityCount, referenceResult);
+
+			BenchmarkResult builderResult = MeasureBenchmark(settings.iterationCount, [&] { BuildMatchState(builder, builderPacket, entities); });
+			PrintBenchmarkResult(fmt::format("MatchStateBuilder ({} layers)", LayerCount), entityCount, builderResult);
+
+			if (!IsSamePacket(referencePacket, builderPacket))
+			{
+				fmt::print("MatchStateBuilder packet differs from the previous algorithm with {} entities\n", entityCount);
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,342 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <CoreLib/NetworkReactor.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace bw
+{
+	namespace
+	{
+		constexpr Nz::UInt64 EventTimeout = 5'000; //< in milliseconds
+
+		// Polls reactors until the predicate is satisfied, returns false on timeout
+		template<typename F, typename P>
+		bool PollUntil(F&& pollReactors, P&& predicate, Nz::UInt64 timeout = EventTimeout)
+		{
+			Nz::UInt64 deadline = Nz::GetElapsedMilliseconds() + timeout;
+			while (!predicate())
+			{
+				if (Nz::GetElapsedMilliseconds() >= deadline)
+					return false;
+
+				pollReactors();
+				std::this_thread::yield();
+			}
+
+			return true;
+		}
+
+		/*!
+		* \brief Measures how long packets wait between SendData and the ENet flush putting them on the wire
+		*
+		* Packets are sent one at a time to an idle reactor (blocked in ENet), a median delay close to the reactor service timeout means it's not woken up.
+		*/
+		bool RunSendDelayTest(const BenchmarkSettings& settings)
+		{
+			constexpr std::size_t PacketCount = 1'000;
+			constexpr Nz::UInt64 MaxMedianSendDelay = 1'000; //< in microseconds, reactor service timeout is at least 5ms
+
+			NetworkReactor server(0, Nz::NetProtocol_IPv4, settings.networkPort, 1);
+			NetworkReactor client(0, Nz::NetProtocol_IPv4, 0, 1);
+
+			Nz::IpAddress serverAddress = Nz::IpAddress::LoopbackIpV4;
+			serverAddress.SetPort(settings.networkPort);
+
+			bool isConnected = false;
+			bool isDisconnected = false;
+
+			auto PollReactors = [&]
+			{
+				server.Poll([](bool /*outgoingConnection*/, std::size_t /*peerId*/, Nz::UInt32 /*data*/) {},
+				            [&](std::size_t /*peerId*/, Nz::UInt32 /*data*/, DisconnectionCause /*cause*/) { isDisconnected = true; },
+				            [](std::size_t /*peerId*/, Nz::NetPacket&& /*packet*/) {});
+
+				client.Poll([&](bool /*outgoingConnection*/, std::size_t /*peerId*/, Nz::UInt32 /*data*/) { isConnected = true; },
+				            [&](std::size_t /*peerId*/, Nz::UInt32 /*data*/, DisconnectionCause /*cause*/) { isDisconnected = true; },
+				            [](std::size_t /*peerId*/, Nz::NetPacket&& /*packet*/) {});
+			};
+
+			std::size_t peerId = client.ConnectTo(serverAddress);
+			if (peerId == NetworkReactor::InvalidPeerId || !PollUntil(PollReactors, [&] { return isConnected || isDisconnected; }) || !isConnected)
+			{
+				fmt::print("failed to connect to {}\n", serverAddress.ToString());
+				return false;
+			}
+
+			// Let the reactor go back to waiting in ENet before each packet
+			constexpr Nz::UInt64 IdleTime = 1; //< in milliseconds
+
+			client.ResetSendStatistics();
+
+			std::vector<Nz::UInt64> sendDelays(PacketCount);
+			for (std::size_t i = 0; i < PacketCount; ++i)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(IdleTime));
+
+				NetworkReactor::SendStatistics previousStatistics = client.GetSendStatistics();
+				client.SendData(peerId, 0, Nz::ENetPacketFlag_Reliable, Nz::NetPacket(static_cast<Nz::UInt16>(i)));
+
+				NetworkReactor::SendStatistics statistics;
+				if (!PollUntil(PollReactors, [&] { statistics = client.GetSendStatistics(); return isDisconnected || statistics.packetCount > previousStatistics.packetCount; }) || isDisconnected)
+				{
+					fmt::print("packet #{} was not sent\n", i);
+					return false;
+				}
+
+				sendDelays[i] = statistics.totalSendDelay - previousStatistics.totalSendDelay;
+			}
+
+			std::sort(sendDelays.begin(), sendDelays.end());
+
+			BenchmarkResult result;
+			result.maxTime = sendDelays.back();
+			result.medianTime = sendDelays[sendDelays.size() / 2];
+			result.minTime = sendDelays.front();
+
+			PrintBenchmarkResult("SendData to wire", 1, result);
+
+			if (result.medianTime > MaxMedianSendDelay)
+			{
+				fmt::print("median delay between SendData and the wire is {}us (expected at most {}us)\n", result.medianTime, MaxMedianSendDelay);
+				return false;
+			}
+
+			return true;
+		}
+
+		/*!
+		* \brief Opens many loopback connections at once and checks every one of them is established and usable
+		*
+		* Each connection echoes a packet, then every connection is closed by the client and must be reported by both reactors.
+		*/
+		bool RunParallelConnectionTest(const BenchmarkSettings& settings)
+		{
+			constexpr std::size_t ConnectionCount = 64;
+
+			NetworkReactor server(0, Nz::NetProtocol_IPv4, settings.networkPort, ConnectionCount);
+			NetworkReactor client(0, Nz::NetProtocol_IPv4, 0, ConnectionCount);
+
+			Nz::IpAddress serverAddress = Nz::IpAddress::LoopbackIpV4;
+			serverAddress.SetPort(settings.networkPort);
+
+			std::vector<std::size_t> clientConnections;
+			std::vector<std::size_t> clientDisconnections;
+			std::size_t unexpectedDisconnectionCount = 0;
+			std::vector<std::size_t> clientReplies;
+			std::size_t serverConnectionCount = 0;
+			std::size_t serverDisconnectionCount = 0;
+
+			auto PollReactors = [&]
+			{
+				server.Poll([&](bool /*outgoingConnection*/, std::size_t /*peerId*/, Nz::UInt32 /*data*/) { serverConnectionCount++; },
+				            [&](std::size_t /*peerId*/, Nz::UInt32 /*data*/, DisconnectionCause cause)
+				{
+					serverDisconnectionCount++;
+					if (cause != DisconnectionCause::Closed)
+						unexpectedDisconnectionCount++;
+				},
+				            [&](std::size_t peerId, Nz::NetPacket&& packet)
+				{
+					server.SendData(peerId, 0, Nz::ENetPacketFlag_Reliable, Nz::NetPacket(packet.GetNetCode()));
+				});
+
+				client.Poll([&](bool /*outgoingConnection*/, std::size_t peerId, Nz::UInt32 /*data*/) { clientConnections.push_back(peerId); },
+				            [&](std::size_t peerId, Nz::UInt32 /*data*/, DisconnectionCause cause)
+				{
+					clientDisconnections.push_back(peerId);
+					if (cause != DisconnectionCause::Closed)
+						unexpectedDisconnectionCount++;
+				},
+				            [&](std::size_t peerId, Nz::NetPacket&& packet)
+				{
+					if (packet.GetNetCode() == peerId)
+						clientReplies.push_back(peerId);
+				});
+			};
+
+			Nz::UInt64 startTime = Nz::GetElapsedMicroseconds();
+
+			std::vector<std::size_t> peerIds;
+			for (std::size_t i = 0; i < ConnectionCount; ++i)
+			{
+				std::size_t peerId = client.ConnectTo(serverAddress);
+				if (peerId == NetworkReactor::InvalidPeerId)
+				{
+					fmt::print("no peer id available for connection #{}\n", i);
+					return false;
+				}
+
+				peerIds.push_back(peerId);
+			}
+
+			if (!PollUntil(PollReactors, [&] { return clientConnections.size() + clientDisconnections.size() == ConnectionCount && serverConnectionCount == ConnectionCount; }) || !clientDisconnections.empty())
+			{
+				fmt::print("{} out of {} connections were established ({} failed, {} seen by the server)\n", clientConnections.size(), ConnectionCount, clientDisconnections.size(), serverConnectionCount);
+				return false;
+			}
+
+			Nz::UInt64 connectionTime = Nz::GetElapsedMicroseconds() - startTime;
+
+			BenchmarkResult result;
+			result.maxTime = connectionTime;
+			result.medianTime = connectionTime;
+			result.minTime = connectionTime;
+
+			PrintBenchmarkResult("Parallel connections", ConnectionCount, result);
+
+			// Every peer id must be reported once, as returned by ConnectTo
+			std::sort(peerIds.begin(), peerIds.end());
+			std::sort(clientConnections.begin(), clientConnections.end());
+			if (std::adjacent_find(peerIds.begin(), peerIds.end()) != peerIds.end() || clientConnections != peerIds)
+			{
+				fmt::print("connection events don't match peer ids returned by ConnectTo\n");
+				return false;
+			}
+
+			for (std::size_t peerId : peerIds)
+				client.SendData(peerId, 0, Nz::ENetPacketFlag_Reliable, Nz::NetPacket(static_cast<Nz::UInt16>(peerId)));
+
+			if (!PollUntil(PollReactors, [&] { return clientReplies.size() == ConnectionCount; }))
+			{
+				fmt::print("{} out of {} connections echoed their packet\n", clientReplies.size(), ConnectionCount);
+				return false;
+			}
+
+			for (std::size_t peerId : peerIds)
+				client.DisconnectPeer(peerId);
+
+			if (!PollUntil(PollReactors, [&] { return clientDisconnections.size() == ConnectionCount && serverDisconnectionCount == ConnectionCount; }))
+			{
+				fmt::print("{} out of {} disconnections were reported ({} by the server)\n", clientDisconnections.size(), ConnectionCount, serverDisconnectionCount);
+				return false;
+			}
+
+			// Established connections must never be reported as failed (or aborted) connection attempts
+			if (unexpectedDisconnectionCount > 0)
+			{
+				fmt::print("{} disconnections were reported with an unexpected cause\n", unexpectedDisconnectionCount);
+				return false;
+			}
+
+			return true;
+		}
+
+		/*!
+		* \brief Connects to a port nobody listens to, every attempt must come back as a single disconnection event
+		*
+		* Half of the connections time out after every attempt (which takes about 17 seconds) and must be reported as failed, the other half is aborted with DisconnectPeer and must be reported as such.
+		* Packets are sent to connecting peers meanwhile, they must be dropped.
+		*/
+		bool RunFailedConnectionTest(const BenchmarkSettings& settings)
+		{
+			constexpr std::size_t ConnectionCount = 16;
+			constexpr Nz::UInt64 FailureTimeout = 3 * 5'000 + 2 * 1'000 + EventTimeout; //< NetworkReactor makes three attempts of 5s, 1s apart
+
+			NetworkReactor client(0, Nz::NetProtocol_IPv4, 0, ConnectionCount);
+
+			Nz::IpAddress unreachableAddress = Nz::IpAddress::LoopbackIpV4;
+			unreachableAddress.SetPort(static_cast<Nz::UInt16>(settings.networkPort + 1));
+
+			std::size_t connectionCount = 0;
+			std::vector<std::size_t> disconnections;
+			std::vector<std::size_t> abortedConnections;
+			std::vector<std::size_t> failedConnections;
+
+			auto PollReactor = [&]
+			{
+				client.Poll([&](bool /*outgoingConnection*/, std::size_t /*peerId*/, Nz::UInt32 /*data*/) { connectionCount++; },
+				            [&](std::size_t peerId, Nz::UInt32 /*data*/, DisconnectionCause cause)
+				{
+					disconnections.push_back(peerId);
+					if (cause == DisconnectionCause::ConnectionAborted)
+						abortedConnections.push_back(peerId);
+					else if (cause == DisconnectionCause::ConnectionFailed)
+						failedConnections.push_back(peerId);
+				},
+				            [&](std::size_t /*peerId*/, Nz::NetPacket&& /*packet*/) {});
+			};
+
+			std::vector<std::size_t> peerIds;
+			std::vector<std::size_t> abortedPeerIds;
+			std::vector<std::size_t> failedPeerIds;
+			for (std::size_t i = 0; i < ConnectionCount; ++i)
+			{
+				std::size_t peerId = client.ConnectTo(unreachableAddress);
+				if (peerId == NetworkReactor::InvalidPeerId)
+				{
+					fmt::print("no peer id available for connection #{}\n", i);
+					return false;
+				}
+
+				peerIds.push_back(peerId);
+			}
+
+			for (std::size_t i = 0; i < ConnectionCount; ++i)
+			{
+				client.SendData(peerIds[i], 0, Nz::ENetPacketFlag_Reliable, Nz::NetPacket(0));
+				if (i % 2 == 0)
+				{
+					client.DisconnectPeer(peerIds[i]);
+					abortedPeerIds.push_back(peerIds[i]);
+				}
+				else
+					failedPeerIds.push_back(peerIds[i]);
+			}
+
+			if (!PollUntil(PollReactor, [&] { return connectionCount > 0 || disconnections.size() >= ConnectionCount; }, FailureTimeout) || connectionCount > 0)
+			{
+				fmt::print("{} out of {} failed connections were reported ({} connected)\n", disconnections.size(), ConnectionCount, connectionCount);
+				return false;
+			}
+
+			// Wait for late events, an aborted attempt must not be reported again when it times out
+			Nz::UInt64 deadline = Nz::GetElapsedMilliseconds() + 500;
+			PollUntil(PollReactor, [&] { return Nz::GetElapsedMilliseconds() >= deadline; });
+
+			std::sort(peerIds.begin(), peerIds.end());
+			std::sort(disconnections.begin(), disconnections.end());
+			if (disconnections != peerIds || connectionCount > 0)
+			{
+				fmt::print("failed connections were reported {} times for {} peers\n", disconnections.size(), ConnectionCount);
+				return false;
+			}
+
+			std::sort(abortedPeerIds.begin(), abortedPeerIds.end());
+			std::sort(failedPeerIds.begin(), failedPeerIds.end());
+			std::sort(abortedConnections.begin(), abortedConnections.end());
+			std::sort(failedConnections.begin(), failedConnections.end());
+			if (abortedConnections != abortedPeerIds || failedConnections != failedPeerIds)
+			{
+				fmt::print("{} out of {} connections were reported as aborted, {} out of {} as failed\n", abortedConnections.size(), abortedPeerIds.size(), failedConnections.size(), failedPeerIds.size());
+				return false;
+			}
+
+			return true;
+		}
+	}
+
+	/*!
+	* \brief Checks NetworkReactor behavior over loopback connections and reports their timings
+	*
+	* Listens on settings.networkPort, nothing must be listening on settings.networkPort + 1 (connection failures are tested on it).
+	*/
+	bool RunReactorBenchmark(const BenchmarkSettings& settings)
+	{
+		PrintBenchmarkHeader("Network reactor");
+
+		bool success = true;
+		success = RunSendDelayTest(settings) && success;
+		success = RunParallelConnectionTest(settings) && success;
+		success = RunFailedConnectionTest(settings) && success;
+
+		return success;
+	}
+}
@@ -0,0 +1,442 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <CoreLib/BurgApp.hpp>
+#include <CoreLib/CommandStore.hpp>
+#include <CoreLib/ConfigFile.hpp>
+#include <CoreLib/Protocol/Packets.hpp>
+#include <CoreLib/Protocol/PacketSerializer.hpp>
+#include <Nazara/Core/ByteArray.hpp>
+#include <Nazara/Core/ByteStream.hpp>
+#include <Nazara/Core/MemoryStream.hpp>
+#include <Nazara/Network/NetPacket.hpp>
+#include <fmt/format.h>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bw
+{
+	namespace
+	{
+		constexpr LayerIndex LayerCount = 8;
+
+		// Heap usage allowed when rejecting a malformed packet, sizes read from it must never be allocated
+		constexpr Nz::UInt64 MaxRejectionUsage = 1024;
+
+		// Number of round trips checked for allocations, once buffers have grown
+		constexpr std::size_t RoundTripCount = 100;
+
+		// Minimal application, command stores need a logger
+		class BenchmarkApp : public BurgApp
+		{
+			public:
+				BenchmarkApp() :
+				BurgApp(LogSide::Server, m_configFile),
+				m_configFile(*this)
+				{
+				}
+
+			private:
+				ConfigFile m_configFile;
+		};
+
+		// Packets sent every tick, received ones are counted by the peer (a simple counter)
+		class RoundTripCommandStore : public CommandStore<std::size_t>
+		{
+			public:
+				RoundTripCommandStore(const Logger& logger) :
+				CommandStore(logger)
+				{
+					auto CountPacket = [](std::size_t& receivedCount, const auto& /*packet*/)
+					{
+						receivedCount++;
+					};
+
+					RegisterIncomingCommand<Packets::EntitiesInputs>("EntitiesInputs", CountPacket);
+					RegisterIncomingCommand<Packets::MatchState>("MatchState", CountPacket);
+					RegisterIncomingCommand<Packets::PlayersInput>("PlayersInput", CountPacket);
+
+					RegisterOutgoingCommand<Packets::EntitiesInputs>("EntitiesInputs", Nz::ENetPacketFlag_Reliable, 1);
+					RegisterOutgoingCommand<Packets::MatchState>("MatchState", 0, 1);
+					RegisterOutgoingCommand<Packets::PlayersInput>("PlayersInput", Nz::ENetPacketFlag_Reliable, 0);
+				}
+		};
+
+		// Serializes in a buffer which keeps its capacity from one call to the next
+		template<typename T>
+		void SerializePacket(T& packet, Nz::ByteArray& buffer)
+		{
+			buffer.Clear(true);
+
+			Nz::MemoryStream memoryStream(&buffer, Nz::OpenMode_WriteOnly);
+			Nz::ByteStream stream(&memoryStream);
+
+			PacketSerializer serializer(stream, true);
+			Packets::Serialize(serializer, packet);
+
+			stream.FlushBits();
+		}
+
+		template<typename T>
+		Nz::ByteArray SerializePacket(T& packet)
+		{
+			Nz::ByteArray buffer;
+			SerializePacket(packet, buffer);
+
+			return buffer;
+		}
+
+		// Sends a packet through the command store and receives it back, as a session does with a reused outgoing packet
+		template<typename T>
+		bool RoundTrip(const RoundTripCommandStore& commandStore, Nz::NetPacket& netPacket, const T& packet, std::size_t& receivedCount)
+		{
+			netPacket.Reset();
+			commandStore.SerializePacket(netPacket, packet);
+
+			// Read it back from the start, as LocalSessionManager does
+			netPacket.GetStream()->SetCursorPos(Nz::NetPacket::HeaderSize);
+
+			return commandStore.UnserializePacket(receivedCount, netPacket);
+		}
+
+		// Steady-state round trips reuse the outgoing packet and the command store unserialized packet, they must not allocate
+		template<typename T>
+		bool RoundTripsWithoutAllocation(std::string_view name, const RoundTripCommandStore& commandStore, const T& packet, const BenchmarkSettings& settings)
+		{
+			Nz::NetPacket netPacket;
+			std::size_t receivedCount = 0;
+
+			bool isValid = true;
+			BenchmarkResult result = MeasureBenchmark(settings.iterationCount, [&] { isValid = RoundTrip(commandStore, netPacket, packet, receivedCount) && isValid; });
+			PrintBenchmarkResult(fmt::format("{} round trip ({} bytes)", name, netPacket.GetDataSize()), 1, result);
+
+			MemoryUsage memoryUsage = MeasureMemoryUsage([&]
+			{
+				for (std::size_t i = 0; i < RoundTripCount; ++i)
+					isValid = RoundTrip(commandStore, netPacket, packet, receivedCount) && isValid;
+			});
+
+			if (!isValid || receivedCount != settings.iterationCount + 1 + RoundTripCount)
+			{
+				fmt::print("{} wasn't received back\n", name);
+				return false;
+			}
+
+			if (memoryUsage.allocationCount > 0)
+			{
+				fmt::print("{} round trips made {} allocations ({} bytes at peak)\n", name, memoryUsage.allocationCount, memoryUsage.peakUsage);
+				return false;
+			}
+
+			fmt::print("{:<56}{:>10} allocations\n", fmt::format("{} round trips", name), 0);
+			return true;
+		}
+
+		template<typename T>
+		bool UnserializePacket(const Nz::UInt8* data, std::size_t size, T& packet)
+		{
+			Nz::ByteStream stream(data, size);
+
+			PacketSerializer serializer(stream, false);
+			Packets::Serialize(serializer, packet);
+
+			return serializer.IsValid();
+		}
+
+		// Entities are evenly spread between layers, half of them have movement data or physics properties (as in MatchStateBenchmark)
+		Packets::MatchState GenerateMatchState(std::mt19937& randomEngine, std::size_t entityCount)
+		{
+			std::uniform_real_distribution<float> positionDistribution(-10'000.f, 10'000.f);
+			std::bernoulli_distribution flagDistribution(0.5);
+
+			Packets::MatchState packet;
+			packet.lastInputTick = 42;
+			packet.stateTick = 1337;
+
+			for (LayerIndex layerIndex = 0; layerIndex < LayerCount; ++layerIndex)
+			{
+				auto& layer = packet.layers.emplace_back();
+				layer.layerIndex = layerIndex;
+				layer.entityCount = Nz::UInt32(entityCount / LayerCount + ((layerIndex < entityCount % LayerCount) ? 1 : 0));
+			}
+
+			packet.entities.resize(entityCount);
+			for (std::size_t i = 0; i < entityCount; ++i)
+			{
+				auto& entity = packet.entities[i];
+				entity.id = Nz::UInt32(i);
+				entity.position = Nz::Vector2f(positionDistribution(randomEngine), positionDistribution(randomEngine));
+				entity.rotation = Nz::RadianAnglef(0.5f);
+
+				if (flagDistribution(randomEngine))
+					entity.playerMovement = Packets::MatchState::PlayerMovementData{ true };
+
+				if (flagDistribution(randomEngine))
+					entity.physicsProperties = Packets::MatchState::PhysicsProperties{ Nz::RadianAnglef(1.f), Nz::Vector2f(10.f, -5.f) };
+			}
+
+			return packet;
+		}
+
+		PlayerInputData GenerateInputs(std::mt19937& randomEngine)
+		{
+			std::uniform_real_distribution<float> directionDistribution(-1.f, 1.f);
+			std::bernoulli_distribution flagDistribution(0.5);
+
+			PlayerInputData inputs;
+			inputs.aimDirection = Nz::Vector2f(directionDistribution(randomEngine), directionDistribution(randomEngine));
+			inputs.isAttacking = flagDistribution(randomEngine);
+			inputs.isJumping = flagDistribution(randomEngine);
+			inputs.isMovingRight = flagDistribution(randomEngine);
+
+			return inputs;
+		}
+
+		// Inputs of every entity controlled by a player, evenly spread between layers
+		Packets::EntitiesInputs GenerateEntitiesInputs(std::mt19937& randomEngine, std::size_t entityCount)
+		{
+			Packets::EntitiesInputs packet;
+			packet.stateTick = 1337;
+
+			for (LayerIndex layerIndex = 0; layerIndex < LayerCount; ++layerIndex)
+			{
+				auto& layer = packet.layers.emplace_back();
+				layer.layerIndex = layerIndex;
+				layer.entityCount = Nz::UInt32(entityCount / LayerCount + ((layerIndex < entityCount % LayerCount) ? 1 : 0));
+			}
+
+			packet.entities.resize(entityCount);
+			for (std::size_t i = 0; i < entityCount; ++i)
+			{
+				auto& entity = packet.entities[i];
+				entity.id = Nz::UInt32(i);
+				entity.inputs = GenerateInputs(randomEngine);
+			}
+
+			return packet;
+		}
+
+		Packets::PlayersInput GeneratePlayersInput(std::mt19937& randomEngine, std::size_t playerCount)
+		{
+			Packets::PlayersInput packet;
+			packet.acknowledgedStateTick = 1337;
+			packet.acknowledgedStateMask = 0xFFFFFFFF;
+			packet.estimatedServerTick = 1340;
+			packet.inputTick = 42;
+
+			packet.inputs.resize(playerCount);
+			for (auto& input : packet.inputs)
+				input = GenerateInputs(randomEngine);
+
+			return packet;
+		}
+
+		Packets::NetworkStrings GenerateNetworkStrings(std::size_t stringCount)
+		{
+			Packets::NetworkStrings packet;
+			packet.startId = 0;
+
+			packet.strings.resize(stringCount);
+			for (std::size_t i = 0; i < stringCount; ++i)
+				packet.strings[i] = fmt::format("entity_weapon_{}", i);
+
+			return packet;
+		}
+
+		bool IsSamePacket(const Packets::MatchState& lhs, const Packets::MatchState& rhs)
+		{
+			if (lhs.lastInputTick != rhs.lastInputTick || lhs.stateTick != rhs.stateTick || lhs.entities.size() != rhs.entities.size() || lhs.layers.size() != rhs.layers.size())
+				return false;
+
+			for (std::size_t i = 0; i < lhs.layers.size(); ++i)
+			{
+				if (lhs.layers[i].layerIndex != rhs.layers[i].layerIndex || lhs.layers[i].entityCount != rhs.layers[i].entityCount)
+					return false;
+			}
+
+			for (std::size_t i = 0; i < lhs.entities.size(); ++i)
+			{
+				const auto& lhsEntity = lhs.entities[i];
+				const auto& rhsEntity = rhs.entities[i];
+				if (lhsEntity.id != rhsEntity.id || lhsEntity.position != rhsEntity.position || lhsEntity.playerMovement.has_value() != rhsEntity.playerMovement.has_value() || lhsEntity.physicsProperties.has_value() != rhsEntity.physicsProperties.has_value())
+					return false;
+			}
+
+			return true;
+		}
+
+		bool IsSamePacket(const Packets::NetworkStrings& lhs, const Packets::NetworkStrings& rhs)
+		{
+			return lhs.startId == rhs.startId && lhs.strings == rhs.strings;
+		}
+
+		// Every byte of a packet is needed to read it, every shorter prefix must be rejected
+		template<typename T>
+		bool RejectsTruncations(const Nz::ByteArray& buffer)
+		{
+			for (std::size_t size = 0; size < buffer.GetSize(); ++size)
+			{
+				T packet;
+				if (UnserializePacket(buffer.GetConstBuffer(), size, packet))
+				{
+					fmt::print("{} bytes out of {} were read as a valid packet\n", size, buffer.GetSize());
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Builds a packet by hand, to put sizes in it which a valid packet can't have
+		Nz::ByteArray BuildMalformedPacket(const std::function<void(Nz::ByteStream& stream)>& writer)
+		{
+			Nz::ByteArray buffer;
+			{
+				Nz::ByteStream stream(&buffer, Nz::OpenMode_WriteOnly);
+				writer(stream);
+				stream.FlushBits();
+			}
+
+			return buffer;
+		}
+
+		template<typename T>
+		bool RejectsMalformedPacket(std::string_view name, const Nz::ByteArray& buffer)
+		{
+			bool isValid = true;
+			MemoryUsage memoryUsage = MeasureMemoryUsage([&]
+			{
+				T packet;
+				isValid = UnserializePacket(buffer.GetConstBuffer(), buffer.GetSize(), packet);
+			});
+			PrintMemoryUsage(fmt::format("Rejection of {}", name), memoryUsage);
+
+			if (isValid || memoryUsage.peakUsage > MaxRejectionUsage)
+			{
+				fmt::print("{} was {} with a peak usage of {} bytes\n", name, (isValid) ? "accepted" : "rejected", memoryUsage.peakUsage);
+				return false;
+			}
+
+			return true;
+		}
+	}
+
+	/*!
+	* \brief Measures packet serialization and checks malformed packets are rejected without allocating the sizes they contain
+	*
+	* Packets sent every tick (MatchState, PlayersInput and EntitiesInputs) must also go through a command store and back without allocating once its buffers have grown.
+	*/
+	bool RunSerializerBenchmark(const BenchmarkSettings& settings)
+	{
+		PrintBenchmarkHeader("Packet serialization");
+
+		std::mt19937 randomEngine(42);
+
+		for (std::size_t entityCount : { 100, 1'000, 10'000 })
+		{
+			Packets::MatchState packet = GenerateMatchState(randomEngine, entityCount);
+
+			Nz::ByteArray buffer;
+			BenchmarkResult writeResult = MeasureBenchmark(settings.iterationCount, [&] { SerializePacket(packet, buffer); });
+			PrintBenchmarkResult(fmt::format("Write MatchState ({} bytes)", buffer.GetSize()), entityCount, writeResult);
+
+			Packets::MatchState readPacket;
+			bool isValid = true;
+			BenchmarkResult readResult = MeasureBenchmark(settings.iterationCount, [&] { isValid = UnserializePacket(buffer.GetConstBuffer(), buffer.GetSize(), readPacket) && isValid; });
+			PrintBenchmarkResult(fmt::format("Read MatchState ({} bytes)", buffer.GetSize()), entityCount, readResult);
+
+			if (!isValid || !IsSamePacket(packet, readPacket))
+			{
+				fmt::print("MatchState with {} entities was not read back as it was written\n", entityCount);
+				return false;
+			}
+		}
+
+		for (std::size_t stringCount : { 100, 1'000, 10'000 })
+		{
+			Packets::NetworkStrings packet = GenerateNetworkStrings(stringCount);
+
+			Nz::ByteArray buffer;
+			BenchmarkResult writeResult = MeasureBenchmark(settings.iterationCount, [&] { SerializePacket(packet, buffer); });
+			PrintBenchmarkResult(fmt::format("Write NetworkStrings ({} bytes)", buffer.GetSize()), stringCount, writeResult);
+
+			Packets::NetworkStrings readPacket;
+			bool isValid = true;
+			BenchmarkResult readResult = MeasureBenchmark(settings.iterationCount, [&] { isValid = UnserializePacket(buffer.GetConstBuffer(), buffer.GetSize(), readPacket) && isValid; });
+			PrintBenchmarkResult(fmt::format("Read NetworkStrings ({} bytes)", buffer.GetSize()), stringCount, readResult);
+
+			if (!isValid || !IsSamePacket(packet, readPacket))
+			{
+				fmt::print("NetworkStrings with {} strings was not read back as it was written\n", stringCount);
+				return false;
+			}
+		}
+
+		// Truncated packets (MatchState mixes bit-packed booleans with other values, NetworkStrings ends with a string)
+		{
+			Packets::MatchState matchState = GenerateMatchState(randomEngine, 16);
+			Packets::NetworkStrings networkStrings = GenerateNetworkStrings(16);
+			if (!RejectsTruncations<Packets::MatchState>(SerializePacket(matchState)) || !RejectsTruncations<Packets::NetworkStrings>(SerializePacket(networkStrings)))
+				return false;
+		}
+
+		bool success = true;
+
+		Nz::ByteArray hugeArray = BuildMalformedPacket([](Nz::ByteStream& stream)
+		{
+			stream << CompressedUnsigned<Nz::UInt32>(0); //< startId
+			stream << CompressedUnsigned<Nz::UInt32>(0xFFFFFFFF); //< string count
+		});
+		success = RejectsMalformedPacket<Packets::NetworkStrings>("NetworkStrings with 2^32-1 strings", hugeArray) && success;
+
+		Nz::ByteArray hugeString = BuildMalformedPacket([](Nz::ByteStream& stream)
+		{
+			stream << CompressedUnsigned<Nz::UInt32>(0); //< startId
+			stream << CompressedUnsigned<Nz::UInt32>(1); //< string count
+			stream << Nz::UInt32(0xFFFFFFFF); //< string size
+			stream << Nz::UInt32(0); //< a few bytes of content
+		});
+		success = RejectsMalformedPacket<Packets::NetworkStrings>("NetworkStrings with a 4GiB string", hugeString) && success;
+
+		Nz::ByteArray overlongInteger = BuildMalformedPacket([](Nz::ByteStream& stream)
+		{
+			// 5 bytes are enough for a 32bits integer
+			for (std::size_t i = 0; i < 8; ++i)
+				stream << Nz::UInt8(0x80);
+
+			stream << Nz::UInt8(0);
+		});
+		success = RejectsMalformedPacket<Packets::NetworkStrings>("NetworkStrings with an overlong startId", overlongInteger) && success;
+
+		Nz::ByteArray hugeEntityCount = BuildMalformedPacket([](Nz::ByteStream& stream)
+		{
+			stream << false << false; //< isQuantized, hasBaseline
+			stream << Nz::UInt16(0) << Nz::UInt16(0); //< lastInputTick, stateTick
+			stream << CompressedUnsigned<Nz::UInt32>(2); //< layer count
+
+			for (LayerIndex layerIndex = 0; layerIndex < 2; ++layerIndex)
+			{
+				stream << CompressedUnsigned<LayerIndex>(layerIndex);
+				stream << CompressedUnsigned<Nz::UInt32>(0x80000000); //< entity count, summed to 2^32
+			}
+		});
+		success = RejectsMalformedPacket<Packets::MatchState>("MatchState with 2^32 entities", hugeEntityCount) && success;
+
+		// Packets sent every tick go through the command store without allocating once buffers have grown
+		{
+			BenchmarkApp app;
+			RoundTripCommandStore commandStore(app.GetLogger());
+
+			success = RoundTripsWithoutAllocation("MatchState", commandStore, GenerateMatchState(randomEngine, 1'000), settings) && success;
+			success = RoundTripsWithoutAllocation("PlayersInput", commandStore, GeneratePlayersInput(randomEngine, 4), settings) && success;
+			success = RoundTripsWithoutAllocation("EntitiesInputs", commandStore, GenerateEntitiesInputs(randomEngine, 64), settings) && success;
+		}
+
+		return success;
+	}
+}
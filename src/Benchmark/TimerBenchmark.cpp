@@ -0,0 +1,202 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <CoreLib/TimerManager.hpp>
+#include <fmt/format.h>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace bw
+{
+	namespace
+	{
+		constexpr std::size_t IdleTickCount = 1'000;
+		constexpr Nz::UInt64 TickDuration = 16; //< in milliseconds, timers use match time
+		constexpr Nz::UInt64 TimerSpread = 10'000; //< Timers expire in [1, TimerSpread] milliseconds
+
+		// TimerManager as it was before the heap (every pending timer checked on every update, fired timers erased from the vector)
+		class ReferenceTimerManager
+		{
+			public:
+				void PushCallback(Nz::UInt64 expirationTime, std::function<void()> callback)
+				{
+					Timer& timer = m_pendingTimers.emplace_back();
+					timer.callback = std::move(callback);
+					timer.expirationTime = expirationTime;
+				}
+
+				void Update(Nz::UInt64 now)
+				{
+					for (std::size_t i = 0; i < m_pendingTimers.size();)
+					{
+						if (now > m_pendingTimers[i].expirationTime)
+						{
+							auto it = m_pendingTimers.begin() + i;
+
+							Timer timer = std::move(*it);
+							m_pendingTimers.erase(it);
+
+							timer.callback();
+						}
+						else
+							++i;
+					}
+				}
+
+				std::size_t GetPendingTimerCount() const
+				{
+					return m_pendingTimers.size();
+				}
+
+			private:
+				struct Timer
+				{
+					std::function<void()> callback;
+					Nz::UInt64 expirationTime;
+				};
+
+				std::vector<Timer> m_pendingTimers;
+		};
+
+		template<typename T>
+		void PushTimers(T& timerManager, const std::vector<Nz::UInt64>& expirationTimes, std::size_t& firedCount)
+		{
+			for (Nz::UInt64 expirationTime : expirationTimes)
+				timerManager.PushCallback(expirationTime, [&firedCount] { firedCount++; });
+		}
+
+		// Ticks until every timer has fired, as a match would
+		template<typename T>
+		void RunTimers(T& timerManager)
+		{
+			for (Nz::UInt64 now = 0; timerManager.GetPendingTimerCount() > 0; now += TickDuration)
+				timerManager.Update(now);
+		}
+
+		template<typename T>
+		void RunIdleTicks(T& timerManager)
+		{
+			for (std::size_t i = 0; i < IdleTickCount; ++i)
+				timerManager.Update(0);
+		}
+	}
+
+	/*!
+	* \brief Compares TimerManager to its previous implementation with 10, 1k and 100k pending timers
+	*
+	* The previous implementation is quadratic when timers fire, it is only measured up to 10k timers for that benchmark.
+	*/
+	bool RunTimerBenchmark(const BenchmarkSettings& settings)
+	{
+		PrintBenchmarkHeader("Timers");
+
+		constexpr std::size_t MaxReferenceFiringTimerCount = 10'000;
+
+		std::mt19937 randomEngine(42);
+		std::uniform_int_distribution<Nz::UInt64> expirationDistribution(1, TimerSpread);
+
+		for (std::size_t timerCount : { 10, 1'000, 100'000 })
+		{
+			std::vector<Nz::UInt64> expirationTimes(timerCount);
+			for (Nz::UInt64& expirationTime : expirationTimes)
+				expirationTime = expirationDistribution(randomEngine);
+
+			std::vector<Nz::UInt64> farExpirationTimes(timerCount, TimerSpread * 1'000);
+
+			// Update calls while no timer is due, which is what most ticks look like
+			{
+				std::size_t firedCount = 0;
+
+				ReferenceTimerManager referenceTimers;
+				PushTimers(referenceTimers, farExpirationTimes, firedCount);
+
+				BenchmarkResult referenceResult = MeasureBenchmark(settings.iterationCount, [&] { RunIdleTicks(referenceTimers); });
+				PrintBenchmarkResult(fmt::format("Previous, idle tick ({} pending)", timerCount), IdleTickCount, referenceResult);
+
+				TimerManager timers;
+				PushTimers(timers, farExpirationTimes, firedCount);
+
+				BenchmarkResult timerResult = MeasureBenchmark(settings.iterationCount, [&] { RunIdleTicks(timers); });
+				PrintBenchmarkResult(fmt::format("TimerManager, idle tick ({} pending)", timerCount), IdleTickCount, timerResult);
+
+				if (firedCount != 0)
+				{
+					fmt::print("timers fired before their expiration time\n");
+					return false;
+				}
+			}
+
+			// Pushing timers and ticking until all of them have fired
+			{
+				std::size_t expectedFiredCount = timerCount * (settings.iterationCount + 1);
+
+				if (timerCount <= MaxReferenceFiringTimerCount)
+				{
+					std::size_t firedCount = 0;
+
+					ReferenceTimerManager referenceTimers;
+					BenchmarkResult referenceResult = MeasureBenchmark(settings.iterationCount, [&]
+					{
+						PushTimers(referenceTimers, expirationTimes, firedCount);
+						RunTimers(referenceTimers);
+					});
+					PrintBenchmarkResult("Previous, push and fire", timerCount, referenceResult);
+
+					if (firedCount != expectedFiredCount)
+					{
+						fmt::print("previous implementation fired {} timers out of {}\n", firedCount, expectedFiredCount);
+						return false;
+					}
+				}
+				else
+					fmt::print("{:<56}{:>10}    skipped (quadratic)\n", "Previous, push and fire", timerCount);
+
+				std::size_t firedCount = 0;
+
+				TimerManager timers;
+				BenchmarkResult timerResult = MeasureBenchmark(settings.iterationCount, [&]
+				{
+					PushTimers(timers, expirationTimes, firedCount);
+					RunTimers(timers);
+				});
+				PrintBenchmarkResult("TimerManager, push and fire", timerCount, timerResult);
+
+				if (firedCount != expectedFiredCount)
+				{
+					fmt::print("TimerManager fired {} timers out of {}\n", firedCount, expectedFiredCount);
+					return false;
+				}
+			}
+
+			// Pushing timers and canceling all of them (previous implementation had no cancellation)
+			{
+				std::size_t firedCount = 0;
+				std::vector<TimerManager::TimerId> timerIds(timerCount);
+
+				TimerManager timers;
+				BenchmarkResult cancelResult = MeasureBenchmark(settings.iterationCount, [&]
+				{
+					for (std::size_t i = 0; i < timerCount; ++i)
+						timerIds[i] = timers.PushCallback(expirationTimes[i], [&firedCount] { firedCount++; });
+
+					for (TimerManager::TimerId timerId : timerIds)
+						timers.Cancel(timerId);
+
+					RunTimers(timers);
+				});
+				PrintBenchmarkResult("TimerManager, push and cancel", timerCount, cancelResult);
+
+				if (firedCount != 0)
+				{
+					fmt::print("canceled timers have fired\n");
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+}
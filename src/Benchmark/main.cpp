@@ -0,0 +1,115 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmark.hpp>
+#include <Main/Main.hpp>
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <cxxopts.hpp>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct BenchmarkSuite
+	{
+		const char* name;
+		bool(*run)(const bw::BenchmarkSettings& settings);
+	};
+
+	constexpr BenchmarkSuite s_suites[] = {
+		{ "bytecode",   &bw::RunBytecodeBenchmark },
+		{ "logging",    &bw::RunLogBenchmark },
+		{ "map",        &bw::RunMapBenchmark },
+		{ "matchstate", &bw::RunMatchStateBenchmark },
+		{ "reactor",    &bw::RunReactorBenchmark },
+		{ "serializer", &bw::RunSerializerBenchmark },
+		{ "timers",     &bw::RunTimerBenchmark }
+	};
+}
+
+int BurgWarBenchmark(int argc, char* argv[])
+{
+	std::string suiteList;
+	for (const BenchmarkSuite& suite : s_suites)
+	{
+		if (!suiteList.empty())
+			suiteList += ", ";
+
+		suiteList += suite.name;
+	}
+
+	cxxopts::Options options("BurgWarBenchmark", "Runs micro-benchmarks of the engine subsystems");
+	options.add_options()
+		("s,suite", "Suites to run (" + suiteList + " or all)", cxxopts::value<std::vector<std::string>>()->default_value("all"))
+		("i,iterations", "Measures per benchmark (the median is reported)", cxxopts::value<std::size_t>()->default_value("20"))
+		("p,port", "Listening port of network benchmarks", cxxopts::value<Nz::UInt16>()->default_value("14790"))
+		("h,help", "Print usage")
+	;
+
+	try
+	{
+		auto result = options.parse(argc, argv);
+		if (result.count("help") > 0)
+		{
+			std::cout << options.help() << std::endl;
+			return EXIT_SUCCESS;
+		}
+
+		bw::BenchmarkSettings settings;
+		settings.iterationCount = result["iterations"].as<std::size_t>();
+		if (settings.iterationCount == 0)
+			throw std::runtime_error("iteration count must be at least 1");
+
+		settings.networkPort = result["port"].as<Nz::UInt16>();
+		if (settings.networkPort == 0)
+			throw std::runtime_error("network port must be specified");
+
+		const auto& suiteNames = result["suite"].as<std::vector<std::string>>();
+		bool runAll = std::find(suiteNames.begin(), suiteNames.end(), "all") != suiteNames.end();
+
+		for (const std::string& suiteName : suiteNames)
+		{
+			if (suiteName == "all")
+				continue;
+
+			auto it = std::find_if(std::begin(s_suites), std::end(s_suites), [&](const BenchmarkSuite& suite) { return suiteName == suite.name; });
+			if (it == std::end(s_suites))
+				throw std::runtime_error("unknown suite " + suiteName + " (expected " + suiteList + " or all)");
+		}
+
+		Nz::Initializer<Nz::Network> network;
+
+		bool success = true;
+		for (const BenchmarkSuite& suite : s_suites)
+		{
+			if (!runAll && std::find(suiteNames.begin(), suiteNames.end(), suite.name) == suiteNames.end())
+				continue;
+
+			if (!suite.run(settings))
+			{
+				std::cout << "suite " << suite.name << " failed" << std::endl;
+				success = false;
+			}
+		}
+
+		return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	catch (const cxxopts::OptionException& e)
+	{
+		std::cout << e.what() << "\n";
+		std::cout << options.help() << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+	}
+
+	return EXIT_FAILURE;
+}
+
+BurgWarMain(BurgWarBenchmark)
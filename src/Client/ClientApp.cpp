@@ -5,13 +5,13 @@
 #include <Client/ClientApp.hpp>
 #include <NDK/Components.hpp>
 #include <NDK/Systems.hpp>
+#include <CoreLib/LocalSessionBridge.hpp>
+#include <CoreLib/LocalSessionManager.hpp>
 #include <CoreLib/Match.hpp>
 #include <CoreLib/Version.hpp>
 #include <ClientLib/ClientSession.hpp>
 #include <ClientLib/KeyboardAndMouseController.hpp>
 #include <ClientLib/LocalMatch.hpp>
-#include <ClientLib/LocalSessionBridge.hpp>
-#include <ClientLib/LocalSessionManager.hpp>
 #include <Client/States/BackgroundState.hpp>
 #include <Client/States/MainMenuState.hpp>
 
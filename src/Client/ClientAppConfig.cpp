@@ -10,9 +10,13 @@ namespace bw
 	ClientAppConfig::ClientAppConfig(ClientApp& app) :
 	SharedAppConfig(app)
 	{
+		RegisterFloatOption("Debug.ReconciliationStatsInterval", 0.0, 3600.0, 0.0);
 		RegisterStringOption("Debug.ShowConnectionData");
 		RegisterBoolOption("Debug.ShowServerGhosts");
 		RegisterBoolOption("Debug.ShowVersion", true);
+		RegisterFloatOption("Network.InterpolationDelay", -1.0, 1.0, -1.0);
+		RegisterFloatOption("Network.MaxExtrapolation", 0.0, 1.0, 0.1);
+		RegisterBoolOption("Network.ScopedReconciliation", true);
 		RegisterStringOption("Resources.AssetCacheDirectory", ".assetCache");
 		RegisterStringOption("Resources.ScriptCacheDirectory", ".scriptCache");
 		RegisterIntegerOption("WindowSettings.AntialiasingLevel", 0, 16);
@@ -48,6 +48,7 @@ namespace bw
 
 		Packets::Auth authPacket;
 		authPacket.players.emplace_back().nickname = playerConfig.GetStringValue("Player.Name");
+		authPacket.supportedFeatures = ProtocolFeature::BatchedEntityEvents | ProtocolFeature::QuantizedMatchState;
 
 		m_clientSession->SendPacket(std::move(authPacket));
 	}
@@ -3,9 +3,9 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Client/States/Game/ConnectionState.hpp>
+#include <CoreLib/LocalSessionBridge.hpp>
+#include <CoreLib/LocalSessionManager.hpp>
 #include <CoreLib/NetworkSessionBridge.hpp>
-#include <ClientLib/LocalSessionBridge.hpp>
-#include <ClientLib/LocalSessionManager.hpp>
 #include <Client/ClientApp.hpp>
 #include <Client/States/BackgroundState.hpp>
 #include <Client/States/MainMenuState.hpp>
@@ -12,7 +12,8 @@ namespace bw
 {
 	GameState::GameState(std::shared_ptr<StateData> stateDataPtr, std::shared_ptr<ClientSession> clientSession, const Packets::AuthSuccess& authSuccess, const Packets::MatchData& matchData, std::shared_ptr<VirtualDirectory> assetDirectory, std::shared_ptr<VirtualDirectory> scriptDirectory) :
 	AbstractState(std::move(stateDataPtr)),
-	m_clientSession(std::move(clientSession))
+	m_clientSession(std::move(clientSession)),
+	m_reconciliationStatsTimer(0.f)
 	{
 		StateData& stateData = GetStateData();
 
@@ -20,7 +21,13 @@ namespace bw
 		m_match->LoadAssets(std::move(assetDirectory));
 		m_match->LoadScripts(std::move(scriptDirectory));
 
-		if (stateData.app->GetConfig().GetBoolValue("Debug.ShowServerGhosts"))
+		const ConfigFile& config = stateData.app->GetConfig();
+		m_match->EnableScopedReconciliation(config.GetBoolValue("Network.ScopedReconciliation"));
+		m_match->SetSnapshotInterpolation(config.GetFloatValue<float>("Network.InterpolationDelay"), config.GetFloatValue<float>("Network.MaxExtrapolation"));
+
+		m_reconciliationStatsInterval = config.GetFloatValue<float>("Debug.ReconciliationStatsInterval");
+
+		if (config.GetBoolValue("Debug.ShowServerGhosts"))
 			m_match->InitDebugGhosts();
 
 		m_clientSession->SendPacket(Packets::Ready{});
@@ -32,6 +39,25 @@ namespace bw
 			m_clientSession->Disconnect();
 	}
 
+	void GameState::LogReconciliationStatistics()
+	{
+		const auto& statistics = m_match->GetReconciliationStatistics();
+		if (statistics.reconciliationCount == 0)
+			return;
+
+		Nz::UInt64 count = statistics.reconciliationCount;
+		bwLog(m_match->GetLogger(), LogLevel::Info, "Reconciliation ({0}): {1} replays of {2:.1f} inputs on average, {3:.1f} bodies replayed and {4:.1f} frozen on average, replay time avg {5:.3f}ms max {6:.3f}ms",
+			(m_match->IsScopedReconciliationEnabled()) ? "scoped" : "full",
+			count,
+			float(statistics.replayedInputCount) / count,
+			float(statistics.replayedBodyCount) / count,
+			float(statistics.frozenBodyCount) / count,
+			statistics.totalReplayTime / 1000.f / count,
+			statistics.maxReplayTime / 1000.f);
+
+		m_match->ResetReconciliationStatistics();
+	}
+
 	bool GameState::Update(Ndk::StateMachine& fsm, float elapsedTime)
 	{
 		if (!AbstractState::Update(fsm, elapsedTime))
@@ -44,6 +70,16 @@ namespace bw
 			return true;
 		}
 
+		if (m_reconciliationStatsInterval > 0.f)
+		{
+			m_reconciliationStatsTimer += elapsedTime;
+			if (m_reconciliationStatsTimer >= m_reconciliationStatsInterval)
+			{
+				m_reconciliationStatsTimer = 0.f;
+				LogReconciliationStatistics();
+			}
+		}
+
 		return true;
 	}
 }
@@ -26,11 +26,14 @@ namespace bw
 
 		private:
 			void Leave(Ndk::StateMachine& fsm) override;
+			void LogReconciliationStatistics();
 			bool Update(Ndk::StateMachine& fsm, float elapsedTime) override;
 
 			std::shared_ptr<AbstractState> m_nextState;
 			std::shared_ptr<ClientSession> m_clientSession;
 			std::shared_ptr<LocalMatch> m_match;
+			float m_reconciliationStatsInterval;
+			float m_reconciliationStatsTimer;
 	};
 }
 
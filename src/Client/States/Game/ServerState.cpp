@@ -3,8 +3,8 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Client/States/Game/ServerState.hpp>
+#include <CoreLib/LocalSessionManager.hpp>
 #include <CoreLib/NetworkSessionManager.hpp>
-#include <ClientLib/LocalSessionManager.hpp>
 #include <Client/ClientApp.hpp>
 #include <Client/States/Game/ConnectionState.hpp>
 
@@ -9,10 +9,12 @@
 #include <ClientLib/Components/LocalMatchComponent.hpp>
 #include <ClientLib/Components/SoundEmitterComponent.hpp>
 #include <ClientLib/Components/VisibleLayerComponent.hpp>
+#include <ClientLib/Components/SnapshotInterpolationComponent.hpp>
 #include <ClientLib/Components/VisualInterpolationComponent.hpp>
 #include <ClientLib/Systems/FrameCallbackSystem.hpp>
 #include <ClientLib/Systems/PostFrameCallbackSystem.hpp>
 #include <ClientLib/Systems/SoundSystem.hpp>
+#include <ClientLib/Systems/SnapshotInterpolationSystem.hpp>
 #include <ClientLib/Systems/VisualInterpolationSystem.hpp>
 #include <Nazara/Audio/Audio.hpp>
 #include <Nazara/Graphics/Model.hpp>
@@ -44,11 +46,13 @@ namespace bw
 
 		Ndk::InitializeComponent<VisualComponent>("LayrEnt");
 		Ndk::InitializeComponent<LocalMatchComponent>("LclMatch");
+		Ndk::InitializeComponent<SnapshotInterpolationComponent>("SnapIntp");
 		Ndk::InitializeComponent<SoundEmitterComponent>("SndEmtr");
 		Ndk::InitializeComponent<VisibleLayerComponent>("VsbLayrs");
 		Ndk::InitializeComponent<VisualInterpolationComponent>("Interp");
 		Ndk::InitializeSystem<FrameCallbackSystem>();
 		Ndk::InitializeSystem<PostFrameCallbackSystem>();
+		Ndk::InitializeSystem<SnapshotInterpolationSystem>();
 		Ndk::InitializeSystem<SoundSystem>();
 		Ndk::InitializeSystem<VisualInterpolationSystem>();
 
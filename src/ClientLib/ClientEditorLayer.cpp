@@ -5,8 +5,10 @@
 #include <ClientLib/ClientEditorLayer.hpp>
 #include <ClientLib/Systems/FrameCallbackSystem.hpp>
 #include <ClientLib/Systems/PostFrameCallbackSystem.hpp>
+#include <ClientLib/Systems/SnapshotInterpolationSystem.hpp>
 #include <ClientLib/Systems/VisualInterpolationSystem.hpp>
 #include <NDK/Systems/LifetimeSystem.hpp>
+#include <NDK/Systems/PhysicsSystem2D.hpp>
 
 namespace bw
 {
@@ -16,6 +18,7 @@ namespace bw
 		Ndk::World& world = GetWorld();
 		world.AddSystem<FrameCallbackSystem>();
 		world.AddSystem<PostFrameCallbackSystem>();
+		world.AddSystem<SnapshotInterpolationSystem>();
 		world.AddSystem<VisualInterpolationSystem>();
 	}
 	
@@ -41,6 +44,7 @@ namespace bw
 			system.Enable(false);
 		});
 
+		world.GetSystem<SnapshotInterpolationSystem>().Enable(true);
 		world.GetSystem<VisualInterpolationSystem>().Enable(true);
 
 		world.Update(elapsedTime);
@@ -59,6 +63,14 @@ namespace bw
 		world.Update(elapsedTime);
 	}
 
+	void ClientEditorLayer::ReplayTickUpdate(float elapsedTime, const Ndk::EntityList& entities)
+	{
+		// Frame updates disable physics
+		GetWorld().GetSystem<Ndk::PhysicsSystem2D>().Enable(true);
+
+		SharedLayer::ReplayTickUpdate(elapsedTime, entities);
+	}
+
 	void ClientEditorLayer::TickUpdate(float elapsedTime)
 	{
 		Ndk::World& world = GetWorld();
@@ -69,6 +81,7 @@ namespace bw
 
 		world.GetSystem<Ndk::LifetimeSystem>().Enable(false);
 		world.GetSystem<FrameCallbackSystem>().Enable(false);
+		world.GetSystem<SnapshotInterpolationSystem>().Enable(false);
 		world.GetSystem<VisualInterpolationSystem>().Enable(false);
 
 		SharedLayer::TickUpdate(elapsedTime);
@@ -4,11 +4,11 @@
 
 #include <ClientLib/ClientSession.hpp>
 #include <CoreLib/BurgApp.hpp>
+#include <CoreLib/LocalSessionBridge.hpp>
+#include <CoreLib/LocalSessionManager.hpp>
 #include <CoreLib/NetworkSessionBridge.hpp>
 #include <CoreLib/Utility/VirtualDirectory.hpp>
 #include <ClientLib/LocalMatch.hpp>
-#include <ClientLib/LocalSessionBridge.hpp>
-#include <ClientLib/LocalSessionManager.hpp>
 #include <Nazara/Network/Algorithm.hpp>
 
 namespace bw
@@ -0,0 +1,129 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <ClientLib/Components/SnapshotInterpolationComponent.hpp>
+#include <CoreLib/Utils.hpp>
+#include <Nazara/Math/Algorithm.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace bw
+{
+	namespace
+	{
+		Nz::RadianAnglef AngleDifference(const Nz::RadianAnglef& from, const Nz::RadianAnglef& to)
+		{
+			// Take the shortest path, so entities don't spin when their rotation wraps around
+			Nz::RadianAnglef difference = to - from;
+			difference.Normalize();
+
+			return difference;
+		}
+
+		float TickDifference(Nz::UInt16 from, Nz::UInt16 to)
+		{
+			return static_cast<float>(static_cast<Nz::Int16>(to - from));
+		}
+	}
+
+	/*!
+	* \brief Registers a new state received from the server
+	*
+	* States which are not more recent than the last registered one are ignored, the oldest state is overwritten once the buffer is full.
+	*/
+	void SnapshotInterpolationComponent::PushSnapshot(Nz::UInt16 serverTick, const Nz::Vector2f& position, const Nz::RadianAnglef& rotation)
+	{
+		if (m_snapshotCount > 0 && !IsMoreRecent(serverTick, GetSnapshot(m_snapshotCount - 1).serverTick))
+			return;
+
+		std::size_t snapshotIndex;
+		if (m_snapshotCount == MaxSnapshotCount)
+		{
+			snapshotIndex = m_firstSnapshot;
+			m_firstSnapshot = (m_firstSnapshot + 1) % MaxSnapshotCount;
+		}
+		else
+			snapshotIndex = (m_firstSnapshot + m_snapshotCount++) % MaxSnapshotCount;
+
+		Snapshot& snapshot = m_snapshots[snapshotIndex];
+		snapshot.position = position;
+		snapshot.rotation = rotation;
+		snapshot.serverTick = serverTick;
+	}
+
+	/*!
+	* \brief Computes the state of the entity at a given point in time
+	* \return False if no state has been registered yet
+	*
+	* If the render time lies between two snapshots, the state is linearly interpolated between them.
+	* If it is past the most recent snapshot (late or lost packets), the state is extrapolated from the two last snapshots for at most maxExtrapolation ticks.
+	*
+	* \param renderTick Server tick to sample
+	* \param tickFraction Progression in [0, 1) between renderTick and the next one
+	* \param maxExtrapolation Maximum number of ticks the state can be extrapolated past the most recent snapshot
+	* \param position Output position
+	* \param rotation Output rotation
+	*/
+	bool SnapshotInterpolationComponent::Sample(Nz::UInt16 renderTick, float tickFraction, float maxExtrapolation, Nz::Vector2f* position, Nz::RadianAnglef* rotation) const
+	{
+		assert(position);
+		assert(rotation);
+
+		if (m_snapshotCount == 0)
+			return false;
+
+		// Snapshot times are computed relatively to the render time, which makes this safe regarding tick wrapping
+		auto GetSnapshotTime = [&](const Snapshot& snapshot)
+		{
+			return TickDifference(renderTick, snapshot.serverTick) - tickFraction;
+		};
+
+		const Snapshot& lastSnapshot = GetSnapshot(m_snapshotCount - 1);
+		float lastSnapshotTime = GetSnapshotTime(lastSnapshot);
+		if (lastSnapshotTime <= 0.f)
+		{
+			*position = lastSnapshot.position;
+			*rotation = lastSnapshot.rotation;
+
+			if (m_snapshotCount >= 2 && maxExtrapolation > 0.f)
+			{
+				const Snapshot& previousSnapshot = GetSnapshot(m_snapshotCount - 2);
+				float snapshotInterval = TickDifference(previousSnapshot.serverTick, lastSnapshot.serverTick);
+				float extrapolationTime = std::min(-lastSnapshotTime, maxExtrapolation);
+
+				float factor = extrapolationTime / snapshotInterval;
+				*position += (lastSnapshot.position - previousSnapshot.position) * factor;
+				*rotation += AngleDifference(previousSnapshot.rotation, lastSnapshot.rotation) * factor;
+			}
+
+			return true;
+		}
+
+		// Find the most recent snapshot which isn't in the future
+		std::size_t nextIndex = m_snapshotCount - 1;
+		while (nextIndex > 0 && GetSnapshotTime(GetSnapshot(nextIndex - 1)) > 0.f)
+			nextIndex--;
+
+		const Snapshot& nextSnapshot = GetSnapshot(nextIndex);
+		if (nextIndex == 0)
+		{
+			// Render time is older than every snapshot we have (entity just started being interpolated)
+			*position = nextSnapshot.position;
+			*rotation = nextSnapshot.rotation;
+			return true;
+		}
+
+		const Snapshot& previousSnapshot = GetSnapshot(nextIndex - 1);
+		float previousSnapshotTime = GetSnapshotTime(previousSnapshot);
+		float nextSnapshotTime = GetSnapshotTime(nextSnapshot);
+
+		float factor = -previousSnapshotTime / (nextSnapshotTime - previousSnapshotTime);
+		*position = Nz::Lerp(previousSnapshot.position, nextSnapshot.position, factor);
+		*rotation = previousSnapshot.rotation + AngleDifference(previousSnapshot.rotation, nextSnapshot.rotation) * factor;
+
+		return true;
+	}
+
+	Ndk::ComponentIndex SnapshotInterpolationComponent::componentIndex;
+}
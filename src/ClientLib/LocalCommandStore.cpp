@@ -11,7 +11,7 @@ namespace bw
 	LocalCommandStore::LocalCommandStore(const Logger& logger) :
 	CommandStore(logger)
 	{
-#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type>(#Type, [](ClientSession* session, Packets::Type&& packet) \
+#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type>(#Type, [](ClientSession* session, Packets::Type& packet) \
 { \
 	session->On##Type(session, packet); \
 })
@@ -34,7 +34,9 @@ namespace bw
 		IncomingCommand(EntitiesAnimation);
 		IncomingCommand(EntitiesDeath);
 		IncomingCommand(EntitiesInputs);
+		IncomingCommand(EntitiesPhysics);
 		IncomingCommand(EntitiesScale);
+		IncomingCommand(EntitiesWeapon);
 		IncomingCommand(EntityPhysics);
 		IncomingCommand(EntityWeapon);
 		IncomingCommand(HealthUpdate);
@@ -417,6 +417,17 @@ namespace bw
 		}
 	}
 
+	void LocalLayer::HandlePacket(const Packets::EntitiesPhysics::Entity* entities, std::size_t entityCount)
+	{
+		assert(m_isEnabled);
+
+		for (std::size_t i = 0; i < entityCount; ++i)
+		{
+			const auto& entityData = entities[i];
+			UpdateEntityPhysics(entityData.id, entityData.asleep, entityData.mass, entityData.momentOfInertia, entityData.playerMovement);
+		}
+	}
+
 	void LocalLayer::HandlePacket(const Packets::EntitiesScale::Entity* entities, std::size_t entityCount)
 	{
 		assert(m_isEnabled);
@@ -435,11 +446,52 @@ namespace bw
 		}
 	}
 
+	void LocalLayer::HandlePacket(const Packets::EntitiesWeapon::Entity* entities, std::size_t entityCount)
+	{
+		assert(m_isEnabled);
+
+		for (std::size_t i = 0; i < entityCount; ++i)
+			UpdateEntityWeapon(entities[i].id, entities[i].weaponEntityId);
+	}
+
 	void LocalLayer::HandlePacket(const Packets::EntityPhysics& packet)
 	{
 		assert(packet.entityId.layerId == GetLayerIndex());
 
-		auto entityOpt = GetEntityByServerId(packet.entityId.entityId);
+		UpdateEntityPhysics(packet.entityId.entityId, packet.asleep, packet.mass, packet.momentOfInertia, packet.playerMovement);
+	}
+
+	void LocalLayer::HandlePacket(const Packets::EntityWeapon& packet)
+	{
+		assert(packet.entityId.layerId == GetLayerIndex());
+
+		UpdateEntityWeapon(packet.entityId.entityId, packet.weaponEntityId);
+	}
+
+	void LocalLayer::HandlePacket(const Packets::HealthUpdate::Entity* entities, std::size_t entityCount)
+	{
+		assert(m_isEnabled);
+
+		for (std::size_t i = 0; i < entityCount; ++i)
+		{
+			Nz::UInt32 entityId = entities[i].id;
+			Nz::UInt16 currentHealth = entities[i].currentHealth;
+
+			auto entityOpt = GetEntityByServerId(entityId);
+			if (!entityOpt)
+				continue;
+
+			LocalLayerEntity& localEntity = entityOpt.value();
+			if (localEntity.HasHealth())
+				localEntity.UpdateHealth(currentHealth);
+			else
+				bwLog(GetMatch().GetLogger(), LogLevel::Error, "Received health data for entity {} which has none", localEntity.GetUniqueId());
+		}
+	}
+
+	void LocalLayer::UpdateEntityPhysics(Nz::UInt32 entityId, bool asleep, float mass, float momentOfInertia, const std::optional<Packets::Helper::PlayerMovementProperties>& playerMovement)
+	{
+		auto entityOpt = GetEntityByServerId(entityId);
 		if (!entityOpt)
 			return;
 
@@ -449,15 +501,15 @@ namespace bw
 			const Ndk::EntityHandle& entity = localEntity.GetEntity();
 
 			auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent2D>();
-			entityPhys.SetMass(packet.mass, false);
-			entityPhys.SetMomentOfInertia(packet.momentOfInertia);
+			entityPhys.SetMass(mass, false);
+			entityPhys.SetMomentOfInertia(momentOfInertia);
 
-			if (packet.asleep)
+			if (asleep)
 				entityPhys.ForceSleep();
 
-			if (packet.playerMovement)
+			if (playerMovement)
 			{
-				auto& packetPlayerMovement = packet.playerMovement.value();
+				auto& packetPlayerMovement = playerMovement.value();
 
 				if (entity->HasComponent<PlayerMovementComponent>())
 				{
@@ -470,18 +522,16 @@ namespace bw
 		}
 	}
 
-	void LocalLayer::HandlePacket(const Packets::EntityWeapon& packet)
+	void LocalLayer::UpdateEntityWeapon(Nz::UInt32 entityId, Nz::UInt32 weaponEntityId)
 	{
-		assert(packet.entityId.layerId == GetLayerIndex());
-
-		auto entityOpt = GetEntityByServerId(packet.entityId.entityId);
+		auto entityOpt = GetEntityByServerId(entityId);
 		if (!entityOpt)
 			return;
 
 		LocalLayerEntity& localEntity = *entityOpt;
-		if (packet.weaponEntityId != Packets::EntityWeapon::NoWeapon)
+		if (weaponEntityId != Packets::EntityWeapon::NoWeapon)
 		{
-			auto newWeaponOpt = GetEntityByServerId(packet.weaponEntityId);
+			auto newWeaponOpt = GetEntityByServerId(weaponEntityId);
 			if (!newWeaponOpt)
 				return;
 
@@ -491,25 +541,4 @@ namespace bw
 		else
 			localEntity.UpdateWeaponEntity({});
 	}
-
-	void LocalLayer::HandlePacket(const Packets::HealthUpdate::Entity* entities, std::size_t entityCount)
-	{
-		assert(m_isEnabled);
-
-		for (std::size_t i = 0; i < entityCount; ++i)
-		{
-			Nz::UInt32 entityId = entities[i].id;
-			Nz::UInt16 currentHealth = entities[i].currentHealth;
-
-			auto entityOpt = GetEntityByServerId(entityId);
-			if (!entityOpt)
-				continue;
-
-			LocalLayerEntity& localEntity = entityOpt.value();
-			if (localEntity.HasHealth())
-				localEntity.UpdateHealth(currentHealth);
-			else
-				bwLog(GetMatch().GetLogger(), LogLevel::Error, "Received health data for entity {} which has none", localEntity.GetUniqueId());
-		}
-	}
 }
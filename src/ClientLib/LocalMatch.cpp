@@ -22,6 +22,7 @@
 #include <ClientLib/LocalCommandStore.hpp>
 #include <ClientLib/Scoreboard.hpp>
 #include <ClientLib/VisualEntity.hpp>
+#include <ClientLib/Components/SnapshotInterpolationComponent.hpp>
 #include <ClientLib/Components/VisibleLayerComponent.hpp>
 #include <ClientLib/Scripting/ClientEditorScriptingLibrary.hpp>
 #include <ClientLib/Scripting/ClientElementLibrary.hpp>
@@ -30,7 +31,9 @@
 #include <ClientLib/Scripting/ClientScriptingLibrary.hpp>
 #include <ClientLib/Scripting/ClientWeaponLibrary.hpp>
 #include <ClientLib/Components/LocalMatchComponent.hpp>
+#include <ClientLib/Systems/SnapshotInterpolationSystem.hpp>
 #include <ClientLib/Systems/SoundSystem.hpp>
+#include <Nazara/Core/Clock.hpp>
 #include <Nazara/Graphics/ColorBackground.hpp>
 #include <Nazara/Graphics/TileMap.hpp>
 #include <Nazara/Graphics/TextSprite.hpp>
@@ -41,11 +44,23 @@
 #include <Nazara/Utility/SimpleTextDrawer.hpp>
 #include <NDK/Components.hpp>
 #include <NDK/Systems.hpp>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <fstream>
 
 namespace bw
 {
+	namespace
+	{
+		// Snapshot interpolation renders entities this many state intervals in the past, so there are states on both sides of the render time even after losing one
+		constexpr float InterpolationStateIntervalCount = 2.f;
+
+		// Intervals (in ticks) between the last received match states, used to size the interpolation delay
+		constexpr std::size_t MatchStateIntervalHistory = 32;
+		constexpr Nz::UInt16 MaxMatchStateInterval = 8;
+	}
+
 	LocalMatch::LocalMatch(ClientEditorApp& burgApp, Nz::RenderWindow* window, Nz::RenderTarget* renderTarget, Ndk::Canvas* canvas, ClientSession& session, const Packets::AuthSuccess& authSuccess, const Packets::MatchData& matchData) :
 	SharedMatch(burgApp, LogSide::Client, "local", matchData.tickDuration),
 	m_gamemodeName(matchData.gamemode),
@@ -55,14 +70,20 @@ namespace bw
 	m_window(window),
 	m_activeLayerIndex(0xFFFF),
 	m_averageTickError(20),
+	m_matchStateInterval(MatchStateIntervalHistory),
 	m_chatBox(GetLogger(), renderTarget, canvas),
 	m_application(burgApp),
 	m_session(session),
 	m_escapeMenu(burgApp, canvas),
 	m_scoreboard(nullptr),
+	m_reconciliationStartTime(0),
 	m_hasFocus(window->HasFocus()),
 	m_isLeavingMatch(false),
+	m_isReconciliationScoped(false),
+	m_isScopedReconciliationEnabled(true),
 	m_errorCorrectionTimer(0.f),
+	m_interpolationDelay(0.f),
+	m_maxExtrapolation(0.f),
 	m_playerEntitiesTimer(0.f),
 	m_playerInputTimer(0.f)
 	{
@@ -76,6 +97,9 @@ namespace bw
 
 		m_averageTickError.InsertValue(-static_cast<Nz::Int32>(matchData.currentTick));
 
+		// Server sends a match state every tick unless told otherwise by received states
+		m_matchStateInterval.InsertValue(1.f);
+
 		m_layers.reserve(matchData.layers.size());
 
 		LayerIndex layerIndex = 0;
@@ -123,6 +147,12 @@ namespace bw
 		for (auto& input : m_inputPacket.inputs)
 			input.emplace();
 
+		if (authSuccess.matchStateQuantization)
+		{
+			m_matchStateQuantizer.emplace(*authSuccess.matchStateQuantization);
+			m_receivedMatchStates.resize(MatchStateQuantizer::BaselineHistorySize);
+		}
+
 		m_localPlayers.reserve(playerCount);
 		assert(playerCount != 0xFF);
 		for (Nz::UInt8 i = 0; i < playerCount; ++i)
@@ -566,6 +596,27 @@ namespace bw
 			}
 		}
 
+		if (m_interpolationDelay != 0.f)
+		{
+			// Last handled server tick (see OnTick) plus the time elapsed since, minus the interpolation delay
+			float tickFraction = 1.f - GetTimeUntilNextTick() / GetTickDuration() - GetInterpolationDelay() / GetTickDuration();
+			float tickOffset = std::floor(tickFraction);
+
+			Nz::UInt16 handledTick = AdjustServerTick(GetNetworkTick(EstimateServerTick() - 1));
+			Nz::UInt16 renderTick = static_cast<Nz::UInt16>(handledTick + static_cast<Nz::Int32>(tickOffset));
+			float maxExtrapolation = m_maxExtrapolation / GetTickDuration();
+
+			for (auto& layer : m_layers)
+			{
+				if (!layer->IsEnabled())
+					continue;
+
+				auto& snapshotInterpolation = layer->GetWorld().GetSystem<SnapshotInterpolationSystem>();
+				snapshotInterpolation.SetMaxExtrapolation(maxExtrapolation);
+				snapshotInterpolation.SetRenderTick(renderTick, tickFraction - tickOffset);
+			}
+		}
+
 		for (auto& layer : m_layers)
 		{
 			if (layer->IsEnabled())
@@ -627,6 +678,88 @@ namespace bw
 		return true;
 	}
 	
+	void LocalMatch::AcknowledgeMatchState(Nz::UInt16 stateTick)
+	{
+		// Acknowledgements are sent along with our inputs, the server uses them to resend lost updates (and as delta baselines)
+		auto& acknowledgedTick = m_inputPacket.acknowledgedStateTick;
+		auto& acknowledgedMask = m_inputPacket.acknowledgedStateMask;
+
+		if (!acknowledgedTick)
+		{
+			acknowledgedTick = stateTick;
+			acknowledgedMask = 0;
+		}
+		else if (IsMoreRecent(stateTick, *acknowledgedTick))
+		{
+			Nz::UInt16 shift = stateTick - *acknowledgedTick;
+			if (shift <= 32)
+			{
+				acknowledgedMask = (shift < 32) ? acknowledgedMask << shift : 0;
+				acknowledgedMask |= Nz::UInt32(1) << (shift - 1);
+			}
+			else
+				acknowledgedMask = 0;
+
+			acknowledgedTick = stateTick;
+		}
+		else
+		{
+			Nz::UInt16 offset = *acknowledgedTick - stateTick;
+			if (offset > 0 && offset <= 32)
+				acknowledgedMask |= Nz::UInt32(1) << (offset - 1);
+		}
+	}
+
+	/*!
+	* \brief Starts measuring a replay of predicted inputs and computes its scope
+	*
+	* With scoped reconciliation, the scope holds the controlled entities, their weapons and the entities around them (a region large enough for them to interact with during the replayed inputs).
+	* Bodies out of the scope are frozen by PrepareReplay once the authoritative state is applied, and only entities of the scope are updated by the replayed ticks.
+	*/
+	void LocalMatch::BeginReconciliation(std::size_t replayedInputCount)
+	{
+		m_reconciliationStartTime = Nz::GetElapsedMicroseconds();
+		m_reconciliationStatistics.reconciliationCount++;
+		m_reconciliationStatistics.replayedInputCount += replayedInputCount;
+
+		m_isReconciliationScoped = m_isScopedReconciliationEnabled;
+		m_reconciliationScope.clear();
+
+		if (!m_isReconciliationScoped)
+			return;
+
+		float replayDuration = replayedInputCount * GetTickDuration();
+
+		for (const LocalPlayerData& controllerData : m_localPlayers)
+		{
+			if (!controllerData.controlledEntity)
+				continue;
+
+			LocalLayerEntity& controlledEntity = *controllerData.controlledEntity;
+			m_reconciliationScope.insert(controlledEntity.GetUniqueId());
+
+			for (const Ndk::EntityHandle& weapon : controllerData.weapons)
+				m_reconciliationScope.insert(RetrieveUniqueIdByEntity(weapon));
+
+			const Ndk::EntityHandle& entity = controlledEntity.GetEntity();
+			if (!entity->HasComponent<Ndk::PhysicsComponent2D>())
+				continue;
+
+			auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent2D>();
+
+			// Take every physical entity the controlled entity could collide with while replaying inputs
+			float scopeRadius = ReconciliationScopeRadius + entityPhys.GetVelocity().GetLength() * replayDuration;
+			Nz::Vector2f position = entityPhys.GetPosition();
+			Nz::Rectf scopeRect(position.x - scopeRadius, position.y - scopeRadius, 2.f * scopeRadius, 2.f * scopeRadius);
+
+			auto& physSystem = m_layers[controlledEntity.GetLayerIndex()]->GetWorld().GetSystem<Ndk::PhysicsSystem2D>();
+			physSystem.RegionQuery(scopeRect, 0, 0xFFFFFFFF, 0xFFFFFFFF, [&](const Ndk::EntityHandle& hitEntity)
+			{
+				m_reconciliationScope.insert(RetrieveUniqueIdByEntity(hitEntity));
+			});
+		}
+	}
+
 	void LocalMatch::BindEscapeMenu()
 	{
 		m_escapeMenu.OnLeaveMatch.Connect([this](EscapeMenu*)
@@ -693,11 +826,21 @@ namespace bw
 			PushTickPacket(inputs.stateTick, inputs);
 		});
 
+		m_session.OnEntitiesPhysics.Connect([this](ClientSession* /*session*/, const Packets::EntitiesPhysics& physics)
+		{
+			PushTickPacket(physics.stateTick, physics);
+		});
+
 		m_session.OnEntitiesScale.Connect([this](ClientSession* /*session*/, const Packets::EntitiesScale& scale)
 		{
 			PushTickPacket(scale.stateTick, scale);
 		});
 
+		m_session.OnEntitiesWeapon.Connect([this](ClientSession* /*session*/, const Packets::EntitiesWeapon& weapons)
+		{
+			PushTickPacket(weapons.stateTick, weapons);
+		});
+
 		m_session.OnEntityPhysics.Connect([this](ClientSession* /*session*/, const Packets::EntityPhysics& physics)
 		{
 			PushTickPacket(physics.stateTick, physics);
@@ -720,7 +863,18 @@ namespace bw
 
 		m_session.OnMatchState.Connect([this](ClientSession* /*session*/, const Packets::MatchState& matchState)
 		{
-			PushTickPacket(matchState.stateTick, matchState);
+			if (matchState.isQuantized)
+			{
+				Packets::MatchState decodedState = matchState;
+				if (!DecodeMatchState(decodedState))
+					return;
+
+				PushTickPacket(decodedState.stateTick, decodedState);
+			}
+			else
+				PushTickPacket(matchState.stateTick, matchState);
+
+			AcknowledgeMatchState(matchState.stateTick);
 		});
 
 		m_session.OnPlayerControlEntity.Connect([this](ClientSession* /*session*/, const Packets::PlayerControlEntity& playerControlEntity)
@@ -888,6 +1042,98 @@ namespace bw
 		return GetCurrentTick() - m_averageTickError.GetAverageValue();
 	}
 
+	/*!
+	* \brief Returns how far in the past entities rendered from server states are
+	*
+	* A negative configured delay means the delay is sized from the tick duration and the interval between received match states.
+	*/
+	float LocalMatch::GetInterpolationDelay() const
+	{
+		if (m_interpolationDelay >= 0.f)
+			return m_interpolationDelay;
+
+		return InterpolationStateIntervalCount * m_matchStateInterval.GetAverageValue() * GetTickDuration();
+	}
+
+	bool LocalMatch::DecodeMatchState(Packets::MatchState& matchState)
+	{
+		assert(m_matchStateQuantizer);
+
+		const ReceivedMatchState* baselineState = nullptr;
+		if (matchState.baselineTick)
+		{
+			Nz::UInt16 baselineTick = *matchState.baselineTick;
+
+			const ReceivedMatchState& candidate = m_receivedMatchStates[baselineTick % MatchStateQuantizer::BaselineHistorySize];
+			if (candidate.stateTick != baselineTick)
+			{
+				bwLog(GetLogger(), LogLevel::Warning, "Received match state #{0} relative to unknown state #{1}, dropping it", matchState.stateTick, baselineTick);
+				return false;
+			}
+
+			baselineState = &candidate;
+		}
+
+		ReceivedMatchState receivedState;
+		receivedState.stateTick = matchState.stateTick;
+
+		std::size_t entityIndex = 0;
+		for (const auto& layer : matchState.layers)
+		{
+			for (std::size_t i = 0; i < layer.entityCount; ++i)
+			{
+				auto& entity = matchState.entities[entityIndex++];
+				Nz::UInt64 entityKey = Nz::UInt64(layer.layerIndex) << 32 | entity.id;
+
+				const MatchStateQuantizer::EntityState* baseline = nullptr;
+				if (baselineState)
+				{
+					if (auto it = baselineState->entities.find(entityKey); it != baselineState->entities.end())
+						baseline = &it.value();
+				}
+
+				MatchStateQuantizer::EntityState entityState;
+				if (!m_matchStateQuantizer->Decode(entity, baseline, entityState))
+				{
+					bwLog(GetLogger(), LogLevel::Warning, "Received match state #{0} with an entity missing from its baseline, dropping it", matchState.stateTick);
+					return false;
+				}
+
+				receivedState.entities.emplace(entityKey, entityState);
+			}
+		}
+
+		m_receivedMatchStates[matchState.stateTick % MatchStateQuantizer::BaselineHistorySize] = std::move(receivedState);
+
+		return true;
+	}
+
+	void LocalMatch::EndReconciliation()
+	{
+		for (const FrozenBody& frozenBody : m_frozenBodies)
+		{
+			// Entity may have been destroyed by a script during the replay
+			if (!frozenBody.entity || !frozenBody.entity->HasComponent<Ndk::PhysicsComponent2D>())
+				continue;
+
+			auto& entityPhys = frozenBody.entity->GetComponent<Ndk::PhysicsComponent2D>();
+			entityPhys.SetMass(frozenBody.mass, false);
+			entityPhys.SetMomentOfInertia(frozenBody.momentOfInertia);
+			entityPhys.SetAngularVelocity(frozenBody.angularVelocity);
+			entityPhys.SetVelocity(frozenBody.linearVelocity);
+		}
+		m_frozenBodies.clear();
+
+		for (Ndk::EntityList& replayedEntities : m_replayedEntities)
+			replayedEntities.Clear();
+
+		m_isReconciliationScoped = false;
+
+		Nz::UInt64 replayTime = Nz::GetElapsedMicroseconds() - m_reconciliationStartTime;
+		m_reconciliationStatistics.maxReplayTime = std::max(m_reconciliationStatistics.maxReplayTime, replayTime);
+		m_reconciliationStatistics.totalReplayTime += replayTime;
+	}
+
 	void LocalMatch::HandleChatMessage(const Packets::ChatMessage& packet)
 	{
 		//TODO: Implement this in gamemode callback
@@ -1205,6 +1451,18 @@ namespace bw
 		}
 	}
 
+	void LocalMatch::HandleTickPacket(Packets::EntitiesPhysics&& packet)
+	{
+		std::size_t offset = 0;
+		for (auto&& layerData : packet.layers)
+		{
+			assert(layerData.layerIndex < m_layers.size());
+			auto& layer = m_layers[layerData.layerIndex];
+			layer->HandlePacket(&packet.entities[offset], layerData.entityCount);
+			offset += layerData.entityCount;
+		}
+	}
+
 	void LocalMatch::HandleTickPacket(Packets::EntitiesScale&& packet)
 	{
 		std::size_t offset = 0;
@@ -1217,6 +1475,18 @@ namespace bw
 		}
 	}
 
+	void LocalMatch::HandleTickPacket(Packets::EntitiesWeapon&& packet)
+	{
+		std::size_t offset = 0;
+		for (auto&& layerData : packet.layers)
+		{
+			assert(layerData.layerIndex < m_layers.size());
+			auto& layer = m_layers[layerData.layerIndex];
+			layer->HandlePacket(&packet.entities[offset], layerData.entityCount);
+			offset += layerData.entityCount;
+		}
+	}
+
 	void LocalMatch::HandleTickPacket(Packets::EntityPhysics&& packet)
 	{
 		assert(packet.entityId.layerId < m_layers.size());
@@ -1248,8 +1518,13 @@ namespace bw
 		if (Nz::Keyboard::IsKeyPressed(Nz::Keyboard::Scancode::Q))
 			return;
 
+		if (m_interpolationDelay != 0.f)
+			PushSnapshots(packet);
+
 		m_inactiveEntities.clear();
 
+		bool isReconciling = false;
+
 		auto inputIt = std::find_if(m_predictedInputs.begin(), m_predictedInputs.end(), [lastInputTick = packet.lastInputTick](const PredictedInput& input)
 		{
 			return input.inputTick == lastInputTick;
@@ -1310,6 +1585,9 @@ namespace bw
 
 			//bwLog(GetLogger(), LogLevel::Debug, "Too much error detected, performing reconciliation...");
 
+			BeginReconciliation(static_cast<std::size_t>(std::distance(std::next(inputIt), m_predictedInputs.end())));
+			isReconciling = true;
+
 			for (const auto& layerData : inputIt->layers)
 			{
 				assert(layerData.layerIndex < m_layers.size());
@@ -1320,6 +1598,11 @@ namespace bw
 				layer->ForEachLayerEntity([&](LocalLayerEntity& layerEntity)
 				{
 					EntityId uniqueId = layerEntity.GetUniqueId();
+
+					// Entities out of the reconciliation scope keep their authoritative state
+					if (!IsInReconciliationScope(uniqueId))
+						return;
+
 					auto it = layerData.entities.find(uniqueId);
 					if (it != layerData.entities.end())
 					{
@@ -1389,6 +1672,16 @@ namespace bw
 		});
 		m_predictedInputs.erase(m_predictedInputs.begin(), firstClientInput);
 
+		if (!isReconciling && !m_predictedInputs.empty())
+		{
+			BeginReconciliation(m_predictedInputs.size());
+			isReconciling = true;
+		}
+
+		// Authoritative state is applied, bodies out of the scope can be frozen in it
+		if (isReconciling)
+			PrepareReplay();
+
 		for (const PredictedInput& input : m_predictedInputs)
 		{
 			for (std::size_t i = 0; i < m_localPlayers.size(); ++i)
@@ -1427,7 +1720,12 @@ namespace bw
 
 			for (auto& layer : m_layers)
 			{
-				if (layer->IsEnabled() && layer->IsPredictionEnabled())
+				if (!layer->IsEnabled() || !layer->IsPredictionEnabled())
+					continue;
+
+				if (m_isReconciliationScoped)
+					layer->ReplayTickUpdate(GetTickDuration(), m_replayedEntities[layer->GetLayerIndex()]);
+				else
 					layer->TickUpdate(GetTickDuration());
 			}
 
@@ -1451,6 +1749,9 @@ namespace bw
 							LocalLayerEntity& layerEntity = layerEntityOpt.value();
 							layerEntity.Enable();
 
+							if (m_isReconciliationScoped && IsInReconciliationScope(uniqueId))
+								m_replayedEntities[layerData.layerIndex].Insert(layerEntity.GetEntity());
+
 							auto& entityData = entityIt.value();
 							if (entityData.isPhysical)
 								layerEntity.UpdateState(entityData.position, entityData.rotation, entityData.linearVelocity, entityData.angularVelocity);
@@ -1488,6 +1789,9 @@ namespace bw
 				break;
 			}
 		}
+
+		if (isReconciling)
+			EndReconciliation();
 	}
 
 	void LocalMatch::HandleTickPacket(Packets::PlayerLayer&& packet)
@@ -1722,6 +2026,120 @@ namespace bw
 		}
 	}
 
+	/*!
+	* \brief Prepares the layers for a replay of predicted inputs, once the authoritative state has been applied
+	*
+	* With scoped reconciliation, entities of the scope are listed for ReplayTickUpdate (only them get movement, weapons and tick callbacks updated) and awake dynamic bodies out of the scope are made kinematic without velocity until EndReconciliation restores them.
+	* Frozen bodies stay in the physics space (so constraints and contacts with scoped bodies remain valid) but the physics step doesn't resolve collisions between them anymore, a scoped body jointed to a frozen one sees it as a fixed anchor during the replay.
+	* Sleeping and static bodies are left as they are and aren't counted as replayed, as the physics step doesn't simulate them.
+	*/
+	void LocalMatch::PrepareReplay()
+	{
+		assert(m_frozenBodies.empty());
+
+		if (m_isReconciliationScoped)
+			m_replayedEntities.resize(m_layers.size());
+
+		for (auto& layer : m_layers)
+		{
+			if (!layer->IsEnabled() || !layer->IsPredictionEnabled())
+				continue;
+
+			layer->ForEachLayerEntity([&](LocalLayerEntity& layerEntity)
+			{
+				if (!layerEntity.IsEnabled())
+					return;
+
+				const Ndk::EntityHandle& entity = layerEntity.GetEntity();
+				bool isInScope = IsInReconciliationScope(layerEntity.GetUniqueId());
+				if (isInScope && m_isReconciliationScoped)
+					m_replayedEntities[layer->GetLayerIndex()].Insert(entity);
+
+				if (!layerEntity.IsPhysical())
+					return;
+
+				auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent2D>();
+				if (entityPhys.GetMass() <= 0.f || entityPhys.IsSleeping())
+					return;
+
+				if (isInScope)
+				{
+					m_reconciliationStatistics.replayedBodyCount++;
+					return;
+				}
+
+				FrozenBody& frozenBody = m_frozenBodies.emplace_back();
+				frozenBody.entity = entity;
+				frozenBody.angularVelocity = entityPhys.GetAngularVelocity();
+				frozenBody.linearVelocity = entityPhys.GetVelocity();
+				frozenBody.mass = entityPhys.GetMass();
+				frozenBody.momentOfInertia = entityPhys.GetMomentOfInertia();
+
+				entityPhys.SetMass(0.f, false);
+				entityPhys.SetAngularVelocity(Nz::RadianAnglef::Zero());
+				entityPhys.SetVelocity(Nz::Vector2f::Zero());
+			});
+		}
+
+		m_reconciliationStatistics.frozenBodyCount += m_frozenBodies.size();
+	}
+
+	void LocalMatch::PushSnapshots(const Packets::MatchState& packet)
+	{
+		if (m_lastMatchStateTick)
+		{
+			Nz::UInt16 stateInterval = static_cast<Nz::UInt16>(packet.stateTick - *m_lastMatchStateTick);
+			if (stateInterval > 0)
+				m_matchStateInterval.InsertValue(static_cast<float>(std::min(stateInterval, MaxMatchStateInterval)));
+		}
+		m_lastMatchStateTick = packet.stateTick;
+
+		// Entities controlled by local players (and their weapons) are predicted and rendered from their physics state,
+		// every other entity is rendered from the states received from the server, even on predicted layers
+		auto IsLocallyControlled = [&](const Ndk::EntityHandle& entity)
+		{
+			for (const LocalPlayerData& localPlayer : m_localPlayers)
+			{
+				if (localPlayer.controlledEntity && localPlayer.controlledEntity->GetEntity() == entity)
+					return true;
+
+				if (std::find(localPlayer.weapons.begin(), localPlayer.weapons.end(), entity) != localPlayer.weapons.end())
+					return true;
+			}
+
+			return false;
+		};
+
+		std::size_t offset = 0;
+		for (auto&& packetLayer : packet.layers)
+		{
+			assert(packetLayer.layerIndex < m_layers.size());
+			auto& layer = m_layers[packetLayer.layerIndex];
+
+			for (std::size_t i = 0; i < packetLayer.entityCount; ++i)
+			{
+				auto& packetEntity = packet.entities[offset + i];
+
+				auto entityOpt = layer->GetEntityByServerId(packetEntity.id);
+				if (!entityOpt)
+					continue;
+
+				const Ndk::EntityHandle& entity = entityOpt->get().GetEntity();
+				if (!IsLocallyControlled(entity))
+				{
+					if (!entity->HasComponent<SnapshotInterpolationComponent>())
+						entity->AddComponent<SnapshotInterpolationComponent>();
+
+					entity->GetComponent<SnapshotInterpolationComponent>().PushSnapshot(packet.stateTick, packetEntity.position, packetEntity.rotation);
+				}
+				else if (entity->HasComponent<SnapshotInterpolationComponent>())
+					entity->RemoveComponent<SnapshotInterpolationComponent>();
+			}
+
+			offset += packetLayer.entityCount;
+		}
+	}
+
 	void LocalMatch::PushTickPacket(Nz::UInt16 tick, const TickPacketContent& packet)
 	{
 		//bwLog(GetLogger(), LogLevel::Debug, "Execute server tick in {}", tick - m_expectedServerTick.value());
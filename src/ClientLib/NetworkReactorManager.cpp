@@ -51,7 +51,7 @@ namespace bw
 		for (const auto& reactorPtr : m_reactors)
 		{
 			reactorPtr->Poll([&](bool outgoing, std::size_t clientId, Nz::UInt32 data) { HandlePeerConnection(outgoing, clientId, data); },
-			                 [&](std::size_t clientId, Nz::UInt32 data) { HandlePeerDisconnection(clientId, data); },
+			                 [&](std::size_t clientId, Nz::UInt32 data, DisconnectionCause cause) { HandlePeerDisconnection(clientId, data, cause); },
 			                 [&](std::size_t clientId, Nz::NetPacket&& packet) { HandlePeerPacket(clientId, packet); });
 		}
 	}
@@ -61,8 +61,11 @@ namespace bw
 		m_connections[peerId]->HandleConnection(data);
 	}
 
-	void NetworkReactorManager::HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data)
+	void NetworkReactorManager::HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data, DisconnectionCause cause)
 	{
+		if (cause == DisconnectionCause::ConnectionFailed)
+			bwLog(m_logger, LogLevel::Error, "Failed to connect to server (peer #{0})", peerId);
+
 		m_connections[peerId]->HandleDisconnection(data);
 		m_connections[peerId].reset();
 	}
@@ -39,7 +39,7 @@ namespace bw
 		if (m_nextFileIndex > 0)
 		{
 			std::size_t currentFileIndex = m_nextFileIndex - 1;
-			if (m_downloadList[currentFileIndex].receivedFragment.GetSize() == 0 || !m_downloadList[currentFileIndex].receivedFragment.TestAll())
+			if (!m_downloadList[currentFileIndex].isComplete)
 				return false;
 		}
 
@@ -62,43 +62,35 @@ namespace bw
 		std::size_t currentFileIndex = m_nextFileIndex - 1;
 
 		PendingFile& pendingFileData = m_downloadList[currentFileIndex];
-		if (packet.fragmentIndex >= pendingFileData.receivedFragment.GetSize())
+		if (pendingFileData.hasFailed)
+			return; //< Remaining fragments of a failed download
+
+		// Fragments are sent in order on a reliable channel, which allows to hash and write them as they come
+		if (pendingFileData.isComplete || packet.fragmentIndex != pendingFileData.receivedFragmentCount)
 			throw std::runtime_error("unexpected fragment " + std::to_string(packet.fragmentIndex) + " from server");
 
-		std::size_t offset = packet.fragmentIndex * pendingFileData.fragmentSize;
-		m_outputFile.SetCursorPos(offset);
-		m_outputFile.Write(packet.fragmentContent.data(), packet.fragmentContent.size());
+		// Every fragment except the last one must be full, and the whole file must match the expected size
+		Nz::UInt64 fragmentSize = packet.fragmentContent.size();
+		bool isLastFragment = (pendingFileData.receivedFragmentCount + 1 == pendingFileData.fragmentCount);
+		if ((isLastFragment) ? pendingFileData.receivedSize + fragmentSize != pendingFileData.expectedSize : fragmentSize != pendingFileData.fragmentSize)
+		{
+			FailDownload(currentFileIndex, Error::SizeMismatch);
+			return;
+		}
 
+		m_outputFile.Write(packet.fragmentContent.data(), packet.fragmentContent.size());
 		m_hash->Append(packet.fragmentContent.data(), packet.fragmentContent.size());
 
-		std::size_t downloadedSize = (packet.fragmentIndex + 1) * pendingFileData.fragmentSize;
 		if (pendingFileData.keepInMemory)
-		{
-			if (m_fileContent.size() < downloadedSize)
-				m_fileContent.resize(downloadedSize);
-
-			std::memcpy(&m_fileContent[offset], packet.fragmentContent.data(), packet.fragmentContent.size());
-		}
+			m_fileContent.insert(m_fileContent.end(), packet.fragmentContent.begin(), packet.fragmentContent.end());
 
-		OnDownloadProgress(this, currentFileIndex, downloadedSize);
+		pendingFileData.receivedFragmentCount++;
+		pendingFileData.receivedSize += fragmentSize;
 
-		pendingFileData.receivedFragment.Set(packet.fragmentIndex, true);
-		if (pendingFileData.receivedFragment.TestAll())
-		{
-			m_outputFile.Close();
-
-			m_byteArray.Assign(pendingFileData.expectedChecksum.begin(), pendingFileData.expectedChecksum.end());
+		OnDownloadProgress(this, currentFileIndex, pendingFileData.receivedSize);
 
-			if (m_byteArray == m_hash->End())
-			{
-				if (pendingFileData.keepInMemory)
-					OnDownloadFinishedMemory(this, currentFileIndex, m_fileContent, 0);
-				else
-					OnDownloadFinished(this, currentFileIndex, pendingFileData.outputPath, 0);
-			}
-			else
-				OnDownloadError(this, currentFileIndex, Error::ChecksumMismatch);
-		}
+		if (isLastFragment)
+			FinishDownload(currentFileIndex);
 	}
 
 	void PacketDownloadManager::HandlePacket(const Packets::DownloadClientFileResponse& packet)
@@ -112,9 +104,18 @@ namespace bw
 			using T = std::decay_t<decltype(arg)>;
 			if constexpr (std::is_same_v<T, Packets::DownloadClientFileResponse::Success>)
 			{
-				pendingFileData.receivedFragment.Resize(arg.fragmentCount);
+				pendingFileData.fragmentCount = arg.fragmentCount;
 				pendingFileData.fragmentSize = arg.fragmentSize;
 
+				// Check the announced fragmentation matches the file we're expecting before receiving anything
+				Nz::UInt64 fragmentSize = pendingFileData.fragmentSize;
+				Nz::UInt64 expectedFragmentCount = (fragmentSize > 0) ? pendingFileData.expectedSize / fragmentSize + ((pendingFileData.expectedSize % fragmentSize != 0) ? 1 : 0) : 0;
+				if ((fragmentSize == 0 && pendingFileData.expectedSize != 0) || expectedFragmentCount != pendingFileData.fragmentCount)
+				{
+					FailDownload(currentFileIndex, Error::SizeMismatch);
+					return;
+				}
+
 				std::filesystem::path clientFolderPath = pendingFileData.outputPath.parent_path();
 				std::string filePath = pendingFileData.outputPath.generic_u8string();
 
@@ -126,6 +127,13 @@ namespace bw
 
 				if (!m_outputFile.Open(filePath, Nz::OpenMode_Truncate | Nz::OpenMode_WriteOnly))
 					throw std::runtime_error("failed to open file " + filePath);
+
+				if (pendingFileData.keepInMemory)
+					m_fileContent.reserve(pendingFileData.expectedSize);
+
+				// Empty files won't receive any fragment
+				if (pendingFileData.fragmentCount == 0)
+					FinishDownload(currentFileIndex);
 			}
 			else if constexpr (std::is_same_v<T, Packets::DownloadClientFileResponse::Failure>)
 			{
@@ -139,7 +147,7 @@ namespace bw
 						break;
 				}
 
-				OnDownloadError(this, currentFileIndex, error);
+				FailDownload(currentFileIndex, error);
 			}
 			else
 				static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
@@ -147,6 +155,34 @@ namespace bw
 		}, packet.content);
 	}
 
+	void PacketDownloadManager::FailDownload(std::size_t fileIndex, Error error)
+	{
+		m_outputFile.Close();
+
+		m_downloadList[fileIndex].hasFailed = true;
+		OnDownloadError(this, fileIndex, error);
+	}
+
+	void PacketDownloadManager::FinishDownload(std::size_t fileIndex)
+	{
+		m_outputFile.Close();
+
+		PendingFile& pendingFileData = m_downloadList[fileIndex];
+		pendingFileData.isComplete = true;
+
+		m_byteArray.Assign(pendingFileData.expectedChecksum.begin(), pendingFileData.expectedChecksum.end());
+
+		if (m_byteArray == m_hash->End())
+		{
+			if (pendingFileData.keepInMemory)
+				OnDownloadFinishedMemory(this, fileIndex, m_fileContent, 0);
+			else
+				OnDownloadFinished(this, fileIndex, pendingFileData.outputPath, 0);
+		}
+		else
+			OnDownloadError(this, fileIndex, Error::ChecksumMismatch);
+	}
+
 	void PacketDownloadManager::Update()
 	{
 		RequestNextFile();
@@ -164,7 +200,7 @@ namespace bw
 		if (m_nextFileIndex > 0)
 		{
 			std::size_t currentFileIndex = m_nextFileIndex - 1;
-			if (m_downloadList[currentFileIndex].receivedFragment.GetSize() == 0 || !m_downloadList[currentFileIndex].receivedFragment.TestAll())
+			if (!m_downloadList[currentFileIndex].isComplete)
 				return;
 		}
 
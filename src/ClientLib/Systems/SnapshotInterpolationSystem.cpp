@@ -0,0 +1,37 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <ClientLib/Systems/SnapshotInterpolationSystem.hpp>
+#include <ClientLib/Components/SnapshotInterpolationComponent.hpp>
+#include <NDK/Components/NodeComponent.hpp>
+
+namespace bw
+{
+	SnapshotInterpolationSystem::SnapshotInterpolationSystem() :
+	m_renderTick(0),
+	m_maxExtrapolation(0.f),
+	m_tickFraction(0.f)
+	{
+		Requires<SnapshotInterpolationComponent, Ndk::NodeComponent>();
+	}
+
+	void SnapshotInterpolationSystem::OnUpdate(float /*elapsedTime*/)
+	{
+		for (const Ndk::EntityHandle& entity : GetEntities())
+		{
+			auto& entityNode = entity->GetComponent<Ndk::NodeComponent>();
+			auto& entitySnapshots = entity->GetComponent<SnapshotInterpolationComponent>();
+
+			Nz::Vector2f position;
+			Nz::RadianAnglef rotation;
+			if (!entitySnapshots.Sample(m_renderTick, m_tickFraction, m_maxExtrapolation, &position, &rotation))
+				continue;
+
+			entityNode.SetPosition(position);
+			entityNode.SetRotation(rotation);
+		}
+	}
+
+	Ndk::SystemIndex SnapshotInterpolationSystem::systemIndex;
+}
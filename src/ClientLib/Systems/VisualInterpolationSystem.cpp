@@ -4,6 +4,7 @@
 
 #include <ClientLib/Systems/VisualInterpolationSystem.hpp>
 #include <CoreLib/Utils.hpp>
+#include <ClientLib/Components/SnapshotInterpolationComponent.hpp>
 #include <ClientLib/Components/VisualInterpolationComponent.hpp>
 #include <Nazara/Math/Algorithm.hpp>
 #include <NDK/Components/NodeComponent.hpp>
@@ -15,6 +16,7 @@ namespace bw
 	VisualInterpolationSystem::VisualInterpolationSystem()
 	{
 		Requires<VisualInterpolationComponent, Ndk::PhysicsComponent2D, Ndk::NodeComponent>();
+		Excludes<SnapshotInterpolationComponent>(); //< Entities rendered from server snapshots don't follow their local physics body
 	}
 
 	void VisualInterpolationSystem::OnEntityAdded(Ndk::Entity* entity)
@@ -61,7 +61,7 @@ namespace bw
 	{
 		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
 		Nz::UInt64 elapsedTime = now - m_lastTime;
-		m_appTime += elapsedTime / 1000;
+		m_appTime.fetch_add(elapsedTime / 1000, std::memory_order_relaxed);
 		m_lastTime = now;
 	}
 }
@@ -0,0 +1,243 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/FileHashCache.hpp>
+#include <CoreLib/Utility/WorkerPool.hpp>
+#include <Nazara/Core/File.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+namespace bw
+{
+	namespace
+	{
+		std::string ToHex(const Nz::ByteArray& byteArray)
+		{
+			constexpr const char* digits = "0123456789abcdef";
+
+			std::string hex;
+			hex.reserve(byteArray.GetSize() * 2);
+			for (std::size_t i = 0; i < byteArray.GetSize(); ++i)
+			{
+				Nz::UInt8 byte = byteArray[i];
+				hex.push_back(digits[byte >> 4]);
+				hex.push_back(digits[byte & 0x0F]);
+			}
+
+			return hex;
+		}
+
+		std::optional<Nz::ByteArray> FromHex(const std::string& hex)
+		{
+			auto HexDigit = [](char c) -> int
+			{
+				if (c >= '0' && c <= '9')
+					return c - '0';
+				else if (c >= 'a' && c <= 'f')
+					return c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F')
+					return c - 'A' + 10;
+				else
+					return -1;
+			};
+
+			if (hex.size() % 2 != 0)
+				return std::nullopt;
+
+			Nz::ByteArray byteArray(hex.size() / 2, 0);
+			for (std::size_t i = 0; i < byteArray.GetSize(); ++i)
+			{
+				int high = HexDigit(hex[i * 2]);
+				int low = HexDigit(hex[i * 2 + 1]);
+				if (high < 0 || low < 0)
+					return std::nullopt;
+
+				byteArray[i] = static_cast<Nz::UInt8>(high << 4 | low);
+			}
+
+			return byteArray;
+		}
+	}
+
+	/*!
+	* \brief Builds a cache, which will be persisted to manifestPath (if not empty) by Save
+	*/
+	FileHashCache::FileHashCache(std::filesystem::path manifestPath) :
+	m_manifestPath(std::move(manifestPath)),
+	m_isModified(false)
+	{
+	}
+
+	/*!
+	* \brief Returns the SHA1 checksum and size of every file (or nothing if it couldn't be read)
+	*
+	* Files whose size and modification time didn't change since they were hashed reuse the cached checksum, others are hashed in parallel.
+	* This function can be called from multiple threads.
+	*/
+	auto FileHashCache::ComputeHashes(const std::vector<std::filesystem::path>& filePaths, Statistics* statistics) -> std::vector<std::optional<FileHash>>
+	{
+		struct PendingFile
+		{
+			std::size_t fileIndex;
+			std::string key;
+			Nz::ByteArray checksum;
+			Nz::Int64 modificationTime;
+			Nz::UInt64 size;
+		};
+
+		std::vector<std::optional<FileHash>> fileHashes(filePaths.size());
+		std::vector<PendingFile> pendingFiles;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			for (std::size_t i = 0; i < filePaths.size(); ++i)
+			{
+				std::error_code err;
+				Nz::UInt64 fileSize = std::filesystem::file_size(filePaths[i], err);
+				if (err)
+					continue;
+
+				auto lastWriteTime = std::filesystem::last_write_time(filePaths[i], err);
+				if (err)
+					continue;
+
+				Nz::Int64 modificationTime = static_cast<Nz::Int64>(lastWriteTime.time_since_epoch().count());
+
+				std::string key = std::filesystem::absolute(filePaths[i]).generic_u8string();
+				if (auto it = m_entries.find(key); it != m_entries.end() && it->second.size == fileSize && it->second.modificationTime == modificationTime)
+				{
+					fileHashes[i] = FileHash{ it->second.checksum, fileSize };
+					continue;
+				}
+
+				auto& pendingFile = pendingFiles.emplace_back();
+				pendingFile.fileIndex = i;
+				pendingFile.key = std::move(key);
+				pendingFile.modificationTime = modificationTime;
+				pendingFile.size = fileSize;
+			}
+		}
+
+		if (!pendingFiles.empty())
+		{
+			// Hashing is I/O and CPU bound, spread it over every core (the calling thread being one of them)
+			std::size_t workerCount = std::min<std::size_t>(pendingFiles.size(), std::max(std::thread::hardware_concurrency(), 1U)) - 1;
+
+			WorkerPool workerPool(workerCount);
+			workerPool.ParallelFor(pendingFiles.size(), [&](std::size_t pendingIndex)
+			{
+				PendingFile& pendingFile = pendingFiles[pendingIndex];
+				pendingFile.checksum = Nz::File::ComputeHash(Nz::HashType_SHA1, filePaths[pendingFile.fileIndex].generic_u8string());
+			});
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			for (PendingFile& pendingFile : pendingFiles)
+			{
+				if (pendingFile.checksum.IsEmpty())
+					continue;
+
+				fileHashes[pendingFile.fileIndex] = FileHash{ pendingFile.checksum, pendingFile.size };
+
+				Entry& entry = m_entries[std::move(pendingFile.key)];
+				entry.checksum = std::move(pendingFile.checksum);
+				entry.modificationTime = pendingFile.modificationTime;
+				entry.size = pendingFile.size;
+			}
+
+			m_isModified = true;
+		}
+
+		if (statistics)
+		{
+			statistics->hashedFileCount += pendingFiles.size();
+			statistics->cachedFileCount += filePaths.size() - pendingFiles.size();
+			for (const PendingFile& pendingFile : pendingFiles)
+				statistics->hashedByteCount += pendingFile.size;
+		}
+
+		return fileHashes;
+	}
+
+	/*!
+	* \brief Loads entries from the manifest file, if it exists
+	*
+	* \return False if the manifest exists but couldn't be read
+	*/
+	bool FileHashCache::Load()
+	{
+		if (m_manifestPath.empty() || !std::filesystem::is_regular_file(m_manifestPath))
+			return true;
+
+		std::ifstream file(m_manifestPath);
+		if (!file)
+			return false;
+
+		try
+		{
+			nlohmann::json manifest = nlohmann::json::parse(file);
+			if (manifest.value("version", 0U) != ManifestVersion)
+				return false;
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			for (auto&& [path, entryDoc] : manifest["files"].items())
+			{
+				std::optional<Nz::ByteArray> checksum = FromHex(entryDoc["sha1"].get<std::string>());
+				if (!checksum)
+					continue;
+
+				Entry& entry = m_entries[path];
+				entry.checksum = std::move(*checksum);
+				entry.modificationTime = entryDoc["mtime"];
+				entry.size = entryDoc["size"];
+			}
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	/*!
+	* \brief Writes entries to the manifest file, if they changed since last load/save
+	*/
+	bool FileHashCache::Save()
+	{
+		if (m_manifestPath.empty())
+			return true;
+
+		// Keep the lock while writing, as multiple matches may share this cache
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (!m_isModified)
+			return true;
+
+		nlohmann::json files = nlohmann::json::object();
+		for (auto&& [path, entry] : m_entries)
+		{
+			nlohmann::json& entryDoc = files[path];
+			entryDoc["mtime"] = entry.modificationTime;
+			entryDoc["sha1"] = ToHex(entry.checksum);
+			entryDoc["size"] = entry.size;
+		}
+
+		nlohmann::json manifest;
+		manifest["files"] = std::move(files);
+		manifest["version"] = ManifestVersion;
+
+		std::ofstream file(m_manifestPath, std::ios::trunc);
+		if (!file)
+			return false;
+
+		file << manifest.dump(1, '\t');
+		if (!file.good())
+			return false;
+
+		m_isModified = false;
+		return true;
+	}
+}
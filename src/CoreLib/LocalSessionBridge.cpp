@@ -2,10 +2,10 @@
 // This file is part of the "Burgwar" project
 // For conditions of distribution and use, see copyright notice in LICENSE
 
-#include <ClientLib/LocalSessionBridge.hpp>
+#include <CoreLib/LocalSessionBridge.hpp>
 #include <CoreLib/BurgApp.hpp>
+#include <CoreLib/LocalSessionManager.hpp>
 #include <CoreLib/Match.hpp>
-#include <ClientLib/LocalSessionManager.hpp>
 
 namespace bw
 {
@@ -19,6 +19,7 @@ namespace bw
 		m_lastReceiveTime = app.GetAppTime();
 
 		m_sessionInfo.ping = 0;
+		m_sessionInfo.reliableBytesInFlight = 0; //< Packets are handed over directly
 		m_sessionInfo.totalByteReceived = 0;
 		m_sessionInfo.totalByteSent = 0;
 		m_sessionInfo.totalPacketLost = 0;
@@ -60,13 +61,13 @@ namespace bw
 		callback(m_sessionInfo);
 	}
 
-	void LocalSessionBridge::SendPacket(Nz::UInt8 /*channelId*/, Nz::ENetPacketFlags /*flags*/, Nz::NetPacket&& packet)
+	void LocalSessionBridge::SendPacket(Nz::UInt8 /*channelId*/, Nz::ENetPacketFlags /*flags*/, const Nz::NetPacket& packet)
 	{
 		assert(IsConnected());
 
 		m_sessionInfo.totalByteSent += packet.GetDataSize();
 		m_sessionInfo.totalPacketSent++;
 
-		m_sessionManager.SendPacket(m_peerId, std::move(packet), m_isServer);
+		m_sessionManager.SendPacket(m_peerId, Nz::NetPacket(packet.GetNetCode(), packet.GetConstData() + Nz::NetPacket::HeaderSize, packet.GetDataSize()), m_isServer);
 	}
 }
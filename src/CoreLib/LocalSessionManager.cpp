@@ -2,8 +2,8 @@
 // This file is part of the "Burgwar" project
 // For conditions of distribution and use, see copyright notice in LICENSE
 
-#include <ClientLib/LocalSessionManager.hpp>
-#include <ClientLib/LocalSessionBridge.hpp>
+#include <CoreLib/LocalSessionManager.hpp>
+#include <CoreLib/LocalSessionBridge.hpp>
 #include <CoreLib/Match.hpp>
 #include <CoreLib/MatchSessions.hpp>
 #include <CoreLib/LogSystem/Logger.hpp>
@@ -0,0 +1,207 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/LogSystem/AsyncSink.hpp>
+#include <CoreLib/LogSystem/LogContext.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace bw
+{
+	namespace
+	{
+		// Upper bound on the writer latency in case a wake up is missed
+		constexpr std::chrono::milliseconds MaxSleepTime(50);
+
+		// Number of times the writer checks for new messages before going to sleep, waking it up is much more expensive than a message
+		constexpr unsigned int SpinCount = 100;
+	}
+
+	AsyncSink::AsyncSink(std::vector<std::shared_ptr<LogSink>> sinks, std::size_t capacity, OverflowPolicy overflowPolicy) :
+	m_writeIndex(0),
+	m_readIndex(0),
+	m_droppedMessageCount(0),
+	m_isWriterSleeping(false),
+	m_running(true),
+	m_sinks(std::move(sinks)),
+	m_lastElapsedTime(0.f),
+	m_reportedDroppedMessageCount(0),
+	m_overflowPolicy(overflowPolicy)
+	{
+		assert(std::find(m_sinks.begin(), m_sinks.end(), nullptr) == m_sinks.end());
+
+		// Round capacity to a power of two so indices can be wrapped with a mask
+		std::size_t roundedCapacity = 2;
+		while (roundedCapacity < capacity)
+			roundedCapacity *= 2;
+
+		m_capacityMask = roundedCapacity - 1;
+
+		m_entries = std::make_unique<Entry[]>(roundedCapacity);
+		for (std::size_t i = 0; i < roundedCapacity; ++i)
+			m_entries[i].sequence.store(i, std::memory_order_relaxed);
+
+		m_writerThread = std::thread(&AsyncSink::WriterThread, this);
+	}
+
+	AsyncSink::~AsyncSink()
+	{
+		m_running.store(false, std::memory_order_relaxed);
+		WakeUp();
+
+		// Writer thread flushes remaining messages before exiting
+		m_writerThread.join();
+	}
+
+	void AsyncSink::Write(const LogContext& context, std::string_view content)
+	{
+		if (!TryPush(context, content))
+		{
+			if (m_overflowPolicy == OverflowPolicy::Drop)
+			{
+				m_droppedMessageCount.fetch_add(1, std::memory_order_relaxed);
+				if (m_isWriterSleeping.load(std::memory_order_relaxed))
+					WakeUp();
+
+				return;
+			}
+
+			do
+			{
+				WakeUp();
+				std::this_thread::yield();
+			}
+			while (!TryPush(context, content));
+		}
+
+		// Pairs with the fence in WriterThread: either we see the writer sleeping or it sees our message
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_isWriterSleeping.load(std::memory_order_relaxed))
+			WakeUp();
+	}
+
+	bool AsyncSink::FlushEntries()
+	{
+		LogContext context;
+		bool hasWritten = false;
+		for (;;)
+		{
+			Entry& entry = m_entries[m_readIndex & m_capacityMask];
+			if (entry.sequence.load(std::memory_order_acquire) != m_readIndex + 1)
+				break;
+
+			context.elapsedTime = entry.elapsedTime;
+			context.level = entry.level;
+			context.side = entry.side;
+
+			for (const auto& sinkPtr : m_sinks)
+				sinkPtr->Write(context, entry.content);
+
+			m_lastElapsedTime = entry.elapsedTime;
+
+			// Give the entry back to producers for the next lap
+			entry.sequence.store(m_readIndex + m_capacityMask + 1, std::memory_order_release);
+			m_readIndex++;
+
+			hasWritten = true;
+		}
+
+		Nz::UInt64 droppedMessageCount = m_droppedMessageCount.load(std::memory_order_relaxed);
+		if (droppedMessageCount != m_reportedDroppedMessageCount)
+		{
+			// Dropped messages have no context of their own, report them at the time of the last written message
+			context.elapsedTime = m_lastElapsedTime;
+			context.level = LogLevel::Warning;
+			context.side = LogSide::Irrelevant;
+
+			std::string warning = fmt::format("{0} log message(s) dropped because the log buffer was full", droppedMessageCount - m_reportedDroppedMessageCount);
+			for (const auto& sinkPtr : m_sinks)
+				sinkPtr->Write(context, warning);
+
+			m_reportedDroppedMessageCount = droppedMessageCount;
+
+			hasWritten = true;
+		}
+
+		return hasWritten;
+	}
+
+	bool AsyncSink::HasPendingEntry() const
+	{
+		const Entry& entry = m_entries[m_readIndex & m_capacityMask];
+		return entry.sequence.load(std::memory_order_acquire) == m_readIndex + 1;
+	}
+
+	/*!
+	* \brief Reserves an entry and copies the message in it (bounded multi-producer queue, producers only contend on the write index)
+	*
+	* \return False if the buffer is full
+	*/
+	bool AsyncSink::TryPush(const LogContext& context, std::string_view content)
+	{
+		std::size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Entry& entry = m_entries[writeIndex & m_capacityMask];
+			std::size_t sequence = entry.sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(writeIndex);
+			if (diff == 0)
+			{
+				if (m_writeIndex.compare_exchange_weak(writeIndex, writeIndex + 1, std::memory_order_relaxed))
+				{
+					entry.content.assign(content.data(), content.size());
+					entry.elapsedTime = context.elapsedTime;
+					entry.level = context.level;
+					entry.side = context.side;
+
+					entry.sequence.store(writeIndex + 1, std::memory_order_release);
+					return true;
+				}
+				// compare_exchange_weak updated writeIndex on failure
+			}
+			else if (diff < 0)
+				return false; //< Entry from the previous lap has not been written yet, buffer is full
+			else
+				writeIndex = m_writeIndex.load(std::memory_order_relaxed); //< Another producer took this entry
+		}
+	}
+
+	void AsyncSink::WakeUp()
+	{
+		std::unique_lock<std::mutex> lock(m_wakeUpMutex);
+		m_wakeUpSignal.notify_one();
+	}
+
+	void AsyncSink::WriterThread()
+	{
+		unsigned int idleCount = 0;
+		while (m_running.load(std::memory_order_relaxed))
+		{
+			if (FlushEntries())
+			{
+				idleCount = 0;
+				continue;
+			}
+
+			if (++idleCount < SpinCount)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			idleCount = 0;
+
+			std::unique_lock<std::mutex> lock(m_wakeUpMutex);
+			m_isWriterSleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			m_wakeUpSignal.wait_for(lock, MaxSleepTime, [&] { return !m_running.load(std::memory_order_relaxed) || HasPendingEntry(); });
+			m_isWriterSleeping.store(false, std::memory_order_relaxed);
+		}
+
+		FlushEntries();
+	}
+}
@@ -0,0 +1,25 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/LogSystem/Enums.hpp>
+
+namespace bw
+{
+	const char* ToString(LogLevel level)
+	{
+		switch (level)
+		{
+			case LogLevel::Debug:
+				return "DEBG";
+			case LogLevel::Info:
+				return "INFO";
+			case LogLevel::Warning:
+				return "WARN";
+			case LogLevel::Error:
+				return "ERR.";
+		}
+
+		return "<Unhandled>";
+	}
+}
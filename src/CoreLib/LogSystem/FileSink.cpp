@@ -0,0 +1,94 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/LogSystem/FileSink.hpp>
+#include <CoreLib/LogSystem/LogContext.hpp>
+#include <string>
+
+namespace bw
+{
+	/*!
+	* \brief Appends messages to a file
+	*
+	* \param maxFileSize Size (in bytes) after which the file is rotated, zero to let the file grow indefinitely
+	* \param maxBackupCount Number of rotated files to keep (file.1 being the most recent), zero to truncate the file instead
+	*/
+	FileSink::FileSink(std::filesystem::path filePath, Nz::UInt64 maxFileSize, std::size_t maxBackupCount) :
+	m_filePath(std::move(filePath)),
+	m_maxBackupCount(maxBackupCount),
+	m_fileSize(0),
+	m_maxFileSize(maxFileSize)
+	{
+		if (m_filePath.has_parent_path())
+		{
+			std::error_code ec;
+			std::filesystem::create_directories(m_filePath.parent_path(), ec);
+		}
+
+		Open();
+	}
+
+	void FileSink::Write(const LogContext& context, std::string_view content)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		if (!m_file.is_open())
+			return;
+
+		// "[LEVL] " + content + '\n'
+		Nz::UInt64 lineSize = 7 + content.size() + 1;
+		if (m_maxFileSize > 0 && m_fileSize > 0 && m_fileSize + lineSize > m_maxFileSize)
+		{
+			Rotate();
+			if (!m_file.is_open())
+				return;
+		}
+
+		m_file << '[' << ToString(context.level) << "] ";
+		m_file.write(content.data(), content.size());
+		m_file << '\n';
+
+		// Make sure errors end up on disk even if the process crashes right after
+		if (context.level >= LogLevel::Warning)
+			m_file.flush();
+
+		m_fileSize += lineSize;
+	}
+
+	void FileSink::Open()
+	{
+		m_file.open(m_filePath, std::ios::out | std::ios::app | std::ios::binary);
+
+		std::error_code ec;
+		std::uintmax_t fileSize = std::filesystem::file_size(m_filePath, ec);
+		m_fileSize = (!ec) ? fileSize : 0;
+	}
+
+	void FileSink::Rotate()
+	{
+		m_file.close();
+
+		std::error_code ec;
+		if (m_maxBackupCount > 0)
+		{
+			auto BackupPath = [&](std::size_t index)
+			{
+				std::filesystem::path backupPath = m_filePath;
+				backupPath += "." + std::to_string(index);
+
+				return backupPath;
+			};
+
+			// file.(n-1) => file.n, ..., file => file.1 (rename replaces the oldest backup)
+			for (std::size_t i = m_maxBackupCount; i > 1; --i)
+				std::filesystem::rename(BackupPath(i - 1), BackupPath(i), ec);
+
+			std::filesystem::rename(m_filePath, BackupPath(1), ec);
+		}
+		else
+			std::filesystem::remove(m_filePath, ec);
+
+		Open();
+	}
+}
@@ -5,12 +5,20 @@
 #include <CoreLib/LogSystem/Logger.hpp>
 #include <CoreLib/BurgApp.hpp>
 #include <CoreLib/LogSystem/LogSink.hpp>
-#include <array>
-#include <charconv>
-#include <sstream>
 
 namespace bw
 {
+	bool Logger::IsLevelEnabled(LogLevel level) const
+	{
+		if (level < m_minimumLogLevel)
+			return false;
+
+		if (m_logParent && !m_logParent->IsLevelEnabled(level))
+			return false;
+
+		return true;
+	}
+
 	void Logger::Log(const LogContext& context, std::string content) const
 	{
 		OverrideContent(context, content);
@@ -50,51 +58,22 @@ namespace bw
 
 	void Logger::OverrideContent(const LogContext& context, std::string& content) const
 	{
-#ifdef _MSC_VER
-		auto TimePart = [](float elapsedTime) -> std::string
-		{
-			std::array<char, 40> buffer;
-			buffer[0] = '[';
-
-			auto result = std::to_chars(buffer.data() + 1, buffer.data() + buffer.size() - 2, elapsedTime, std::chars_format::fixed, 3);
-			assert(result.ec == std::errc{});
-
-			*result.ptr = ']';
-
-			return std::string(buffer.data(), result.ptr - buffer.data() + 1);
-		};
-#else
-		// libstdc++ doesn't support std::to_chars for floating-point values :(
-
-		auto TimePart = [](float elapsedTime) -> std::string
-		{
-			std::stringstream ss;
-			ss.setf(std::ios::fixed, std::ios::floatfield);
-			ss.precision(3);
-
-			ss << '[';
-			ss << elapsedTime;
-			ss << ']';
-
-			return ss.str();
-		};
-#endif
 		switch (context.side)
 		{
 			case LogSide::Irrelevant:
-				content = TimePart(context.elapsedTime) + content;
+				content = fmt::format("[{:.3f}]{}", context.elapsedTime, content);
 				break;
 
 			case LogSide::Client:
-				content = TimePart(context.elapsedTime) + " [C] " + content;
+				content = fmt::format("[{:.3f}] [C] {}", context.elapsedTime, content);
 				break;
 
 			case LogSide::Editor:
-				content = TimePart(context.elapsedTime) + " [E] " + content;
+				content = fmt::format("[{:.3f}] [E] {}", context.elapsedTime, content);
 				break;
 
 			case LogSide::Server:
-				content = TimePart(context.elapsedTime) + " [S] " + content;
+				content = fmt::format("[{:.3f}] [S] {}", context.elapsedTime, content);
 				break;
 
 			default:
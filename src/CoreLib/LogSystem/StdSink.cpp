@@ -99,23 +99,6 @@ namespace bw
 
 		constexpr const char* ResetColorCode = "\033[0m";
 #endif
-
-		const char* ToString(LogLevel level)
-		{
-			switch (level)
-			{
-				case LogLevel::Debug:
-					return "DEBG";
-				case LogLevel::Info:
-					return "INFO";
-				case LogLevel::Warning:
-					return "WARN";
-				case LogLevel::Error:
-					return "ERR.";
-			}
-
-			return "<Unhandled>";
-		}
 	}
 
 	void StdSink::Write(const LogContext& context, std::string_view content)
@@ -6,14 +6,22 @@
 #include <CoreLib/Protocol/CompressedInteger.hpp>
 #include <CoreLib/Version.hpp>
 #include <CoreLib/Utils.hpp>
+#include <CoreLib/Utility/WorkerPool.hpp>
 #include <Nazara/Core/Bitset.hpp>
 #include <Nazara/Core/ByteStream.hpp>
+#include <Nazara/Core/Endianness.hpp>
 #include <Nazara/Core/ErrorFlags.hpp>
 #include <Nazara/Core/File.hpp>
 #include <Nazara/Math/Rect.hpp>
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
 #include <stdexcept>
+#include <string_view>
+#include <thread>
 
 namespace Nz
 {
@@ -101,61 +109,269 @@ namespace Nz
 
 namespace bw
 {
-	constexpr Nz::UInt16 MapFileVersion = 1;
+	namespace
+	{
+		/*
+		* Map file versions:
+		* 1: sequential stream, every string is stored inline
+		* 2: indexed format, strings are stored once in a string table and referenced by index
+		*
+		* v2 layout (little endian, offsets are relative to the beginning of the file):
+		* - header: signature, version, game version, offset and count of the layer/asset/string tables, map info strings
+		* - for each layer: entity records, property records and property values
+		* - layer table: a LayerRecordSize record per layer, pointing to its entity/property/value ranges
+		* - asset table: an AssetRecordSize record per asset
+		* - string table: a StringRecordSize record (offset, size) per string, followed by string contents
+		*
+		* Records have a fixed size so any layer, entity or property can be located without decoding the rest of the file,
+		* the whole file can be loaded (or mapped) as is and layers decoded independently.
+		*/
+		constexpr Nz::UInt16 MapFileVersion = 2;
+
+		constexpr std::size_t SignatureSize = 8;
+		constexpr std::size_t HeaderPrefixSize = SignatureSize + sizeof(Nz::UInt16); //< signature + version, common to all versions
+
+		constexpr std::size_t AssetRecordSize = 4 + 4 + 8 + Map::Asset::ChecksumSize + 4;
+		constexpr std::size_t EntityRecordSize = 8 + 4 + 4 + 4 + 4 + 4 + 4 + 4;
+		constexpr std::size_t LayerRecordSize = 4 + 4 + 4 + 4 + 4 + 4 + 4 + 4;
+		constexpr std::size_t PropertyRecordSize = 4 + 1 + 1 + 2 + 4 + 4;
+		constexpr std::size_t StringRecordSize = 4 + 4;
+
+		// Below this entity count, spawning threads costs more than decoding layers sequentially
+		constexpr std::size_t ParallelDecodingThreshold = 4096;
+
+		template<typename T>
+		void ToLittleEndian(T& value)
+		{
+			if (Nz::GetPlatformEndianness() != Nz::Endianness_LittleEndian)
+				Nz::SwapBytes(&value, sizeof(T));
+		}
+
+		class BinaryReader
+		{
+			public:
+				BinaryReader(const std::vector<Nz::UInt8>& content, std::size_t offset = 0) :
+				m_content(content),
+				m_offset(offset)
+				{
+				}
+
+				void Read(void* buffer, std::size_t size)
+				{
+					if (size > m_content.size() || m_offset > m_content.size() - size)
+						throw std::runtime_error("corrupted map file (out of bounds read)");
+
+					std::memcpy(buffer, &m_content[m_offset], size);
+					m_offset += size;
+				}
+
+				template<typename T>
+				T Read()
+				{
+					T value;
+					Read(&value, sizeof(T));
+					ToLittleEndian(value);
+
+					return value;
+				}
+
+				void Skip(std::size_t size)
+				{
+					m_offset += size;
+				}
+
+			private:
+				const std::vector<Nz::UInt8>& m_content;
+				std::size_t m_offset;
+		};
+
+		class BinaryWriter
+		{
+			public:
+				BinaryWriter() = default;
+
+				void Append(const BinaryWriter& writer)
+				{
+					m_content.insert(m_content.end(), writer.m_content.begin(), writer.m_content.end());
+				}
+
+				const std::vector<Nz::UInt8>& GetContent() const
+				{
+					return m_content;
+				}
+
+				std::size_t GetOffset() const
+				{
+					return m_content.size();
+				}
+
+				void Write(const void* buffer, std::size_t size)
+				{
+					const Nz::UInt8* bytes = static_cast<const Nz::UInt8*>(buffer);
+					m_content.insert(m_content.end(), bytes, bytes + size);
+				}
+
+				template<typename T>
+				void Write(T value)
+				{
+					ToLittleEndian(value);
+					Write(&value, sizeof(T));
+				}
+
+				template<typename T>
+				void WriteAt(std::size_t offset, T value)
+				{
+					assert(offset + sizeof(T) <= m_content.size());
+
+					ToLittleEndian(value);
+					std::memcpy(&m_content[offset], &value, sizeof(T));
+				}
+
+			private:
+				std::vector<Nz::UInt8> m_content;
+		};
+
+		class StringTableBuilder
+		{
+			public:
+				StringTableBuilder() = default;
+
+				const std::vector<std::string>& GetStrings() const
+				{
+					return m_strings;
+				}
+
+				Nz::UInt32 Register(const std::string& str)
+				{
+					auto it = m_indices.find(str);
+					if (it != m_indices.end())
+						return it->second;
+
+					Nz::UInt32 index = Nz::UInt32(m_strings.size());
+					m_indices.emplace(str, index);
+					m_strings.push_back(str);
+
+					return index;
+				}
+
+			private:
+				tsl::hopscotch_map<std::string, Nz::UInt32> m_indices;
+				std::vector<std::string> m_strings;
+		};
+
+		template<typename T>
+		void WritePropertyValue(BinaryWriter& writer, StringTableBuilder& strings, const T& value)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+				writer.Write<Nz::UInt8>((value) ? 1 : 0);
+			else if constexpr (std::is_same_v<T, std::string>)
+				writer.Write<Nz::UInt32>(strings.Register(value));
+			else if constexpr (std::is_arithmetic_v<T>)
+				writer.Write<T>(value);
+			else
+			{
+				// Vectors
+				using ComponentType = std::decay_t<decltype(value.x)>;
+				const ComponentType* components = value;
+				for (std::size_t i = 0; i < sizeof(T) / sizeof(ComponentType); ++i)
+					writer.Write<ComponentType>(components[i]);
+			}
+		}
+
+		template<typename T, typename F>
+		T ReadPropertyValue(BinaryReader& reader, F&& getString)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+				return reader.Read<Nz::UInt8>() != 0;
+			else if constexpr (std::is_same_v<T, std::string>)
+				return std::string(getString(reader.Read<Nz::UInt32>()));
+			else if constexpr (std::is_arithmetic_v<T>)
+				return reader.Read<T>();
+			else
+			{
+				// Vectors
+				T value;
+
+				using ComponentType = std::decay_t<decltype(value.x)>;
+				ComponentType* components = value;
+				for (std::size_t i = 0; i < sizeof(T) / sizeof(ComponentType); ++i)
+					components[i] = reader.Read<ComponentType>();
+
+				return value;
+			}
+		}
+	}
 
 	bool Map::Compile(const std::filesystem::path& outputPath)
 	{
-		Nz::File infoFile(outputPath.generic_u8string(), Nz::OpenMode_WriteOnly | Nz::OpenMode_Truncate);
-		if (!infoFile.IsOpen())
-			return false;
+		BinaryWriter writer;
+		StringTableBuilder strings;
+
+		writer.Write("Burgrmap", SignatureSize);
+		writer.Write<Nz::UInt16>(MapFileVersion);
+		writer.Write<Nz::UInt16>(0); //< reserved
 
-		Nz::ByteStream stream(&infoFile);
-		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+		// Game version (for debugging purpose)
+		writer.Write<Nz::UInt32>(BURGWAR_VERSION);
 
-		stream.Write("Burgrmap", 8);
-		stream << MapFileVersion;
+		// Table offsets and counts are known once everything has been written
+		std::size_t tableHeaderOffset = writer.GetOffset();
+		for (std::size_t i = 0; i < 6; ++i)
+			writer.Write<Nz::UInt32>(0);
 
 		// Map header
-		stream << m_mapInfo.name << m_mapInfo.author << m_mapInfo.description;
+		writer.Write<Nz::UInt32>(strings.Register(m_mapInfo.name));
+		writer.Write<Nz::UInt32>(strings.Register(m_mapInfo.author));
+		writer.Write<Nz::UInt32>(strings.Register(m_mapInfo.description));
 
-		// Game version
-		stream << BURGWAR_VERSION;
+		struct LayerRecord
+		{
+			Nz::UInt32 entityOffset;
+			Nz::UInt32 propertyOffset;
+			Nz::UInt32 propertyCount;
+			Nz::UInt32 valueOffset;
+			Nz::UInt32 valueSize;
+		};
 
-		// Map layers
-		CompressedUnsigned<Nz::UInt16> layerCount(Nz::UInt16(m_layers.size()));
-		stream << layerCount;
+		std::vector<LayerRecord> layerRecords;
+		layerRecords.reserve(m_layers.size());
 
+		BinaryWriter properties;
+		BinaryWriter values;
 		for (const Layer& layer : m_layers)
 		{
-			stream << layer.name;
-			stream << layer.backgroundColor;
+			LayerRecord& layerRecord = layerRecords.emplace_back();
+			layerRecord.entityOffset = Nz::UInt32(writer.GetOffset());
 
-			CompressedUnsigned<Nz::UInt16> entityCount(Nz::UInt16(layer.entities.size()));
-			stream << entityCount;
+			properties = BinaryWriter{};
+			values = BinaryWriter{};
 
+			Nz::UInt32 propertyIndex = 0;
 			for (const Entity& entity : layer.entities)
 			{
-				stream << entity.entityType;
-				stream << entity.name;
-				stream << entity.position.x << entity.position.y;
-				stream << entity.rotation.ToDegrees();
-
-				CompressedSigned<EntityId> compressedUniqueId(entity.uniqueId);
-				stream << compressedUniqueId;
+				writer.Write<Nz::Int64>(entity.uniqueId);
+				writer.Write<Nz::UInt32>(strings.Register(entity.entityType));
+				writer.Write<Nz::UInt32>(strings.Register(entity.name));
+				writer.Write<float>(entity.position.x);
+				writer.Write<float>(entity.position.y);
+				writer.Write<float>(entity.rotation.ToDegrees());
+				writer.Write<Nz::UInt32>(propertyIndex);
+				writer.Write<Nz::UInt32>(Nz::UInt32(entity.properties.size()));
 
-				CompressedUnsigned<Nz::UInt16> propertyCount(Nz::UInt16(entity.properties.size()));
-				stream << propertyCount;
+				propertyIndex += Nz::UInt32(entity.properties.size());
 
 				for (const auto& [key, value] : entity.properties)
 				{
-					stream << key;
-
 					auto [P, isArray] = ExtractPropertyType(value);
 
-					Nz::UInt8 propertyType = Nz::UInt8(P);
-					stream << propertyType;
+					properties.Write<Nz::UInt32>(strings.Register(key));
+					properties.Write<Nz::UInt8>(Nz::UInt8(P));
+					properties.Write<Nz::UInt8>((isArray) ? 1 : 0);
+					properties.Write<Nz::UInt16>(0); //< reserved
 
-					stream << isArray;
+					std::size_t elementCountOffset = properties.GetOffset();
+					properties.Write<Nz::UInt32>(0);
+					properties.Write<Nz::UInt32>(Nz::UInt32(values.GetOffset()));
 
 					std::visit([&](auto&& propertyValue)
 					{
@@ -165,43 +381,92 @@ namespace bw
 
 						if constexpr (IsArray)
 						{
-							CompressedUnsigned<Nz::UInt32> arraySize(Nz::UInt32(propertyValue.size()));
-
-							stream << arraySize;
+							properties.WriteAt<Nz::UInt32>(elementCountOffset, Nz::UInt32(propertyValue.size()));
 							for (const auto& element : propertyValue)
-								stream << element;
+								WritePropertyValue(values, strings, element);
 						}
 						else
-							stream << propertyValue.value;
+						{
+							properties.WriteAt<Nz::UInt32>(elementCountOffset, 1);
+							WritePropertyValue(values, strings, propertyValue.value);
+						}
 
 					}, value);
 				}
 			}
-		}
-
-		CompressedUnsigned<Nz::UInt32> empty(0);
-		stream << empty;
 
-		// Scripts (TODO)
-		/*std::vector<std::string> scripts;
+			layerRecord.propertyOffset = Nz::UInt32(writer.GetOffset());
+			layerRecord.propertyCount = propertyIndex;
+			writer.Append(properties);
 
-		for (const auto& scriptPath : std::filesystem::recursive_directory_iterator(m_mapPath / "scripts"))
-			scripts.emplace_back(scriptPath.path().generic_u8string());
+			layerRecord.valueOffset = Nz::UInt32(writer.GetOffset());
+			layerRecord.valueSize = Nz::UInt32(values.GetOffset());
+			writer.Append(values);
+		}
 
-		Nz::UInt32 scriptCount = Nz::UInt32(scripts.size());*/
+		// Layer table
+		std::size_t layerTableOffset = writer.GetOffset();
+		for (std::size_t i = 0; i < m_layers.size(); ++i)
+		{
+			const Layer& layer = m_layers[i];
+			const LayerRecord& layerRecord = layerRecords[i];
+
+			writer.Write<Nz::UInt32>(strings.Register(layer.name));
+			writer.Write<Nz::UInt8>(layer.backgroundColor.r);
+			writer.Write<Nz::UInt8>(layer.backgroundColor.g);
+			writer.Write<Nz::UInt8>(layer.backgroundColor.b);
+			writer.Write<Nz::UInt8>(layer.backgroundColor.a);
+			writer.Write<Nz::UInt32>(layerRecord.entityOffset);
+			writer.Write<Nz::UInt32>(Nz::UInt32(layer.entities.size()));
+			writer.Write<Nz::UInt32>(layerRecord.propertyOffset);
+			writer.Write<Nz::UInt32>(layerRecord.propertyCount);
+			writer.Write<Nz::UInt32>(layerRecord.valueOffset);
+			writer.Write<Nz::UInt32>(layerRecord.valueSize);
+		}
 
 		// Assets
-		CompressedUnsigned<Nz::UInt32> assetCount(Nz::UInt32(m_assets.size()));
-		stream << assetCount;
-
+		std::size_t assetTableOffset = writer.GetOffset();
 		for (const Asset& asset : m_assets)
 		{
-			stream << asset.filepath;
-			stream << asset.size;
-			stream.Write(asset.sha1Checksum.data(), asset.sha1Checksum.size());
+			writer.Write<Nz::UInt32>(strings.Register(asset.filepath));
+			writer.Write<Nz::UInt32>(0); //< reserved
+			writer.Write<Nz::UInt64>(asset.size);
+			writer.Write(asset.sha1Checksum.data(), asset.sha1Checksum.size());
+			writer.Write<Nz::UInt32>(0); //< reserved
 		}
 
-		return true;
+		// String table (must be last as every other part registers strings)
+		const std::vector<std::string>& stringList = strings.GetStrings();
+
+		std::size_t stringTableOffset = writer.GetOffset();
+		std::size_t stringOffset = stringTableOffset + stringList.size() * StringRecordSize;
+		for (const std::string& str : stringList)
+		{
+			writer.Write<Nz::UInt32>(Nz::UInt32(stringOffset));
+			writer.Write<Nz::UInt32>(Nz::UInt32(str.size()));
+
+			stringOffset += str.size();
+		}
+
+		for (const std::string& str : stringList)
+			writer.Write(str.data(), str.size());
+
+		if (writer.GetOffset() > std::numeric_limits<Nz::UInt32>::max())
+			return false;
+
+		writer.WriteAt<Nz::UInt32>(tableHeaderOffset + 0 * sizeof(Nz::UInt32), Nz::UInt32(layerTableOffset));
+		writer.WriteAt<Nz::UInt32>(tableHeaderOffset + 1 * sizeof(Nz::UInt32), Nz::UInt32(m_layers.size()));
+		writer.WriteAt<Nz::UInt32>(tableHeaderOffset + 2 * sizeof(Nz::UInt32), Nz::UInt32(assetTableOffset));
+		writer.WriteAt<Nz::UInt32>(tableHeaderOffset + 3 * sizeof(Nz::UInt32), Nz::UInt32(m_assets.size()));
+		writer.WriteAt<Nz::UInt32>(tableHeaderOffset + 4 * sizeof(Nz::UInt32), Nz::UInt32(stringTableOffset));
+		writer.WriteAt<Nz::UInt32>(tableHeaderOffset + 5 * sizeof(Nz::UInt32), Nz::UInt32(stringList.size()));
+
+		Nz::File mapFile(outputPath.generic_u8string(), Nz::OpenMode_WriteOnly | Nz::OpenMode_Truncate);
+		if (!mapFile.IsOpen())
+			return false;
+
+		const std::vector<Nz::UInt8>& content = writer.GetContent();
+		return mapFile.Write(content.data(), content.size()) == content.size();
 	}
 
 	void Map::RebuildEntityIndices()
@@ -448,24 +713,43 @@ namespace bw
 		if (!infoFile.IsOpen())
 			throw std::runtime_error("failed to open map file");
 
-		Nz::ErrorFlags errFlags(Nz::ErrorFlag_ThrowException);
+		// Load the whole file at once, v2 decoding works directly on it
+		std::vector<Nz::UInt8> content(infoFile.GetSize());
+		if (infoFile.Read(content.data(), content.size()) != content.size())
+			throw std::runtime_error("failed to read map file");
 
-		Nz::ByteStream stream(&infoFile);
-		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+		infoFile.Close();
 
-		std::array<char, 8> signature;
-		if (stream.Read(signature.data(), signature.size()) != signature.size())
+		if (content.size() < HeaderPrefixSize)
 			throw std::runtime_error("Corrupted map file (or not a burger map file)");
 
-		if (std::memcmp(signature.data(), "Burgrmap", signature.size()) != 0)
+		if (std::memcmp(content.data(), "Burgrmap", SignatureSize) != 0)
 			throw std::runtime_error("Not a valid burger map file");
 
-		Nz::UInt16 fileVersion;
-		stream >> fileVersion;
-
+		Nz::UInt16 fileVersion = BinaryReader(content, SignatureSize).Read<Nz::UInt16>();
 		if (fileVersion > MapFileVersion)
 			throw std::runtime_error("Unhandled file version (more recent than game)");
 
+		if (fileVersion >= 2)
+			LoadFromBinaryV2(content);
+		else
+		{
+			Nz::ErrorFlags errFlags(Nz::ErrorFlag_ThrowException);
+
+			Nz::ByteStream stream(content.data() + HeaderPrefixSize, content.size() - HeaderPrefixSize);
+			stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+			LoadFromBinaryV1(stream, fileVersion);
+		}
+
+		RebuildEntityIndices();
+		Sanitize();
+
+		m_isValid = true;
+	}
+
+	void Map::LoadFromBinaryV1(Nz::ByteStream& stream, Nz::UInt16 fileVersion)
+	{
 		// Map header
 		stream >> m_mapInfo.name >> m_mapInfo.author >> m_mapInfo.description;
 
@@ -577,11 +861,217 @@ namespace bw
 			stream >> asset.size;
 			stream.Read(asset.sha1Checksum.data(), asset.sha1Checksum.size());
 		}
+	}
 
-		RebuildEntityIndices();
-		Sanitize();
+	void Map::LoadFromBinaryV2(const std::vector<Nz::UInt8>& content)
+	{
+		BinaryReader headerReader(content, HeaderPrefixSize);
+		headerReader.Skip(sizeof(Nz::UInt16)); //< reserved
 
-		m_isValid = true;
+		// For debugging purpose
+		Nz::UInt32 gameVersion = headerReader.Read<Nz::UInt32>();
+		NazaraUnused(gameVersion);
+
+		Nz::UInt32 layerTableOffset = headerReader.Read<Nz::UInt32>();
+		Nz::UInt32 layerCount = headerReader.Read<Nz::UInt32>();
+		Nz::UInt32 assetTableOffset = headerReader.Read<Nz::UInt32>();
+		Nz::UInt32 assetCount = headerReader.Read<Nz::UInt32>();
+		Nz::UInt32 stringTableOffset = headerReader.Read<Nz::UInt32>();
+		Nz::UInt32 stringCount = headerReader.Read<Nz::UInt32>();
+
+		if (layerCount > std::numeric_limits<LayerIndex>::max())
+			throw std::runtime_error("corrupted map file (too many layers)");
+
+		// Checking sizes before allocating protects against huge allocations from corrupted files
+		if (std::size_t(layerCount) * LayerRecordSize > content.size() || std::size_t(assetCount) * AssetRecordSize > content.size() || std::size_t(stringCount) * StringRecordSize > content.size())
+			throw std::runtime_error("corrupted map file (invalid table size)");
+
+		// Strings are referenced in place, they're only copied when assigned to the map
+		std::vector<std::string_view> strings(stringCount);
+
+		BinaryReader stringReader(content, stringTableOffset);
+		for (std::string_view& str : strings)
+		{
+			Nz::UInt32 offset = stringReader.Read<Nz::UInt32>();
+			Nz::UInt32 size = stringReader.Read<Nz::UInt32>();
+			if (offset > content.size() || size > content.size() - offset)
+				throw std::runtime_error("corrupted map file (invalid string)");
+
+			str = std::string_view(reinterpret_cast<const char*>(content.data()) + offset, size);
+		}
+
+		auto GetString = [&](Nz::UInt32 stringIndex) -> std::string_view
+		{
+			if (stringIndex >= strings.size())
+				throw std::runtime_error("corrupted map file (invalid string index)");
+
+			return strings[stringIndex];
+		};
+
+		// Map header
+		m_mapInfo.name = GetString(headerReader.Read<Nz::UInt32>());
+		m_mapInfo.author = GetString(headerReader.Read<Nz::UInt32>());
+		m_mapInfo.description = GetString(headerReader.Read<Nz::UInt32>());
+
+		struct LayerRecord
+		{
+			Nz::UInt32 entityOffset;
+			Nz::UInt32 entityCount;
+			Nz::UInt32 propertyOffset;
+			Nz::UInt32 propertyCount;
+			Nz::UInt32 valueOffset;
+			Nz::UInt32 valueSize;
+		};
+
+		std::vector<LayerRecord> layerRecords(layerCount);
+
+		m_layers.clear();
+		m_layers.resize(layerCount);
+
+		std::size_t totalEntityCount = 0;
+
+		BinaryReader layerReader(content, layerTableOffset);
+		for (std::size_t i = 0; i < layerCount; ++i)
+		{
+			Layer& layer = m_layers[i];
+			layer.name = GetString(layerReader.Read<Nz::UInt32>());
+			layer.backgroundColor.r = layerReader.Read<Nz::UInt8>();
+			layer.backgroundColor.g = layerReader.Read<Nz::UInt8>();
+			layer.backgroundColor.b = layerReader.Read<Nz::UInt8>();
+			layer.backgroundColor.a = layerReader.Read<Nz::UInt8>();
+
+			LayerRecord& layerRecord = layerRecords[i];
+			layerRecord.entityOffset = layerReader.Read<Nz::UInt32>();
+			layerRecord.entityCount = layerReader.Read<Nz::UInt32>();
+			layerRecord.propertyOffset = layerReader.Read<Nz::UInt32>();
+			layerRecord.propertyCount = layerReader.Read<Nz::UInt32>();
+			layerRecord.valueOffset = layerReader.Read<Nz::UInt32>();
+			layerRecord.valueSize = layerReader.Read<Nz::UInt32>();
+
+			if (std::size_t(layerRecord.entityCount) * EntityRecordSize > content.size() || std::size_t(layerRecord.propertyCount) * PropertyRecordSize > content.size())
+				throw std::runtime_error("corrupted map file (invalid layer)");
+
+			totalEntityCount += layerRecord.entityCount;
+		}
+
+		// Layers don't share anything but the (read-only) file content and string table, they can be decoded in parallel
+		std::vector<std::exception_ptr> layerErrors(layerCount);
+		auto DecodeLayer = [&](std::size_t layerIndex)
+		{
+			try
+			{
+				const LayerRecord& layerRecord = layerRecords[layerIndex];
+				Layer& layer = m_layers[layerIndex];
+
+				BinaryReader entityReader(content, layerRecord.entityOffset);
+
+				layer.entities.resize(layerRecord.entityCount);
+				for (Entity& entity : layer.entities)
+				{
+					entity.uniqueId = entityReader.Read<Nz::Int64>();
+					entity.entityType = GetString(entityReader.Read<Nz::UInt32>());
+					entity.name = GetString(entityReader.Read<Nz::UInt32>());
+					entity.position.x = entityReader.Read<float>();
+					entity.position.y = entityReader.Read<float>();
+					entity.rotation = Nz::DegreeAnglef::FromDegrees(entityReader.Read<float>());
+
+					Nz::UInt32 firstProperty = entityReader.Read<Nz::UInt32>();
+					Nz::UInt32 propertyCount = entityReader.Read<Nz::UInt32>();
+					if (firstProperty > layerRecord.propertyCount || propertyCount > layerRecord.propertyCount - firstProperty)
+						throw std::runtime_error("corrupted map file (invalid entity properties)");
+
+					entity.properties.reserve(propertyCount);
+
+					BinaryReader propertyReader(content, layerRecord.propertyOffset + std::size_t(firstProperty) * PropertyRecordSize);
+					for (std::size_t i = 0; i < propertyCount; ++i)
+					{
+						std::string_view propertyName = GetString(propertyReader.Read<Nz::UInt32>());
+						Nz::UInt8 propertyTypeInt = propertyReader.Read<Nz::UInt8>();
+						bool isArray = propertyReader.Read<Nz::UInt8>() != 0;
+						propertyReader.Skip(sizeof(Nz::UInt16)); //< reserved
+						Nz::UInt32 elementCount = propertyReader.Read<Nz::UInt32>();
+						Nz::UInt32 valueOffset = propertyReader.Read<Nz::UInt32>();
+
+						if (valueOffset > layerRecord.valueSize || elementCount > layerRecord.valueSize)
+							throw std::runtime_error("corrupted map file (invalid property value)");
+
+						BinaryReader valueReader(content, std::size_t(layerRecord.valueOffset) + valueOffset);
+
+						// Waiting for template lambda in C++20
+						auto Unserialize = [&](auto dummyType)
+						{
+							using T = std::decay_t<decltype(dummyType)>;
+
+							static constexpr PropertyType Property = T::Property;
+							using UnderlyingType = PropertyUnderlyingType_t<Property>;
+
+							if (isArray)
+							{
+								PropertyArrayValue<Property> elements(elementCount);
+								for (auto& element : elements)
+									element = ReadPropertyValue<UnderlyingType>(valueReader, GetString);
+
+								entity.properties.emplace(std::string(propertyName), std::move(elements));
+							}
+							else
+							{
+								PropertySingleValue<Property> value;
+								value.value = ReadPropertyValue<UnderlyingType>(valueReader, GetString);
+
+								entity.properties.emplace(std::string(propertyName), std::move(value));
+							}
+						};
+
+						switch (static_cast<PropertyType>(propertyTypeInt))
+						{
+#define BURGWAR_PROPERTYTYPE(V, T, IT) case PropertyType:: T: Unserialize(PropertyTag<PropertyType:: T>{}); break;
+
+#include <CoreLib/PropertyTypeList.hpp>
+
+							default:
+								throw std::runtime_error("corrupted map file (unknown property type " + std::to_string(propertyTypeInt) + ")");
+						}
+					}
+				}
+			}
+			catch (...)
+			{
+				layerErrors[layerIndex] = std::current_exception();
+			}
+		};
+
+		if (totalEntityCount >= ParallelDecodingThreshold && layerCount > 1)
+		{
+			std::size_t workerCount = std::min<std::size_t>(layerCount, std::max(std::thread::hardware_concurrency(), 1U)) - 1;
+
+			WorkerPool workerPool(workerCount);
+			workerPool.ParallelFor(layerCount, DecodeLayer);
+		}
+		else
+		{
+			for (std::size_t i = 0; i < layerCount; ++i)
+				DecodeLayer(i);
+		}
+
+		for (const std::exception_ptr& layerError : layerErrors)
+		{
+			if (layerError)
+				std::rethrow_exception(layerError);
+		}
+
+		// Assets
+		m_assets.clear();
+		m_assets.resize(assetCount);
+
+		BinaryReader assetReader(content, assetTableOffset);
+		for (Asset& asset : m_assets)
+		{
+			asset.filepath = GetString(assetReader.Read<Nz::UInt32>());
+			assetReader.Skip(sizeof(Nz::UInt32)); //< reserved
+			asset.size = assetReader.Read<Nz::UInt64>();
+			assetReader.Read(asset.sha1Checksum.data(), asset.sha1Checksum.size());
+			assetReader.Skip(sizeof(Nz::UInt32)); //< reserved
+		}
 	}
 
 	void Map::LoadFromTextInternal(const std::filesystem::path& mapFolder)
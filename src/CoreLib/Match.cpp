@@ -18,31 +18,70 @@
 #include <CoreLib/Scripting/ServerScriptingLibrary.hpp>
 #include <CoreLib/Systems/NetworkSyncSystem.hpp>
 #include <CoreLib/Utils.hpp>
+#include <Nazara/Core/CallOnExit.hpp>
+#include <Nazara/Core/Clock.hpp>
 #include <Nazara/Core/File.hpp>
 #include <NDK/Components/PhysicsComponent2D.hpp>
 #include <tsl/hopscotch_set.h>
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <fstream>
 
 namespace bw
 {
 	Match::Match(BurgApp& app, MatchSettings matchSettings, GamemodeSettings gamemodeSettings) :
 	SharedMatch(app, LogSide::Server, std::move(matchSettings.name), matchSettings.tickDuration),
+	m_scriptBytecodeCache(std::move(matchSettings.scriptBytecodeCache)),
+	m_interestRadius(matchSettings.interestRadius),
 	m_maxPlayerCount(matchSettings.maxPlayerCount),
+	m_fileHashCache((matchSettings.fileHashCache) ? std::move(matchSettings.fileHashCache) : std::make_shared<FileHashCache>()),
 	m_nextUniqueId(matchSettings.map.GetFreeUniqueId()),
+	m_fileTransferRate(matchSettings.fileTransferRate),
 	m_lastPingUpdate(0),
+	m_lastTickProfileDump(0),
 	m_app(app),
 	m_gamemodeSettings(std::move(gamemodeSettings)),
 	m_map(std::move(matchSettings.map)),
 	m_sessions(*this),
-	m_disableWhenEmpty(true)
+	m_tickProfilerSettings(std::move(matchSettings.tickProfiler)),
+	m_disableWhenEmpty(true),
+	m_isLoadingScripts(false)
 	{
+		GetProfiler().Enable(m_tickProfilerSettings.enable);
+
 		ReloadAssets();
 		ReloadScripts();
 
 		m_terrain = std::make_unique<Terrain>(m_map);
 		m_terrain->Initialize(*this);
 
+		if (matchSettings.layerWorkerCount > 0)
+			m_terrain->EnableParallelUpdate(matchSettings.layerWorkerCount);
+
+		if (matchSettings.matchStateQuantization)
+		{
+			const QuantizationSettings& quantizationSettings = *matchSettings.matchStateQuantization;
+
+			// Quantized positions are relative to the map top-left corner to keep them small
+			Nz::Vector2f positionOrigin = Nz::Vector2f::Zero();
+			for (std::size_t i = 0; i < m_map.GetLayerCount(); ++i)
+			{
+				for (const Map::Entity& entity : m_map.GetLayer(LayerIndex(i)).entities)
+				{
+					positionOrigin.x = std::min(positionOrigin.x, entity.position.x);
+					positionOrigin.y = std::min(positionOrigin.y, entity.position.y);
+				}
+			}
+
+			auto& quantization = m_matchStateQuantization.emplace();
+			quantization.angularVelocityPrecision = quantizationSettings.angularVelocityPrecision;
+			quantization.linearVelocityPrecision = quantizationSettings.linearVelocityPrecision;
+			quantization.positionOrigin = positionOrigin;
+			quantization.positionPrecision = quantizationSettings.positionPrecision;
+			quantization.rotationBits = quantizationSettings.rotationBits;
+		}
+
 		BuildMatchData();
 
 		m_gamemode->ExecuteCallback<GamemodeEvent::Init>();
@@ -73,6 +112,39 @@ namespace bw
 		});
 	}
 
+	/*!
+	* \brief Writes recorded ticks timings as a Chrome trace in the profile folder and logs a summary of them
+	* \return Path of the trace file, or nothing if the profiler is disabled or the file couldn't be written
+	*/
+	std::optional<std::filesystem::path> Match::DumpTickProfile()
+	{
+		const TickProfiler& profiler = GetProfiler();
+		if (!profiler.IsEnabled() || profiler.GetRecordedTickCount() == 0)
+			return std::nullopt;
+
+		std::string fileName = GetName();
+		for (char& c : fileName)
+		{
+			if (!std::isalnum(static_cast<unsigned char>(c)))
+				c = '_';
+		}
+		fileName += "_tick" + std::to_string(GetCurrentTick()) + ".json";
+
+		std::error_code err;
+		std::filesystem::create_directories(m_tickProfilerSettings.dumpFolder, err);
+
+		std::filesystem::path filePath = m_tickProfilerSettings.dumpFolder / fileName;
+		if (!profiler.ExportChromeTrace(filePath))
+		{
+			bwLog(GetLogger(), LogLevel::Error, "Failed to write tick profile to {0}", filePath.generic_u8string());
+			return std::nullopt;
+		}
+
+		bwLog(GetLogger(), LogLevel::Info, "Tick profile written to {0}\n{1}", filePath.generic_u8string(), profiler.BuildSummary());
+
+		return filePath;
+	}
+
 	void Match::BuildClientAssetListPacket(Packets::MatchData& clientAsset) const
 	{
 		const std::string& fastDownloadUrls = m_app.GetConfig().GetStringValue("GameSettings.FastDownloadURLs");
@@ -110,7 +182,7 @@ namespace bw
 		{
 			auto& scriptData = clientScript.scripts.emplace_back();
 			scriptData.path = pair.first;
-			scriptData.size = pair.second.content.size();
+			scriptData.size = pair.second.size;
 
 			const Nz::ByteArray& checksum = pair.second.checksum;
 			assert(scriptData.sha1Checksum.size() == checksum.size());
@@ -236,21 +308,49 @@ namespace bw
 
 	void Match::RegisterClientAsset(std::string assetPath)
 	{
-		if (m_clientAssets.find(assetPath) != m_clientAssets.end())
-			return;
+		std::vector<std::string> assetPaths;
+		assetPaths.push_back(std::move(assetPath));
 
+		RegisterClientAssets(std::move(assetPaths));
+	}
+
+	void Match::RegisterClientAssets(std::vector<std::string> assetPaths)
+	{
 		const std::string& resourceFolder = m_app.GetConfig().GetStringValue("Resources.AssetDirectory");
 
-		std::filesystem::path filePath = resourceFolder;
-		filePath /= assetPath;
+		// Remove already registered assets and check every file before hashing any of them
+		assetPaths.erase(std::remove_if(assetPaths.begin(), assetPaths.end(), [&](const std::string& assetPath)
+		{
+			return m_clientAssets.find(assetPath) != m_clientAssets.end();
+		}), assetPaths.end());
 
-		if (!std::filesystem::is_regular_file(filePath))
-			throw std::runtime_error(filePath.generic_u8string() + " is not a file");
+		std::vector<std::filesystem::path> filePaths;
+		filePaths.reserve(assetPaths.size());
 
-		Nz::UInt64 assetSize = std::filesystem::file_size(filePath);
-		Nz::ByteArray assetHash = Nz::File::ComputeHash(Nz::HashType_SHA1, filePath.generic_u8string());
+		for (const std::string& assetPath : assetPaths)
+		{
+			std::filesystem::path filePath = resourceFolder;
+			filePath /= assetPath;
+
+			if (!std::filesystem::is_regular_file(filePath))
+				throw std::runtime_error(filePath.generic_u8string() + " is not a file");
+
+			filePaths.push_back(std::move(filePath));
+		}
 
-		RegisterClientAssetInternal(std::move(assetPath), assetSize, std::move(assetHash), std::move(filePath));
+		if (filePaths.empty())
+			return;
+
+		// Scripts call this while loading, the cache is saved once they're loaded
+		auto fileHashes = m_fileHashCache->ComputeHashes(filePaths, &m_scriptHashStatistics);
+
+		for (std::size_t i = 0; i < assetPaths.size(); ++i)
+		{
+			if (!fileHashes[i])
+				throw std::runtime_error("failed to hash " + filePaths[i].generic_u8string());
+
+			RegisterClientAssetInternal(std::move(assetPaths[i]), fileHashes[i]->size, std::move(fileHashes[i]->checksum), std::move(filePaths[i]));
+		}
 	}
 
 	void Match::RegisterClientScript(std::string scriptPath)
@@ -260,27 +360,23 @@ namespace bw
 
 		const std::string& scriptFolder = m_app.GetConfig().GetStringValue("Resources.ScriptDirectory");
 
-		std::string filePath = scriptFolder + "/" + scriptPath;
-		if (!std::filesystem::is_regular_file(filePath))
-			throw std::runtime_error(filePath + " is not a file");
-
-		Nz::File file(filePath);
-		if (!file.Open(Nz::OpenMode_ReadOnly))
-			throw std::runtime_error("failed to open " + filePath);
+		std::filesystem::path filePath = scriptFolder;
+		filePath /= scriptPath;
 
-		std::vector<Nz::UInt8> content(file.GetSize());
-		if (file.Read(content.data(), content.size()) != content.size())
-			throw std::runtime_error("failed to read " + filePath);
-
-		auto hash = Nz::AbstractHash::Get(Nz::HashType_SHA1);
-		hash->Begin();
-		hash->Append(content.data(), content.size());
+		if (!std::filesystem::is_regular_file(filePath))
+			throw std::runtime_error(filePath.generic_u8string() + " is not a file");
 
+		// Scripts are only read when a client downloads them (and checked against their checksum then), unchanged scripts don't need to be read here
 		ClientScript clientScriptData;
-		clientScriptData.checksum = hash->End();
-		clientScriptData.content = std::move(content);
+		clientScriptData.realPath = std::move(filePath);
+		clientScriptData.size = 0;
+
+		m_clientScripts.emplace(scriptPath, std::move(clientScriptData));
+		m_pendingClientScripts.push_back(std::move(scriptPath));
 
-		m_clientScripts.emplace(std::move(scriptPath), std::move(clientScriptData));
+		// Scripts registered while loading scripts are hashed together once loading is over
+		if (!m_isLoadingScripts)
+			HashPendingClientScripts();
 	}
 
 	void Match::RegisterEntity(EntityId uniqueId, Ndk::EntityHandle entity)
@@ -320,9 +416,17 @@ namespace bw
 			m_assetStore->Clear();
 		}
 
+		Nz::UInt64 startTime = Nz::GetElapsedMilliseconds();
+
 		assert(m_map.IsValid());
-		for (const auto& asset : m_map.GetAssets())
+		const auto& mapAssets = m_map.GetAssets();
+
+		std::vector<std::size_t> assetIndices;
+		std::vector<std::filesystem::path> assetPaths;
+		for (std::size_t i = 0; i < mapAssets.size(); ++i)
 		{
+			const auto& asset = mapAssets[i];
+
 			std::filesystem::path assetPath = resourceFolder;
 			assetPath /= asset.filepath;
 
@@ -339,29 +443,55 @@ namespace bw
 				continue;
 			}
 
+			assetIndices.push_back(i);
+			assetPaths.push_back(std::move(assetPath));
+		}
+
+		// Unchanged files reuse their cached checksum, others are hashed in parallel
+		FileHashCache::Statistics hashStatistics;
+		auto fileHashes = m_fileHashCache->ComputeHashes(assetPaths, &hashStatistics);
+		m_fileHashCache->Save();
+
+		for (std::size_t i = 0; i < assetPaths.size(); ++i)
+		{
+			const auto& asset = mapAssets[assetIndices[i]];
+			if (!fileHashes[i])
+			{
+				bwLog(GetLogger(), LogLevel::Error, "Failed to hash map asset {}", asset.filepath);
+				continue;
+			}
+
 			Nz::ByteArray expectedChecksum(asset.sha1Checksum.size(), 0);
 			std::memcpy(expectedChecksum.GetBuffer(), asset.sha1Checksum.data(), asset.sha1Checksum.size());
 
-			Nz::ByteArray fileChecksum = Nz::File::ComputeHash(Nz::HashType_SHA1, assetPath.generic_u8string());
-			if (fileChecksum != expectedChecksum)
+			if (fileHashes[i]->checksum != expectedChecksum)
 			{
-				bwLog(GetLogger(), LogLevel::Error, "Map asset doesn't match file ({}): checksum doesn't match", asset.filepath, asset.size, fileSize);
+				bwLog(GetLogger(), LogLevel::Error, "Map asset doesn't match file ({}): checksum doesn't match", asset.filepath);
 				continue;
 			}
 
-			RegisterClientAssetInternal(asset.filepath, fileSize, fileChecksum, std::move(assetPath));
+			RegisterClientAssetInternal(asset.filepath, fileHashes[i]->size, std::move(fileHashes[i]->checksum), std::move(assetPaths[i]));
 		}
+
+		bwLog(GetLogger(), LogLevel::Info, "Checked {} map assets in {}ms ({} from cache, {} hashed for {} bytes)", assetPaths.size(), Nz::GetElapsedMilliseconds() - startTime, hashStatistics.cachedFileCount, hashStatistics.hashedFileCount, hashStatistics.hashedByteCount);
 	}
 
 	void Match::ReloadScripts()
 	{
 		assert(m_assetStore);
 
+		Nz::UInt64 startTime = Nz::GetElapsedMilliseconds();
+		m_scriptHashStatistics = FileHashCache::Statistics{};
+
 		const std::string& scriptFolder = m_app.GetConfig().GetStringValue("Resources.ScriptDirectory");
 
 		std::shared_ptr<VirtualDirectory> scriptDir = std::make_shared<VirtualDirectory>(scriptFolder);
 
 		m_clientScripts.clear();
+		m_pendingClientScripts.clear();
+
+		m_isLoadingScripts = true;
+		Nz::CallOnExit resetLoadingFlag([&] { m_isLoadingScripts = false; });
 
 		if (!m_scriptingContext)
 		{
@@ -369,6 +499,9 @@ namespace bw
 				m_scriptingLibrary = std::make_shared<ServerScriptingLibrary>(*this, *m_assetStore);
 
 			m_scriptingContext = std::make_shared<ScriptingContext>(GetLogger(), scriptDir);
+			if (m_scriptBytecodeCache)
+				m_scriptingContext->SetBytecodeCache(m_scriptBytecodeCache);
+
 			m_scriptingContext->LoadLibrary(m_scriptingLibrary);
 		}
 		else
@@ -463,6 +596,13 @@ namespace bw
 					m_networkStringStore.RegisterString(propertyName);
 			}
 		});
+
+		resetLoadingFlag.CallAndReset();
+		HashPendingClientScripts();
+
+		m_fileHashCache->Save();
+
+		bwLog(GetLogger(), LogLevel::Info, "Loaded scripts in {}ms (client files registered by scripts: {} from cache, {} hashed for {} bytes)", Nz::GetElapsedMilliseconds() - startTime, m_scriptHashStatistics.cachedFileCount, m_scriptHashStatistics.hashedFileCount, m_scriptHashStatistics.hashedByteCount);
 	}
 
 	void Match::RemovePlayer(Player* player, DisconnectionReason disconnectionReason)
@@ -537,7 +677,10 @@ namespace bw
 		m_sessions.Poll();
 
 		if (m_disableWhenEmpty && m_freePlayerId.TestAll())
+		{
+			m_sessions.Flush();
 			return;
+		}
 
 		m_scriptingContext->Update();
 
@@ -550,6 +693,15 @@ namespace bw
 			m_lastPingUpdate = appTime;
 		}
 
+		// Hand every packet sent during this update to the network thread at once
+		m_sessions.Flush();
+
+		if (m_tickProfilerSettings.dumpInterval > 0.f && appTime - m_lastTickProfileDump >= static_cast<Nz::UInt64>(m_tickProfilerSettings.dumpInterval * 1000.f))
+		{
+			DumpTickProfile();
+			m_lastTickProfileDump = appTime;
+		}
+
 
 		if (m_debug && appTime - m_debug->lastBroadcastTime > 1000 / 60)
 		{
@@ -662,6 +814,49 @@ namespace bw
 		}
 	}
 
+	/*!
+	* \brief Computes checksums of client scripts registered since last call, in a single batch
+	*
+	* Scripts which can't be hashed are unregistered.
+	*/
+	void Match::HashPendingClientScripts()
+	{
+		if (m_pendingClientScripts.empty())
+			return;
+
+		std::vector<std::filesystem::path> filePaths;
+		filePaths.reserve(m_pendingClientScripts.size());
+
+		for (const std::string& scriptPath : m_pendingClientScripts)
+		{
+			auto it = m_clientScripts.find(scriptPath);
+			assert(it != m_clientScripts.end());
+
+			filePaths.push_back(it->second.realPath);
+		}
+
+		auto fileHashes = m_fileHashCache->ComputeHashes(filePaths, &m_scriptHashStatistics);
+
+		for (std::size_t i = 0; i < m_pendingClientScripts.size(); ++i)
+		{
+			auto it = m_clientScripts.find(m_pendingClientScripts[i]);
+			assert(it != m_clientScripts.end());
+
+			if (!fileHashes[i])
+			{
+				bwLog(GetLogger(), LogLevel::Error, "Failed to hash client script {}, it won't be sent to clients", filePaths[i].generic_u8string());
+				m_clientScripts.erase(it);
+				continue;
+			}
+
+			ClientScript& clientScriptData = it.value();
+			clientScriptData.checksum = std::move(fileHashes[i]->checksum);
+			clientScriptData.size = fileHashes[i]->size;
+		}
+
+		m_pendingClientScripts.clear();
+	}
+
 	void Match::OnPlayerReady(Player* newPlayer)
 	{
 		if (newPlayer->IsReady())
@@ -717,25 +912,41 @@ namespace bw
 	void Match::OnTick(bool lastTick)
 	{
 		float elapsedTime = GetTickDuration();
+		TickProfiler& profiler = GetProfiler();
 
-		m_sessions.ForEachSession([&](MatchClientSession* session)
 		{
-			session->OnTick(elapsedTime);
-		});
+			TickProfiler::Scope profileScope(profiler, "Sessions.OnTick", ProfileCategory::Network);
+			m_sessions.ForEachSession([&](MatchClientSession* session)
+			{
+				session->OnTick(elapsedTime);
+			});
+		}
 
-		ForEachPlayer([&](Player* player)
 		{
-			player->OnTick(lastTick);
-		});
+			TickProfiler::Scope profileScope(profiler, "Players.OnTick", ProfileCategory::Simulation);
+			ForEachPlayer([&](Player* player)
+			{
+				player->OnTick(lastTick);
+			});
+		}
 
-		m_gamemode->ExecuteCallback<GamemodeEvent::Tick>();
+		{
+			TickProfiler::Scope profileScope(profiler, "Gamemode.Tick", ProfileCategory::Script);
+			m_gamemode->ExecuteCallback<GamemodeEvent::Tick>();
+		}
 
-		m_terrain->Update(elapsedTime);
+		{
+			TickProfiler::Scope profileScope(profiler, "Terrain.Update", ProfileCategory::Simulation);
+			m_terrain->Update(elapsedTime);
+		}
 
-		m_sessions.ForEachSession([&](MatchClientSession* session)
 		{
-			session->Update(elapsedTime);
-		});
+			TickProfiler::Scope profileScope(profiler, "Sessions.Update", ProfileCategory::Network);
+			m_sessions.ForEachSession([&](MatchClientSession* session)
+			{
+				session->Update(elapsedTime);
+			});
+		}
 	}
 
 	void Match::RegisterClientAssetInternal(std::string assetPath, Nz::UInt64 assetSize, Nz::ByteArray assetChecksum, std::filesystem::path realPath)
@@ -15,11 +15,29 @@
 #include <CoreLib/Scripting/ServerGamemode.hpp>
 #include <CoreLib/Components/PlayerControlledComponent.hpp>
 #include <CoreLib/Components/WeaponWielderComponent.hpp>
+#include <Nazara/Core/AbstractHash.hpp>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <limits>
 
 namespace
 {
 	constexpr Nz::UInt64 MaxFragmentSize = 1200;
+
+	// Unused transfer budget is kept for this long (in seconds), so a late update doesn't send a burst of fragments which would fill the peer reliable window
+	constexpr float MaxFileTransferBurstDuration = 0.05f;
+
+	// Clients download files one at a time, each transfer keeps its file open
+	constexpr std::size_t MaxPendingFileTransfers = 4;
+
+	// Fragments aren't sent while that much reliable data is unacknowledged, enough for the default rate (1MiB/s) over a ~100ms round trip
+	// Sending more wouldn't go faster, it would only queue fragments in ENet ahead of game packets
+	constexpr Nz::UInt64 MaxReliableBytesInFlight = 128 * 1024;
+
+	// Peer info (in seconds) is refreshed more often during file transfers, as they're throttled on its unacknowledged data
+	constexpr float PeerInfoUpdateInterval = 1.f;
+	constexpr float FileTransferPeerInfoUpdateInterval = 0.1f;
 }
 
 namespace bw
@@ -31,6 +49,8 @@ namespace bw
 	m_sessionId(sessionId),
 	m_bridge(std::move(bridge)),
 	m_ping(0),
+	m_fileTransferBudget(0),
+	m_reliableBytesInFlight(0),
 	m_peerInfoUpdateCounter(0.f)
 	{
 		m_visibility = std::make_unique<MatchClientVisibility>(match, *this);
@@ -65,7 +85,7 @@ namespace bw
 			Input inputData = m_queuedInputs.Dequeue();
 			m_lastInputTick = inputData.inputTick;
 
-			for (std::size_t playerIndex = 0; playerIndex < inputData.inputs.size(); ++playerIndex)
+			for (std::size_t playerIndex = 0; playerIndex < m_players.size(); ++playerIndex)
 			{
 				const auto& inputOpt = inputData.inputs[playerIndex];
 				if (!inputOpt.has_value())
@@ -82,8 +102,13 @@ namespace bw
 	{
 		m_visibility->Update();
 
+		if (!m_pendingFileTransfers.empty())
+			SendFileFragments(elapsedTime);
+
+		float peerInfoUpdateInterval = (!m_pendingFileTransfers.empty()) ? FileTransferPeerInfoUpdateInterval : PeerInfoUpdateInterval;
+
 		m_peerInfoUpdateCounter += elapsedTime;
-		if (m_peerInfoUpdateCounter >= 1.f)
+		if (m_peerInfoUpdateCounter >= peerInfoUpdateInterval)
 		{
 			m_peerInfoUpdateCounter = 0.f;
 
@@ -103,7 +128,7 @@ namespace bw
 
 		bwLog(m_match.GetLogger(), LogLevel::Info, "Auth request for {0} players", playerCount);
 
-		if (playerCount == 0 || playerCount >= 8) //< For now, we don't have any spectator
+		if (playerCount == 0 || playerCount > MaxLocalPlayerCount) //< For now, we don't have any spectator
 		{
 			SendPacket(Packets::AuthFailure());
 			Disconnect();
@@ -139,6 +164,18 @@ namespace bw
 
 		m_players = std::move(players);
 
+		if (packet.supportedFeatures.Test(ProtocolFeature::BatchedEntityEvents))
+			m_visibility->EnableBatchedEntityEvents();
+
+		if (packet.supportedFeatures.Test(ProtocolFeature::QuantizedMatchState))
+		{
+			if (const auto& quantization = m_match.GetMatchStateQuantization())
+			{
+				authSuccessPacket.matchStateQuantization = *quantization;
+				m_visibility->EnableMatchStateQuantization(*quantization);
+			}
+		}
+
 		SendPacket(authSuccessPacket);
 		SendPacket(m_match.GetNetworkStringStore().BuildPacket());
 
@@ -149,12 +186,19 @@ namespace bw
 	{
 		bwLog(m_match.GetLogger(), LogLevel::Info, "Client requested client asset {0}", packet.path);
 
+		if (m_pendingFileTransfers.size() >= MaxPendingFileTransfers)
+		{
+			bwLog(m_match.GetLogger(), LogLevel::Warning, "Client requested too many files at once, disconnecting");
+			Disconnect();
+			return;
+		}
+
 		const Match::ClientAsset* clientAsset;
 		const Match::ClientScript* clientScript;
 		if (m_match.GetClientAsset(packet.path, &clientAsset))
 			SendClientFile(clientAsset->realPath);
 		else if (m_match.GetClientScript(packet.path, &clientScript))
-			SendClientFile(clientScript->content);
+			SendClientScript(clientScript->realPath, clientScript->size, clientScript->checksum);
 		else
 			Disconnect();
 	}
@@ -216,7 +260,14 @@ namespace bw
 
 		SendPacket(correctionPacket);
 
-		m_queuedInputs.Enqueue(Input{ std::move(packet.inputs), packet.inputTick });
+		if (packet.acknowledgedStateTick)
+			m_visibility->AcknowledgeStateTick(*packet.acknowledgedStateTick, packet.acknowledgedStateMask);
+
+		Input inputData;
+		inputData.inputTick = packet.inputTick;
+		std::copy(packet.inputs.begin(), packet.inputs.end(), inputData.inputs.begin());
+
+		m_queuedInputs.Enqueue(inputData);
 	}
 
 	void MatchClientSession::HandleIncomingPacket(const Packets::PlayerSelectWeapon& packet)
@@ -269,80 +320,169 @@ namespace bw
 
 	void MatchClientSession::SendClientFile(const std::filesystem::path& filePath)
 	{
-		if (!std::filesystem::is_regular_file(filePath))
+		auto SendFailure = [&]
 		{
-			bwLog(m_match.GetLogger(), LogLevel::Error, "Client asset {} does not exist", filePath.generic_u8string());
-
 			Packets::DownloadClientFileResponse response;
 			auto& failure = response.content.emplace<Packets::DownloadClientFileResponse::Failure>();
 			failure.error = Packets::DownloadClientFileResponse::Error::FileNotFound;
 
 			SendPacket(response);
-			return;
+		};
+
+		if (!std::filesystem::is_regular_file(filePath))
+		{
+			bwLog(m_match.GetLogger(), LogLevel::Error, "Client file {} does not exist", filePath.generic_u8string());
+			return SendFailure();
 		}
 
-		//FIXME: Use fragments instead of sending the whole file at once
-		Nz::File file(filePath.generic_u8string(), Nz::OpenMode_ReadOnly);
-		if (!file.IsOpen())
+		auto file = std::make_unique<Nz::File>(filePath.generic_u8string(), Nz::OpenMode_ReadOnly);
+		if (!file->IsOpen())
 		{
 			bwLog(m_match.GetLogger(), LogLevel::Error, "Failed to open {}", filePath.generic_u8string());
+			return SendFailure();
+		}
+
+		Nz::UInt64 fileSize = file->GetSize();
+		Nz::UInt64 fragmentCount = fileSize / MaxFragmentSize + ((fileSize % MaxFragmentSize != 0) ? 1 : 0);
+		if (fragmentCount > std::numeric_limits<Nz::UInt32>::max())
+		{
+			bwLog(m_match.GetLogger(), LogLevel::Error, "{} is too big to be sent", filePath.generic_u8string());
+			return SendFailure();
+		}
+
+		bwLog(m_match.GetLogger(), LogLevel::Info, "Sending client file {}", filePath.generic_u8string());
+
+		Packets::DownloadClientFileResponse response;
+		auto& success = response.content.emplace<Packets::DownloadClientFileResponse::Success>();
+		success.fragmentCount = static_cast<Nz::UInt32>(fragmentCount);
+		success.fragmentSize = MaxFragmentSize;
+
+		SendPacket(response);
+
+		if (fragmentCount == 0)
+			return;
 
-			// An error occurred, send 0 fragment to notify the issue
+		// File content is read fragment by fragment when sending it
+		auto& transfer = m_pendingFileTransfers.emplace_back();
+		transfer.file = std::move(file);
+		transfer.fragmentCount = static_cast<Nz::UInt32>(fragmentCount);
+		transfer.size = fileSize;
+	}
+
+	/*!
+	* \brief Sends a client script from an in-memory copy, after checking it still matches the checksum sent to clients
+	*
+	* Script checksums come from the hash cache, the file may have been modified since it was registered.
+	*/
+	void MatchClientSession::SendClientScript(const std::filesystem::path& filePath, Nz::UInt64 expectedSize, const Nz::ByteArray& expectedChecksum)
+	{
+		auto SendFailure = [&]
+		{
 			Packets::DownloadClientFileResponse response;
 			auto& failure = response.content.emplace<Packets::DownloadClientFileResponse::Failure>();
 			failure.error = Packets::DownloadClientFileResponse::Error::FileNotFound;
 
 			SendPacket(response);
-			return;
+		};
+
+		Nz::File file(filePath.generic_u8string(), Nz::OpenMode_ReadOnly);
+		if (!file.IsOpen())
+		{
+			bwLog(m_match.GetLogger(), LogLevel::Error, "Failed to open {}", filePath.generic_u8string());
+			return SendFailure();
 		}
 
-		std::vector<Nz::UInt8> content(file.GetSize());
+		std::vector<Nz::UInt8> content(static_cast<std::size_t>(file.GetSize()));
 		if (file.Read(content.data(), content.size()) != content.size())
 		{
 			bwLog(m_match.GetLogger(), LogLevel::Error, "Failed to read {}", filePath.generic_u8string());
-
-			// An error occurred, send 0 fragment to notify the issue
-			Packets::DownloadClientFileResponse response;
-			auto& failure = response.content.emplace<Packets::DownloadClientFileResponse::Failure>();
-			failure.error = Packets::DownloadClientFileResponse::Error::FileNotFound;
-
-			SendPacket(response);
-			return;
+			return SendFailure();
 		}
 
-		file.Close();
+		auto hash = Nz::AbstractHash::Get(Nz::HashType_SHA1);
+		hash->Begin();
+		hash->Append(content.data(), content.size());
 
-		bwLog(m_match.GetLogger(), LogLevel::Info, "Sending asset {}", filePath.generic_u8string());
-		SendClientFile(content);
-	}
+		if (content.size() != expectedSize || hash->End() != expectedChecksum)
+		{
+			bwLog(m_match.GetLogger(), LogLevel::Error, "Client script {} has been modified since scripts were loaded, reload scripts to send it", filePath.generic_u8string());
+			return SendFailure();
+		}
 
-	void MatchClientSession::SendClientFile(const std::vector<Nz::UInt8>& content)
-	{
-		//std::size_t fragmentCount = clientAsset->size / MaxFragmentSize + ((clientAsset->size % MaxFragmentSize != 0) ? 1 : 0);
+		bwLog(m_match.GetLogger(), LogLevel::Info, "Sending client script {}", filePath.generic_u8string());
 
-		/*auto& pendingRequest = m_pendingAssetRequest.emplace_back();
-		pendingRequest.currentFragmentIndex = 0;
-		pendingRequest.filePath = clientAsset->path;
-		pendingRequest.fragmentCount = fragmentCount;
-		pendingRequest.fragmentSize = MaxFragmentSize;*/
+		Nz::UInt64 fragmentCount = content.size() / MaxFragmentSize + ((content.size() % MaxFragmentSize != 0) ? 1 : 0);
 
 		Packets::DownloadClientFileResponse response;
 		auto& success = response.content.emplace<Packets::DownloadClientFileResponse::Success>();
-		//success.fragmentCount = static_cast<Nz::UInt32>(fragmentCount);
-		success.fragmentCount = 1;
-		success.fragmentSize = content.size();
+		success.fragmentCount = static_cast<Nz::UInt32>(fragmentCount);
+		success.fragmentSize = MaxFragmentSize;
 
 		SendPacket(response);
 
+		if (fragmentCount == 0)
+			return;
+
+		// Keep the verified copy, the file may change again before the transfer is over
+		auto& transfer = m_pendingFileTransfers.emplace_back();
+		transfer.content = std::move(content);
+		transfer.fragmentCount = static_cast<Nz::UInt32>(fragmentCount);
+		transfer.size = transfer.content.size();
+	}
+
+	/*!
+	* \brief Sends the next fragments of pending file transfers, within the per-client transfer rate
+	*/
+	void MatchClientSession::SendFileFragments(float elapsedTime)
+	{
+		Nz::UInt64 transferRate = m_match.GetFileTransferRate();
+		Nz::UInt64 maxBudget = std::max(static_cast<Nz::UInt64>(transferRate * MaxFileTransferBurstDuration), MaxFragmentSize);
+
+		m_fileTransferBudget += static_cast<Nz::UInt64>(transferRate * elapsedTime);
+		m_fileTransferBudget = std::min(m_fileTransferBudget, maxBudget);
+
 		Packets::DownloadClientFileFragment fragment;
-		fragment.fragmentIndex = 0;
-		fragment.fragmentContent = std::move(content);
+		while (!m_pendingFileTransfers.empty() && m_fileTransferBudget >= MaxFragmentSize && m_reliableBytesInFlight < MaxReliableBytesInFlight)
+		{
+			PendingFileTransfer& transfer = m_pendingFileTransfers.front();
+
+			Nz::UInt64 offset = transfer.nextFragmentIndex * MaxFragmentSize;
+			std::size_t fragmentSize = static_cast<std::size_t>(std::min(MaxFragmentSize, transfer.size - offset));
+
+			fragment.fragmentIndex = transfer.nextFragmentIndex;
+			fragment.fragmentContent.resize(fragmentSize);
+
+			if (transfer.file)
+			{
+				if (transfer.file->Read(fragment.fragmentContent.data(), fragmentSize) != fragmentSize)
+				{
+					// The client has already been told the file size, it can't recover from this
+					bwLog(m_match.GetLogger(), LogLevel::Error, "Failed to read client file fragment #{}", transfer.nextFragmentIndex);
+
+					m_pendingFileTransfers.clear();
+					Disconnect();
+					return;
+				}
+			}
+			else
+				std::memcpy(fragment.fragmentContent.data(), &transfer.content[offset], fragmentSize);
+
+			SendPacket(fragment);
+
+			m_fileTransferBudget -= fragmentSize;
+			m_reliableBytesInFlight += fragmentSize; //< Until the next peer info update
+
+			if (++transfer.nextFragmentIndex >= transfer.fragmentCount)
+				m_pendingFileTransfers.pop_front();
+		}
 
-		SendPacket(fragment);
+		if (m_pendingFileTransfers.empty())
+			m_fileTransferBudget = 0;
 	}
 	
 	void MatchClientSession::UpdatePeerInfo(const SessionBridge::SessionInfo& sessionInfo)
 	{
 		m_ping = sessionInfo.ping;
+		m_reliableBytesInFlight = sessionInfo.reliableBytesInFlight;
 	}
 }
@@ -8,7 +8,11 @@
 #include <CoreLib/Protocol/Packets.hpp>
 #include <CoreLib/MatchClientSession.hpp>
 #include <CoreLib/Terrain.hpp>
+#include <NDK/Components/NodeComponent.hpp>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <limits>
 #include <queue>
 
 namespace bw
@@ -33,9 +37,13 @@ namespace bw
 			TerrainLayer& terrainLayer = terrain.GetLayer(layerIndex);
 			NetworkSyncSystem& syncSystem = terrainLayer.GetWorld().GetSystem<NetworkSyncSystem>();
 			
-			layer.onEntityCreatedSlot.Connect(syncSystem.OnEntityCreated, [this](NetworkSyncSystem* syncSystem, const NetworkSyncSystem::EntityCreation& entityCreation)
+			layer.onEntityCreatedSlot.Connect(syncSystem.OnEntityCreated, [this, layerIndex](NetworkSyncSystem*, const NetworkSyncSystem::EntityCreation& entityCreation)
 			{
-				HandleEntityCreation(syncSystem->GetLayer().GetLayerIndex(), entityCreation);
+				assert(m_layers.find(layerIndex) != m_layers.end());
+				if (!IsEntityRelevant(*m_layers[layerIndex], entityCreation))
+					return;
+
+				HandleEntityCreation(layerIndex, entityCreation);
 			});
 
 			layer.onEntityDeletedSlot.Connect(syncSystem.OnEntityDeleted, [this](NetworkSyncSystem* syncSystem, const NetworkSyncSystem::EntityDestruction& entityDestruction)
@@ -154,10 +162,38 @@ namespace bw
 		}
 	}
 
+	void MatchClientVisibility::AcknowledgeStateTick(Nz::UInt16 stateTick, Nz::UInt32 previousStatesMask)
+	{
+		auto Acknowledge = [&](Nz::UInt16 tick)
+		{
+			SentMatchState& sentState = m_sentMatchStates[tick % MatchStateHistorySize];
+			if (sentState.stateTick == tick)
+				sentState.isAcknowledged = true;
+		};
+
+		Acknowledge(stateTick);
+		for (Nz::UInt16 i = 0; i < 32; ++i)
+		{
+			if (previousStatesMask & (Nz::UInt32(1) << i))
+				Acknowledge(stateTick - i - 1);
+		}
+
+		if (!m_acknowledgedStateTick || IsMoreRecent(stateTick, *m_acknowledgedStateTick))
+			m_acknowledgedStateTick = stateTick;
+	}
+
+	void MatchClientVisibility::EnableMatchStateQuantization(const Packets::Helper::MatchStateQuantization& quantization)
+	{
+		m_matchStateQuantizer.emplace(quantization);
+	}
+
 	void MatchClientVisibility::Update()
 	{
 		Nz::UInt16 networkTick = m_match.GetNetworkTick();
 
+		if (m_match.GetInterestRadius())
+			UpdateViewpoints();
+
 		// Handle hidden and shown layers
 		if (m_newlyHiddenLayers.GetSize() != 0)
 		{
@@ -216,10 +252,22 @@ namespace bw
 
 				if (m_clientVisibleLayers.UnboundedTest(i))
 				{
-					for (const Ndk::EntityHandle& entity : syncSystem.GetEntities())
-						layer.visibleEntities.emplace(entity->GetId(), Layer::VisibleEntityData{});
+					if (!m_match.GetInterestRadius())
+					{
+						for (const Ndk::EntityHandle& entity : syncSystem.GetEntities())
+							layer.visibleEntities.emplace(entity->GetId(), Layer::VisibleEntityData{});
 
-					continue;
+						continue;
+					}
+
+					// We don't know which entities the client knows about anymore, recreate the layer
+					Packets::DisableLayer disableLayer;
+					disableLayer.layerIndex = layerIndex;
+					disableLayer.stateTick = networkTick;
+
+					m_session.SendPacket(disableLayer);
+
+					m_clientVisibleLayers.UnboundedReset(layerIndex);
 				}
 
 				syncSystem.CreateEntities([&](const NetworkSyncSystem::EntityCreation* entitiesCreation, std::size_t entityCount)
@@ -231,6 +279,31 @@ namespace bw
 					}
 				});
 
+				if (const auto& interestRadius = m_match.GetInterestRadius(); interestRadius && !layer.viewpoints.empty())
+				{
+					// Skip entities outside of the interest area, along with their descendants
+					for (auto it = pendingCreationMap.begin(); it != pendingCreationMap.end(); ++it)
+					{
+						const NetworkSyncSystem::EntityCreation* rootEntity = &it.value().value();
+						while (rootEntity->parent)
+						{
+							auto parentIt = pendingCreationMap.find(static_cast<Nz::UInt32>(*rootEntity->parent));
+							if (parentIt == pendingCreationMap.end() || !parentIt.value())
+								break;
+
+							rootEntity = &parentIt.value().value();
+						}
+
+						if (!rootEntity->parent && rootEntity->physicsProperties && !IsInInterestArea(layer, rootEntity->position, *interestRadius))
+							m_interestUpdateEntities.push_back(it.key());
+					}
+
+					for (Ndk::EntityId entityId : m_interestUpdateEntities)
+						pendingCreationMap[static_cast<Nz::UInt32>(entityId)].reset();
+
+					m_interestUpdateEntities.clear();
+				}
+
 				Packets::EnableLayer enableLayerPacket;
 				enableLayerPacket.layerIndex = layerIndex;
 				enableLayerPacket.stateTick = networkTick;
@@ -268,10 +341,13 @@ namespace bw
 
 					auto& entityData = enableLayerPacket.layerEntities.emplace_back();
 					entityData.id = eventData->entityId;
-					FillEntityData(eventData.value(), entityData.data);
+					entityData.encodedData = syncSystem.GetEncodedEntityData(eventData.value());
 
 					layer.visibleEntities.emplace(entityId, Layer::VisibleEntityData{});
 
+					if (m_match.GetInterestRadius() && !eventData->parent && eventData->physicsProperties)
+						layer.interestEntities.insert(entityId);
+
 					eventData.reset();
 				};
 
@@ -287,6 +363,9 @@ namespace bw
 			m_newlyVisibleLayers.Clear();
 		}
 
+		if (m_match.GetInterestRadius())
+			UpdateInterestAreas();
+
 		// Send packet in fixed order
 		if (m_pendingEvents.Test(VisibilityEventType::Death))
 		{
@@ -365,6 +444,8 @@ namespace bw
 
 				LayerIndex layerIndex = it.key();
 
+				const NetworkSyncSystem& syncSystem = m_match.GetTerrain().GetLayer(layerIndex).GetWorld().GetSystem<NetworkSyncSystem>();
+
 				std::function<void(PendingCreationEventMap::iterator it)> PushEntity;
 				PushEntity = [&](PendingCreationEventMap::iterator it)
 				{
@@ -397,7 +478,7 @@ namespace bw
 
 					auto& entityData = m_createEntitiesPacket.entities.emplace_back();
 					entityData.id = eventData->entityId;
-					FillEntityData(eventData.value(), entityData.data);
+					entityData.encodedData = syncSystem.GetEncodedEntityData(eventData.value());
 
 					eventData.reset();
 				};
@@ -523,40 +604,63 @@ namespace bw
 
 		if (m_pendingEvents.Test(VisibilityEventType::PhysicsUpdate))
 		{
-			for (auto it = m_layers.begin(); it != m_layers.end(); ++it)
+			auto FillPlayerMovement = [](const NetworkSyncSystem::EntityPhysics& physicsData, std::optional<Packets::Helper::PlayerMovementProperties>& packetMovement)
 			{
-				auto& layer = *it.value();
-				if (layer.physicsEvents.empty())
-					continue;
+				if (physicsData.playerMovement)
+				{
+					const auto& playerMovementData = physicsData.playerMovement.value();
 
-				LayerIndex layerIndex = it.key();
+					auto& movementProperties = packetMovement.emplace();
+					movementProperties.jumpHeight = playerMovementData.jumpHeight;
+					movementProperties.jumpHeightBoost = playerMovementData.jumpHeightBoost;
+					movementProperties.movementSpeed = playerMovementData.movementSpeed;
+				}
+			};
+
+			if (m_batchedEntityEvents)
+			{
+				// id + flags + mass + moment of inertia + player movement
+				constexpr std::size_t MaxEntitySize = 5 + 1 + 2 * sizeof(float) + 3 * sizeof(float);
 
-				for (auto&& pair : layer.physicsEvents)
+				SendBatchedEntityEvents(m_physicsUpdatePacket, networkTick, MaxEntitySize, &Layer::physicsEvents, [&](Packets::EntitiesPhysics::Entity& entityData, const NetworkSyncSystem::EntityPhysics& physicsData)
 				{
-					Packets::EntityPhysics physicsPacket;
-					physicsPacket.entityId.layerId = layerIndex;
-					physicsPacket.entityId.entityId = pair.first;
-					physicsPacket.stateTick = networkTick;
-
-					auto& physicsData = pair.second;
-					physicsPacket.asleep = physicsData.isAsleep;
-					physicsPacket.mass = physicsData.mass;
-					physicsPacket.momentOfInertia = physicsData.momentOfInertia;
-					
-					if (physicsData.playerMovement)
+					entityData.asleep = physicsData.isAsleep;
+					entityData.mass = physicsData.mass;
+					entityData.momentOfInertia = physicsData.momentOfInertia;
+					entityData.playerMovement.reset();
+
+					FillPlayerMovement(physicsData, entityData.playerMovement);
+				});
+			}
+			else
+			{
+				for (auto it = m_layers.begin(); it != m_layers.end(); ++it)
+				{
+					auto& layer = *it.value();
+					if (layer.physicsEvents.empty())
+						continue;
+
+					LayerIndex layerIndex = it.key();
+
+					for (auto&& pair : layer.physicsEvents)
 					{
-						const auto& playerMovementData = physicsData.playerMovement.value();
+						Packets::EntityPhysics physicsPacket;
+						physicsPacket.entityId.layerId = layerIndex;
+						physicsPacket.entityId.entityId = pair.first;
+						physicsPacket.stateTick = networkTick;
+
+						auto& physicsData = pair.second;
+						physicsPacket.asleep = physicsData.isAsleep;
+						physicsPacket.mass = physicsData.mass;
+						physicsPacket.momentOfInertia = physicsData.momentOfInertia;
 
-						auto& packetMovement = physicsPacket.playerMovement.emplace();
-						packetMovement.jumpHeight = playerMovementData.jumpHeight;
-						packetMovement.jumpHeightBoost = playerMovementData.jumpHeightBoost;
-						packetMovement.movementSpeed = playerMovementData.movementSpeed;
+						FillPlayerMovement(physicsData, physicsPacket.playerMovement);
+
+						m_session.SendPacket(physicsPacket);
 					}
 
-					m_session.SendPacket(physicsPacket);
+					layer.physicsEvents.clear();
 				}
-
-				layer.physicsEvents.clear();
 			}
 
 			m_pendingEvents.Clear(VisibilityEventType::PhysicsUpdate);
@@ -598,28 +702,41 @@ namespace bw
 
 		if (m_pendingEvents.Test(VisibilityEventType::WeaponUpdate))
 		{
-			for (auto it = m_layers.begin(); it != m_layers.end(); ++it)
+			if (m_batchedEntityEvents)
 			{
-				auto& layer = *it.value();
-				if (layer.weaponEvents.empty())
-					continue;
-
-				LayerIndex layerIndex = it.key();
+				// id + weapon id
+				constexpr std::size_t MaxEntitySize = 5 + 5;
 
-				for (auto&& pair : layer.weaponEvents)
+				SendBatchedEntityEvents(m_weaponUpdatePacket, networkTick, MaxEntitySize, &Layer::weaponEvents, [&](Packets::EntitiesWeapon::Entity& entityData, const NetworkSyncSystem::EntityWeapon& weaponData)
+				{
+					entityData.weaponEntityId = (weaponData.weaponId.has_value()) ? weaponData.weaponId.value() : Packets::EntitiesWeapon::NoWeapon;
+				});
+			}
+			else
+			{
+				for (auto it = m_layers.begin(); it != m_layers.end(); ++it)
 				{
-					Packets::EntityWeapon weaponPacket;
-					weaponPacket.entityId.layerId = layerIndex;
-					weaponPacket.entityId.entityId = pair.first;
-					weaponPacket.stateTick = networkTick;
+					auto& layer = *it.value();
+					if (layer.weaponEvents.empty())
+						continue;
 
-					auto& weaponData = pair.second;
-					weaponPacket.weaponEntityId = (weaponData.weaponId.has_value()) ? weaponData.weaponId.value() : Packets::EntityWeapon::NoWeapon;
+					LayerIndex layerIndex = it.key();
 
-					m_session.SendPacket(weaponPacket);
-				}
+					for (auto&& pair : layer.weaponEvents)
+					{
+						Packets::EntityWeapon weaponPacket;
+						weaponPacket.entityId.layerId = layerIndex;
+						weaponPacket.entityId.entityId = pair.first;
+						weaponPacket.stateTick = networkTick;
+
+						auto& weaponData = pair.second;
+						weaponPacket.weaponEntityId = (weaponData.weaponId.has_value()) ? weaponData.weaponId.value() : Packets::EntityWeapon::NoWeapon;
 
-				layer.weaponEvents.clear();
+						m_session.SendPacket(weaponPacket);
+					}
+
+					layer.weaponEvents.clear();
+				}
 			}
 
 			m_pendingEvents.Clear(VisibilityEventType::WeaponUpdate);
@@ -692,6 +809,9 @@ namespace bw
 		layer.creationEvents[eventData.entityId] = eventData;
 		layer.visibleEntities.emplace(eventData.entityId, Layer::VisibleEntityData{});
 
+		if (m_match.GetInterestRadius() && !eventData.parent && eventData.physicsProperties)
+			layer.interestEntities.insert(eventData.entityId);
+
 		m_pendingEvents.Set(VisibilityEventType::Creation);
 	}
 
@@ -700,6 +820,10 @@ namespace bw
 		assert(m_layers.find(layerIndex) != m_layers.end());
 		Layer& layer = *m_layers[layerIndex];
 
+		// Entities outside of the interest area are unknown to the client
+		if (layer.visibleEntities.find(entityId) == layer.visibleEntities.end())
+			return;
+
 		// Only send entity destruction packet if this entity was already created client-side
 		auto it = layer.creationEvents.find(entityId);
 		if (it != layer.creationEvents.end())
@@ -720,6 +844,7 @@ namespace bw
 
 		layer.inputUpdateEvents.erase(entityId);
 		layer.healthUpdateEvents.erase(entityId);
+		layer.interestEntities.erase(entityId);
 		layer.physicsEvents.erase(entityId);
 		layer.playAnimationEvents.erase(entityId);
 		layer.staticMovementUpdateEvents.erase(entityId);
@@ -727,16 +852,155 @@ namespace bw
 		layer.weaponEvents.erase(entityId);
 	}
 
-	void MatchClientVisibility::SendMatchState()
+	bool MatchClientVisibility::IsEntityRelevant(const Layer& layer, const NetworkSyncSystem::EntityCreation& entityCreation) const
+	{
+		const auto& interestRadius = m_match.GetInterestRadius();
+		if (!interestRadius)
+			return true;
+
+		// Descendants follow the interest of their root entity
+		if (entityCreation.parent)
+			return layer.visibleEntities.find(static_cast<Nz::UInt32>(*entityCreation.parent)) != layer.visibleEntities.end();
+
+		// Only physical entities are subject to interest management, others (such as the map) are always relevant
+		if (!entityCreation.physicsProperties)
+			return true;
+
+		return IsInInterestArea(layer, entityCreation.position, *interestRadius);
+	}
+
+	bool MatchClientVisibility::IsInInterestArea(const Layer& layer, const Nz::Vector2f& position, float radius) const
+	{
+		// Without any viewpoint on this layer, the whole layer is relevant
+		if (layer.viewpoints.empty())
+			return true;
+
+		float squaredRadius = radius * radius;
+		for (const Nz::Vector2f& viewpoint : layer.viewpoints)
+		{
+			if (viewpoint.SquaredDistance(position) <= squaredRadius)
+				return true;
+		}
+
+		return false;
+	}
+
+	void MatchClientVisibility::HandleLostMatchState(SentMatchState& sentState)
+	{
+		assert(sentState.stateTick);
+		Nz::UInt16 stateTick = *sentState.stateTick;
+
+		for (const SentMatchState::Entity& sentEntity : sentState.entities)
+		{
+			auto layerIt = m_layers.find(sentEntity.layerIndex);
+			if (layerIt == m_layers.end())
+				continue;
+
+			Layer& layer = *layerIt.value();
+
+			auto visibleIt = layer.visibleEntities.find(sentEntity.entityId);
+			if (visibleIt == layer.visibleEntities.end())
+				continue;
+
+			// Skip entities which have been sent again since
+			auto& visibleData = visibleIt.value();
+			if (visibleData.lastSentTick != stateTick)
+				continue;
+
+			if (sentEntity.staticMovement)
+			{
+				// Don't override a more recent movement event
+				layer.staticMovementUpdateEvents.emplace(sentEntity.entityId, *sentEntity.staticMovement);
+			}
+			else
+				visibleData.priorityAccumulator = static_cast<Nz::UInt8>(std::min(visibleData.priorityAccumulator + sentEntity.priorityAccumulator, 0xFF));
+		}
+
+		sentState.entities.clear();
+		sentState.quantizedStates.clear();
+		sentState.stateTick.reset();
+	}
+
+	/*!
+	* \brief Sends the pending events of every layer as multi-entity packets, split so that each one fits in a single ENet packet
+	*
+	* \param maxEntitySize Worst-case encoded size of one entity record
+	*/
+	template<typename T, typename E, typename F>
+	void MatchClientVisibility::SendBatchedEntityEvents(T& packet, Nz::UInt16 networkTick, std::size_t maxEntitySize, tsl::hopscotch_map<Nz::UInt32, E> Layer::* layerEvents, F&& fillEntity)
 	{
-		constexpr std::size_t MaxPacketSize = Nz::ENetConstants::ENetHost_DefaultMTU - sizeof(Nz::ENetProtocolHeader) - sizeof(Nz::ENetProtocolSendFragment);
+		constexpr std::size_t MaxHeaderSize = sizeof(Nz::UInt8) + sizeof(Nz::UInt16) + 5; //< opcode + state tick + layer count
+		constexpr std::size_t MaxLayerSize = 3 + 5; //< layer index + entity count
 
-		auto HasExceededPacketSize = [&]() -> bool
+		std::size_t packetSize = 0;
+		auto ResetPacket = [&]
 		{
-			std::size_t size = Packets::EstimateSize(m_matchStatePacket);
-			return size > MaxPacketSize;
+			packet.stateTick = networkTick;
+			packet.entities.clear();
+			packet.layers.clear();
+
+			packetSize = MaxHeaderSize;
 		};
 
+		ResetPacket();
+
+		for (auto it = m_layers.begin(); it != m_layers.end(); ++it)
+		{
+			auto& events = (*it.value()).*layerEvents;
+			if (events.empty())
+				continue;
+
+			Nz::UInt32 layerEntityCount = 0;
+			for (auto&& pair : events)
+			{
+				bool newLayer = (layerEntityCount == 0);
+				std::size_t entitySize = maxEntitySize + ((newLayer) ? MaxLayerSize : 0);
+
+				// Allow at least one entity in the packet
+				if (!packet.entities.empty() && packetSize + entitySize > MaxBatchedEventsPacketSize)
+				{
+					m_session.SendPacket(packet);
+					ResetPacket();
+
+					layerEntityCount = 0;
+					newLayer = true;
+					entitySize = maxEntitySize + MaxLayerSize;
+				}
+
+				if (newLayer)
+				{
+					auto& layerData = packet.layers.emplace_back();
+					layerData.layerIndex = it.key();
+				}
+
+				auto& entityData = packet.entities.emplace_back();
+				entityData.id = pair.first;
+				fillEntity(entityData, pair.second);
+
+				packet.layers.back().entityCount = ++layerEntityCount;
+				packetSize += entitySize;
+			}
+
+			events.clear();
+		}
+
+		if (!packet.entities.empty())
+			m_session.SendPacket(packet);
+	}
+
+	void MatchClientVisibility::SendMatchState()
+	{
+		if (m_acknowledgedStateTick)
+		{
+			// MatchState packets are unreliable but sequenced: any state older than the last acknowledged one that wasn't acknowledged has been lost
+			Nz::UInt16 acknowledgedTick = *m_acknowledgedStateTick;
+			for (SentMatchState& sentState : m_sentMatchStates)
+			{
+				if (sentState.stateTick && !sentState.isAcknowledged && IsMoreRecent(acknowledgedTick, *sentState.stateTick))
+					HandleLostMatchState(sentState);
+			}
+		}
+
 		Terrain& terrain = m_match.GetTerrain();
 
 		m_priorityMovementData.clear();
@@ -745,7 +1009,7 @@ namespace bw
 			m_priorityMovementData.push_back(PriorityMovementData{
 				priorityAccumulator,
 				layerIndex,
-				movementData,
+				&movementData,
 				isStatic
 			});
 		};
@@ -766,34 +1030,28 @@ namespace bw
 				PushMovementData(layerIndex, visibleData.priorityAccumulator, pair.second, true);
 			}
 
-			layer.staticMovementUpdateEvents.clear();
-
 			TerrainLayer& terrainLayer = terrain.GetLayer(layerIndex);
 			const NetworkSyncSystem& syncSystem = terrainLayer.GetWorld().GetSystem<NetworkSyncSystem>();
 
-			syncSystem.MoveEntities([&](const NetworkSyncSystem::EntityMovement* entitiesMovement, std::size_t entityCount)
+			const NetworkSyncSystem::MovementSnapshot& movementSnapshot = syncSystem.GetMovementSnapshot();
+			for (const NetworkSyncSystem::EntityMovement& movementData : movementSnapshot.entities)
 			{
-				for (std::size_t i = 0; i < entityCount; ++i)
-				{
-					auto& movementData = entitiesMovement[i];
-
-					auto visibleIt = layer.visibleEntities.find(movementData.entityId);
-					if (visibleIt == layer.visibleEntities.end())
-						continue;
-
-					auto& visibleData = visibleIt.value();
-					Nz::UInt64 entityKey = Nz::UInt64(layerIndex) << 32 | movementData.entityId;
-					if (m_controlledEntities.find(entityKey) != m_controlledEntities.end())
-					{
-						//FIXME
-						visibleData.priorityAccumulator = 0xFF;
-					}
-					else
-						visibleData.priorityAccumulator += 1; //< TODO use NetworkSyncComponent value
+				auto visibleIt = layer.visibleEntities.find(movementData.entityId);
+				if (visibleIt == layer.visibleEntities.end())
+					continue;
 
-					PushMovementData(layerIndex, visibleData.priorityAccumulator, movementData, false);
+				auto& visibleData = visibleIt.value();
+				Nz::UInt64 entityKey = Nz::UInt64(layerIndex) << 32 | movementData.entityId;
+				if (m_controlledEntities.find(entityKey) != m_controlledEntities.end())
+				{
+					//FIXME
+					visibleData.priorityAccumulator = 0xFF;
 				}
-			});
+				else
+					visibleData.priorityAccumulator += ComputeMovementPriority(layer, movementData.position); //< TODO use NetworkSyncComponent value
+
+				PushMovementData(layerIndex, visibleData.priorityAccumulator, movementData, false);
+			}
 		}
 
 		std::sort(m_priorityMovementData.begin(), m_priorityMovementData.end(), [](const PriorityMovementData& lhs, const PriorityMovementData& rhs)
@@ -801,65 +1059,76 @@ namespace bw
 			return lhs.priorityAccumulator > rhs.priorityAccumulator;
 		});
 
-		m_matchStatePacket.entities.clear();
-		m_matchStatePacket.layers.clear();
-		m_matchStatePacket.stateTick = m_match.GetNetworkTick();
-		m_matchStatePacket.lastInputTick = m_session.GetLastInputTick();
+		Nz::UInt16 stateTick = m_match.GetNetworkTick();
 
-		std::size_t handledEntities = 0;
-		for (PriorityMovementData& movementData : m_priorityMovementData)
+		// Quantized entities are sent relative to the last state the client acknowledged, if we still remember it
+		SentMatchState* baselineState = nullptr;
+		if (m_matchStateQuantizer && m_acknowledgedStateTick)
 		{
-			std::size_t entityIndex = 0;
-
-			LayerIndex layerIndex = 0;
-			std::size_t layerCount = m_matchStatePacket.layers.size();
-			for (; layerIndex < layerCount; ++layerIndex)
+			Nz::UInt16 acknowledgedTick = *m_acknowledgedStateTick;
+			Nz::UInt16 tickDiff = stateTick - acknowledgedTick;
+			if (tickDiff > 0 && tickDiff < MatchStateHistorySize)
 			{
-				auto& layer = m_matchStatePacket.layers[layerIndex];
-				entityIndex += layer.entityCount;
-
-				if (layer.layerIndex == movementData.layerIndex)
-				{
-					layer.entityCount++;
-					break;
-				}
+				SentMatchState& candidate = m_sentMatchStates[acknowledgedTick % MatchStateHistorySize];
+				if (candidate.stateTick == acknowledgedTick)
+					baselineState = &candidate;
 			}
+		}
 
-			// Has layer been found?
-			if (layerIndex == layerCount)
-			{
-				// No, insert it as a new one
-				auto& layer = m_matchStatePacket.layers.emplace_back();
-				layer.entityCount = 1;
-				layer.layerIndex = movementData.layerIndex;
-			}
+		SentMatchState& sentState = m_sentMatchStates[stateTick % MatchStateHistorySize];
+		if (sentState.stateTick && !sentState.isAcknowledged && m_acknowledgedStateTick)
+		{
+			// We never got any acknowledgement for this state in time, consider it lost
+			HandleLostMatchState(sentState);
+		}
 
-			assert(entityIndex <= m_matchStatePacket.entities.size());
-			auto entityIt = m_matchStatePacket.entities.emplace(m_matchStatePacket.entities.begin() + entityIndex);
-			BuildMovementPacket(*entityIt, movementData.movementData);
+		sentState.entities.clear();
+		sentState.quantizedStates.clear();
+		sentState.isAcknowledged = false;
+		sentState.stateTick = stateTick;
 
-			if (handledEntities != 0 && HasExceededPacketSize()) //< Allow at least one entity in the packet
+		m_matchStateBuilder.Clear(m_matchStateQuantizer.has_value());
+		for (const PriorityMovementData& movementData : m_priorityMovementData)
+		{
+			const NetworkSyncSystem::EntityMovement& entityMovement = *movementData.movementData;
+
+			Packets::MatchState::Entity entityData;
+			BuildMovementPacket(entityData, entityMovement);
+
+			if (m_matchStateQuantizer)
 			{
-				// Remove last inserted entity
-				m_matchStatePacket.entities.erase(entityIt);
+				Nz::UInt64 entityKey = Nz::UInt64(movementData.layerIndex) << 32 | entityMovement.entityId;
 
-				auto& layer = m_matchStatePacket.layers[layerIndex];
-				if (--layer.entityCount == 0)
+				const MatchStateQuantizer::EntityState* baseline = nullptr;
+				if (baselineState)
 				{
-					assert(layerIndex == layerCount);
-					m_matchStatePacket.layers.pop_back();
+					if (auto it = baselineState->quantizedStates.find(entityKey); it != baselineState->quantizedStates.end())
+						baseline = &it.value();
 				}
 
-				handledEntities--;
+				MatchStateQuantizer::EntityState entityState;
+				m_matchStateQuantizer->Encode(entityData, baseline, entityState);
 
-				break;
-			}
+				if (!m_matchStateBuilder.PushEntity(movementData.layerIndex, std::move(entityData)))
+					break;
 
-			handledEntities++;
+				sentState.quantizedStates[entityKey] = entityState;
+			}
+			else if (!m_matchStateBuilder.PushEntity(movementData.layerIndex, std::move(entityData)))
+				break;
 		}
 
-		// Reset priority only once we're sure entities are being sent
-		// TODO: Reset priority accumulator only once a client acknowledge the packet? (Or maybe reset priority / events if the packet is lost)
+		m_matchStatePacket.stateTick = stateTick;
+		m_matchStatePacket.lastInputTick = m_session.GetLastInputTick();
+		m_matchStatePacket.baselineTick.reset();
+		if (baselineState)
+			m_matchStatePacket.baselineTick = baselineState->stateTick;
+
+		m_matchStateBuilder.Build(m_matchStatePacket);
+
+		std::size_t handledEntities = m_matchStateBuilder.GetEntityCount();
+
+		// Reset priority only once we're sure entities are being sent, and remember them in case the packet gets lost
 		for (std::size_t i = 0; i < handledEntities; ++i)
 		{
 			const PriorityMovementData& movementData = m_priorityMovementData[i];
@@ -869,16 +1138,29 @@ namespace bw
 
 			auto& layerData = *layerIt.value();
 
-			Nz::UInt32 entityId = Nz::UInt32(movementData.movementData.entityId);
+			Nz::UInt32 entityId = Nz::UInt32(movementData.movementData->entityId);
 
 			auto visibleIt = layerData.visibleEntities.find(entityId);
 			assert(visibleIt != layerData.visibleEntities.end());
 
 			auto& visibleData = visibleIt.value();
+			visibleData.lastSentTick = stateTick;
 			visibleData.priorityAccumulator = 0;
 
+			auto& sentEntity = sentState.entities.emplace_back();
+			sentEntity.entityId = entityId;
+			sentEntity.layerIndex = movementData.layerIndex;
+			sentEntity.priorityAccumulator = movementData.priorityAccumulator;
+
 			if (movementData.staticEntity)
-				layerData.staticMovementUpdateEvents.erase(entityId);
+				sentEntity.staticMovement = *movementData.movementData;
+		}
+
+		// Static movement events are referenced by m_priorityMovementData and can only be released now, keep the ones which didn't fit in the packet
+		for (const SentMatchState::Entity& sentEntity : sentState.entities)
+		{
+			if (sentEntity.staticMovement)
+				m_layers[sentEntity.layerIndex]->staticMovementUpdateEvents.erase(sentEntity.entityId);
 		}
 
 		//bwLog(m_match.GetLogger(), LogLevel::Debug, "Entity count: {0} (packet size: {1})", m_matchStatePacket.entities.size(), Packets::EstimateSize(m_matchStatePacket));
@@ -886,76 +1168,151 @@ namespace bw
 		m_session.SendPacket(m_matchStatePacket);
 	}
 
-	void MatchClientVisibility::BuildMovementPacket(Packets::MatchState::Entity& packetData, const NetworkSyncSystem::EntityMovement& eventData)
+	void MatchClientVisibility::UpdateInterestAreas()
 	{
-		packetData.id = eventData.entityId;
-		packetData.position = eventData.position;
-		packetData.rotation = eventData.rotation;
+		const auto& interestRadius = m_match.GetInterestRadius();
+		assert(interestRadius);
 
-		if (eventData.playerMovement.has_value())
-		{
-			packetData.playerMovement.emplace();
-			packetData.playerMovement->isFacingRight = eventData.playerMovement->isFacingRight;
-		}
+		Terrain& terrain = m_match.GetTerrain();
 
-		if (eventData.physicsProperties.has_value())
+		for (auto it = m_layers.begin(); it != m_layers.end(); ++it)
 		{
-			packetData.physicsProperties.emplace();
-			packetData.physicsProperties->angularVelocity = eventData.physicsProperties->angularVelocity;
-			packetData.physicsProperties->linearVelocity = eventData.physicsProperties->linearVelocity;
+			LayerIndex layerIndex = it.key();
+			auto& layer = *it.value();
+
+			if (layer.viewpoints.empty())
+				continue;
+
+			TerrainLayer& terrainLayer = terrain.GetLayer(layerIndex);
+			const NetworkSyncSystem& syncSystem = terrainLayer.GetWorld().GetSystem<NetworkSyncSystem>();
+
+			const NetworkSyncSystem::InterestSnapshot& interestSnapshot = syncSystem.GetInterestSnapshot(*interestRadius);
+
+			// Destroy entities leaving the interest area (using a larger radius to prevent them from flickering at its edge)
+			for (Nz::UInt32 entityId : layer.interestEntities)
+			{
+				auto entityIt = interestSnapshot.entities.find(entityId);
+				if (entityIt == interestSnapshot.entities.end())
+					continue;
+
+				if (!IsInInterestArea(layer, entityIt->second.position, *interestRadius * InterestLeaveFactor))
+					m_interestUpdateEntities.push_back(entityId);
+			}
+
+			for (Ndk::EntityId entityId : m_interestUpdateEntities)
+			{
+				const auto& entityData = interestSnapshot.entities.find(entityId)->second;
+				for (Ndk::EntityId descendantId : entityData.descendants)
+					HandleEntityRemove(layerIndex, descendantId, false);
+
+				HandleEntityRemove(layerIndex, entityId, false);
+			}
+			m_interestUpdateEntities.clear();
+
+			// Create entities entering the interest area
+			auto PushEntity = [&](Ndk::EntityId entityId)
+			{
+				if (!layer.visibleEntities.emplace(static_cast<Nz::UInt32>(entityId), Layer::VisibleEntityData{}).second)
+					return false;
+
+				m_interestUpdateEntities.push_back(entityId);
+				return true;
+			};
+
+			for (const Nz::Vector2f& viewpoint : layer.viewpoints)
+			{
+				interestSnapshot.grid.Query(viewpoint, *interestRadius, [&](const Nz::Vector2f& /*position*/, Ndk::EntityId entityId)
+				{
+					if (!PushEntity(entityId))
+						return;
+
+					const auto& entityData = interestSnapshot.entities.find(entityId)->second;
+					for (Ndk::EntityId descendantId : entityData.descendants)
+						PushEntity(descendantId);
+				});
+			}
+
+			if (!m_interestUpdateEntities.empty())
+			{
+				syncSystem.CreateEntities(m_interestUpdateEntities.data(), m_interestUpdateEntities.size(), [&](const NetworkSyncSystem::EntityCreation* entitiesCreation, std::size_t entityCount)
+				{
+					for (std::size_t i = 0; i < entityCount; ++i)
+						HandleEntityCreation(layerIndex, entitiesCreation[i]);
+				});
+
+				m_interestUpdateEntities.clear();
+			}
 		}
 	}
 
-	void MatchClientVisibility::FillEntityData(const NetworkSyncSystem::EntityCreation& creationEvent, Packets::Helper::EntityData& entityData)
+	void MatchClientVisibility::UpdateViewpoints()
 	{
-		const NetworkStringStore& networkStringStore = m_match.GetNetworkStringStore();
+		Terrain& terrain = m_match.GetTerrain();
 
-		assert(creationEvent.uniqueId > 0);
+		for (auto it = m_layers.begin(); it != m_layers.end(); ++it)
+		{
+			LayerIndex layerIndex = it.key();
+			auto& layer = *it.value();
 
-		entityData.entityClass = networkStringStore.CheckStringIndex(creationEvent.entityClass);
-		entityData.uniqueId = static_cast<Nz::UInt64>(creationEvent.uniqueId);
-		entityData.position = creationEvent.position;
-		entityData.rotation = creationEvent.rotation;
+			Ndk::World& world = terrain.GetLayer(layerIndex).GetWorld();
 
-		if (!Nz::NumberEquals(creationEvent.scale, 1.f))
-			entityData.scale = creationEvent.scale;
+			std::size_t previousViewpointCount = layer.viewpoints.size();
+			for (Nz::UInt64 entityKey : m_controlledEntities)
+			{
+				if (LayerIndex(entityKey >> 32) != layerIndex)
+					continue;
 
-		if (creationEvent.inputs.has_value())
-			entityData.inputs = creationEvent.inputs.value();
+				Ndk::EntityId entityId = static_cast<Ndk::EntityId>(entityKey & 0xFFFFFFFF);
+				if (!world.IsEntityIdValid(entityId))
+					continue;
 
-		if (creationEvent.parent.has_value())
-			entityData.parentId = creationEvent.parent.value();
+				const Ndk::EntityHandle& entity = world.GetEntity(entityId);
+				layer.viewpoints.emplace_back(entity->GetComponent<Ndk::NodeComponent>().GetPosition(Nz::CoordSys_Global));
+			}
 
-		if (creationEvent.healthProperties.has_value())
-		{
-			entityData.health.emplace();
-			entityData.health->currentHealth = creationEvent.healthProperties->currentHealth;
-			entityData.health->maxHealth = creationEvent.healthProperties->maxHealth;
+			// Keep previous viewpoints if the client doesn't control any entity on this layer anymore (so dead players still see what's around them)
+			if (layer.viewpoints.size() > previousViewpointCount)
+				layer.viewpoints.erase(layer.viewpoints.begin(), layer.viewpoints.begin() + previousViewpointCount);
 		}
+	}
 
-		if (creationEvent.playerMovement.has_value())
-		{
-			entityData.playerMovement.emplace();
-			entityData.playerMovement->isFacingRight = creationEvent.playerMovement->isFacingRight;
-		}
+	void MatchClientVisibility::BuildMovementPacket(Packets::MatchState::Entity& packetData, const NetworkSyncSystem::EntityMovement& eventData)
+	{
+		packetData.id = eventData.entityId;
+		packetData.position = eventData.position;
+		packetData.rotation = eventData.rotation;
 
-		if (creationEvent.physicsProperties.has_value())
+		if (eventData.playerMovement.has_value())
 		{
-			const auto& physicsProperties = *creationEvent.physicsProperties;
-
-			entityData.physicsProperties.emplace();
-			entityData.physicsProperties->angularVelocity = physicsProperties.angularVelocity;
-			entityData.physicsProperties->linearVelocity = physicsProperties.linearVelocity;
-			entityData.physicsProperties->isAsleep = physicsProperties.isSleeping;
-			entityData.physicsProperties->mass = physicsProperties.mass;
-			entityData.physicsProperties->momentOfInertia = physicsProperties.momentOfInertia;
+			packetData.playerMovement.emplace();
+			packetData.playerMovement->isFacingRight = eventData.playerMovement->isFacingRight;
 		}
 
-		for (auto&& [propertyName, propertyValue] : creationEvent.properties)
+		if (eventData.physicsProperties.has_value())
 		{
-			auto& propertyData = entityData.properties.emplace_back();
-			propertyData.name = networkStringStore.CheckStringIndex(propertyName);
-			propertyData.value = propertyValue;
+			packetData.physicsProperties.emplace();
+			packetData.physicsProperties->angularVelocity = eventData.physicsProperties->angularVelocity;
+			packetData.physicsProperties->linearVelocity = eventData.physicsProperties->linearVelocity;
 		}
 	}
+
+	Nz::UInt8 MatchClientVisibility::ComputeMovementPriority(const Layer& layer, const Nz::Vector2f& position) const
+	{
+		const auto& interestRadius = m_match.GetInterestRadius();
+		if (!interestRadius || layer.viewpoints.empty())
+			return 1;
+
+		float closestSquaredDistance = std::numeric_limits<float>::infinity();
+		for (const Nz::Vector2f& viewpoint : layer.viewpoints)
+			closestSquaredDistance = std::min(closestSquaredDistance, viewpoint.SquaredDistance(position));
+
+		// Entities closer to the player are updated more often
+		float distanceFactor = std::sqrt(closestSquaredDistance) / *interestRadius;
+		if (distanceFactor < 1.f / 3.f)
+			return 3;
+		else if (distanceFactor < 2.f / 3.f)
+			return 2;
+		else
+			return 1;
+	}
 }
@@ -30,6 +30,12 @@ namespace bw
 		m_sessionIdToSession.clear();
 	}
 
+	void MatchSessions::Flush()
+	{
+		for (auto& sessionManager : m_managers)
+			sessionManager->Flush();
+	}
+
 	void MatchSessions::Poll()
 	{
 		for (auto& sessionManager : m_managers)
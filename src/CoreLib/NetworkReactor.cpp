@@ -5,27 +5,61 @@
 #include <CoreLib/NetworkReactor.hpp>
 #include <CoreLib/Config.hpp>
 #include <CoreLib/Utils.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <algorithm>
 #include <cassert>
-#include <condition_variable>
-#include <mutex>
+#include <iterator>
 #include <stdexcept>
 
 namespace bw
 {
 	NetworkReactor::NetworkReactor(std::size_t firstId, Nz::NetProtocol protocol, Nz::UInt16 port, std::size_t maxClient) :
 	m_firstId(firstId),
-	m_protocol(protocol)
+	m_pendingConnectionCount(0),
+	m_connectionConsumerToken(m_connectionRequests),
+	m_outgoingProducerToken(m_outgoingQueue),
+	m_wakeUpPeer(nullptr),
+	m_protocol(protocol),
+	m_isBatchingOutgoing(false),
+	m_isWakeUpConnected(false)
 	{
+		m_outgoingBuffer.resize(OutgoingBulkSize);
+
+		const Nz::IpAddress& loopbackAddress = (protocol == Nz::NetProtocol_IPv4) ? Nz::IpAddress::LoopbackIpV4 : Nz::IpAddress::LoopbackIpV6;
+
+		// One more ENet peer is used by the wake-up connection, it's reserved below before any client can connect
 		if (port > 0)
 		{
-			if (!m_host.Create(protocol, port, maxClient, NetworkChannelCount))
+			if (!m_host.Create(protocol, port, maxClient + 1, NetworkChannelCount))
 				throw std::runtime_error("failed to start reactor");
 		}
-		else if (!m_host.Create((protocol == Nz::NetProtocol_IPv4) ? Nz::IpAddress::LoopbackIpV4 : Nz::IpAddress::LoopbackIpV6, maxClient, NetworkChannelCount))
+		else if (!m_host.Create(loopbackAddress, maxClient + 1, NetworkChannelCount))
 			throw std::runtime_error("failed to start reactor");
 
+		// The reactor thread blocks in ENet, which only returns early when an event occurs: outgoing events are signaled by sending a packet through a loopback connection
+		// The connection is made by m_host itself, its peer is known by id (instead of being an incoming connection any client could take)
+		if (!m_wakeUpHost.Create(loopbackAddress, 1, 1))
+			throw std::runtime_error("failed to start reactor wake-up host");
+
+		m_wakeUpAddress = loopbackAddress;
+		m_wakeUpAddress.SetPort(m_wakeUpHost.GetBoundAddress().GetPort());
+
+		m_hostLoopbackAddress = loopbackAddress;
+		m_hostLoopbackAddress.SetPort(m_host.GetBoundAddress().GetPort());
+
+		Nz::ENetPeer* wakeUpPeer = m_host.Connect(m_wakeUpAddress, 1);
+		if (!wakeUpPeer)
+			throw std::runtime_error("failed to connect reactor wake-up host");
+
+		m_wakeUpPeerId = wakeUpPeer->GetPeerId();
+
 		m_clients.resize(maxClient, nullptr);
+		m_connectionAttempts.resize(maxClient);
+		m_peerSlots.resize(maxClient + 1, InvalidPeerId); //< Every ENet peer of m_host, including the wake-up one
+		m_reliablePackets.resize(maxClient);
+		m_freeSlots.Resize(maxClient, true);
 
+		m_isWakeUpRequested.store(false, std::memory_order_relaxed);
 		m_running.store(true, std::memory_order_release);
 		m_thread = Nz::Thread(&NetworkReactor::WorkerThread, this);
 		m_thread.SetName("NetworkReactor");
@@ -33,40 +67,38 @@ namespace bw
 
 	NetworkReactor::~NetworkReactor()
 	{
+		FlushOutgoing();
+
 		m_running.store(false, std::memory_order_relaxed);
+		WakeUp();
+
 		m_thread.Join();
 	}
 
+	/*!
+	* \brief Requests a connection to a remote host, without waiting for it
+	*
+	* The peer id is reserved right away while the reactor thread handles the connection (along with timeouts and retries).
+	* The outcome is reported through Poll: a connection event once connected, or a disconnection event with DisconnectionCause::ConnectionFailed if every attempt failed.
+	* Until the connection event, packets sent to the peer are dropped and info queries are not answered (see SendData).
+	*
+	* \return Peer id of the new connection, or InvalidPeerId if every peer is already in use
+	*/
 	std::size_t NetworkReactor::ConnectTo(Nz::IpAddress address, Nz::UInt32 data)
 	{
-		// We will need a few synchronization primitives to block the calling thread until the reactor has treated our request
-		std::condition_variable signal;
-		std::mutex signalMutex;
+		std::size_t slot = AllocateSlot();
+		if (slot == InvalidPeerId)
+			return InvalidPeerId;
 
 		ConnectionRequest request;
 		request.data = data;
 		request.remoteAddress = std::move(address);
+		request.slot = slot;
 
-		std::size_t newClientId = InvalidPeerId;
-		bool hasReturned = false;
-		request.callback = [&](std::size_t peerId)
-		{
-			// This callback is called from within the reactor
-			newClientId = m_firstId + peerId;
-			hasReturned = true;
-
-			std::unique_lock<std::mutex> lock(signalMutex);
-			signal.notify_all();
-		};
+		m_connectionRequests.enqueue(std::move(request));
+		WakeUp();
 
-		// Lock before enqueuing the request, to prevent notify being called before we actually wait on the signal
-		std::unique_lock<std::mutex> lock(signalMutex);
-		m_connectionRequests.enqueue(request);
-
-		// As InvalidClientId is a possible return from the callback, we need another variable to prevent spurious wakeup
-		signal.wait(lock, [&]() { return hasReturned; });
-
-		return newClientId;
+		return m_firstId + slot;
 	}
 
 	void NetworkReactor::DisconnectPeer(std::size_t peerId, Nz::UInt32 data, DisconnectionType type)
@@ -81,9 +113,42 @@ namespace bw
 		outgoingData.peerId = peerId - m_firstId;
 		outgoingData.data = std::move(disconnectEvent);
 
-		m_outgoingQueue.enqueue(std::move(outgoingData));
+		EnqueueOutgoing(std::move(outgoingData));
 	}
 
+	/*!
+	* \brief Enables or disables outgoing events batching
+	*
+	* When enabled, packets, disconnections and info queries are kept aside and only handed to the reactor thread (in a single bulk operation) when FlushOutgoing is called.
+	* This reduces contention on the outgoing queue when many packets are sent at once (as in a match tick), at the cost of having to call FlushOutgoing.
+	*/
+	void NetworkReactor::EnableOutgoingBatching(bool enable)
+	{
+		if (m_isBatchingOutgoing == enable)
+			return;
+
+		if (!enable)
+			FlushOutgoing();
+
+		m_isBatchingOutgoing = enable;
+	}
+
+	void NetworkReactor::FlushOutgoing()
+	{
+		if (m_pendingOutgoingEvents.empty())
+			return;
+
+		m_outgoingQueue.enqueue_bulk(m_outgoingProducerToken, std::make_move_iterator(m_pendingOutgoingEvents.begin()), m_pendingOutgoingEvents.size());
+		m_pendingOutgoingEvents.clear(); //< Keep capacity for next flush
+
+		WakeUp();
+	}
+
+	/*!
+	* \brief Queries connection statistics of a peer, the callback is called from Poll
+	*
+	* The callback is never called if the peer is not connected (including while connecting).
+	*/
 	void NetworkReactor::QueryInfo(std::size_t peerId, PeerInfoCallback callback)
 	{
 		assert(peerId >= m_firstId);
@@ -94,9 +159,15 @@ namespace bw
 		auto& queryInfo = outgoingRequest.data.emplace<OutgoingEvent::QueryPeerInfo>();
 		queryInfo.callback = std::move(callback);
 
-		m_outgoingQueue.enqueue(std::move(outgoingRequest));
+		EnqueueOutgoing(std::move(outgoingRequest));
 	}
 
+	/*!
+	* \brief Queues a packet to a connected peer
+	*
+	* Packets are only sent once the connection is established, a packet sent to a peer which is still connecting (including while a failed attempt waits for its retry delay) is dropped.
+	* Callers of ConnectTo have to wait for the connection event before sending anything.
+	*/
 	void NetworkReactor::SendData(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet)
 	{
 		assert(peerId >= m_firstId);
@@ -105,27 +176,129 @@ namespace bw
 		packetEvent.channelId = channelId;
 		packetEvent.packet = std::move(packet);
 		packetEvent.flags = flags;
+		packetEvent.sendTime = Nz::GetElapsedMicroseconds();
 
 		OutgoingEvent outgoingData;
 		outgoingData.peerId = peerId - m_firstId;
 		outgoingData.data = std::move(packetEvent);
 
-		m_outgoingQueue.enqueue(std::move(outgoingData));
+		EnqueueOutgoing(std::move(outgoingData));
+	}
+
+	/*!
+	* \brief Returns how long packets took to be put on the wire since SendData was called
+	*
+	* Only packets sent to a connected peer are accounted for.
+	*/
+	auto NetworkReactor::GetSendStatistics() const -> SendStatistics
+	{
+		std::unique_lock<std::mutex> lock(m_statisticsMutex);
+		return m_sendStatistics;
+	}
+
+	void NetworkReactor::ResetSendStatistics()
+	{
+		std::unique_lock<std::mutex> lock(m_statisticsMutex);
+		m_sendStatistics = SendStatistics{};
+	}
+
+	std::size_t NetworkReactor::AllocateSlot()
+	{
+		std::unique_lock<std::mutex> lock(m_slotMutex);
+
+		std::size_t slot = m_freeSlots.FindFirst();
+		if (slot == m_freeSlots.npos)
+			return InvalidPeerId;
+
+		m_freeSlots.Reset(slot);
+		return slot;
+	}
+
+	void NetworkReactor::EnqueueOutgoing(OutgoingEvent&& outgoingEvent)
+	{
+		if (m_isBatchingOutgoing)
+			m_pendingOutgoingEvents.push_back(std::move(outgoingEvent));
+		else
+		{
+			m_outgoingQueue.enqueue(std::move(outgoingEvent));
+			WakeUp();
+		}
+	}
+
+	/*!
+	* \brief Returns how many bytes of reliable packets sent to a slot are still held by ENet (queued or waiting for an acknowledgement)
+	*/
+	Nz::UInt64 NetworkReactor::CountReliableBytesInFlight(std::size_t slot)
+	{
+		ForgetAcknowledgedPackets(slot);
+
+		Nz::UInt64 byteCount = 0;
+		for (const Nz::ENetPacketRef& packetRef : m_reliablePackets[slot])
+			byteCount += packetRef->data.GetDataSize();
+
+		return byteCount;
+	}
+
+	void NetworkReactor::ForgetAcknowledgedPackets(std::size_t slot)
+	{
+		// ENet keeps a reference on reliable packets until they are acknowledged, packets only referenced by the reactor are done
+		auto& reliablePackets = m_reliablePackets[slot];
+		reliablePackets.erase(std::remove_if(reliablePackets.begin(), reliablePackets.end(), [](const Nz::ENetPacketRef& packetRef)
+		{
+			return packetRef->referenceCount <= 1;
+		}), reliablePackets.end());
+	}
+
+	void NetworkReactor::ReleaseSlot(std::size_t slot)
+	{
+		std::unique_lock<std::mutex> lock(m_slotMutex);
+
+		assert(!m_freeSlots.Test(slot));
+		m_freeSlots.Set(slot);
+	}
+
+	/*!
+	* \brief Wakes the reactor thread so that queued outgoing events and connection requests are handled right away
+	*
+	* Only one wake-up packet is sent until the reactor thread handles the queues, if the wake-up connection isn't established yet the reactor thread will notice the events when its (shorter) service timeout expires.
+	*/
+	void NetworkReactor::WakeUp()
+	{
+		if (m_isWakeUpRequested.exchange(true, std::memory_order_acq_rel))
+			return;
+
+		std::unique_lock<std::mutex> lock(m_wakeUpMutex);
+		if (m_wakeUpPeer && m_wakeUpPeer->GetState() == Nz::ENetPeerState::Connected)
+		{
+			m_wakeUpPeer->Send(0, Nz::ENetPacketFlag_Unsequenced, Nz::NetPacket(0));
+			m_wakeUpHost.Flush();
+		}
 	}
 
 	void NetworkReactor::WorkerThread()
 	{
-		moodycamel::ConsumerToken connectionToken(m_connectionRequests);
 		moodycamel::ConsumerToken outgoingToken(m_outgoingQueue);
 		moodycamel::ProducerToken incomingToken(m_incomingQueue);
 
 		while (m_running.load(std::memory_order_acquire))
 		{
+			// Blocks until an ENet event occurs (including wake-up packets) or until the timeout expires
 			ReceivePackets(incomingToken);
+
+			// Events queued from now on will send a new wake-up packet
+			m_isWakeUpRequested.store(false, std::memory_order_release);
+
 			SendPackets(incomingToken, outgoingToken);
 
 			// Handle connection requests last to treat disconnection request before connection requests
-			HandleConnectionRequests(connectionToken);
+			HandleConnectionRequests(incomingToken);
+			UpdateConnectionAttempts(incomingToken);
+
+			ServiceWakeUpHost();
+
+			// Put packets on the wire now instead of waiting for the next service
+			m_host.Flush();
+			UpdateSendStatistics();
 		}
 
 		EnsureProperDisconnection(incomingToken, outgoingToken);
@@ -170,11 +343,8 @@ namespace bw
 				switch (event.type)
 				{
 					case Nz::ENetEventType::Disconnect:
-					{
-						Nz::UInt16 peerId = event.peer->GetPeerId();
-						m_clients[peerId] = nullptr;
+						ReleasePeer(event.peer);
 						break;
-					}
 
 					default:
 						// Ignore everything else
@@ -188,27 +358,82 @@ namespace bw
 		}
 	}
 
-	void NetworkReactor::HandleConnectionRequests(moodycamel::ConsumerToken& token)
-{
+	/*!
+	* \brief Handles a failed connection attempt, by scheduling a new one or by reporting the failure if there's no attempt left
+	*/
+	void NetworkReactor::FailConnectionAttempt(const moodycamel::ProducerToken& producterToken, std::size_t slot)
+	{
+		ConnectionAttempt& attempt = *m_connectionAttempts[slot];
+		if (attempt.remainingAttempts > 0)
+		{
+			attempt.isConnecting = false;
+			attempt.nextEventTime = Nz::GetElapsedMilliseconds() + ConnectionRetryDelay;
+			return;
+		}
+
+		m_connectionAttempts[slot].reset();
+		m_pendingConnectionCount--;
+
+		IncomingEvent newEvent;
+		newEvent.peerId = m_firstId + slot;
+
+		auto& disconnectEvent = newEvent.data.emplace<IncomingEvent::DisconnectEvent>();
+		disconnectEvent.cause = DisconnectionCause::ConnectionFailed;
+		disconnectEvent.data = 0;
+
+		m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+	}
+
+	/*!
+	* \brief Returns how long the reactor thread can wait for ENet events, bounded by the next connection attempt event
+	*
+	* Outgoing events can't wake the reactor thread up until the wake-up connection is established, a short timeout is used meanwhile.
+	*/
+	Nz::UInt32 NetworkReactor::GetServiceTimeout() const
+	{
+		Nz::UInt64 timeout = (m_isWakeUpConnected) ? MaxServiceTimeout : UnsignaledServiceTimeout;
+		if (m_pendingConnectionCount == 0)
+			return static_cast<Nz::UInt32>(timeout);
+
+		Nz::UInt64 now = Nz::GetElapsedMilliseconds();
+		for (const auto& attemptOpt : m_connectionAttempts)
+		{
+			if (!attemptOpt)
+				continue;
+
+			if (attemptOpt->nextEventTime <= now)
+				return 0;
+
+			timeout = std::min(timeout, attemptOpt->nextEventTime - now);
+		}
+
+		return static_cast<Nz::UInt32>(timeout);
+	}
+
+	void NetworkReactor::HandleConnectionRequests(const moodycamel::ProducerToken& producterToken)
+	{
 		ConnectionRequest request;
-		while (m_connectionRequests.try_dequeue(token, request))
+		while (m_connectionRequests.try_dequeue(m_connectionConsumerToken, request))
 		{
-			if (Nz::ENetPeer* peer = m_host.Connect(request.remoteAddress, NetworkChannelCount, request.data))
-			{
-				Nz::UInt16 peerId = peer->GetPeerId();
-				m_clients[peerId] = peer;
+			assert(!m_connectionAttempts[request.slot]);
 
-				request.callback(peerId);
-			}
-			else
-				request.callback(InvalidPeerId);
+			auto& attempt = m_connectionAttempts[request.slot].emplace();
+			attempt.data = request.data;
+			attempt.isConnecting = false;
+			attempt.nextEventTime = 0;
+			attempt.remainingAttempts = ConnectionAttemptCount;
+			attempt.remoteAddress = std::move(request.remoteAddress);
+
+			m_pendingConnectionCount++;
+
+			StartConnectionAttempt(producterToken, request.slot);
 		}
 	}
 
 	void NetworkReactor::ReceivePackets(const moodycamel::ProducerToken& producterToken)
 	{
 		Nz::ENetEvent event;
-		if (m_host.Service(&event, 5) > 0)
+		if (m_host.Service(&event, GetServiceTimeout()) > 0)
 		{
 			do
 			{
@@ -216,14 +441,35 @@ namespace bw
 				{
 					case Nz::ENetEventType::Disconnect:
 					{
-						Nz::UInt16 peerId = event.peer->GetPeerId();
-						m_clients[peerId] = nullptr;
+						if (event.peer->GetPeerId() == m_wakeUpPeerId)
+						{
+							// Wake-up connection was lost (or couldn't be established), the peer which was just released can be used again
+							Nz::ENetPeer* wakeUpPeer = m_host.Connect(m_wakeUpAddress, 1);
+							assert(wakeUpPeer);
+
+							m_wakeUpPeerId = wakeUpPeer->GetPeerId();
+							break;
+						}
+
+						std::size_t slot = m_peerSlots[event.peer->GetPeerId()];
+						if (slot == InvalidPeerId)
+							break; //< Refused incoming connection
+
+						ReleasePeer(event.peer);
+
+						if (m_connectionAttempts[slot])
+						{
+							// We failed to connect, retry or report the failure
+							FailConnectionAttempt(producterToken, slot);
+							break;
+						}
 
 						IncomingEvent::DisconnectEvent disconnectEvent;
+						disconnectEvent.cause = DisconnectionCause::Closed;
 						disconnectEvent.data = event.data;
 
 						IncomingEvent newEvent;
-						newEvent.peerId = m_firstId + peerId;
+						newEvent.peerId = m_firstId + slot;
 						newEvent.data.emplace<IncomingEvent::DisconnectEvent>(std::move(disconnectEvent));
 
 						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
@@ -233,15 +479,39 @@ namespace bw
 					case Nz::ENetEventType::IncomingConnect:
 					case Nz::ENetEventType::OutgoingConnect:
 					{
-						Nz::UInt16 peerId = event.peer->GetPeerId();
-						m_clients[peerId] = event.peer;
+						// Wake-up connection, its packets are ignored as it has no slot
+						if (event.peer->GetPeerId() == m_wakeUpPeerId)
+							break;
+
+						std::size_t slot;
+						if (event.type == Nz::ENetEventType::OutgoingConnect)
+						{
+							slot = m_peerSlots[event.peer->GetPeerId()];
+							assert(slot != InvalidPeerId && m_connectionAttempts[slot]);
+
+							m_connectionAttempts[slot].reset();
+							m_pendingConnectionCount--;
+						}
+						else
+						{
+							slot = AllocateSlot();
+							if (slot == InvalidPeerId)
+							{
+								// Every peer id is still in use (disconnections which haven't been polled yet)
+								event.peer->DisconnectNow(0);
+								break;
+							}
+
+							m_clients[slot] = event.peer;
+							m_peerSlots[event.peer->GetPeerId()] = slot;
+						}
 
 						IncomingEvent::ConnectEvent connectEvent;
 						connectEvent.data = event.data;
 						connectEvent.outgoingConnection = (event.type == Nz::ENetEventType::OutgoingConnect);
 
 						IncomingEvent newEvent;
-						newEvent.peerId = m_firstId + peerId;
+						newEvent.peerId = m_firstId + slot;
 						newEvent.data.emplace<IncomingEvent::ConnectEvent>(std::move(connectEvent));
 
 						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
@@ -250,13 +520,16 @@ namespace bw
 
 					case Nz::ENetEventType::Receive:
 					{
-						Nz::UInt16 peerId = event.peer->GetPeerId();
+						// Wake-up packets only have to interrupt the service
+						std::size_t slot = m_peerSlots[event.peer->GetPeerId()];
+						if (slot == InvalidPeerId)
+							break;
 
 						IncomingEvent::PacketEvent packetEvent;
 						packetEvent.packet = std::move(event.packet->data);
 
 						IncomingEvent newEvent;
-						newEvent.peerId = m_firstId + peerId;
+						newEvent.peerId = m_firstId + slot;
 						newEvent.data.emplace<IncomingEvent::PacketEvent>(std::move(packetEvent));
 
 						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
@@ -271,79 +544,256 @@ namespace bw
 		}
 	}
 
+	void NetworkReactor::ReleasePeer(Nz::ENetPeer* peer)
+	{
+		std::size_t& slot = m_peerSlots[peer->GetPeerId()];
+		if (slot == InvalidPeerId)
+			return;
+
+		m_clients[slot] = nullptr;
+		m_reliablePackets[slot].clear();
+		slot = InvalidPeerId;
+	}
+
 	void NetworkReactor::SendPackets(const moodycamel::ProducerToken& producterToken, moodycamel::ConsumerToken& token)
 	{
-		OutgoingEvent outEvent;
-		while (m_outgoingQueue.try_dequeue(token, outEvent))
+		std::size_t eventCount;
+		while ((eventCount = m_outgoingQueue.try_dequeue_bulk(token, m_outgoingBuffer.begin(), m_outgoingBuffer.size())) > 0)
 		{
-			std::visit([&](auto&& arg) {
-				using T = std::decay_t<decltype(arg)>;
-				if constexpr (std::is_same_v<T, OutgoingEvent::DisconnectEvent>)
+			for (std::size_t i = 0; i < eventCount; ++i)
+				HandleOutgoingEvent(producterToken, m_outgoingBuffer[i]);
+		}
+	}
+
+	/*!
+	* \brief Processes the wake-up host events (the connection from m_host, acknowledgements and pings)
+	*
+	* The wake-up connection is restored by m_host if it's lost.
+	*/
+	void NetworkReactor::ServiceWakeUpHost()
+	{
+		std::unique_lock<std::mutex> lock(m_wakeUpMutex);
+
+		Nz::ENetEvent event;
+		if (m_wakeUpHost.Service(&event, 0) > 0)
+		{
+			do
+			{
+				switch (event.type)
 				{
-					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
-					{
-						switch (arg.type)
+					case Nz::ENetEventType::IncomingConnect:
+						// Wake-up host only listens on loopback, but any local process could try to connect to it
+						if (event.peer->GetAddress() != m_hostLoopbackAddress)
 						{
-							case DisconnectionType::Kick:
-							{
-								peer->DisconnectNow(arg.data);
+							event.peer->DisconnectNow(0);
+							break;
+						}
 
-								// DisconnectNow does not generate Disconnect event
-								m_clients[outEvent.peerId] = nullptr;
+						m_wakeUpPeer = event.peer;
+						break;
 
-								IncomingEvent newEvent;
-								newEvent.peerId = m_firstId + outEvent.peerId;
+					case Nz::ENetEventType::Disconnect:
+						if (event.peer == m_wakeUpPeer)
+							m_wakeUpPeer = nullptr;
+						break;
 
-								auto& disconnectEvent = newEvent.data.emplace<IncomingEvent::DisconnectEvent>();
-								disconnectEvent.data = 0;
+					default:
+						break;
+				}
+			}
+			while (m_wakeUpHost.CheckEvents(&event));
+		}
 
-								m_incomingQueue.enqueue(producterToken, std::move(newEvent));
-								break;
-							}
+		m_isWakeUpConnected = (m_wakeUpPeer && m_wakeUpPeer->GetState() == Nz::ENetPeerState::Connected);
+	}
 
-							case DisconnectionType::Later:
-								peer->DisconnectLater(arg.data);
-								break;
+	void NetworkReactor::StartConnectionAttempt(const moodycamel::ProducerToken& producterToken, std::size_t slot)
+	{
+		ConnectionAttempt& attempt = *m_connectionAttempts[slot];
+		assert(attempt.remainingAttempts > 0);
+		attempt.remainingAttempts--;
 
-							case DisconnectionType::Normal:
-								peer->Disconnect(arg.data);
-								break;
+		Nz::ENetPeer* peer = m_host.Connect(attempt.remoteAddress, NetworkChannelCount, attempt.data);
+		if (!peer)
+		{
+			// Every ENet peer may be busy (some of them may still be disconnecting)
+			FailConnectionAttempt(producterToken, slot);
+			return;
+		}
 
-							default:
-								assert(!"Unknown disconnection type");
-								break;
-						}
+		m_clients[slot] = peer;
+		m_peerSlots[peer->GetPeerId()] = slot;
+
+		attempt.isConnecting = true;
+		attempt.nextEventTime = Nz::GetElapsedMilliseconds() + ConnectionAttemptTimeout;
+	}
+
+	/*!
+	* \brief Handles connection attempts timeouts and retries
+	*/
+	void NetworkReactor::UpdateConnectionAttempts(const moodycamel::ProducerToken& producterToken)
+	{
+		if (m_pendingConnectionCount == 0)
+			return;
+
+		Nz::UInt64 now = Nz::GetElapsedMilliseconds();
+		for (std::size_t slot = 0; slot < m_connectionAttempts.size(); ++slot)
+		{
+			auto& attemptOpt = m_connectionAttempts[slot];
+			if (!attemptOpt || now < attemptOpt->nextEventTime)
+				continue;
+
+			if (attemptOpt->isConnecting)
+			{
+				// Attempt timed out, DisconnectNow doesn't generate a Disconnect event
+				Nz::ENetPeer* peer = m_clients[slot];
+				assert(peer);
+
+				peer->DisconnectNow(0);
+				ReleasePeer(peer);
+
+				FailConnectionAttempt(producterToken, slot);
+			}
+			else
+				StartConnectionAttempt(producterToken, slot);
+		}
+	}
+
+	void NetworkReactor::UpdateSendStatistics()
+	{
+		if (m_unflushedSendTimes.empty())
+			return;
+
+		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+
+		std::unique_lock<std::mutex> lock(m_statisticsMutex);
+		for (Nz::UInt64 sendTime : m_unflushedSendTimes)
+		{
+			Nz::UInt64 sendDelay = now - sendTime;
+			m_sendStatistics.maxSendDelay = std::max(m_sendStatistics.maxSendDelay, sendDelay);
+			m_sendStatistics.totalSendDelay += sendDelay;
+		}
+		m_sendStatistics.packetCount += m_unflushedSendTimes.size();
+
+		m_unflushedSendTimes.clear();
+	}
+
+	void NetworkReactor::HandleOutgoingEvent(const moodycamel::ProducerToken& producterToken, OutgoingEvent& outEvent)
+	{
+		std::visit([&](auto&& arg) {
+			using T = std::decay_t<decltype(arg)>;
+			if constexpr (std::is_same_v<T, OutgoingEvent::DisconnectEvent>)
+			{
+				// ConnectTo doesn't go through the outgoing queue, a peer disconnected right after ConnectTo may still have its connection request waiting
+				if (!m_connectionAttempts[outEvent.peerId] && !m_clients[outEvent.peerId])
+					HandleConnectionRequests(producterToken);
+
+				if (m_connectionAttempts[outEvent.peerId])
+				{
+					// Abort the connection attempt, there's no connection to close gracefully yet
+					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
+					{
+						peer->DisconnectNow(arg.data);
+						ReleasePeer(peer);
 					}
+
+					m_connectionAttempts[outEvent.peerId].reset();
+					m_pendingConnectionCount--;
+
+					IncomingEvent newEvent;
+					newEvent.peerId = m_firstId + outEvent.peerId;
+
+					auto& disconnectEvent = newEvent.data.emplace<IncomingEvent::DisconnectEvent>();
+					disconnectEvent.cause = DisconnectionCause::ConnectionAborted;
+					disconnectEvent.data = 0;
+
+					m_incomingQueue.enqueue(producterToken, std::move(newEvent));
 				}
-				else if constexpr (std::is_same_v<T, OutgoingEvent::PacketEvent>)
+				else if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
 				{
-					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
-						peer->Send(arg.channelId, arg.flags, std::move(arg.packet));
+					switch (arg.type)
+					{
+						case DisconnectionType::Kick:
+						{
+							peer->DisconnectNow(arg.data);
+
+							// DisconnectNow does not generate Disconnect event
+							ReleasePeer(peer);
+
+							IncomingEvent newEvent;
+							newEvent.peerId = m_firstId + outEvent.peerId;
+
+							auto& disconnectEvent = newEvent.data.emplace<IncomingEvent::DisconnectEvent>();
+							disconnectEvent.cause = DisconnectionCause::Kicked;
+							disconnectEvent.data = 0;
+
+							m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+							break;
+						}
+
+						case DisconnectionType::Later:
+							peer->DisconnectLater(arg.data);
+							break;
+
+						case DisconnectionType::Normal:
+							peer->Disconnect(arg.data);
+							break;
+
+						default:
+							assert(!"Unknown disconnection type");
+							break;
+					}
 				}
-				else if constexpr (std::is_same_v<T, OutgoingEvent::QueryPeerInfo>)
+			}
+			else if constexpr (std::is_same_v<T, OutgoingEvent::PacketEvent>)
+			{
+				// ENet can't send to a peer before it's connected, and there's no peer at all between two connection attempts
+				if (m_connectionAttempts[outEvent.peerId])
+					return;
+
+				if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
 				{
-					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
+					Nz::ENetPacketRef enetPacket = m_host.AllocatePacket(arg.flags, std::move(arg.packet));
+					if (arg.flags & Nz::ENetPacketFlag_Reliable)
 					{
-						IncomingEvent newEvent;
-						newEvent.peerId = m_firstId + outEvent.peerId;
-
-						auto& peerInfo = newEvent.data.emplace<IncomingEvent::PeerInfoResponse>();
-						peerInfo.callback = std::move(arg.callback);
-						peerInfo.peerInfo.timeSinceLastReceive = m_host.GetServiceTime() - peer->GetLastReceiveTime();
-						peerInfo.peerInfo.ping = peer->GetRoundTripTime();
-						peerInfo.peerInfo.totalByteReceived = peer->GetTotalByteReceived();
-						peerInfo.peerInfo.totalByteSent = peer->GetTotalByteSent();
-						peerInfo.peerInfo.totalPacketLost = peer->GetTotalPacketLost();
-						peerInfo.peerInfo.totalPacketReceived = peer->GetTotalPacketReceived();
-						peerInfo.peerInfo.totalPacketSent = peer->GetTotalPacketSent();
+						auto& reliablePackets = m_reliablePackets[outEvent.peerId];
+						if (reliablePackets.size() == reliablePackets.capacity())
+							ForgetAcknowledgedPackets(outEvent.peerId); //< Keeps the list bounded even if nobody queries peer info
 
-						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+						reliablePackets.push_back(enetPacket);
 					}
+
+					peer->Send(arg.channelId, std::move(enetPacket));
+					m_unflushedSendTimes.push_back(arg.sendTime);
 				}
-				else
-					static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
+			}
+			else if constexpr (std::is_same_v<T, OutgoingEvent::QueryPeerInfo>)
+			{
+				if (m_connectionAttempts[outEvent.peerId])
+					return;
 
-			}, outEvent.data);
-		}
+				if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
+				{
+					IncomingEvent newEvent;
+					newEvent.peerId = m_firstId + outEvent.peerId;
+
+					auto& peerInfo = newEvent.data.emplace<IncomingEvent::PeerInfoResponse>();
+					peerInfo.callback = std::move(arg.callback);
+					peerInfo.peerInfo.timeSinceLastReceive = m_host.GetServiceTime() - peer->GetLastReceiveTime();
+					peerInfo.peerInfo.ping = peer->GetRoundTripTime();
+					peerInfo.peerInfo.reliableBytesInFlight = CountReliableBytesInFlight(outEvent.peerId);
+					peerInfo.peerInfo.totalByteReceived = peer->GetTotalByteReceived();
+					peerInfo.peerInfo.totalByteSent = peer->GetTotalByteSent();
+					peerInfo.peerInfo.totalPacketLost = peer->GetTotalPacketLost();
+					peerInfo.peerInfo.totalPacketReceived = peer->GetTotalPacketReceived();
+					peerInfo.peerInfo.totalPacketSent = peer->GetTotalPacketSent();
+
+					m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+				}
+			}
+			else
+				static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
+
+		}, outEvent.data);
 	}
 }
@@ -25,6 +25,7 @@ namespace bw
 		{
 			SessionInfo info;
 			info.ping = peerInfo.ping;
+			info.reliableBytesInFlight = peerInfo.reliableBytesInFlight;
 			info.timeSinceLastReceive = peerInfo.timeSinceLastReceive;
 			info.totalByteReceived = peerInfo.totalByteReceived;
 			info.totalByteSent = peerInfo.totalByteSent;
@@ -36,9 +37,9 @@ namespace bw
 		});
 	}
 
-	void NetworkSessionBridge::SendPacket(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket && packet)
+	void NetworkSessionBridge::SendPacket(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, const Nz::NetPacket& packet)
 	{
-		packet.FlushBits();
-		m_reactor.SendData(m_peerId, channelId, flags, std::move(packet));
+		// Packet belongs to the session which reuses it, the reactor gets its own copy (a single copy of the serialized content)
+		m_reactor.SendData(m_peerId, channelId, flags, Nz::NetPacket(packet.GetNetCode(), packet.GetConstData() + Nz::NetPacket::HeaderSize, packet.GetDataSize()));
 	}
 }
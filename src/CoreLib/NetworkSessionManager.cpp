@@ -15,14 +15,21 @@ namespace bw
 	SessionManager(owner),
 	m_reactor(0, Nz::NetProtocol_Any, port, maxClient)
 	{
+		// Packets are sent in bulk once per update (see Flush)
+		m_reactor.EnableOutgoingBatching(true);
 	}
 
 	NetworkSessionManager::~NetworkSessionManager() = default;
 
+	void NetworkSessionManager::Flush()
+	{
+		m_reactor.FlushOutgoing();
+	}
+
 	void NetworkSessionManager::Poll()
 	{
 		m_reactor.Poll([&](bool outgoing, std::size_t peerId, Nz::UInt32 data) { HandlePeerConnection(outgoing, peerId, data); },
-		               [&](std::size_t peerId, Nz::UInt32 data) { HandlePeerDisconnection(peerId, data); },
+		               [&](std::size_t peerId, Nz::UInt32 data, DisconnectionCause cause) { HandlePeerDisconnection(peerId, data, cause); },
 		               [&](std::size_t peerId, Nz::NetPacket&& packet) { HandlePeerPacket(peerId, std::move(packet)); });
 	}
 
@@ -40,9 +47,15 @@ namespace bw
 		m_peerIdToSession[peerId] = session;
 	}
 
-	void NetworkSessionManager::HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 /*data*/)
+	void NetworkSessionManager::HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 /*data*/, DisconnectionCause cause)
 	{
-		bwLog(GetOwner()->GetMatch().GetLogger(), LogLevel::Info, "Peer #{0} disconnected", peerId);
+		// Peers are only accepted here, their connection can't fail
+		assert(cause == DisconnectionCause::Closed || cause == DisconnectionCause::Kicked);
+
+		if (cause == DisconnectionCause::Kicked)
+			bwLog(GetOwner()->GetMatch().GetLogger(), LogLevel::Info, "Peer #{0} kicked", peerId);
+		else
+			bwLog(GetOwner()->GetMatch().GetLogger(), LogLevel::Info, "Peer #{0} disconnected", peerId);
 
 		MatchClientSession*& session = m_peerIdToSession[peerId];
 		assert(session);
@@ -11,7 +11,7 @@ namespace bw
 	PlayerCommandStore::PlayerCommandStore(const Logger& logger) :
 	CommandStore(logger)
 	{
-#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type>(#Type, [](MatchClientSession& session, Packets::Type&& packet) \
+#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type>(#Type, [](MatchClientSession& session, Packets::Type& packet) \
 { \
 	session.HandleIncomingPacket(std::move(packet)); \
 })
@@ -45,7 +45,9 @@ namespace bw
 		OutgoingCommand(EntitiesAnimation,            Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(EntitiesDeath,                Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(EntitiesInputs,               Nz::ENetPacketFlag_Reliable,    1);
+		OutgoingCommand(EntitiesPhysics,              Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(EntitiesScale,                Nz::ENetPacketFlag_Reliable,    1);
+		OutgoingCommand(EntitiesWeapon,               Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(EntityPhysics,                Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(EntityWeapon,                 Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(HealthUpdate,                 Nz::ENetPacketFlag_Reliable,    1);
@@ -0,0 +1,74 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Protocol/MatchStateBuilder.hpp>
+#include <cassert>
+
+namespace bw
+{
+	void MatchStateBuilder::Build(Packets::MatchState& packet)
+	{
+		packet.isQuantized = m_isQuantized;
+		packet.layers.resize(m_layers.size());
+		packet.entities.resize(m_pendingEntities.size());
+
+		// Entities are grouped by layer (in the order layers were first pushed), keeping their push order inside a layer
+		std::size_t offset = 0;
+		for (std::size_t i = 0; i < m_layers.size(); ++i)
+		{
+			LayerData& layerData = m_layers[i];
+			packet.layers[i].layerIndex = layerData.layerIndex;
+			packet.layers[i].entityCount = layerData.entityCount;
+
+			layerData.entityOffset = offset;
+			offset += layerData.entityCount;
+		}
+		assert(offset == m_pendingEntities.size());
+
+		for (PendingEntity& pendingEntity : m_pendingEntities)
+			packet.entities[m_layers[pendingEntity.layerDataIndex].entityOffset++] = std::move(pendingEntity.entity);
+	}
+
+	bool MatchStateBuilder::PushEntity(LayerIndex layerIndex, Packets::MatchState::Entity&& entity)
+	{
+		std::size_t layerDataIndex = 0;
+		for (; layerDataIndex < m_layers.size(); ++layerDataIndex)
+		{
+			if (m_layers[layerDataIndex].layerIndex == layerIndex)
+				break;
+		}
+
+		bool isNewLayer = (layerDataIndex == m_layers.size());
+
+		std::size_t playerEntityCount = m_playerEntityCount + ((entity.playerMovement) ? 1 : 0);
+		std::size_t physicalEntityCount = m_physicalEntityCount + ((entity.physicsProperties) ? 1 : 0);
+		std::size_t quantizedDataSize = m_quantizedDataSize + ((m_isQuantized) ? Packets::EstimateQuantizedEntitySize(entity) : 0);
+		std::size_t newSize = EstimateSize(m_layers.size() + ((isNewLayer) ? 1 : 0), m_pendingEntities.size() + 1, playerEntityCount, physicalEntityCount, quantizedDataSize);
+
+		if (!m_pendingEntities.empty() && newSize > m_maxPacketSize) //< Allow at least one entity in the packet
+			return false;
+
+		if (isNewLayer)
+			m_layers.push_back({ layerIndex, 0, 0 });
+
+		m_layers[layerDataIndex].entityCount++;
+		m_physicalEntityCount = physicalEntityCount;
+		m_playerEntityCount = playerEntityCount;
+		m_quantizedDataSize = quantizedDataSize;
+
+		PendingEntity& pendingEntity = m_pendingEntities.emplace_back();
+		pendingEntity.entity = std::move(entity);
+		pendingEntity.layerDataIndex = layerDataIndex;
+
+		return true;
+	}
+
+	std::size_t MatchStateBuilder::EstimateSize(std::size_t layerCount, std::size_t entityCount, std::size_t playerEntityCount, std::size_t physicalEntityCount, std::size_t quantizedDataSize) const
+	{
+		if (m_isQuantized)
+			return Packets::EstimateQuantizedMatchStateSize(layerCount, entityCount, playerEntityCount, quantizedDataSize);
+		else
+			return Packets::EstimateMatchStateSize(layerCount, entityCount, playerEntityCount, physicalEntityCount);
+	}
+}
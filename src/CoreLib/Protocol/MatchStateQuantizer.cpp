@@ -0,0 +1,121 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Protocol/MatchStateQuantizer.hpp>
+#include <Nazara/Math/Algorithm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace bw
+{
+	bool MatchStateQuantizer::Decode(Packets::MatchState::Entity& entity, const EntityState* baseline, EntityState& state) const
+	{
+		const auto& quantizedData = entity.quantized;
+		if (quantizedData.isDelta)
+		{
+			if (!baseline)
+				return false;
+
+			state.positionX = baseline->positionX + quantizedData.positionX;
+			state.positionY = baseline->positionY + quantizedData.positionY;
+			state.rotation = (baseline->rotation + quantizedData.rotation) & m_rotationMask;
+			state.angularVelocity = baseline->angularVelocity + quantizedData.angularVelocity;
+			state.linearVelocityX = baseline->linearVelocityX + quantizedData.linearVelocityX;
+			state.linearVelocityY = baseline->linearVelocityY + quantizedData.linearVelocityY;
+		}
+		else
+		{
+			state.positionX = quantizedData.positionX;
+			state.positionY = quantizedData.positionY;
+			state.rotation = quantizedData.rotation & m_rotationMask;
+			state.angularVelocity = quantizedData.angularVelocity;
+			state.linearVelocityX = quantizedData.linearVelocityX;
+			state.linearVelocityY = quantizedData.linearVelocityY;
+		}
+
+		entity.position.x = m_settings.positionOrigin.x + state.positionX * m_settings.positionPrecision;
+		entity.position.y = m_settings.positionOrigin.y + state.positionY * m_settings.positionPrecision;
+		entity.rotation = Nz::RadianAnglef(float(M_PI) * 2.f * state.rotation / m_rotationSteps);
+
+		if (entity.physicsProperties)
+		{
+			auto& physicsProperties = entity.physicsProperties.value();
+			physicsProperties.angularVelocity = Nz::RadianAnglef(state.angularVelocity * m_settings.angularVelocityPrecision);
+			physicsProperties.linearVelocity.x = state.linearVelocityX * m_settings.linearVelocityPrecision;
+			physicsProperties.linearVelocity.y = state.linearVelocityY * m_settings.linearVelocityPrecision;
+		}
+		else
+		{
+			// Keep the state consistent with what the server stores
+			state.angularVelocity = 0;
+			state.linearVelocityX = 0;
+			state.linearVelocityY = 0;
+		}
+
+		return true;
+	}
+
+	void MatchStateQuantizer::Encode(Packets::MatchState::Entity& entity, const EntityState* baseline, EntityState& state) const
+	{
+		state = Quantize(entity);
+
+		auto& quantizedData = entity.quantized;
+		if (baseline)
+		{
+			// Take the shortest path between both rotations
+			Nz::Int32 rotationDelta = (state.rotation - baseline->rotation) & m_rotationMask;
+			if (rotationDelta >= m_rotationSteps / 2)
+				rotationDelta -= m_rotationSteps;
+
+			quantizedData.isDelta = true;
+			quantizedData.positionX = state.positionX - baseline->positionX;
+			quantizedData.positionY = state.positionY - baseline->positionY;
+			quantizedData.rotation = rotationDelta;
+			quantizedData.angularVelocity = state.angularVelocity - baseline->angularVelocity;
+			quantizedData.linearVelocityX = state.linearVelocityX - baseline->linearVelocityX;
+			quantizedData.linearVelocityY = state.linearVelocityY - baseline->linearVelocityY;
+		}
+		else
+		{
+			quantizedData.isDelta = false;
+			quantizedData.positionX = state.positionX;
+			quantizedData.positionY = state.positionY;
+			quantizedData.rotation = state.rotation;
+			quantizedData.angularVelocity = state.angularVelocity;
+			quantizedData.linearVelocityX = state.linearVelocityX;
+			quantizedData.linearVelocityY = state.linearVelocityY;
+		}
+	}
+
+	auto MatchStateQuantizer::Quantize(const Packets::MatchState::Entity& entity) const -> EntityState
+	{
+		EntityState state;
+		state.positionX = QuantizeValue(entity.position.x - m_settings.positionOrigin.x, m_settings.positionPrecision);
+		state.positionY = QuantizeValue(entity.position.y - m_settings.positionOrigin.y, m_settings.positionPrecision);
+
+		float turns = entity.rotation.value / (float(M_PI) * 2.f);
+		turns -= std::floor(turns);
+		state.rotation = static_cast<Nz::Int32>(std::lround(turns * m_rotationSteps)) & m_rotationMask;
+
+		if (entity.physicsProperties)
+		{
+			const auto& physicsProperties = entity.physicsProperties.value();
+			state.angularVelocity = QuantizeValue(physicsProperties.angularVelocity.value, m_settings.angularVelocityPrecision);
+			state.linearVelocityX = QuantizeValue(physicsProperties.linearVelocity.x, m_settings.linearVelocityPrecision);
+			state.linearVelocityY = QuantizeValue(physicsProperties.linearVelocity.y, m_settings.linearVelocityPrecision);
+		}
+
+		return state;
+	}
+
+	Nz::Int32 MatchStateQuantizer::QuantizeValue(float value, float precision)
+	{
+		// Keep some margin so that deltas between two quantized values never overflow
+		constexpr double MaxValue = std::numeric_limits<Nz::Int32>::max() / 2;
+
+		double quantizedValue = std::round(double(value) / precision);
+		return static_cast<Nz::Int32>(std::clamp(quantizedValue, -MaxValue, MaxValue));
+	}
+}
@@ -14,35 +14,105 @@ namespace bw
 {
 	namespace Packets
 	{
+		namespace
+		{
+			void SerializeEntityData(PacketSerializer& serializer, Helper::EntityData& data, const std::shared_ptr<const Nz::ByteArray>& encodedData)
+			{
+				// Entity data shared between sessions may have been encoded once beforehand, copy it as-is
+				if (serializer.IsWriting() && encodedData)
+					serializer.Write(encodedData->GetConstBuffer(), encodedData->GetSize());
+				else
+					Serialize(serializer, data);
+			}
+		}
+
 		std::size_t EstimateSize(const MatchState& matchState)
+		{
+			std::size_t playerEntity = 0;
+			std::size_t physicalEntity = 0;
+
+			for (auto& entity : matchState.entities)
+			{
+				if (entity.playerMovement)
+					playerEntity++;
+
+				if (entity.physicsProperties)
+					physicalEntity++;
+			}
+
+			return EstimateMatchStateSize(matchState.layers.size(), matchState.entities.size(), playerEntity, physicalEntity);
+		}
+
+		std::size_t EstimateMatchStateSize(std::size_t layerCount, std::size_t entityCount, std::size_t playerEntityCount, std::size_t physicalEntityCount)
 		{
 			std::size_t size = 0;
 			
+			size += sizeof(Nz::UInt8); // quantization flag
 			size += sizeof(MatchState::lastInputTick);
 			size += sizeof(MatchState::stateTick);
 
 			size += sizeof(Nz::UInt8); // layer count
-			size += (sizeof(MatchState::Layer::layerIndex) + sizeof(MatchState::Layer::entityCount)) * matchState.layers.size();
+			size += (sizeof(MatchState::Layer::layerIndex) + sizeof(MatchState::Layer::entityCount)) * layerCount;
 
 			// entity property bit size (2 bits per entity), rounded up
-			size += (matchState.entities.size() * 2 + 7) / 8;
+			size += (entityCount * 2 + 7) / 8;
 
-			size += (sizeof(MatchState::Entity::id) + sizeof(MatchState::Entity::position) + sizeof(MatchState::Entity::rotation)) * matchState.entities.size();
+			size += (sizeof(MatchState::Entity::id) + sizeof(MatchState::Entity::position) + sizeof(MatchState::Entity::rotation)) * entityCount;
 
-			std::size_t playerEntity = 0;
-			std::size_t physicalEntity = 0;
+			size += (playerEntityCount + 7) / 8; // one bit per player entity, rounded up
+			size += (sizeof(MatchState::PhysicsProperties::angularVelocity) + sizeof(MatchState::PhysicsProperties::linearVelocity)) * physicalEntityCount;
 
-			for (auto& entity : matchState.entities)
+			return size;
+		}
+
+		std::size_t EstimateQuantizedEntitySize(const MatchState::Entity& entity)
+		{
+			auto CompressedSize = [](Nz::Int32 value) -> std::size_t
 			{
-				if (entity.playerMovement)
-					playerEntity++;
+				// ZigZag encoding followed by 7 bits per byte
+				Nz::UInt32 unsignedValue = (static_cast<Nz::UInt32>(value) << 1) ^ static_cast<Nz::UInt32>(value >> 31);
 
-				if (entity.physicsProperties)
-					physicalEntity++;
+				std::size_t byteCount = 1;
+				while (unsignedValue >>= 7)
+					byteCount++;
+
+				return byteCount;
+			};
+
+			std::size_t size = 0;
+			size += sizeof(MatchState::Entity::id);
+
+			const auto& quantizedData = entity.quantized;
+			size += CompressedSize(quantizedData.positionX);
+			size += CompressedSize(quantizedData.positionY);
+			size += CompressedSize(quantizedData.rotation);
+
+			if (entity.physicsProperties)
+			{
+				size += CompressedSize(quantizedData.angularVelocity);
+				size += CompressedSize(quantizedData.linearVelocityX);
+				size += CompressedSize(quantizedData.linearVelocityY);
 			}
 
-			size += (playerEntity + 7) / 8; // one bit per player entity, rounded up
-			size += (sizeof(MatchState::PhysicsProperties::angularVelocity) + sizeof(MatchState::PhysicsProperties::linearVelocity)) * physicalEntity;
+			return size;
+		}
+
+		std::size_t EstimateQuantizedMatchStateSize(std::size_t layerCount, std::size_t entityCount, std::size_t playerEntityCount, std::size_t entityDataSize)
+		{
+			std::size_t size = 0;
+
+			size += sizeof(Nz::UInt8); // quantization and baseline flags
+			size += sizeof(Nz::UInt16); // baseline tick
+			size += sizeof(MatchState::lastInputTick);
+			size += sizeof(MatchState::stateTick);
+
+			size += sizeof(Nz::UInt8); // layer count
+			size += (sizeof(MatchState::Layer::layerIndex) + sizeof(MatchState::Layer::entityCount)) * layerCount;
+
+			// entity property bit size (3 bits per entity + 1 bit per player entity), rounded up
+			size += (entityCount * 3 + playerEntityCount + 7) / 8;
+
+			size += entityDataSize;
 
 			return size;
 		}
@@ -53,6 +123,15 @@ namespace bw
 
 			for (auto& player : data.players)
 				serializer &= player.nickname;
+
+			CompressedUnsigned<Nz::UInt32> supportedFeatures;
+			if (serializer.IsWriting())
+				supportedFeatures = static_cast<Nz::UInt32>(static_cast<ProtocolFeatures::BitField>(data.supportedFeatures));
+
+			serializer &= supportedFeatures;
+
+			if (!serializer.IsWriting())
+				data.supportedFeatures = ProtocolFeatures(static_cast<ProtocolFeatures::BitField>(Nz::UInt32(supportedFeatures)));
 		}
 
 		void Serialize(PacketSerializer& /*serializer*/, AuthFailure& /*data*/)
@@ -65,6 +144,23 @@ namespace bw
 
 			for (auto& player : data.players)
 				serializer &= player.playerIndex;
+
+			bool hasQuantization;
+			if (serializer.IsWriting())
+				hasQuantization = data.matchStateQuantization.has_value();
+
+			serializer &= hasQuantization;
+
+			if (!serializer.IsWriting())
+			{
+				if (hasQuantization)
+					data.matchStateQuantization.emplace();
+				else
+					data.matchStateQuantization.reset();
+			}
+
+			if (data.matchStateQuantization)
+				Serialize(serializer, data.matchStateQuantization.value());
 		}
 
 		void Serialize(PacketSerializer& serializer, ChatMessage& data)
@@ -120,7 +216,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			std::size_t entityCount = 0;
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -134,12 +230,16 @@ namespace bw
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+			{
+				// Layer entity counts are summed, the total has to be checked before allocating
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
 
 			for (auto& entity : data.entities)
 			{
 				serializer &= entity.id;
-				Serialize(serializer, entity.data);
+				SerializeEntityData(serializer, entity.data, entity.encodedData);
 			}
 		}
 
@@ -155,7 +255,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			std::size_t entityCount = 0;
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -169,7 +269,10 @@ namespace bw
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+			{
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
 
 			for (auto& entity : data.entities)
 			{
@@ -254,7 +357,7 @@ namespace bw
 			for (auto& entity : data.layerEntities)
 			{
 				serializer &= entity.id;
-				Serialize(serializer, entity.data);
+				SerializeEntityData(serializer, entity.data, entity.encodedData);
 			}
 		}
 
@@ -262,7 +365,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			std::size_t entityCount = 0;
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -276,7 +379,10 @@ namespace bw
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+			{
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
 
 			for (auto& entity : data.entities)
 			{
@@ -289,7 +395,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			std::size_t entityCount = 0;
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -303,7 +409,10 @@ namespace bw
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+			{
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
 
 			for (auto& entity : data.entities)
 			{
@@ -315,7 +424,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			std::size_t entityCount = 0;
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -329,7 +438,10 @@ namespace bw
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+			{
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
 
 			for (auto& entity : data.entities)
 			{
@@ -338,9 +450,58 @@ namespace bw
 			}
 		}
 
+		void Serialize(PacketSerializer& serializer, EntitiesPhysics& data)
+		{
+			serializer &= data.stateTick;
+
+			std::size_t entityCount = 0;
+
+			serializer.SerializeArraySize(data.layers);
+			for (auto& layer : data.layers)
+			{
+				serializer &= layer.layerIndex;
+				serializer &= layer.entityCount;
+
+				entityCount += layer.entityCount;
+			}
+
+			if (serializer.IsWriting())
+				assert(data.entities.size() == entityCount);
+			else
+			{
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
+
+			for (auto& entity : data.entities)
+			{
+				serializer &= entity.id;
+				serializer &= entity.asleep;
+
+				bool hasPlayerMovement;
+				if (serializer.IsWriting())
+					hasPlayerMovement = entity.playerMovement.has_value();
+
+				serializer &= hasPlayerMovement;
+				if (!serializer.IsWriting())
+				{
+					if (hasPlayerMovement)
+						entity.playerMovement.emplace();
+					else
+						entity.playerMovement.reset();
+				}
+
+				serializer &= entity.mass;
+				serializer &= entity.momentOfInertia;
+
+				if (entity.playerMovement.has_value())
+					Serialize(serializer, entity.playerMovement.value());
+			}
+		}
+
 		void Serialize(PacketSerializer& serializer, EntitiesScale& data)
 		{
-			Nz::UInt32 entityCount = 0;
+			std::size_t entityCount = 0;
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -354,7 +515,10 @@ namespace bw
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+			{
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
 
 			for (auto& entity : data.entities)
 			{
@@ -363,6 +527,36 @@ namespace bw
 			}
 		}
 
+		void Serialize(PacketSerializer& serializer, EntitiesWeapon& data)
+		{
+			serializer &= data.stateTick;
+
+			std::size_t entityCount = 0;
+
+			serializer.SerializeArraySize(data.layers);
+			for (auto& layer : data.layers)
+			{
+				serializer &= layer.layerIndex;
+				serializer &= layer.entityCount;
+
+				entityCount += layer.entityCount;
+			}
+
+			if (serializer.IsWriting())
+				assert(data.entities.size() == entityCount);
+			else
+			{
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
+
+			for (auto& entity : data.entities)
+			{
+				serializer &= entity.id;
+				serializer &= entity.weaponEntityId;
+			}
+		}
+
 		void Serialize(PacketSerializer& serializer, EntityPhysics& data)
 		{
 			Serialize(serializer, data.entityId);
@@ -380,15 +574,12 @@ namespace bw
 			{
 				if (hasPlayerMovement)
 					data.playerMovement.emplace();
+				else
+					data.playerMovement.reset();
 			}
 
 			if (data.playerMovement.has_value())
-			{
-				auto& playerMovement = data.playerMovement.value();
-				serializer &= playerMovement.jumpHeight;
-				serializer &= playerMovement.jumpHeightBoost;
-				serializer &= playerMovement.movementSpeed;
-			}
+				Serialize(serializer, data.playerMovement.value());
 		}
 
 		void Serialize(PacketSerializer& serializer, EntityWeapon& data)
@@ -402,7 +593,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			std::size_t entityCount = 0;
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -416,7 +607,10 @@ namespace bw
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+			{
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
 
 			for (auto& entity : data.entities)
 			{
@@ -479,12 +673,30 @@ namespace bw
 
 		void Serialize(PacketSerializer& serializer, MatchState& data)
 		{
-			// Don't forget to update EstimateSize(const MatchState&)
+			// Don't forget to update EstimateMatchStateSize and EstimateQuantizedMatchStateSize
+
+			bool hasBaseline;
+			if (serializer.IsWriting())
+				hasBaseline = data.baselineTick.has_value();
+
+			serializer &= data.isQuantized;
+			serializer &= hasBaseline;
+
+			if (!serializer.IsWriting())
+			{
+				if (hasBaseline)
+					data.baselineTick.emplace();
+				else
+					data.baselineTick.reset();
+			}
+
+			if (data.baselineTick)
+				serializer &= data.baselineTick.value();
 
 			serializer &= data.lastInputTick;
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			std::size_t entityCount = 0;
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -498,7 +710,10 @@ namespace bw
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+			{
+				bool isValidCount = serializer.CheckArraySize<decltype(data.entities)::value_type>(entityCount);
+				data.entities.resize((isValidCount) ? entityCount : 0);
+			}
 
 			for (auto& entity : data.entities)
 			{
@@ -513,13 +728,20 @@ namespace bw
 				serializer &= hasMovementData;
 				serializer &= hasPhysicsProps;
 
+				if (data.isQuantized)
+					serializer &= entity.quantized.isDelta;
+
 				if (!serializer.IsWriting())
 				{
 					if (hasMovementData)
 						entity.playerMovement.emplace();
+					else
+						entity.playerMovement.reset();
 
 					if (hasPhysicsProps)
 						entity.physicsProperties.emplace();
+					else
+						entity.physicsProperties.reset();
 				}
 
 				if (entity.playerMovement)
@@ -532,14 +754,32 @@ namespace bw
 			for (auto& entity : data.entities)
 			{
 				serializer &= entity.id;
-				serializer &= entity.position;
-				serializer &= entity.rotation;
 
-				if (entity.physicsProperties)
+				if (data.isQuantized)
+				{
+					auto& quantizedData = entity.quantized;
+					serializer &= quantizedData.positionX;
+					serializer &= quantizedData.positionY;
+					serializer &= quantizedData.rotation;
+
+					if (entity.physicsProperties)
+					{
+						serializer &= quantizedData.angularVelocity;
+						serializer &= quantizedData.linearVelocityX;
+						serializer &= quantizedData.linearVelocityY;
+					}
+				}
+				else
 				{
-					auto& physicsProperties = entity.physicsProperties.value();
-					serializer &= physicsProperties.angularVelocity;
-					serializer &= physicsProperties.linearVelocity;
+					serializer &= entity.position;
+					serializer &= entity.rotation;
+
+					if (entity.physicsProperties)
+					{
+						auto& physicsProperties = entity.physicsProperties.value();
+						serializer &= physicsProperties.angularVelocity;
+						serializer &= physicsProperties.linearVelocity;
+					}
 				}
 			}
 		}
@@ -609,6 +849,26 @@ namespace bw
 
 		void Serialize(PacketSerializer& serializer, PlayersInput& data)
 		{
+			bool hasAcknowledgedStateTick;
+			if (serializer.IsWriting())
+				hasAcknowledgedStateTick = data.acknowledgedStateTick.has_value();
+
+			serializer &= hasAcknowledgedStateTick;
+
+			if (!serializer.IsWriting())
+			{
+				if (hasAcknowledgedStateTick)
+					data.acknowledgedStateTick.emplace();
+				else
+					data.acknowledgedStateTick.reset();
+			}
+
+			if (data.acknowledgedStateTick)
+			{
+				serializer &= data.acknowledgedStateTick.value();
+				serializer &= data.acknowledgedStateMask;
+			}
+
 			serializer &= data.estimatedServerTick;
 			serializer &= data.inputTick;
 
@@ -622,8 +882,13 @@ namespace bw
 
 				serializer &= hasInput;
 
-				if (!serializer.IsWriting() && hasInput)
-					input.emplace();
+				if (!serializer.IsWriting())
+				{
+					if (hasInput)
+						input.emplace();
+					else
+						input.reset();
+				}
 			}
 
 			for (auto& input : data.inputs)
@@ -712,21 +977,33 @@ namespace bw
 			{
 				if (hasScale)
 					data.scale.emplace();
+				else
+					data.scale.reset();
 
 				if (hasHealth)
 					data.health.emplace();
+				else
+					data.health.reset();
 
 				if (hasInputs)
 					data.inputs.emplace();
+				else
+					data.inputs.reset();
 
 				if (hasParent)
 					data.parentId.emplace();
+				else
+					data.parentId.reset();
 
 				if (hasMovementData)
 					data.playerMovement.emplace();
+				else
+					data.playerMovement.reset();
 
 				if (hasPhysicsProps)
 					data.physicsProperties.emplace();
+				else
+					data.physicsProperties.reset();
 			}
 
 			serializer &= data.entityClass;
@@ -776,7 +1053,23 @@ namespace bw
 			serializer &= data.layerId;
 			serializer &= data.entityId;
 		}
+
+		void Serialize(PacketSerializer& serializer, Helper::MatchStateQuantization& data)
+		{
+			serializer &= data.positionOrigin;
+			serializer &= data.angularVelocityPrecision;
+			serializer &= data.linearVelocityPrecision;
+			serializer &= data.positionPrecision;
+			serializer &= data.rotationBits;
+		}
 		
+		void Serialize(PacketSerializer& serializer, Helper::PlayerMovementProperties& data)
+		{
+			serializer &= data.jumpHeight;
+			serializer &= data.jumpHeightBoost;
+			serializer &= data.movementSpeed;
+		}
+
 		void Serialize(PacketSerializer& serializer, Helper::Property& data)
 		{
 			serializer &= data.name;
@@ -833,6 +1126,9 @@ namespace bw
 						CompressedUnsigned<Nz::UInt32> size;
 						serializer &= size;
 
+						if (!serializer.CheckArraySize<PropertyUnderlyingType_t<Property>>(size))
+							return;
+
 						auto& elements = data.value.emplace<PropertyArrayValue<Property>>(size);
 						for (auto& element : elements)
 							serializer &= element;
@@ -0,0 +1,232 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Scripting/ScriptBytecodeCache.hpp>
+#include <Nazara/Core/AbstractHash.hpp>
+#include <Nazara/Core/ByteArray.hpp>
+#include <fmt/format.h>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace bw
+{
+	namespace
+	{
+		// Cache files start with a magic number, the file version and the SHA1 of the bytecode following them
+		constexpr std::array<char, 4> FileMagic = { 'B', 'W', 'B', 'C' };
+		constexpr std::size_t DigestSize = 20;
+		constexpr std::size_t FileHeaderSize = FileMagic.size() + sizeof(Nz::UInt32) + DigestSize;
+
+		Nz::ByteArray ComputeSHA1(const void* data, std::size_t size)
+		{
+			auto hash = Nz::AbstractHash::Get(Nz::HashType_SHA1);
+			hash->Begin();
+			hash->Append(static_cast<const Nz::UInt8*>(data), size);
+
+			return hash->End();
+		}
+	}
+
+	/*!
+	* \brief Builds a bytecode cache keeping at most maxMemoryUsage bytes of bytecode in memory
+	*
+	* If cacheFolder is not empty, compiled chunks are also written to (and read from) it.
+	* Lua doesn't verify bytecode it loads, the cache folder must not be writable by anyone who shouldn't be able to run code on the server.
+	*/
+	ScriptBytecodeCache::ScriptBytecodeCache(std::filesystem::path cacheFolder, std::size_t maxMemoryUsage) :
+	m_cacheFolder(std::move(cacheFolder)),
+	m_maxMemoryUsage(maxMemoryUsage),
+	m_memoryUsage(0)
+	{
+		if (!m_cacheFolder.empty())
+		{
+			std::error_code err;
+			std::filesystem::create_directories(m_cacheFolder, err);
+		}
+	}
+
+	void ScriptBytecodeCache::Clear()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_bytecodes.clear();
+		m_usageOrder.clear();
+		m_memoryUsage = 0;
+	}
+
+	/*!
+	* \brief Returns the bytecode stored for this key (from memory or from the cache folder), or null if there's none
+	*
+	* This function can be called from multiple threads
+	*/
+	auto ScriptBytecodeCache::Find(const std::string& key) -> Bytecode
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (auto it = m_bytecodes.find(key); it != m_bytecodes.end())
+			{
+				m_usageOrder.splice(m_usageOrder.begin(), m_usageOrder, it->second.usageIt);
+				return it->second.bytecode;
+			}
+		}
+
+		if (m_cacheFolder.empty())
+			return nullptr;
+
+		Bytecode bytecode = ReadFile(key);
+		if (!bytecode)
+			return nullptr;
+
+		return Insert(key, std::move(bytecode));
+	}
+
+	std::size_t ScriptBytecodeCache::GetMemoryUsage()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		return m_memoryUsage;
+	}
+
+	void ScriptBytecodeCache::Store(const std::string& key, std::string bytecode)
+	{
+		Bytecode bytecodePtr = Insert(key, std::make_shared<const std::string>(std::move(bytecode)));
+
+		if (!m_cacheFolder.empty())
+			WriteFile(key, *bytecodePtr);
+	}
+
+	/*!
+	* \brief Builds a cache key from a script source and its chunk name (which is part of the compiled bytecode)
+	*
+	* The key is the SHA1 of both, it is stable between runs, allowing it to be used for on-disk caching
+	*/
+	std::string ScriptBytecodeCache::BuildKey(std::string_view source, std::string_view chunkName)
+	{
+		auto hash = Nz::AbstractHash::Get(Nz::HashType_SHA1);
+		hash->Begin();
+		hash->Append(reinterpret_cast<const Nz::UInt8*>(chunkName.data()), chunkName.size());
+		hash->Append(reinterpret_cast<const Nz::UInt8*>("\0"), 1);
+		hash->Append(reinterpret_cast<const Nz::UInt8*>(source.data()), source.size());
+
+		Nz::ByteArray digest = hash->End();
+
+		constexpr const char* digits = "0123456789abcdef";
+
+		std::string key;
+		key.reserve(digest.GetSize() * 2);
+		for (std::size_t i = 0; i < digest.GetSize(); ++i)
+		{
+			Nz::UInt8 byte = digest[i];
+			key.push_back(digits[byte >> 4]);
+			key.push_back(digits[byte & 0x0F]);
+		}
+
+		return key;
+	}
+
+	/*!
+	* \brief Inserts (or replaces) a bytecode in memory, evicting least recently used ones to stay under the memory limit
+	*
+	* Evicted bytecodes stay alive as long as they're referenced, the most recent one is always kept.
+	*/
+	auto ScriptBytecodeCache::Insert(const std::string& key, Bytecode bytecode) -> Bytecode
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		if (auto it = m_bytecodes.find(key); it != m_bytecodes.end())
+		{
+			m_memoryUsage -= it->second.bytecode->size();
+			m_usageOrder.erase(it->second.usageIt);
+			m_bytecodes.erase(it);
+		}
+
+		m_usageOrder.push_front(key);
+		m_memoryUsage += bytecode->size();
+
+		Entry& entry = m_bytecodes.emplace(key, Entry{}).first.value();
+		entry.bytecode = bytecode;
+		entry.usageIt = m_usageOrder.begin();
+
+		while (m_memoryUsage > m_maxMemoryUsage && m_usageOrder.size() > 1)
+		{
+			auto it = m_bytecodes.find(m_usageOrder.back());
+			assert(it != m_bytecodes.end());
+
+			m_memoryUsage -= it->second.bytecode->size();
+			m_bytecodes.erase(it);
+			m_usageOrder.pop_back();
+		}
+
+		return bytecode;
+	}
+
+	/*!
+	* \brief Reads a bytecode from the cache folder, files which are truncated, corrupted or from another version are ignored
+	*/
+	auto ScriptBytecodeCache::ReadFile(const std::string& key) -> Bytecode
+	{
+		std::ifstream file(m_cacheFolder / (key + ".luac"), std::ios::binary);
+		if (!file)
+			return nullptr;
+
+		std::string content(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>{});
+		if (content.size() <= FileHeaderSize)
+			return nullptr;
+
+		if (std::memcmp(content.data(), FileMagic.data(), FileMagic.size()) != 0)
+			return nullptr;
+
+		Nz::UInt32 fileVersion;
+		std::memcpy(&fileVersion, &content[FileMagic.size()], sizeof(fileVersion));
+		if (fileVersion != FileVersion)
+			return nullptr;
+
+		const char* digest = &content[FileMagic.size() + sizeof(Nz::UInt32)];
+		const char* bytecodeData = &content[FileHeaderSize];
+		std::size_t bytecodeSize = content.size() - FileHeaderSize;
+
+		Nz::ByteArray bytecodeDigest = ComputeSHA1(bytecodeData, bytecodeSize);
+		if (bytecodeDigest.GetSize() != DigestSize || std::memcmp(bytecodeDigest.GetConstBuffer(), digest, DigestSize) != 0)
+			return nullptr;
+
+		return std::make_shared<const std::string>(bytecodeData, bytecodeSize);
+	}
+
+	void ScriptBytecodeCache::WriteFile(const std::string& key, const std::string& bytecode)
+	{
+		Nz::ByteArray digest = ComputeSHA1(bytecode.data(), bytecode.size());
+		if (digest.GetSize() != DigestSize)
+			return;
+
+		Nz::UInt32 fileVersion = FileVersion;
+
+		// Write to a temporary file first so another process (or match) never reads a partial chunk
+		std::filesystem::path filePath = m_cacheFolder / (key + ".luac");
+		std::filesystem::path tempPath = filePath;
+		tempPath += fmt::format(".{}.tmp", static_cast<const void*>(&bytecode));
+
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file)
+				return;
+
+			file.write(FileMagic.data(), FileMagic.size());
+			file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
+			file.write(reinterpret_cast<const char*>(digest.GetConstBuffer()), digest.GetSize());
+			file.write(bytecode.data(), bytecode.size());
+		}
+
+		std::error_code err;
+		if (std::filesystem::file_size(tempPath, err) != FileHeaderSize + bytecode.size())
+		{
+			std::filesystem::remove(tempPath, err);
+			return;
+		}
+
+		std::filesystem::rename(tempPath, filePath, err);
+		if (err)
+			std::filesystem::remove(tempPath, err);
+	}
+}
@@ -18,6 +18,7 @@ namespace bw
 	}
 	
 	ScriptingContext::ScriptingContext(const Logger& logger, std::shared_ptr<VirtualDirectory> scriptDir) :
+	m_bytecodeCache(std::make_shared<ScriptBytecodeCache>()),
 	m_scriptDirectory(std::move(scriptDir)),
 	m_logger(logger)
 	{
@@ -211,8 +212,16 @@ namespace bw
 		m_currentFile = std::move(path);
 		m_currentFolder = m_currentFile.parent_path();
 
-		sol::state& state = GetLuaState();
-		sol::protected_function_result result = state.do_string(content, m_currentFile.generic_string());
+		sol::load_result loadResult = LoadChunk(content, m_currentFile.generic_string());
+		if (!loadResult.valid())
+		{
+			sol::error err = loadResult;
+			bwLog(m_logger, LogLevel::Error, "failed to load {0}: {1}", m_currentFile.generic_u8string(), err.what());
+			return {};
+		}
+
+		sol::protected_function chunk = loadResult;
+		sol::protected_function_result result = chunk();
 		if (!result.valid())
 		{
 			sol::error err = result;
@@ -226,7 +235,7 @@ namespace bw
 	auto ScriptingContext::LoadFile(std::filesystem::path path, const std::string_view& content, Async) -> std::optional<FileLoadCoroutine>
 	{
 		sol::state& state = GetLuaState();
-		sol::load_result result = state.load(content, path.generic_string());
+		sol::load_result result = LoadChunk(content, path.generic_string());
 		if (!result.valid())
 		{
 			sol::error err = result;
@@ -244,6 +253,47 @@ namespace bw
 		};
 	}
 
+	/*!
+	* \brief Compiles a chunk, or loads its bytecode from the cache if its source didn't change since it was compiled
+	*/
+	sol::load_result ScriptingContext::LoadChunk(const std::string_view& content, const std::string& chunkName)
+	{
+		sol::state& state = GetLuaState();
+
+		std::string cacheKey = ScriptBytecodeCache::BuildKey(content, chunkName);
+		if (ScriptBytecodeCache::Bytecode bytecode = m_bytecodeCache->Find(cacheKey))
+		{
+			sol::load_result result = state.load(std::string_view(*bytecode), chunkName, sol::load_mode::binary);
+			if (result.valid())
+				return result;
+
+			// Bytecode may come from an incompatible Lua build, compile the source and replace it
+			bwLog(m_logger, LogLevel::Warning, "failed to load cached bytecode of {0}, recompiling it", chunkName);
+		}
+
+		sol::load_result result = state.load(content, chunkName);
+		if (!result.valid())
+			return result;
+
+		std::string compiledChunk;
+		auto ChunkWriter = [](lua_State* /*L*/, const void* data, std::size_t size, void* userdata) -> int
+		{
+			static_cast<std::string*>(userdata)->append(static_cast<const char*>(data), size);
+			return 0;
+		};
+
+		// Keep debug informations, for errors to report lines
+		lua_State* L = state.lua_state();
+		lua_pushvalue(L, result.stack_index());
+		int dumpError = lua_dump(L, ChunkWriter, &compiledChunk, 0);
+		lua_pop(L, 1);
+
+		if (dumpError == 0)
+			m_bytecodeCache->Store(cacheKey, std::move(compiledChunk));
+
+		return result;
+	}
+
 	void ScriptingContext::LoadDirectory(std::filesystem::path path, const VirtualDirectory::VirtualDirectoryEntry& folder)
 	{
 		folder->Foreach([&](const std::string& entryName, VirtualDirectory::Entry& entry)
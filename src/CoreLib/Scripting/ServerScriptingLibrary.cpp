@@ -71,12 +71,17 @@ namespace bw
 			{
 				if (paths.is<sol::table>())
 				{
+					// Register them all at once so they can be hashed in parallel
+					std::vector<std::string> assetPaths;
+
 					sol::table pathTable = paths.as<sol::table>();
 					for (auto&& [k, v] : pathTable)
 					{
 						if (v.is<std::string>())
-							GetMatch().RegisterClientAsset(v.as<std::string>());
+							assetPaths.push_back(v.as<std::string>());
 					}
+
+					GetMatch().RegisterClientAssets(std::move(assetPaths));
 				}
 				else if (paths.is<std::string>())
 				{
@@ -271,6 +276,23 @@ namespace bw
 			return scriptComponent.GetTable();
 		});
 
+		library["DumpTickProfile"] = LuaFunction([&]() -> std::optional<std::string>
+		{
+			if (auto filePath = GetMatch().DumpTickProfile())
+				return filePath->generic_u8string();
+			else
+				return std::nullopt;
+		});
+
+		library["EnableTickProfiler"] = LuaFunction([&](bool enable)
+		{
+			TickProfiler& profiler = GetMatch().GetProfiler();
+			if (enable && !profiler.IsEnabled())
+				profiler.Clear();
+
+			profiler.Enable(enable);
+		});
+
 		library["GetLocalTick"] = LuaFunction([&]()
 		{
 			return GetMatch().GetCurrentTick();
@@ -305,6 +327,11 @@ namespace bw
 		{
 			return GetMatch().GetCurrentTick();
 		});
+
+		library["GetTickProfileSummary"] = LuaFunction([&]()
+		{
+			return GetMatch().GetProfiler().BuildSummary();
+		});
 	}
 
 	void ServerScriptingLibrary::RegisterNetworkLibrary(ScriptingContext& context, sol::table& library)
@@ -16,9 +16,12 @@
 #include <CoreLib/Scripting/SharedGamemode.hpp>
 #include <CoreLib/Scripting/ScriptingContext.hpp>
 #include <CoreLib/Scripting/ScriptingUtils.hpp>
+#include <CoreLib/Utility/TileColliders.hpp>
 #include <Nazara/Physics2D/Constraint2D.hpp>
 #include <NDK/Components/ConstraintComponent2D.hpp>
 #include <NDK/Systems/PhysicsSystem2D.hpp>
+#include <tsl/hopscotch_map.h>
+#include <optional>
 #include <CoreLib/SharedMatch.hpp>
 
 namespace bw
@@ -307,6 +310,48 @@ namespace bw
 
 	void SharedScriptingLibrary::RegisterPhysicsLibrary(ScriptingContext& /*context*/, sol::table& library)
 	{
+		library["BuildTilemapColliders"] = LuaFunction([](sol::this_state L, const Nz::Vector2i64& mapSize, const Nz::Vector2f& cellSize, const sol::table& content, std::optional<sol::table> solidTiles)
+		{
+			if (mapSize.x <= 0 || mapSize.y <= 0)
+				TriggerLuaArgError(L, 1, "invalid map size");
+
+			std::size_t width = static_cast<std::size_t>(mapSize.x);
+			std::size_t height = static_cast<std::size_t>(mapSize.y);
+			std::size_t cellCount = width * height;
+			if (content.size() < cellCount)
+				TriggerLuaArgError(L, 3, "content has " + std::to_string(content.size()) + " tiles, expected " + std::to_string(cellCount));
+
+			// Without a solid tile table, every non-empty tile is solid
+			tsl::hopscotch_map<Nz::Int64, bool> solidTileCache;
+			auto IsSolid = [&](Nz::Int64 tile)
+			{
+				if (!solidTiles)
+					return tile != 0;
+
+				auto it = solidTileCache.find(tile);
+				if (it == solidTileCache.end())
+					it = solidTileCache.emplace(tile, solidTiles->get_or(tile, false)).first;
+
+				return it->second;
+			};
+
+			std::vector<bool> solidCells(cellCount);
+			for (std::size_t i = 0; i < cellCount; ++i)
+				solidCells[i] = IsSolid(content.raw_get_or<Nz::Int64>(i + 1, 0));
+
+			std::vector<Nz::Rectui> colliders = BuildTileColliders(width, height, solidCells);
+
+			sol::state_view state(L);
+			sol::table result = state.create_table(int(colliders.size()), 0);
+			for (std::size_t i = 0; i < colliders.size(); ++i)
+			{
+				const Nz::Rectui& collider = colliders[i];
+				result[i + 1] = Nz::Rectf(collider.x * cellSize.x, collider.y * cellSize.y, collider.width * cellSize.x, collider.height * cellSize.y);
+			}
+
+			return result;
+		});
+
 		library["CreateDampenedSpringConstraint"] = LuaFunction([](sol::this_state L, const sol::table& firstEntityTable, const sol::table& secondEntityTable, const Nz::Vector2f& firstAnchor, const Nz::Vector2f& secondAnchor, float restLength, float stiffness, float damping)
 		{
 			const Ndk::EntityHandle& firstEntity = AssertScriptEntity(firstEntityTable);
@@ -468,9 +513,14 @@ namespace bw
 
 	void SharedScriptingLibrary::RegisterTimerLibrary(ScriptingContext& /*context*/, sol::table& library)
 	{
+		library["Cancel"] = LuaFunction([&](TimerManager::TimerId timerId)
+		{
+			return m_match.GetTimerManager().Cancel(timerId);
+		});
+
 		library["Create"] = LuaFunction([&](Nz::UInt64 time, sol::main_protected_function callback)
 		{
-			m_match.GetTimerManager().PushCallback(m_match.GetCurrentTime() + time, [this, callback = std::move(callback)]()
+			return m_match.GetTimerManager().PushCallback(m_match.GetCurrentTime() + time, [this, callback = std::move(callback)]()
 			{
 				auto result = callback();
 				if (!result.valid())
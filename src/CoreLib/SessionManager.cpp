@@ -7,4 +7,11 @@
 namespace bw
 {
 	SessionManager::~SessionManager() = default;
+
+	/*!
+	* \brief Sends packets which may have been buffered since the last call
+	*/
+	void SessionManager::Flush()
+	{
+	}
 }
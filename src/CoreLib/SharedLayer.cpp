@@ -8,19 +8,50 @@
 #include <CoreLib/Components/PlayerMovementComponent.hpp>
 #include <CoreLib/Components/ScriptComponent.hpp>
 #include <CoreLib/Systems/AnimationSystem.hpp>
+#include <CoreLib/Systems/NetworkSyncSystem.hpp>
 #include <CoreLib/Systems/PlayerMovementSystem.hpp>
 #include <CoreLib/Systems/TickCallbackSystem.hpp>
 #include <CoreLib/Systems/WeaponSystem.hpp>
 #include <NDK/Systems/LifetimeSystem.hpp>
 #include <NDK/Systems/PhysicsSystem2D.hpp>
 #include <NDK/Systems/VelocitySystem.hpp>
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
 namespace bw
 {
+	namespace
+	{
+		std::pair<const char*, ProfileCategory> GetSystemProfileInfo(const Ndk::BaseSystem& system)
+		{
+			Ndk::SystemIndex systemIndex = system.GetIndex();
+			if (systemIndex == Ndk::GetSystemIndex<AnimationSystem>())
+				return { "AnimationSystem", ProfileCategory::Simulation };
+			else if (systemIndex == Ndk::GetSystemIndex<Ndk::LifetimeSystem>())
+				return { "LifetimeSystem", ProfileCategory::Simulation };
+			else if (systemIndex == Ndk::GetSystemIndex<NetworkSyncSystem>())
+				return { "NetworkSyncSystem", ProfileCategory::Network };
+			else if (systemIndex == Ndk::GetSystemIndex<Ndk::PhysicsSystem2D>())
+				return { "PhysicsSystem2D", ProfileCategory::Physics };
+			else if (systemIndex == Ndk::GetSystemIndex<PlayerMovementSystem>())
+				return { "PlayerMovementSystem", ProfileCategory::Physics };
+			else if (systemIndex == Ndk::GetSystemIndex<TickCallbackSystem>())
+				return { "TickCallbackSystem", ProfileCategory::Script };
+			else if (systemIndex == Ndk::GetSystemIndex<Ndk::VelocitySystem>())
+				return { "VelocitySystem", ProfileCategory::Simulation };
+			else if (systemIndex == Ndk::GetSystemIndex<WeaponSystem>())
+				return { "WeaponSystem", ProfileCategory::Script };
+			else
+				return { "OtherSystem", ProfileCategory::Simulation };
+		}
+	}
+
 	SharedLayer::SharedLayer(SharedMatch& match, LayerIndex layerIndex) :
 	m_match(match),
-	m_layerIndex(layerIndex)
+	m_layerIndex(layerIndex),
+	m_isParallelUpdateEnabled(false),
+	m_isRunningParallelUpdate(false)
 	{
 		m_world.AddSystem<Ndk::LifetimeSystem>();
 		m_world.AddSystem<Ndk::PhysicsSystem2D>();
@@ -38,31 +69,50 @@ namespace bw
 		physics.SetStepSize(match.GetTickDuration());
 
 		Ndk::PhysicsSystem2D::Callback triggerCallbacks;
-		triggerCallbacks.startCallback = [](Ndk::PhysicsSystem2D& /*world*/, Nz::Arbiter2D& /*arbiter*/, const Ndk::EntityHandle& bodyA, const Ndk::EntityHandle& bodyB, void* /*userdata*/)
+		triggerCallbacks.startCallback = [this](Ndk::PhysicsSystem2D& /*world*/, Nz::Arbiter2D& /*arbiter*/, const Ndk::EntityHandle& bodyA, const Ndk::EntityHandle& bodyB, void* /*userdata*/)
 		{
-			bool shouldCollide = true;
+			if (!bodyA->HasComponent<ScriptComponent>() || !bodyB->HasComponent<ScriptComponent>())
+				return true;
 
-			auto HandleCollision = [&](const Ndk::EntityHandle& first, const Ndk::EntityHandle& second)
+			if (m_isRunningParallelUpdate)
 			{
-				if (first->HasComponent<ScriptComponent>() && second->HasComponent<ScriptComponent>())
-				{
-					auto& firstScript = first->GetComponent<ScriptComponent>();
-					auto& secondScript = second->GetComponent<ScriptComponent>();
-					if (auto ret = firstScript.ExecuteCallback<ElementEvent::CollisionStart>(secondScript.GetTable()); ret.has_value())
-						shouldCollide = *ret;
-				}
-			};
+				// Scripts can't run while other layers are being updated, the contact will be ignored until the callback has been executed
+				CollisionDecision& decision = m_collisionDecisions[BuildCollisionKey(bodyA, bodyB)];
+				if (decision.contactCount++ == 0)
+					decision.shouldCollide.reset();
 
-			HandleCollision(bodyA, bodyB);
-			HandleCollision(bodyB, bodyA);
+				m_deferredCollisions.push_back({ bodyA, bodyB });
+				return true;
+			}
 
-			return shouldCollide;
+			return HandleScriptCollision(bodyA, bodyB);
+		};
+
+		triggerCallbacks.endCallback = [this](Ndk::PhysicsSystem2D& /*world*/, Nz::Arbiter2D& /*arbiter*/, const Ndk::EntityHandle& bodyA, const Ndk::EntityHandle& bodyB, void* /*userdata*/)
+		{
+			if (m_collisionDecisions.empty())
+				return;
+
+			auto it = m_collisionDecisions.find(BuildCollisionKey(bodyA, bodyB));
+			if (it == m_collisionDecisions.end())
+				return;
+
+			if (--it.value().contactCount == 0)
+				m_collisionDecisions.erase(it);
+		};
+
+		triggerCallbacks.preSolveCallback = [this](Ndk::PhysicsSystem2D& /*world*/, Nz::Arbiter2D& /*arbiter*/, const Ndk::EntityHandle& bodyA, const Ndk::EntityHandle& bodyB, void* /*userdata*/)
+		{
+			return IsCollisionAllowed(bodyA, bodyB);
 		};
 
 		physics.RegisterCallbacks(1, triggerCallbacks);
 
-		triggerCallbacks.preSolveCallback = [](Ndk::PhysicsSystem2D& /*world*/, Nz::Arbiter2D& arbiter, const Ndk::EntityHandle& bodyA, const Ndk::EntityHandle& bodyB, void* /*userdata*/)
+		triggerCallbacks.preSolveCallback = [this](Ndk::PhysicsSystem2D& /*world*/, Nz::Arbiter2D& arbiter, const Ndk::EntityHandle& bodyA, const Ndk::EntityHandle& bodyB, void* /*userdata*/)
 		{
+			if (!IsCollisionAllowed(bodyA, bodyB))
+				return false;
+
 			bool shouldCollide = true;
 
 			auto HandleCollision = [&](const Ndk::EntityHandle& first, const Ndk::EntityHandle& second)
@@ -92,8 +142,251 @@ namespace bw
 
 	SharedLayer::~SharedLayer() = default;
 
+	/*!
+	* \brief Splits the layer update in steps, alternating between systems which may run scripts and script-free systems (physics, movement, animations)
+	*
+	* Steps keep the order in which the world would update its systems, script-free steps (odd indexes) may then run concurrently with other layers.
+	* Systems must have been added to the world before parallel update gets enabled.
+	*
+	* \see UpdateStep
+	*/
+	void SharedLayer::EnableParallelUpdate(bool enable)
+	{
+		if (m_isParallelUpdateEnabled == enable)
+			return;
+
+		m_isParallelUpdateEnabled = enable;
+		m_updateSteps.clear();
+
+		if (!enable)
+		{
+			ProcessDeferredCollisions();
+			return;
+		}
+
+		Ndk::SystemIndex physicsIndex = Ndk::GetSystemIndex<Ndk::PhysicsSystem2D>();
+
+		auto IsScriptFree = [](const Ndk::BaseSystem& system)
+		{
+			Ndk::SystemIndex systemIndex = system.GetIndex();
+			return systemIndex == Ndk::GetSystemIndex<AnimationSystem>() ||
+			       systemIndex == Ndk::GetSystemIndex<Ndk::PhysicsSystem2D>() ||
+			       systemIndex == Ndk::GetSystemIndex<PlayerMovementSystem>() ||
+			       systemIndex == Ndk::GetSystemIndex<Ndk::VelocitySystem>();
+		};
+
+		std::vector<Ndk::BaseSystem*> orderedSystems;
+		GetOrderedSystems(orderedSystems);
+
+		m_updateSteps.emplace_back(); //< First step always runs on the calling thread, even if empty
+		for (Ndk::BaseSystem* system : orderedSystems)
+		{
+			if (IsScriptFree(*system) != IsParallelUpdateStep(m_updateSteps.size() - 1))
+				m_updateSteps.emplace_back();
+
+			m_updateSteps.back().push_back(system);
+
+			// Collision callbacks deferred by the physics step are executed before any other system runs, as they would during a sequential update
+			if (system->GetIndex() == physicsIndex)
+				m_updateSteps.emplace_back();
+		}
+	}
+
+	/*!
+	* \brief Replays a tick for some entities of the layer only (as client reconciliation does)
+	*
+	* The physics step runs for the whole space (bodies which shouldn't move have to be made kinematic beforehand), movement, weapons and tick callbacks are only updated for the given entities and other systems don't run.
+	*/
+	void SharedLayer::ReplayTickUpdate(float elapsedTime, const Ndk::EntityList& entities)
+	{
+		TickProfiler& profiler = m_match.GetProfiler();
+		TickProfiler::Scope profileScope(profiler, "Layer.ReplayTickUpdate", ProfileCategory::Simulation, m_layerIndex);
+
+		m_world.Refresh();
+
+		// Collisions deferred by a previous parallel update, if any
+		ProcessDeferredCollisions();
+
+		GetOrderedSystems(m_profiledSystems);
+
+		Ndk::SystemIndex physicsIndex = Ndk::GetSystemIndex<Ndk::PhysicsSystem2D>();
+		Ndk::SystemIndex playerMovementIndex = Ndk::GetSystemIndex<PlayerMovementSystem>();
+		Ndk::SystemIndex tickCallbackIndex = Ndk::GetSystemIndex<TickCallbackSystem>();
+		Ndk::SystemIndex weaponIndex = Ndk::GetSystemIndex<WeaponSystem>();
+
+		for (Ndk::BaseSystem* system : m_profiledSystems)
+		{
+			Ndk::SystemIndex systemIndex = system->GetIndex();
+			if (systemIndex != physicsIndex && systemIndex != playerMovementIndex && systemIndex != tickCallbackIndex && systemIndex != weaponIndex)
+				continue;
+
+			auto [name, category] = GetSystemProfileInfo(*system);
+			TickProfiler::Scope systemProfileScope(profiler, name, category, m_layerIndex);
+
+			if (systemIndex == physicsIndex)
+				system->Update(elapsedTime);
+			else if (systemIndex == playerMovementIndex)
+				static_cast<PlayerMovementSystem*>(system)->UpdateEntities(entities);
+			else if (systemIndex == tickCallbackIndex)
+				static_cast<TickCallbackSystem*>(system)->UpdateEntities(elapsedTime, entities);
+			else
+				static_cast<WeaponSystem*>(system)->UpdateEntities(entities);
+		}
+	}
+
 	void SharedLayer::TickUpdate(float elapsedTime)
 	{
-		m_world.Update(elapsedTime);
+		TickProfiler::Scope profileScope(m_match.GetProfiler(), "Layer.TickUpdate", ProfileCategory::Simulation, m_layerIndex);
+
+		if (m_isParallelUpdateEnabled)
+		{
+			m_world.Refresh();
+			for (std::size_t stepIndex = 0; stepIndex < m_updateSteps.size(); ++stepIndex)
+				UpdateStep(stepIndex, elapsedTime);
+		}
+		else
+			UpdateWorld(elapsedTime);
+	}
+
+	/*!
+	* \brief Updates the systems of one update step, odd steps are script-free and may run concurrently with other layers
+	*
+	* Steps have to be run in order, after a world refresh, and require parallel update to be enabled.
+	* Collision script callbacks triggered during a script-free step are deferred to the next step.
+	*
+	* \see EnableParallelUpdate
+	*/
+	void SharedLayer::UpdateStep(std::size_t stepIndex, float elapsedTime)
+	{
+		assert(m_isParallelUpdateEnabled);
+		assert(stepIndex < m_updateSteps.size());
+
+		if (IsParallelUpdateStep(stepIndex))
+		{
+			m_isRunningParallelUpdate = true;
+
+			for (Ndk::BaseSystem* system : m_updateSteps[stepIndex])
+				system->Update(elapsedTime);
+
+			m_isRunningParallelUpdate = false;
+		}
+		else
+		{
+			TickProfiler& profiler = m_match.GetProfiler();
+
+			if (!m_deferredCollisions.empty())
+			{
+				TickProfiler::Scope collisionProfileScope(profiler, "Layer.DeferredCollisions", ProfileCategory::Script, m_layerIndex);
+				ProcessDeferredCollisions();
+			}
+
+			for (Ndk::BaseSystem* system : m_updateSteps[stepIndex])
+			{
+				auto [name, category] = GetSystemProfileInfo(*system);
+
+				TickProfiler::Scope profileScope(profiler, name, category, m_layerIndex);
+				system->Update(elapsedTime);
+			}
+		}
+	}
+
+	void SharedLayer::GetOrderedSystems(std::vector<Ndk::BaseSystem*>& systems)
+	{
+		systems.clear();
+		m_world.ForEachSystem([&](Ndk::BaseSystem& system)
+		{
+			systems.push_back(&system);
+		});
+
+		std::stable_sort(systems.begin(), systems.end(), [](const Ndk::BaseSystem* lhs, const Ndk::BaseSystem* rhs)
+		{
+			return lhs->GetUpdateOrder() < rhs->GetUpdateOrder();
+		});
+	}
+
+	bool SharedLayer::IsCollisionAllowed(const Ndk::EntityHandle& first, const Ndk::EntityHandle& second) const
+	{
+		if (m_collisionDecisions.empty())
+			return true;
+
+		auto it = m_collisionDecisions.find(BuildCollisionKey(first, second));
+		if (it == m_collisionDecisions.end())
+			return true;
+
+		return it->second.shouldCollide.value_or(false);
+	}
+
+	void SharedLayer::ProcessDeferredCollisions()
+	{
+		// Callbacks are executed in the order the physics engine reported contacts, keeping the update deterministic
+		for (const DeferredCollision& collision : m_deferredCollisions)
+		{
+			if (!collision.first || !collision.second)
+				continue;
+
+			if (!collision.first->HasComponent<ScriptComponent>() || !collision.second->HasComponent<ScriptComponent>())
+				continue;
+
+			bool shouldCollide = HandleScriptCollision(collision.first, collision.second);
+
+			// Contact may have ended during the same step
+			if (auto it = m_collisionDecisions.find(BuildCollisionKey(collision.first, collision.second)); it != m_collisionDecisions.end())
+				it.value().shouldCollide = shouldCollide;
+		}
+		m_deferredCollisions.clear();
+	}
+
+	void SharedLayer::UpdateWorld(float elapsedTime)
+	{
+		TickProfiler& profiler = m_match.GetProfiler();
+		if (!profiler.IsRecording())
+		{
+			m_world.Update(elapsedTime);
+			return;
+		}
+
+		// Same as Ndk::World::Update, but with a profile scope per system
+		{
+			TickProfiler::Scope profileScope(profiler, "World.Refresh", ProfileCategory::Simulation, m_layerIndex);
+			m_world.Refresh();
+		}
+
+		GetOrderedSystems(m_profiledSystems);
+
+		for (Ndk::BaseSystem* system : m_profiledSystems)
+		{
+			auto [name, category] = GetSystemProfileInfo(*system);
+
+			TickProfiler::Scope profileScope(profiler, name, category, m_layerIndex);
+			system->Update(elapsedTime);
+		}
+	}
+
+	Nz::UInt64 SharedLayer::BuildCollisionKey(const Ndk::EntityHandle& first, const Ndk::EntityHandle& second)
+	{
+		Nz::UInt64 firstId = first->GetId();
+		Nz::UInt64 secondId = second->GetId();
+		if (firstId > secondId)
+			std::swap(firstId, secondId);
+
+		return firstId << 32 | secondId;
+	}
+
+	bool SharedLayer::HandleScriptCollision(const Ndk::EntityHandle& first, const Ndk::EntityHandle& second)
+	{
+		bool shouldCollide = true;
+
+		auto HandleCollision = [&](const Ndk::EntityHandle& collider, const Ndk::EntityHandle& other)
+		{
+			auto& colliderScript = collider->GetComponent<ScriptComponent>();
+			auto& otherScript = other->GetComponent<ScriptComponent>();
+			if (auto ret = colliderScript.ExecuteCallback<ElementEvent::CollisionStart>(otherScript.GetTable()); ret.has_value())
+				shouldCollide = *ret;
+		};
+
+		HandleCollision(first, second);
+		HandleCollision(second, first);
+
+		return shouldCollide;
 	}
 }
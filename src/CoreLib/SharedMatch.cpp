@@ -8,7 +8,9 @@
 #include <CoreLib/LogSystem/EntityLogContext.hpp>
 #include <CoreLib/LogSystem/Logger.hpp>
 #include <NDK/Components/PhysicsComponent2D.hpp>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace bw
 {
@@ -41,6 +43,8 @@ namespace bw
 			float lostTicks = (m_tickTimer - m_maxTickTimer) / m_tickDuration;
 			bwLog(m_logger, LogLevel::Warning, "Update is too slow, {} ticks have been discarded to preserve realtime", lostTicks);
 
+			m_tickStatistics.droppedTickCount += static_cast<Nz::UInt64>(std::ceil(lostTicks));
+
 			m_tickTimer = m_maxTickTimer;
 		}
 
@@ -48,10 +52,24 @@ namespace bw
 		{
 			m_tickTimer -= m_tickDuration;
 
-			m_timerManager.Update(m_currentTime);
+			// Remaining timer is how late this tick is compared to its deadline
+			m_tickStatistics.maxTickDelay = std::max(m_tickStatistics.maxTickDelay, m_tickTimer);
+			m_tickStatistics.tickCount++;
+			m_tickStatistics.totalTickDelay += m_tickTimer;
+			if (m_tickTimer >= m_tickDuration)
+				m_tickStatistics.lateTickCount++;
+
+			m_profiler.BeginTick(m_currentTick);
+
+			{
+				TickProfiler::Scope profileScope(m_profiler, "TimerManager.Update", ProfileCategory::Script);
+				m_timerManager.Update(m_currentTime);
+			}
 
 			OnTick(m_tickTimer < m_tickDuration);
 
+			m_profiler.EndTick();
+
 			m_currentTick++;
 			m_floatingTime += m_tickDuration * 1000.f;
 			Nz::UInt64 elapsedTimeMs = static_cast<Nz::UInt64>(m_floatingTime);
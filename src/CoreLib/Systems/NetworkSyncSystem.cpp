@@ -4,6 +4,7 @@
 
 #include <CoreLib/Systems/NetworkSyncSystem.hpp>
 #include <NDK/Components.hpp>
+#include <Nazara/Core/ByteStream.hpp>
 #include <CoreLib/Match.hpp>
 #include <CoreLib/TerrainLayer.hpp>
 #include <CoreLib/Components/HealthComponent.hpp>
@@ -11,11 +12,71 @@
 #include <CoreLib/Components/NetworkSyncComponent.hpp>
 #include <CoreLib/Components/PlayerMovementComponent.hpp>
 #include <CoreLib/Components/ScriptComponent.hpp>
+#include <CoreLib/Protocol/NetworkStringStore.hpp>
+#include <CoreLib/Protocol/Packets.hpp>
 #include <CoreLib/Utils.hpp>
+#include <limits>
 
 namespace bw
 {
+	namespace
+	{
+		void FillEntityData(const NetworkStringStore& networkStringStore, const NetworkSyncSystem::EntityCreation& creationEvent, Packets::Helper::EntityData& entityData)
+		{
+			assert(creationEvent.uniqueId > 0);
+
+			entityData.entityClass = networkStringStore.CheckStringIndex(creationEvent.entityClass);
+			entityData.uniqueId = static_cast<Nz::UInt64>(creationEvent.uniqueId);
+			entityData.position = creationEvent.position;
+			entityData.rotation = creationEvent.rotation;
+
+			if (!Nz::NumberEquals(creationEvent.scale, 1.f))
+				entityData.scale = creationEvent.scale;
+
+			if (creationEvent.inputs.has_value())
+				entityData.inputs = creationEvent.inputs.value();
+
+			if (creationEvent.parent.has_value())
+				entityData.parentId = creationEvent.parent.value();
+
+			if (creationEvent.healthProperties.has_value())
+			{
+				entityData.health.emplace();
+				entityData.health->currentHealth = creationEvent.healthProperties->currentHealth;
+				entityData.health->maxHealth = creationEvent.healthProperties->maxHealth;
+			}
+
+			if (creationEvent.playerMovement.has_value())
+			{
+				entityData.playerMovement.emplace();
+				entityData.playerMovement->isFacingRight = creationEvent.playerMovement->isFacingRight;
+			}
+
+			if (creationEvent.physicsProperties.has_value())
+			{
+				const auto& physicsProperties = *creationEvent.physicsProperties;
+
+				entityData.physicsProperties.emplace();
+				entityData.physicsProperties->angularVelocity = physicsProperties.angularVelocity;
+				entityData.physicsProperties->linearVelocity = physicsProperties.linearVelocity;
+				entityData.physicsProperties->isAsleep = physicsProperties.isSleeping;
+				entityData.physicsProperties->mass = physicsProperties.mass;
+				entityData.physicsProperties->momentOfInertia = physicsProperties.momentOfInertia;
+			}
+
+			for (auto&& [propertyName, propertyValue] : creationEvent.properties)
+			{
+				auto& propertyData = entityData.properties.emplace_back();
+				propertyData.name = networkStringStore.CheckStringIndex(propertyName);
+				propertyData.value = propertyValue;
+			}
+		}
+	}
+
 	NetworkSyncSystem::NetworkSyncSystem(TerrainLayer& layer) :
+	m_encodedEntityDataTick(std::numeric_limits<Nz::UInt64>::max()),
+	m_isInterestSnapshotValid(false),
+	m_isMovementSnapshotValid(false),
 	m_layer(layer)
 	{
 		Requires<NetworkSyncComponent, Ndk::NodeComponent>();
@@ -36,6 +97,23 @@ namespace bw
 		callback(m_creationEvents.data(), m_creationEvents.size());
 	}
 
+	void NetworkSyncSystem::CreateEntities(const Ndk::EntityId* entityIds, std::size_t entityCount, const std::function<void(const EntityCreation* entityCreation, std::size_t entityCount)>& callback) const
+	{
+		m_creationEvents.clear();
+
+		Ndk::World& world = m_layer.GetWorld();
+		for (std::size_t i = 0; i < entityCount; ++i)
+		{
+			const Ndk::EntityHandle& entity = world.GetEntity(entityIds[i]);
+			assert(entity && HasEntity(entity));
+
+			EntityCreation& creationEvent = m_creationEvents.emplace_back();
+			BuildEvent(creationEvent, entity);
+		}
+
+		callback(m_creationEvents.data(), m_creationEvents.size());
+	}
+
 	void NetworkSyncSystem::DeleteEntities(const std::function<void(const EntityDestruction* entityDestruction, std::size_t entityCount)>& callback) const
 	{
 		m_destructionEvents.clear();
@@ -49,9 +127,99 @@ namespace bw
 		callback(m_destructionEvents.data(), m_destructionEvents.size());
 	}
 
-	void NetworkSyncSystem::MoveEntities(const std::function<void(const EntityMovement* entityMovement, std::size_t entityCount)>& callback) const
+	/*!
+	* \brief Returns the entity data of a creation event already encoded in the network format
+	*
+	* Encoded data is cached for the current tick and shared by every session creating the entity, sessions only have to copy it into their packets.
+	* All creation events of an entity during a tick are considered equivalent, the first one encoded is kept.
+	*/
+	std::shared_ptr<const Nz::ByteArray> NetworkSyncSystem::GetEncodedEntityData(const EntityCreation& creationEvent) const
+	{
+		const Match& match = m_layer.GetMatch();
+
+		Nz::UInt64 currentTick = match.GetCurrentTick();
+		if (m_encodedEntityDataTick != currentTick)
+		{
+			m_encodedEntityData.clear();
+			m_encodedEntityDataTick = currentTick;
+		}
+
+		auto it = m_encodedEntityData.find(creationEvent.entityId);
+		if (it != m_encodedEntityData.end())
+			return it->second;
+
+		Packets::Helper::EntityData entityData;
+		FillEntityData(match.GetNetworkStringStore(), creationEvent, entityData);
+
+		std::shared_ptr<Nz::ByteArray> encodedData = std::make_shared<Nz::ByteArray>();
+		{
+			Nz::ByteStream stream(encodedData.get(), Nz::OpenMode_WriteOnly);
+
+			PacketSerializer serializer(stream, true);
+			Packets::Serialize(serializer, entityData);
+
+			// Trailing booleans must not be merged with what comes next in the packet
+			stream.FlushBits();
+		}
+
+		m_encodedEntityData.emplace(creationEvent.entityId, encodedData);
+
+		return encodedData;
+	}
+
+	auto NetworkSyncSystem::GetInterestSnapshot(float cellSize) const -> const InterestSnapshot&
+	{
+		Nz::UInt64 currentTick = m_layer.GetMatch().GetCurrentTick();
+		if (m_isInterestSnapshotValid && m_interestSnapshot.tick == currentTick && m_interestSnapshot.grid.GetCellSize() == cellSize)
+			return m_interestSnapshot;
+
+		m_interestSnapshot.tick = currentTick;
+		m_interestSnapshot.entities.clear();
+
+		if (m_interestSnapshot.grid.GetCellSize() == cellSize)
+			m_interestSnapshot.grid.Clear();
+		else
+			m_interestSnapshot.grid.SetCellSize(cellSize);
+
+		for (const Ndk::EntityHandle& entity : m_physicsEntities)
+		{
+			if (entity->GetComponent<NetworkSyncComponent>().GetParent())
+				continue;
+
+			Nz::Vector2f position = entity->GetComponent<Ndk::PhysicsComponent2D>().GetPosition();
+
+			m_interestSnapshot.entities[entity->GetId()].position = position;
+			m_interestSnapshot.grid.Insert(position, entity->GetId());
+		}
+
+		// Descendants follow the interest of their root entity
+		for (const Ndk::EntityHandle& entity : GetEntities())
+		{
+			const Ndk::EntityHandle* root = &entity->GetComponent<NetworkSyncComponent>().GetParent();
+			if (!*root)
+				continue;
+
+			while (const Ndk::EntityHandle& parent = (*root)->GetComponent<NetworkSyncComponent>().GetParent())
+				root = &parent;
+
+			auto it = m_interestSnapshot.entities.find((*root)->GetId());
+			if (it != m_interestSnapshot.entities.end())
+				it.value().descendants.push_back(entity->GetId());
+		}
+
+		m_isInterestSnapshotValid = true;
+
+		return m_interestSnapshot;
+	}
+
+	auto NetworkSyncSystem::GetMovementSnapshot() const -> const MovementSnapshot&
 	{
-		m_movementEvents.clear();
+		Nz::UInt64 currentTick = m_layer.GetMatch().GetCurrentTick();
+		if (m_isMovementSnapshotValid && m_movementSnapshot.tick == currentTick)
+			return m_movementSnapshot;
+
+		m_movementSnapshot.tick = currentTick;
+		m_movementSnapshot.entities.clear();
 
 		for (const Ndk::EntityHandle& entity : m_physicsEntities)
 		{
@@ -59,10 +227,12 @@ namespace bw
 			if (entityPhys.IsSleeping())
 				continue;
 
-			BuildEvent(m_movementEvents.emplace_back(), entity);
+			BuildEvent(m_movementSnapshot.entities.emplace_back(), entity);
 		}
 
-		callback(m_movementEvents.data(), m_movementEvents.size());
+		m_isMovementSnapshotValid = true;
+
+		return m_movementSnapshot;
 	}
 
 	void NetworkSyncSystem::NotifyPhysicsUpdate(const Ndk::EntityHandle& entity)
@@ -245,6 +415,9 @@ namespace bw
 
 		OnEntityCreated(this, creationEvent);
 
+		m_encodedEntityData.erase(entity->GetId());
+		m_isInterestSnapshotValid = false;
+
 		assert(m_entitySlots.find(entity->GetId()) == m_entitySlots.end());
 		auto& slots = m_entitySlots.emplace(entity->GetId(), EntitySlots()).first.value();
 
@@ -319,6 +492,13 @@ namespace bw
 
 		OnEntityDeleted(this, destructionEvent);
 
+		// Entity ids may be reused, don't keep a snapshot referencing a dead entity
+		if (entity->HasComponent<Ndk::PhysicsComponent2D>())
+			m_isMovementSnapshotValid = false;
+
+		m_encodedEntityData.erase(entity->GetId());
+		m_isInterestSnapshotValid = false;
+
 		m_healthUpdateEntities.Remove(entity);
 		m_inputUpdateEntities.Remove(entity);
 		m_physicsEntities.Remove(entity);
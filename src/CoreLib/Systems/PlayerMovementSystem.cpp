@@ -49,33 +49,50 @@ namespace bw
 		entityPhys.ResetVelocityFunction();
 	}
 
+	/*!
+	* \brief Updates movement of the given entities only, entities not handled by this system are ignored
+	*
+	* Used to replay inputs on a subset of the world.
+	*/
+	void PlayerMovementSystem::UpdateEntities(const Ndk::EntityList& entities)
+	{
+		for (const Ndk::EntityHandle& entity : entities)
+		{
+			if (HasEntity(entity))
+				UpdateEntity(entity);
+		}
+	}
+
 	void PlayerMovementSystem::OnUpdate(float /*elapsedTime*/)
 	{
 		for (const Ndk::EntityHandle& entity : GetEntities())
-		{
-			auto& inputComponent = entity->GetComponent<InputComponent>();
-			auto& playerMovement = entity->GetComponent<PlayerMovementComponent>();
-			auto& nodeComponent = entity->GetComponent<Ndk::NodeComponent>();
-			auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent2D>();
+			UpdateEntity(entity);
+	}
 
-			const auto& inputs = inputComponent.GetInputs();
-			
-			Nz::Vector2f up = Nz::Vector2f::UnitY();
+	void PlayerMovementSystem::UpdateEntity(const Ndk::EntityHandle& entity)
+	{
+		auto& inputComponent = entity->GetComponent<InputComponent>();
+		auto& playerMovement = entity->GetComponent<PlayerMovementComponent>();
+		auto& nodeComponent = entity->GetComponent<Ndk::NodeComponent>();
+		auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent2D>();
 
-			bool isOnGround = false;
-			entityPhys.ForEachArbiter([&](Nz::Arbiter2D& arbiter)
-			{
-				if (up.DotProduct(arbiter.GetNormal()) > 0.75f)
-					isOnGround = true;
-			});
+		const auto& inputs = inputComponent.GetInputs();
+		
+		Nz::Vector2f up = Nz::Vector2f::UnitY();
+
+		bool isOnGround = false;
+		entityPhys.ForEachArbiter([&](Nz::Arbiter2D& arbiter)
+		{
+			if (up.DotProduct(arbiter.GetNormal()) > 0.75f)
+				isOnGround = true;
+		});
 
-			playerMovement.UpdateGroundState(isOnGround);
+		playerMovement.UpdateGroundState(isOnGround);
 
-			playerMovement.UpdateWasJumpingState(inputs.isJumping);
+		playerMovement.UpdateWasJumpingState(inputs.isJumping);
 
-			if (playerMovement.UpdateFacingRightState(inputs.isLookingRight))
-				nodeComponent.Scale(-1.f, 1.f);
-		}
+		if (playerMovement.UpdateFacingRightState(inputs.isLookingRight))
+			nodeComponent.Scale(-1.f, 1.f);
 	}
 
 	Ndk::SystemIndex PlayerMovementSystem::systemIndex;
@@ -31,30 +31,47 @@ namespace bw
 			m_tickableEntities.Remove(entity);
 	}
 
+	/*!
+	* \brief Executes tick callbacks of the given entities only, entities without a tick callback are ignored
+	*
+	* Used to replay inputs on a subset of the world.
+	*/
+	void TickCallbackSystem::UpdateEntities(float elapsedTime, const Ndk::EntityList& entities)
+	{
+		for (const Ndk::EntityHandle& entity : entities)
+		{
+			if (m_tickableEntities.Has(entity))
+				UpdateEntity(elapsedTime, entity);
+		}
+	}
+
 	void TickCallbackSystem::OnUpdate(float elapsedTime)
 	{
 		for (const Ndk::EntityHandle& entity : m_tickableEntities)
+			UpdateEntity(elapsedTime, entity);
+	}
+
+	void TickCallbackSystem::UpdateEntity(float elapsedTime, const Ndk::EntityHandle& entity)
+	{
+		auto& scriptComponent = entity->GetComponent<ScriptComponent>();
+		if (!scriptComponent.CanTriggerTick(elapsedTime)) //<FIXME: Due to reconciliation, this is not right
+			return;
+
+		//FIXME
+		scriptComponent.ExecuteCallback<ElementEvent::Tick>();
+
+		/*auto result = element->tickFunction(scriptComponent.GetTable());
+		if (result.valid())
 		{
-			auto& scriptComponent = entity->GetComponent<ScriptComponent>();
-			if (!scriptComponent.CanTriggerTick(elapsedTime)) //<FIXME: Due to reconciliation, this is not right
-				continue;
-
-			//FIXME
-			scriptComponent.ExecuteCallback<ElementEvent::Tick>();
-
-			/*auto result = element->tickFunction(scriptComponent.GetTable());
-			if (result.valid())
-			{
-				sol::object retObj = result;
-				if (retObj.is<float>())
-					scriptComponent.SetNextTick(retObj.as<float>());
-			}
-			else
-			{
-				sol::error err = result;
-				bwLog(m_match.GetLogger(), LogLevel::Error, "OnTick failed: {0}", err.what());
-			}*/
+			sol::object retObj = result;
+			if (retObj.is<float>())
+				scriptComponent.SetNextTick(retObj.as<float>());
 		}
+		else
+		{
+			sol::error err = result;
+			bwLog(m_match.GetLogger(), LogLevel::Error, "OnTick failed: {0}", err.what());
+		}*/
 	}
 
 	Ndk::SystemIndex TickCallbackSystem::systemIndex;
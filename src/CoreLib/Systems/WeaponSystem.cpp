@@ -19,63 +19,80 @@ namespace bw
 		SetMaximumUpdateRate(0);
 	}
 
+	/*!
+	* \brief Updates the given weapons only, entities not handled by this system are ignored
+	*
+	* Used to replay inputs on a subset of the world.
+	*/
+	void WeaponSystem::UpdateEntities(const Ndk::EntityList& entities)
+	{
+		for (const Ndk::EntityHandle& weapon : entities)
+		{
+			if (HasEntity(weapon))
+				UpdateEntity(weapon);
+		}
+	}
+
 	void WeaponSystem::OnUpdate(float /*elapsedTime*/)
 	{
 		for (const Ndk::EntityHandle& weapon : GetEntities())
-		{
-			auto& weaponComponent = weapon->GetComponent<WeaponComponent>();
-			if (!weaponComponent.IsActive())
-				continue;
+			UpdateEntity(weapon);
+	}
 
-			if (const Ndk::EntityHandle& owner = weaponComponent.GetOwner())
-			{
-				InputComponent& ownerInputs = owner->GetComponent<InputComponent>();
-				Ndk::NodeComponent& ownerNode = owner->GetComponent<Ndk::NodeComponent>();
-				Ndk::NodeComponent& weaponNode = weapon->GetComponent<Ndk::NodeComponent>();
+	void WeaponSystem::UpdateEntity(const Ndk::EntityHandle& weapon)
+	{
+		auto& weaponComponent = weapon->GetComponent<WeaponComponent>();
+		if (!weaponComponent.IsActive())
+			return;
 
-				const auto& inputs = ownerInputs.GetInputs();
-				const auto& previousInputs = ownerInputs.GetPreviousInputs();
+		if (const Ndk::EntityHandle& owner = weaponComponent.GetOwner())
+		{
+			InputComponent& ownerInputs = owner->GetComponent<InputComponent>();
+			Ndk::NodeComponent& ownerNode = owner->GetComponent<Ndk::NodeComponent>();
+			Ndk::NodeComponent& weaponNode = weapon->GetComponent<Ndk::NodeComponent>();
 
-				Nz::RadianAnglef angle(std::atan2(inputs.aimDirection.y, inputs.aimDirection.x));
-				if (std::signbit(ownerNode.GetScale(Nz::CoordSys_Global).x) != std::signbit(weaponNode.GetScale(Nz::CoordSys_Global).x))
-					weaponNode.Scale(-1.f, 1.f);
+			const auto& inputs = ownerInputs.GetInputs();
+			const auto& previousInputs = ownerInputs.GetPreviousInputs();
 
-				if (weaponNode.GetScale().x < 0.f)
-					angle += Nz::RadianAnglef(float(M_PI));
+			Nz::RadianAnglef angle(std::atan2(inputs.aimDirection.y, inputs.aimDirection.x));
+			if (std::signbit(ownerNode.GetScale(Nz::CoordSys_Global).x) != std::signbit(weaponNode.GetScale(Nz::CoordSys_Global).x))
+				weaponNode.Scale(-1.f, 1.f);
 
-				weaponNode.SetRotation(angle);
+			if (weaponNode.GetScale().x < 0.f)
+				angle += Nz::RadianAnglef(float(M_PI));
 
-				bool isAttacking = false;
-				switch (weaponComponent.GetAttackMode())
-				{
-					case WeaponAttackMode::SingleShot:
-						isAttacking = inputs.isAttacking && !previousInputs.isAttacking;
-						break;
+			weaponNode.SetRotation(angle);
 
-					case WeaponAttackMode::SingleShotRepeat:
-						isAttacking = inputs.isAttacking;
-						break;
-				}
+			bool isAttacking = false;
+			switch (weaponComponent.GetAttackMode())
+			{
+				case WeaponAttackMode::SingleShot:
+					isAttacking = inputs.isAttacking && !previousInputs.isAttacking;
+					break;
 
-				if (isAttacking)
-				{
-					auto& weaponCooldown = weapon->GetComponent<CooldownComponent>();
-					if (weaponCooldown.Trigger(m_match.GetCurrentTime()))
-					{
-						auto& weaponScript = weapon->GetComponent<ScriptComponent>();
-						weaponScript.ExecuteCallback<ElementEvent::Attack>(weaponScript.GetTable());
-
-						weaponComponent.SetAttacking(true);
-					}
-				}
-				else if (!inputs.isAttacking && weaponComponent.IsAttacking())
+				case WeaponAttackMode::SingleShotRepeat:
+					isAttacking = inputs.isAttacking;
+					break;
+			}
+
+			if (isAttacking)
+			{
+				auto& weaponCooldown = weapon->GetComponent<CooldownComponent>();
+				if (weaponCooldown.Trigger(m_match.GetCurrentTime()))
 				{
 					auto& weaponScript = weapon->GetComponent<ScriptComponent>();
-					weaponScript.ExecuteCallback<ElementEvent::AttackFinish>(weaponScript.GetTable());
+					weaponScript.ExecuteCallback<ElementEvent::Attack>(weaponScript.GetTable());
 
-					weaponComponent.SetAttacking(false);
+					weaponComponent.SetAttacking(true);
 				}
 			}
+			else if (!inputs.isAttacking && weaponComponent.IsAttacking())
+			{
+				auto& weaponScript = weapon->GetComponent<ScriptComponent>();
+				weaponScript.ExecuteCallback<ElementEvent::AttackFinish>(weaponScript.GetTable());
+
+				weaponComponent.SetAttacking(false);
+			}
 		}
 	}
 
@@ -4,6 +4,7 @@
 
 #include <CoreLib/Terrain.hpp>
 #include <CoreLib/LayerIndex.hpp>
+#include <algorithm>
 
 namespace bw
 {
@@ -12,6 +13,22 @@ namespace bw
 	{
 	}
 
+	/*!
+	* \brief Updates layers simultaneously using workerCount threads (in addition to the calling thread)
+	*
+	* A worker count of zero goes back to updating layers one after another.
+	*/
+	void Terrain::EnableParallelUpdate(std::size_t workerCount)
+	{
+		if (workerCount > 0)
+			m_workerPool.emplace(workerCount);
+		else
+			m_workerPool.reset();
+
+		for (TerrainLayer& layer : m_layers)
+			layer.EnableParallelUpdate(workerCount > 0);
+	}
+
 	void Terrain::Initialize(Match& match)
 	{
 		m_layers.reserve(m_map.GetLayerCount());
@@ -24,7 +41,42 @@ namespace bw
 
 	void Terrain::Update(float elapsedTime)
 	{
-		for (TerrainLayer& layer : m_layers)
-			layer.TickUpdate(elapsedTime);
+		if (m_workerPool)
+		{
+			// Entity creation and destruction trigger signals handled by client sessions, process them on this thread
+			std::size_t stepCount = 0;
+			for (TerrainLayer& layer : m_layers)
+			{
+				layer.GetWorld().Refresh();
+				stepCount = std::max(stepCount, layer.GetUpdateStepCount());
+			}
+
+			// Every layer runs its systems in the same order as a sequential update, only script-free steps are spread over the worker pool
+			for (std::size_t stepIndex = 0; stepIndex < stepCount; ++stepIndex)
+			{
+				if (SharedLayer::IsParallelUpdateStep(stepIndex))
+				{
+					m_workerPool->ParallelFor(m_layers.size(), [&](std::size_t layerIndex)
+					{
+						TerrainLayer& layer = m_layers[layerIndex];
+						if (stepIndex < layer.GetUpdateStepCount())
+							layer.UpdateStep(stepIndex, elapsedTime);
+					});
+				}
+				else
+				{
+					for (TerrainLayer& layer : m_layers)
+					{
+						if (stepIndex < layer.GetUpdateStepCount())
+							layer.UpdateStep(stepIndex, elapsedTime);
+					}
+				}
+			}
+		}
+		else
+		{
+			for (TerrainLayer& layer : m_layers)
+				layer.TickUpdate(elapsedTime);
+		}
 	}
 }
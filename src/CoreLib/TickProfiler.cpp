@@ -0,0 +1,217 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/TickProfiler.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <fmt/format.h>
+#include <tsl/hopscotch_map.h>
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <string_view>
+
+namespace bw
+{
+	TickProfiler::TickProfiler(std::size_t historySize) :
+	m_currentTick(0),
+	m_recordedTickCount(0),
+	m_ticks(historySize),
+	m_scriptDepth(0),
+	m_isEnabled(false),
+	m_isRecording(false)
+	{
+		assert(historySize > 0);
+	}
+
+	void TickProfiler::BeginTick(Nz::UInt64 tick)
+	{
+		if (!m_isEnabled)
+			return;
+
+		// Events vector is reused from tick to tick to prevent allocations once the buffer is warm
+		TickRecord& record = m_ticks[m_currentTick];
+		record.events.clear();
+		record.scriptTime = 0;
+		record.startTime = Nz::GetElapsedMicroseconds();
+		record.endTime = record.startTime;
+		record.tick = tick;
+
+		m_scriptDepth = 0;
+		m_isRecording = true;
+	}
+
+	/*!
+	* \brief Builds a human-readable table of per-phase timings percentiles over the recorded ticks
+	*/
+	std::string TickProfiler::BuildSummary() const
+	{
+		struct PhaseTimings
+		{
+			std::vector<Nz::UInt64> durations;
+			Nz::UInt64 lastTick;
+		};
+
+		std::vector<std::string_view> phaseNames;
+		tsl::hopscotch_map<std::string_view, PhaseTimings> phases;
+
+		auto RegisterDuration = [&](std::string_view name, Nz::UInt64 tick, Nz::UInt64 duration)
+		{
+			auto it = phases.find(name);
+			if (it == phases.end())
+			{
+				phaseNames.push_back(name);
+				it = phases.emplace(name, PhaseTimings{ {}, tick }).first;
+				it.value().durations.push_back(duration);
+			}
+			else if (it->second.lastTick == tick && !it->second.durations.empty())
+				it.value().durations.back() += duration; //< Phases running multiple times per tick (per-layer systems) are accumulated
+			else
+			{
+				it.value().lastTick = tick;
+				it.value().durations.push_back(duration);
+			}
+		};
+
+		ForEachRecordedTick([&](const TickRecord& record)
+		{
+			RegisterDuration("Tick", record.tick, record.endTime - record.startTime);
+			RegisterDuration("Script (total)", record.tick, record.scriptTime);
+
+			for (const Event& event : record.events)
+				RegisterDuration(event.name, record.tick, event.endTime - event.startTime);
+		});
+
+		std::string summary = fmt::format("Tick profile over {} ticks (microseconds)\n", m_recordedTickCount);
+		summary += fmt::format("{:<32}{:>8}{:>10}{:>10}{:>10}{:>10}\n", "Phase", "Count", "p50", "p90", "p99", "Max");
+
+		for (std::string_view name : phaseNames)
+		{
+			std::vector<Nz::UInt64>& durations = phases.find(name).value().durations;
+			std::sort(durations.begin(), durations.end());
+
+			auto Percentile = [&](std::size_t percent)
+			{
+				return durations[(durations.size() - 1) * percent / 100];
+			};
+
+			summary += fmt::format("{:<32}{:>8}{:>10}{:>10}{:>10}{:>10}\n", name, durations.size(), Percentile(50), Percentile(90), Percentile(99), durations.back());
+		}
+
+		return summary;
+	}
+
+	void TickProfiler::Clear()
+	{
+		m_currentTick = 0;
+		m_recordedTickCount = 0;
+		m_isRecording = false;
+	}
+
+	void TickProfiler::Enable(bool enable)
+	{
+		m_isEnabled = enable;
+		if (!enable)
+			m_isRecording = false;
+	}
+
+	void TickProfiler::EndTick()
+	{
+		if (!m_isRecording)
+			return;
+
+		m_ticks[m_currentTick].endTime = Nz::GetElapsedMicroseconds();
+
+		m_currentTick = (m_currentTick + 1) % m_ticks.size();
+		m_recordedTickCount = std::min(m_recordedTickCount + 1, m_ticks.size());
+		m_isRecording = false;
+	}
+
+	/*!
+	* \brief Exports recorded ticks in the Chrome trace event format (can be loaded in chrome://tracing or Perfetto)
+	*/
+	bool TickProfiler::ExportChromeTrace(const std::filesystem::path& filePath) const
+	{
+		std::ofstream file(filePath, std::ios::trunc);
+		if (!file)
+			return false;
+
+		file << "{\"traceEvents\":[\n";
+
+		bool first = true;
+		ForEachRecordedTick([&](const TickRecord& record)
+		{
+			file << (first ? "" : ",\n");
+			file << fmt::format(R"({{"name":"Tick","cat":"Tick","ph":"X","pid":1,"tid":1,"ts":{},"dur":{},"args":{{"tick":{},"scriptTime":{}}}}})", record.startTime, record.endTime - record.startTime, record.tick, record.scriptTime);
+			first = false;
+
+			for (const Event& event : record.events)
+			{
+				file << ",\n";
+				file << fmt::format(R"({{"name":"{}","cat":"{}","ph":"X","pid":1,"tid":1,"ts":{},"dur":{})", event.name, ToString(event.category), event.startTime, event.endTime - event.startTime);
+				if (event.layerIndex != NoLayer)
+					file << fmt::format(R"(,"args":{{"layer":{}}})", event.layerIndex);
+
+				file << '}';
+			}
+		});
+
+		file << "\n]}\n";
+
+		return file.good();
+	}
+
+	std::size_t TickProfiler::BeginEvent(const char* name, ProfileCategory category, LayerIndex layerIndex)
+	{
+		assert(m_isRecording);
+
+		TickRecord& record = m_ticks[m_currentTick];
+
+		std::size_t eventIndex = record.events.size();
+
+		Event& event = record.events.emplace_back();
+		event.category = category;
+		event.isOutermostScript = (category == ProfileCategory::Script && m_scriptDepth++ == 0);
+		event.layerIndex = layerIndex;
+		event.name = name;
+		event.startTime = Nz::GetElapsedMicroseconds();
+		event.endTime = event.startTime;
+
+		return eventIndex;
+	}
+
+	void TickProfiler::EndEvent(std::size_t eventIndex)
+	{
+		// Recording may have been stopped while this scope was alive
+		if (!m_isRecording)
+			return;
+
+		TickRecord& record = m_ticks[m_currentTick];
+		assert(eventIndex < record.events.size());
+
+		Event& event = record.events[eventIndex];
+		event.endTime = Nz::GetElapsedMicroseconds();
+
+		if (event.category == ProfileCategory::Script)
+		{
+			m_scriptDepth--;
+
+			// Nested script scopes are already accounted for by their parent
+			if (event.isOutermostScript)
+				record.scriptTime += event.endTime - event.startTime;
+		}
+	}
+
+	const char* ToString(ProfileCategory category)
+	{
+		switch (category)
+		{
+			case ProfileCategory::Network:    return "Network";
+			case ProfileCategory::Physics:    return "Physics";
+			case ProfileCategory::Script:     return "Script";
+			case ProfileCategory::Simulation: return "Simulation";
+		}
+
+		return "<Unhandled>";
+	}
+}
@@ -0,0 +1,78 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/TimerManager.hpp>
+#include <algorithm>
+
+namespace bw
+{
+	TimerManager::TimerManager() :
+	m_nextTimerId(1)
+	{
+	}
+
+	/*!
+	* \brief Cancels a pending timer, its callback will never be called
+	*
+	* The timer is only removed from the queue once its expiration time is reached (or when the queue gets compacted)
+	*
+	* \return True if the timer was pending
+	*/
+	bool TimerManager::Cancel(TimerId timerId)
+	{
+		auto it = m_pendingCallbacks.find(timerId);
+		if (it == m_pendingCallbacks.end())
+			return false;
+
+		m_pendingCallbacks.erase(it);
+
+		// Prevent long-lived canceled timers from piling up in the queue
+		if (m_timerQueue.size() > 64 && m_timerQueue.size() > m_pendingCallbacks.size() * 2)
+			Compact();
+
+		return true;
+	}
+
+	TimerManager::TimerId TimerManager::PushCallback(Nz::UInt64 expirationTime, Callback callback)
+	{
+		TimerId timerId = m_nextTimerId++;
+		m_pendingCallbacks.emplace(timerId, std::move(callback));
+
+		m_timerQueue.push_back({ expirationTime, timerId });
+		std::push_heap(m_timerQueue.begin(), m_timerQueue.end(), std::greater<>());
+
+		return timerId;
+	}
+
+	void TimerManager::Update(Nz::UInt64 now)
+	{
+		// Only expired timers are visited, callbacks may push new timers (which will be called during this update if they're already expired)
+		while (!m_timerQueue.empty() && now > m_timerQueue.front().expirationTime)
+		{
+			TimerId timerId = m_timerQueue.front().timerId;
+
+			std::pop_heap(m_timerQueue.begin(), m_timerQueue.end(), std::greater<>());
+			m_timerQueue.pop_back();
+
+			auto it = m_pendingCallbacks.find(timerId);
+			if (it == m_pendingCallbacks.end())
+				continue; //< Canceled timer
+
+			Callback callback = std::move(it.value());
+			m_pendingCallbacks.erase(it);
+
+			callback();
+		}
+	}
+
+	void TimerManager::Compact()
+	{
+		m_timerQueue.erase(std::remove_if(m_timerQueue.begin(), m_timerQueue.end(), [&](const QueuedTimer& timer)
+		{
+			return m_pendingCallbacks.find(timer.timerId) == m_pendingCallbacks.end();
+		}), m_timerQueue.end());
+
+		std::make_heap(m_timerQueue.begin(), m_timerQueue.end(), std::greater<>());
+	}
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Utility/TileColliders.hpp>
+#include <cassert>
+
+namespace bw
+{
+	/*!
+	* \brief Merges solid cells of a grid into rectangles (in cell units), to build as few colliders as possible
+	*
+	* Cells are merged greedily: starting from the first free solid cell (in row-major order), a rectangle is grown horizontally as far as possible
+	* and then vertically as long as the whole row below is solid and free.
+	* This doesn't always give the minimum number of rectangles.
+	*
+	* Complexity is O(width * height): it depends on the grid size, empty cells included, and not on the number of solid cells or colliders.
+	* Every cell is merged at most once, and a rejected row never costs more than the first row of the rectangle being grown.
+	*
+	* \param width Grid width
+	* \param height Grid height
+	* \param solidCells Row-major cells, true if the cell is solid
+	*/
+	std::vector<Nz::Rectui> BuildTileColliders(std::size_t width, std::size_t height, const std::vector<bool>& solidCells)
+	{
+		assert(solidCells.size() == width * height);
+
+		std::vector<Nz::Rectui> colliders;
+		std::vector<bool> mergedCells(solidCells.size(), false);
+
+		auto IsFree = [&](std::size_t x, std::size_t y)
+		{
+			std::size_t cellIndex = y * width + x;
+			return solidCells[cellIndex] && !mergedCells[cellIndex];
+		};
+
+		for (std::size_t y = 0; y < height; ++y)
+		{
+			for (std::size_t x = 0; x < width; ++x)
+			{
+				if (!IsFree(x, y))
+					continue;
+
+				std::size_t runWidth = 1;
+				while (x + runWidth < width && IsFree(x + runWidth, y))
+					runWidth++;
+
+				std::size_t runHeight = 1;
+				for (; y + runHeight < height; ++runHeight)
+				{
+					bool isRowFree = true;
+					for (std::size_t i = 0; i < runWidth; ++i)
+					{
+						if (!IsFree(x + i, y + runHeight))
+						{
+							isRowFree = false;
+							break;
+						}
+					}
+
+					if (!isRowFree)
+						break;
+				}
+
+				for (std::size_t j = 0; j < runHeight; ++j)
+				{
+					for (std::size_t i = 0; i < runWidth; ++i)
+						mergedCells[(y + j) * width + x + i] = true;
+				}
+
+				colliders.emplace_back(static_cast<unsigned int>(x), static_cast<unsigned int>(y), static_cast<unsigned int>(runWidth), static_cast<unsigned int>(runHeight));
+
+				// Cells of this run are now merged, skip them
+				x += runWidth - 1;
+			}
+		}
+
+		return colliders;
+	}
+}
@@ -0,0 +1,116 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Utility/WorkerPool.hpp>
+
+namespace bw
+{
+	WorkerPool::WorkerPool(std::size_t workerCount) :
+	m_task(nullptr),
+	m_nextTaskIndex(0),
+	m_activeWorkerCount(0),
+	m_generation(0),
+	m_remainingTaskCount(0),
+	m_taskCount(0),
+	m_running(true)
+	{
+		m_workers.reserve(workerCount);
+		for (std::size_t i = 0; i < workerCount; ++i)
+			m_workers.emplace_back(&WorkerPool::WorkerThread, this);
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_running = false;
+		}
+		m_taskSignal.notify_all();
+
+		for (std::thread& worker : m_workers)
+			worker.join();
+	}
+
+	/*!
+	* \brief Calls task once for every index in [0, taskCount)
+	*
+	* Tasks are shared between the workers and the calling thread, this function returns once every task has been executed
+	*/
+	void WorkerPool::ParallelFor(std::size_t taskCount, const std::function<void(std::size_t taskIndex)>& task)
+	{
+		if (m_workers.empty() || taskCount <= 1)
+		{
+			for (std::size_t i = 0; i < taskCount; ++i)
+				task(i);
+
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			// A worker may have woken up too late to take part in the previous batch, let it finish before changing its parameters
+			m_doneSignal.wait(lock, [&] { return m_activeWorkerCount == 0; });
+
+			m_generation++;
+			m_nextTaskIndex.store(0, std::memory_order_relaxed);
+			m_remainingTaskCount = taskCount;
+			m_task = &task;
+			m_taskCount = taskCount;
+		}
+		m_taskSignal.notify_all();
+
+		std::size_t executedTaskCount = RunTasks();
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_remainingTaskCount -= executedTaskCount;
+
+		// Wait for workers to leave RunTasks as well, so they can't pick a task from the next batch with this batch parameters
+		m_doneSignal.wait(lock, [&] { return m_remainingTaskCount == 0 && m_activeWorkerCount == 0; });
+
+		m_task = nullptr;
+	}
+
+	std::size_t WorkerPool::RunTasks()
+	{
+		std::size_t executedTaskCount = 0;
+		for (;;)
+		{
+			std::size_t taskIndex = m_nextTaskIndex.fetch_add(1, std::memory_order_relaxed);
+			if (taskIndex >= m_taskCount)
+				break;
+
+			(*m_task)(taskIndex);
+			executedTaskCount++;
+		}
+
+		return executedTaskCount;
+	}
+
+	void WorkerPool::WorkerThread()
+	{
+		std::size_t generation = 0;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;)
+		{
+			m_taskSignal.wait(lock, [&] { return !m_running || m_generation != generation; });
+			if (!m_running)
+				break;
+
+			generation = m_generation;
+			m_activeWorkerCount++;
+
+			lock.unlock();
+			std::size_t executedTaskCount = RunTasks();
+			lock.lock();
+
+			m_activeWorkerCount--;
+			m_remainingTaskCount -= executedTaskCount;
+
+			if (m_remainingTaskCount == 0 && m_activeWorkerCount == 0)
+				m_doneSignal.notify_all();
+		}
+	}
+}
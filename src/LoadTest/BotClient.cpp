@@ -0,0 +1,332 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadTest/BotClient.hpp>
+#include <CoreLib/Utils.hpp>
+#include <CoreLib/LogSystem/Logger.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <variant>
+
+namespace bw
+{
+	namespace
+	{
+		// Remember inputs sent during the last two seconds (at most) to match them with timing corrections
+		constexpr std::size_t MaxSentInputs = 128;
+	}
+
+	BotClient::BotClient(const Logger& logger, const BotCommandStore& commandStore, std::size_t botIndex, std::shared_ptr<SessionBridge> bridge, BotInputController inputController) :
+	m_bridge(std::move(bridge)),
+	m_botIndex(botIndex),
+	m_nextFileIndex(0),
+	m_commandStore(commandStore),
+	m_logger(logger),
+	m_inputController(std::move(inputController)),
+	m_status(Status::Connecting),
+	m_tickOffset(0),
+	m_serverTick(0),
+	m_currentFileFragmentCount(0),
+	m_currentFileReceivedFragments(0),
+	m_currentFileReceivedSize(0),
+	m_downloadStartTime(0),
+	m_handledPacketSize(0),
+	m_inputTick(0),
+	m_tickAccumulator(0.f),
+	m_tickDuration(0.f)
+	{
+		assert(m_bridge);
+
+		m_inputPacket.inputs.resize(1);
+
+		m_onDisconnectedSlot.Connect(m_bridge->OnDisconnected, [this](Nz::UInt32 /*data*/)
+		{
+			HandleDisconnection();
+		});
+
+		m_onIncomingPacketSlot.Connect(m_bridge->OnIncomingPacket, [this](Nz::NetPacket& packet)
+		{
+			HandlePacket(packet);
+		});
+
+		// Local bridges are connected right away
+		if (!m_bridge->IsConnected())
+		{
+			m_onConnectedSlot.Connect(m_bridge->OnConnected, [this](Nz::UInt32 /*data*/)
+			{
+				HandleConnection();
+			});
+		}
+		else
+			HandleConnection();
+	}
+
+	BotClient::~BotClient()
+	{
+		Disconnect();
+	}
+
+	void BotClient::Disconnect()
+	{
+		if (m_bridge->IsConnected())
+			m_bridge->Disconnect();
+
+		m_status = Status::Disconnected;
+	}
+
+	void BotClient::HandleIncomingPacket(const Packets::AuthFailure& /*packet*/)
+	{
+		bwLog(m_logger, LogLevel::Error, "Bot #{0}: authentication failed", m_botIndex);
+		Disconnect();
+	}
+
+	void BotClient::HandleIncomingPacket(const Packets::AuthSuccess& packet)
+	{
+		if (packet.players.size() != 1)
+		{
+			bwLog(m_logger, LogLevel::Error, "Bot #{0}: expected one player, server accepted {1}", m_botIndex, packet.players.size());
+			Disconnect();
+		}
+	}
+
+	void BotClient::HandleIncomingPacket(const Packets::DownloadClientFileFragment& packet)
+	{
+		if (m_status != Status::Downloading || m_nextFileIndex == 0)
+			return;
+
+		const auto& clientFile = m_clientFiles[m_nextFileIndex - 1];
+
+		m_currentFileReceivedFragments++;
+		m_currentFileReceivedSize += packet.fragmentContent.size();
+		m_statistics.downloadedBytes += packet.fragmentContent.size();
+
+		if (m_currentFileReceivedFragments < m_currentFileFragmentCount)
+			return;
+
+		// File content isn't kept nor hashed, only the transfer itself is of interest here
+		if (m_currentFileReceivedSize != clientFile.size)
+		{
+			bwLog(m_logger, LogLevel::Error, "Bot #{0}: {1} size mismatch (expected {2}, got {3})", m_botIndex, clientFile.path, Nz::UInt64(clientFile.size), m_currentFileReceivedSize);
+			Disconnect();
+			return;
+		}
+
+		RequestNextFile();
+	}
+
+	void BotClient::HandleIncomingPacket(const Packets::DownloadClientFileResponse& packet)
+	{
+		if (m_status != Status::Downloading || m_nextFileIndex == 0)
+			return;
+
+		if (std::holds_alternative<Packets::DownloadClientFileResponse::Failure>(packet.content))
+		{
+			bwLog(m_logger, LogLevel::Error, "Bot #{0}: server failed to send {1}", m_botIndex, m_clientFiles[m_nextFileIndex - 1].path);
+			Disconnect();
+			return;
+		}
+
+		const auto& success = std::get<Packets::DownloadClientFileResponse::Success>(packet.content);
+		m_currentFileFragmentCount = success.fragmentCount;
+
+		// Empty files won't receive any fragment
+		if (m_currentFileFragmentCount == 0)
+			RequestNextFile();
+	}
+
+	void BotClient::HandleIncomingPacket(const Packets::InputTimingCorrection& packet)
+	{
+		Nz::Int32 tickError = packet.tickError;
+		Nz::UInt32 absTickError = static_cast<Nz::UInt32>(std::abs(tickError));
+
+		m_statistics.tickErrorCount++;
+		m_statistics.tickErrorSum += absTickError;
+		m_statistics.maxTickError = std::max(m_statistics.maxTickError, absTickError);
+
+		// Corrections are absolute relative to the offset used when sending the input, so late corrections don't make us overshoot
+		auto it = std::find_if(m_sentInputs.begin(), m_sentInputs.end(), [&](const SentInput& sentInput) { return sentInput.estimatedServerTick == packet.serverTick; });
+		if (it != m_sentInputs.end())
+		{
+			m_tickOffset = it->tickOffset - tickError;
+			m_sentInputs.erase(m_sentInputs.begin(), it + 1);
+		}
+	}
+
+	void BotClient::HandleIncomingPacket(const Packets::MatchData& packet)
+	{
+		if (m_status != Status::Authenticating)
+			return;
+
+		m_serverTick = packet.currentTick;
+		m_tickDuration = packet.tickDuration;
+
+		m_clientFiles.clear();
+		m_clientFiles.reserve(packet.assets.size() + packet.scripts.size());
+		m_clientFiles.insert(m_clientFiles.end(), packet.assets.begin(), packet.assets.end());
+		m_clientFiles.insert(m_clientFiles.end(), packet.scripts.begin(), packet.scripts.end());
+
+		bwLog(m_logger, LogLevel::Debug, "Bot #{0}: downloading {1} client files", m_botIndex, m_clientFiles.size());
+
+		m_downloadStartTime = Nz::GetElapsedMilliseconds();
+		m_nextFileIndex = 0;
+		m_status = Status::Downloading;
+
+		RequestNextFile();
+	}
+
+	void BotClient::HandleIncomingPacket(const Packets::MatchState& packet)
+	{
+		m_statistics.matchStateBytes += m_handledPacketSize;
+		m_statistics.matchStateCount++;
+		if (packet.isQuantized)
+			m_statistics.quantizedMatchStateCount++;
+
+		AcknowledgeMatchState(packet.stateTick);
+
+		if (m_status == Status::Playing && m_inputTick > 0)
+		{
+			Nz::UInt16 lastSentInputTick = static_cast<Nz::UInt16>(m_inputTick - 1);
+			Nz::UInt32 inputDelay = static_cast<Nz::UInt16>(lastSentInputTick - packet.lastInputTick);
+
+			m_statistics.inputDelayCount++;
+			m_statistics.inputDelaySum += inputDelay;
+			m_statistics.maxInputDelay = std::max(m_statistics.maxInputDelay, inputDelay);
+		}
+	}
+
+	void BotClient::Update(float elapsedTime)
+	{
+		if (m_status == Status::Disconnected || m_tickDuration <= 0.f)
+			return;
+
+		m_tickAccumulator += elapsedTime;
+		while (m_tickAccumulator >= m_tickDuration)
+		{
+			m_tickAccumulator -= m_tickDuration;
+			m_serverTick++;
+
+			if (m_status == Status::Playing)
+				SendInputs();
+		}
+	}
+
+	void BotClient::AcknowledgeMatchState(Nz::UInt16 stateTick)
+	{
+		// Same as LocalMatch, the server uses acknowledgements to resend lost updates and as delta baselines
+		auto& acknowledgedTick = m_inputPacket.acknowledgedStateTick;
+		auto& acknowledgedMask = m_inputPacket.acknowledgedStateMask;
+
+		if (!acknowledgedTick)
+		{
+			acknowledgedTick = stateTick;
+			acknowledgedMask = 0;
+		}
+		else if (IsMoreRecent(stateTick, *acknowledgedTick))
+		{
+			Nz::UInt16 shift = stateTick - *acknowledgedTick;
+			if (shift <= 32)
+			{
+				acknowledgedMask = (shift < 32) ? acknowledgedMask << shift : 0;
+				acknowledgedMask |= Nz::UInt32(1) << (shift - 1);
+			}
+			else
+				acknowledgedMask = 0;
+
+			acknowledgedTick = stateTick;
+		}
+		else
+		{
+			Nz::UInt16 offset = *acknowledgedTick - stateTick;
+			if (offset > 0 && offset <= 32)
+				acknowledgedMask |= Nz::UInt32(1) << (offset - 1);
+		}
+	}
+
+	void BotClient::HandleConnection()
+	{
+		bwLog(m_logger, LogLevel::Debug, "Bot #{0}: connected, authenticating...", m_botIndex);
+
+		m_status = Status::Authenticating;
+
+		Packets::Auth authPacket;
+		authPacket.players.emplace_back().nickname = "Bot" + std::to_string(m_botIndex);
+		authPacket.supportedFeatures = ProtocolFeature::BatchedEntityEvents | ProtocolFeature::QuantizedMatchState;
+
+		SendPacket(authPacket);
+	}
+
+	void BotClient::HandleDisconnection()
+	{
+		if (m_status != Status::Disconnected)
+			bwLog(m_logger, LogLevel::Warning, "Bot #{0}: disconnected by server", m_botIndex);
+
+		m_status = Status::Disconnected;
+	}
+
+	void BotClient::HandlePacket(Nz::NetPacket& packet)
+	{
+		m_statistics.receivedBytes += packet.GetDataSize();
+		m_statistics.receivedPackets++;
+
+		// Packet handlers only get the unserialized packet
+		m_handledPacketSize = packet.GetDataSize();
+		m_commandStore.UnserializePacket(this, packet);
+	}
+
+	void BotClient::RequestNextFile()
+	{
+		if (m_nextFileIndex >= m_clientFiles.size())
+		{
+			m_statistics.downloadDuration = Nz::GetElapsedMilliseconds() - m_downloadStartTime;
+
+			bwLog(m_logger, LogLevel::Debug, "Bot #{0}: downloaded {1} in {2}ms, joining match", m_botIndex, ByteToString(m_statistics.downloadedBytes), m_statistics.downloadDuration);
+
+			m_clientFiles.clear();
+			m_clientFiles.shrink_to_fit();
+			m_status = Status::Playing;
+
+			SendPacket(Packets::Ready{});
+			return;
+		}
+
+		m_currentFileFragmentCount = 0;
+		m_currentFileReceivedFragments = 0;
+		m_currentFileReceivedSize = 0;
+
+		Packets::DownloadClientFileRequest request;
+		request.path = m_clientFiles[m_nextFileIndex++].path;
+
+		SendPacket(request);
+	}
+
+	void BotClient::SendInputs()
+	{
+		PlayerInputData inputs = m_inputController.Poll(m_inputTick);
+
+		// Inputs are only sent when they change, like a regular client
+		if (!m_lastInputs || *m_lastInputs != inputs)
+		{
+			m_lastInputs = inputs;
+			m_inputPacket.inputs[0] = inputs;
+		}
+		else
+			m_inputPacket.inputs[0].reset();
+
+		Nz::UInt16 estimatedServerTick = static_cast<Nz::UInt16>(m_serverTick + m_tickOffset);
+
+		m_inputPacket.estimatedServerTick = estimatedServerTick;
+		m_inputPacket.inputTick = static_cast<Nz::UInt16>(m_inputTick++);
+
+		if (m_sentInputs.size() >= MaxSentInputs)
+			m_sentInputs.pop_front();
+
+		auto& sentInput = m_sentInputs.emplace_back();
+		sentInput.estimatedServerTick = estimatedServerTick;
+		sentInput.tickOffset = m_tickOffset;
+
+		SendPacket(m_inputPacket);
+	}
+}
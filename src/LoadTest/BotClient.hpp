@@ -0,0 +1,134 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_LOADTEST_BOTCLIENT_HPP
+#define BURGWAR_LOADTEST_BOTCLIENT_HPP
+
+#include <CoreLib/SessionBridge.hpp>
+#include <CoreLib/Protocol/Packets.hpp>
+#include <LoadTest/BotInputController.hpp>
+#include <Nazara/Core/Signal.hpp>
+#include <Nazara/Network/NetPacket.hpp>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bw
+{
+	class BotCommandStore;
+	class Logger;
+
+	/*!
+	* \brief Headless client going through the same steps as a player (authentication, client files download, inputs) without running the match locally
+	*/
+	class BotClient
+	{
+		public:
+			enum class Status
+			{
+				Connecting,
+				Authenticating,
+				Downloading,
+				Playing,
+				Disconnected
+			};
+
+			struct Statistics;
+
+			BotClient(const Logger& logger, const BotCommandStore& commandStore, std::size_t botIndex, std::shared_ptr<SessionBridge> bridge, BotInputController inputController);
+			BotClient(const BotClient&) = delete;
+			BotClient(BotClient&&) = delete;
+			~BotClient();
+
+			void Disconnect();
+
+			inline std::size_t GetIndex() const;
+			inline const Statistics& GetStatistics() const;
+			inline Status GetStatus() const;
+
+			template<typename T> void HandleIncomingPacket(const T& packet);
+			void HandleIncomingPacket(const Packets::AuthFailure& packet);
+			void HandleIncomingPacket(const Packets::AuthSuccess& packet);
+			void HandleIncomingPacket(const Packets::DownloadClientFileFragment& packet);
+			void HandleIncomingPacket(const Packets::DownloadClientFileResponse& packet);
+			void HandleIncomingPacket(const Packets::InputTimingCorrection& packet);
+			void HandleIncomingPacket(const Packets::MatchData& packet);
+			void HandleIncomingPacket(const Packets::MatchState& packet);
+
+			void Update(float elapsedTime);
+
+			BotClient& operator=(const BotClient&) = delete;
+			BotClient& operator=(BotClient&&) = delete;
+
+			struct Statistics
+			{
+				Nz::UInt64 downloadedBytes = 0;
+				Nz::UInt64 downloadDuration = 0; //< milliseconds
+				Nz::UInt64 inputDelayCount = 0;
+				Nz::UInt64 inputDelaySum = 0;    //< ticks between an input and the first match state taking it into account
+				Nz::UInt64 matchStateBytes = 0;  //< bytes received in MatchState packets, to compare quantized and raw states
+				Nz::UInt64 matchStateCount = 0;
+				Nz::UInt64 quantizedMatchStateCount = 0;
+				Nz::UInt64 receivedBytes = 0;
+				Nz::UInt64 receivedPackets = 0;
+				Nz::UInt64 sentBytes = 0;
+				Nz::UInt64 sentPackets = 0;
+				Nz::UInt64 tickErrorCount = 0;
+				Nz::UInt64 tickErrorSum = 0;     //< absolute tick errors reported by the server (input timing reconciliation)
+				Nz::UInt32 maxInputDelay = 0;
+				Nz::UInt32 maxTickError = 0;
+			};
+
+		private:
+			void AcknowledgeMatchState(Nz::UInt16 stateTick);
+			void HandleConnection();
+			void HandleDisconnection();
+			void HandlePacket(Nz::NetPacket& packet);
+			void RequestNextFile();
+			void SendInputs();
+			template<typename T> void SendPacket(const T& packet);
+
+			struct SentInput
+			{
+				Nz::Int32 tickOffset;
+				Nz::UInt16 estimatedServerTick;
+			};
+
+			NazaraSlot(SessionBridge, OnConnected, m_onConnectedSlot);
+			NazaraSlot(SessionBridge, OnDisconnected, m_onDisconnectedSlot);
+			NazaraSlot(SessionBridge, OnIncomingPacket, m_onIncomingPacketSlot);
+
+			std::deque<SentInput> m_sentInputs;
+			std::optional<PlayerInputData> m_lastInputs;
+			std::shared_ptr<SessionBridge> m_bridge;
+			std::size_t m_botIndex;
+			std::size_t m_nextFileIndex;
+			std::vector<Packets::MatchData::ClientFile> m_clientFiles;
+			const BotCommandStore& m_commandStore;
+			const Logger& m_logger;
+			BotInputController m_inputController;
+			Nz::NetPacket m_outgoingPacket;
+			Packets::PlayersInput m_inputPacket;
+			Statistics m_statistics;
+			Status m_status;
+			Nz::Int32 m_tickOffset;
+			Nz::UInt16 m_serverTick;
+			Nz::UInt32 m_currentFileFragmentCount;
+			Nz::UInt32 m_currentFileReceivedFragments;
+			Nz::UInt64 m_currentFileReceivedSize;
+			Nz::UInt64 m_downloadStartTime;
+			Nz::UInt64 m_handledPacketSize;
+			Nz::UInt64 m_inputTick;
+			float m_tickAccumulator;
+			float m_tickDuration;
+	};
+}
+
+#include <LoadTest/BotClient.inl>
+
+#endif
@@ -0,0 +1,46 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadTest/BotClient.hpp>
+#include <LoadTest/BotCommandStore.hpp>
+
+namespace bw
+{
+	inline std::size_t BotClient::GetIndex() const
+	{
+		return m_botIndex;
+	}
+
+	inline auto BotClient::GetStatistics() const -> const Statistics&
+	{
+		return m_statistics;
+	}
+
+	inline auto BotClient::GetStatus() const -> Status
+	{
+		return m_status;
+	}
+
+	template<typename T>
+	void BotClient::HandleIncomingPacket(const T& /*packet*/)
+	{
+		// Bots don't simulate the match, most packets are only accounted for in the statistics
+	}
+
+	template<typename T>
+	void BotClient::SendPacket(const T& packet)
+	{
+		if (!m_bridge->IsConnected())
+			return;
+
+		m_outgoingPacket.Reset();
+		m_commandStore.SerializePacket(m_outgoingPacket, packet);
+
+		m_statistics.sentBytes += m_outgoingPacket.GetDataSize();
+		m_statistics.sentPackets++;
+
+		const auto& command = m_commandStore.GetOutgoingCommand<T>();
+		m_bridge->SendPacket(command.channelId, command.flags, m_outgoingPacket);
+	}
+}
@@ -0,0 +1,65 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadTest/BotCommandStore.hpp>
+#include <CoreLib/Protocol/Packets.hpp>
+#include <LoadTest/BotClient.hpp>
+
+namespace bw
+{
+	BotCommandStore::BotCommandStore(const Logger& logger) :
+	CommandStore(logger)
+	{
+#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type>(#Type, [](BotClient* bot, Packets::Type& packet) \
+{ \
+	bot->HandleIncomingPacket(packet); \
+})
+#define OutgoingCommand(Type, Flags, Channel) RegisterOutgoingCommand<Packets::Type>(#Type, Flags, Channel)
+
+		// Incoming commands (same as a regular client, most of them are only counted)
+		IncomingCommand(AuthFailure);
+		IncomingCommand(AuthSuccess);
+		IncomingCommand(ChatMessage);
+		IncomingCommand(ClientAssetList);
+		IncomingCommand(ClientScriptList);
+		IncomingCommand(ConsoleAnswer);
+		IncomingCommand(ControlEntity);
+		IncomingCommand(CreateEntities);
+		IncomingCommand(DeleteEntities);
+		IncomingCommand(DisableLayer);
+		IncomingCommand(DownloadClientFileFragment);
+		IncomingCommand(DownloadClientFileResponse);
+		IncomingCommand(EnableLayer);
+		IncomingCommand(EntitiesAnimation);
+		IncomingCommand(EntitiesDeath);
+		IncomingCommand(EntitiesInputs);
+		IncomingCommand(EntitiesPhysics);
+		IncomingCommand(EntitiesScale);
+		IncomingCommand(EntitiesWeapon);
+		IncomingCommand(EntityPhysics);
+		IncomingCommand(EntityWeapon);
+		IncomingCommand(HealthUpdate);
+		IncomingCommand(InputTimingCorrection);
+		IncomingCommand(MatchData);
+		IncomingCommand(MatchState);
+		IncomingCommand(NetworkStrings);
+		IncomingCommand(PlayerControlEntity);
+		IncomingCommand(PlayerJoined);
+		IncomingCommand(PlayerLayer);
+		IncomingCommand(PlayerLeaving);
+		IncomingCommand(PlayerNameUpdate);
+		IncomingCommand(PlayerPingUpdate);
+		IncomingCommand(PlayerWeapons);
+		IncomingCommand(ScriptPacket);
+
+		// Outgoing commands
+		OutgoingCommand(Auth,                        Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(DownloadClientFileRequest,   Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(PlayersInput,                Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(Ready,                       Nz::ENetPacketFlag_Reliable, 0);
+
+#undef IncomingCommand
+#undef OutgoingCommand
+	}
+}
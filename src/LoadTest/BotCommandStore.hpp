@@ -0,0 +1,26 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_LOADTEST_BOTCOMMANDSTORE_HPP
+#define BURGWAR_LOADTEST_BOTCOMMANDSTORE_HPP
+
+#include <CoreLib/CommandStore.hpp>
+
+namespace bw
+{
+	class BotClient;
+
+	class BotCommandStore : public CommandStore<BotClient*>
+	{
+		public:
+			BotCommandStore(const Logger& logger);
+			~BotCommandStore() = default;
+	};
+}
+
+#include <LoadTest/BotCommandStore.inl>
+
+#endif
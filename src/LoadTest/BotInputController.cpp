@@ -0,0 +1,117 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadTest/BotInputController.hpp>
+#include <Nazara/Math/Angle.hpp>
+#include <cassert>
+
+namespace bw
+{
+	BotInputController::BotInputController(Behavior behavior, Nz::UInt32 seed) :
+	m_behavior(behavior),
+	m_seed(seed),
+	m_nextActionTick(0),
+	m_randomGenerator(seed)
+	{
+	}
+
+	PlayerInputData BotInputController::Poll(Nz::UInt64 tick)
+	{
+		switch (m_behavior)
+		{
+			case Behavior::Idle:
+				return PlayerInputData{};
+
+			case Behavior::Random:
+				return PollRandom(tick);
+
+			case Behavior::Scripted:
+				return PollScripted(tick);
+		}
+
+		assert(!"unhandled behavior");
+		return PlayerInputData{};
+	}
+
+	PlayerInputData BotInputController::PollRandom(Nz::UInt64 tick)
+	{
+		if (tick < m_nextActionTick)
+		{
+			// Jumps only last one tick, otherwise bots would bunny hop until their next action
+			m_currentInputs.isJumping = false;
+			return m_currentInputs;
+		}
+
+		std::uniform_int_distribution<int> actionDurationDis(5, 60);
+		std::uniform_int_distribution<int> directionDis(-1, 1);
+		std::uniform_int_distribution<int> percentDis(0, 99);
+		std::uniform_real_distribution<float> angleDis(-180.f, 180.f);
+
+		m_nextActionTick = tick + actionDurationDis(m_randomGenerator);
+
+		int direction = directionDis(m_randomGenerator);
+
+		PlayerInputData& inputs = m_currentInputs;
+		inputs.isMovingLeft = (direction < 0);
+		inputs.isMovingRight = (direction > 0);
+		inputs.isLookingRight = (direction != 0) ? direction > 0 : inputs.isLookingRight;
+		inputs.isJumping = percentDis(m_randomGenerator) < 30;
+		inputs.isAttacking = percentDis(m_randomGenerator) < 40;
+		inputs.isCrouching = percentDis(m_randomGenerator) < 10;
+
+		Nz::DegreeAnglef aimAngle(angleDis(m_randomGenerator));
+		inputs.aimDirection = Nz::Vector2f(aimAngle.GetCos(), aimAngle.GetSin());
+
+		return inputs;
+	}
+
+	PlayerInputData BotInputController::PollScripted(Nz::UInt64 tick)
+	{
+		constexpr Nz::UInt64 StepDuration = 30;
+		constexpr Nz::UInt64 StepCount = 6;
+
+		// Offset bots by their seed so they don't all move in sync
+		Nz::UInt64 localTick = tick + m_seed * 7;
+		Nz::UInt64 step = (localTick / StepDuration) % StepCount;
+		bool isStepStart = (localTick % StepDuration) == 0;
+
+		PlayerInputData inputs;
+		switch (step)
+		{
+			case 0: // walk right
+				inputs.isMovingRight = true;
+				break;
+
+			case 1: // jump right while shooting
+				inputs.isMovingRight = true;
+				inputs.isJumping = isStepStart;
+				inputs.isAttacking = true;
+				break;
+
+			case 2: // stand still and shoot upwards
+				inputs.aimDirection = Nz::Vector2f(0.f, -1.f);
+				inputs.isAttacking = true;
+				break;
+
+			case 3: // walk left
+				inputs.isLookingRight = false;
+				inputs.isMovingLeft = true;
+				break;
+
+			case 4: // jump left while shooting
+				inputs.aimDirection = Nz::Vector2f(-1.f, 0.f);
+				inputs.isAttacking = true;
+				inputs.isJumping = isStepStart;
+				inputs.isLookingRight = false;
+				inputs.isMovingLeft = true;
+				break;
+
+			case 5: // crouch
+				inputs.isCrouching = true;
+				break;
+		}
+
+		return inputs;
+	}
+}
@@ -0,0 +1,52 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_LOADTEST_BOTINPUTCONTROLLER_HPP
+#define BURGWAR_LOADTEST_BOTINPUTCONTROLLER_HPP
+
+#include <CoreLib/PlayerInputData.hpp>
+#include <Nazara/Prerequisites.hpp>
+#include <random>
+
+namespace bw
+{
+	class BotInputController
+	{
+		public:
+			enum class Behavior
+			{
+				Idle,     //< Never sends any input
+				Random,   //< Picks a new random action every few ticks
+				Scripted  //< Loops over a fixed sequence of actions (reproducible across runs)
+			};
+
+			BotInputController(Behavior behavior, Nz::UInt32 seed);
+			BotInputController(const BotInputController&) = delete;
+			BotInputController(BotInputController&&) noexcept = default;
+			~BotInputController() = default;
+
+			inline Behavior GetBehavior() const;
+
+			PlayerInputData Poll(Nz::UInt64 tick);
+
+			BotInputController& operator=(const BotInputController&) = delete;
+			BotInputController& operator=(BotInputController&&) noexcept = default;
+
+		private:
+			PlayerInputData PollRandom(Nz::UInt64 tick);
+			PlayerInputData PollScripted(Nz::UInt64 tick);
+
+			Behavior m_behavior;
+			Nz::UInt32 m_seed;
+			Nz::UInt64 m_nextActionTick;
+			PlayerInputData m_currentInputs;
+			std::minstd_rand m_randomGenerator;
+	};
+}
+
+#include <LoadTest/BotInputController.inl>
+
+#endif
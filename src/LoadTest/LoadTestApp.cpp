@@ -0,0 +1,331 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadTest/LoadTestApp.hpp>
+#include <CoreLib/LocalSessionBridge.hpp>
+#include <CoreLib/LocalSessionManager.hpp>
+#include <CoreLib/NetworkReactor.hpp>
+#include <CoreLib/NetworkSessionBridge.hpp>
+#include <CoreLib/NetworkSessionManager.hpp>
+#include <CoreLib/Utils.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <Nazara/Core/String.hpp>
+#include <Nazara/Network/Algorithm.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+namespace bw
+{
+	LoadTestApp::LoadTestApp(int argc, char* argv[], Settings settings) :
+	Application(argc, argv),
+	BurgApp(LogSide::Server, m_configFile),
+	m_configFile(*this),
+	m_commandStore(GetLogger()),
+	m_settings(std::move(settings)),
+	m_startTime(0),
+	m_localSessionManager(nullptr)
+	{
+		if (!m_configFile.LoadFromFile("serverconfig.lua"))
+			throw std::runtime_error("failed to load config file");
+
+		// Match logs would bury the reports (which are printed to the standard output)
+		if (!m_settings.verbose)
+			GetLogger().SetMinimumLogLevel(LogLevel::Warning);
+
+		if (m_settings.serverPort == 0)
+			m_settings.serverPort = m_configFile.GetIntegerValue<Nz::UInt16>("Server.Port");
+
+		if (m_settings.mode != ConnectionMode::Remote)
+			HostMatch();
+
+		if (m_settings.mode != ConnectionMode::Local)
+		{
+			if (!SetupReactor())
+				throw std::runtime_error("failed to setup network");
+		}
+
+		m_bots.reserve(m_settings.botCount);
+	}
+
+	LoadTestApp::~LoadTestApp()
+	{
+		// Let disconnection packets reach the server before the reactor is destroyed
+		m_bots.clear();
+		if (m_reactor)
+			m_reactor->FlushOutgoing();
+	}
+
+	int LoadTestApp::Run()
+	{
+		m_startTime = Nz::GetElapsedMicroseconds();
+
+		Nz::UInt64 lastUpdateTime = m_startTime;
+		Nz::UInt64 nextConnectionTime = m_startTime;
+		Nz::UInt64 nextReportTime = m_startTime + static_cast<Nz::UInt64>(m_settings.reportInterval * 1'000'000.f);
+		Nz::UInt64 endTime = m_startTime + static_cast<Nz::UInt64>(m_settings.duration * 1'000'000.f);
+
+		while (Application::Run())
+		{
+			BurgApp::Update();
+
+			Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+			if (now >= endTime)
+				break;
+
+			float elapsedTime = (now - lastUpdateTime) / 1'000'000.f;
+			lastUpdateTime = now;
+
+			// Bots join progressively, like players would
+			while (m_bots.size() < m_settings.botCount && now >= nextConnectionTime)
+			{
+				ConnectBot();
+				nextConnectionTime += static_cast<Nz::UInt64>(m_settings.connectionInterval * 1'000'000.f);
+			}
+
+			if (m_match)
+			{
+				Nz::UInt64 previousTick = m_match->GetCurrentTick();
+				Nz::UInt64 updateStart = Nz::GetElapsedMicroseconds();
+
+				m_match->Update(elapsedTime);
+
+				Nz::UInt64 updateDuration = Nz::GetElapsedMicroseconds() - updateStart;
+				Nz::UInt64 executedTickCount = m_match->GetCurrentTick() - previousTick;
+				if (executedTickCount > 0)
+				{
+					for (Nz::UInt64 i = 0; i < executedTickCount; ++i)
+						m_tickTimings.durations.push_back(updateDuration / executedTickCount);
+
+					m_tickTimings.tickCount += executedTickCount;
+				}
+			}
+
+			if (m_reactor)
+				PollReactor();
+
+			for (auto& botPtr : m_bots)
+				botPtr->Update(elapsedTime);
+
+			if (now >= nextReportTime)
+			{
+				PrintReport(false);
+				nextReportTime += static_cast<Nz::UInt64>(m_settings.reportInterval * 1'000'000.f);
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		PrintReport(true);
+
+		bool success = true;
+
+		std::size_t playingBotCount = std::count_if(m_bots.begin(), m_bots.end(), [](const auto& botPtr) { return botPtr->GetStatus() == BotClient::Status::Playing; });
+		if (playingBotCount != m_settings.botCount)
+		{
+			bwLog(GetLogger(), LogLevel::Error, "{0}/{1} bots were playing at the end of the test", playingBotCount, m_settings.botCount);
+			success = false;
+		}
+
+		if (m_settings.maxTickTime && !m_tickTimings.durations.empty())
+		{
+			std::vector<Nz::UInt64> durations = m_tickTimings.durations;
+			std::sort(durations.begin(), durations.end());
+
+			float p99 = durations[(durations.size() - 1) * 99 / 100] / 1000.f;
+			if (p99 > *m_settings.maxTickTime)
+			{
+				bwLog(GetLogger(), LogLevel::Error, "99th percentile tick time ({0:.3f}ms) is above the limit ({1:.3f}ms)", p99, *m_settings.maxTickTime);
+				success = false;
+			}
+		}
+
+		return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	void LoadTestApp::ConnectBot()
+	{
+		std::size_t botIndex = m_bots.size();
+
+		std::shared_ptr<SessionBridge> bridge;
+		if (m_localSessionManager)
+			bridge = m_localSessionManager->CreateSession();
+		else
+		{
+			std::size_t peerId = m_reactor->ConnectTo(m_serverAddress);
+			if (peerId == NetworkReactor::InvalidPeerId)
+			{
+				bwLog(GetLogger(), LogLevel::Error, "Bot #{0}: failed to allocate a peer", botIndex);
+				return;
+			}
+
+			auto networkBridge = std::make_shared<NetworkSessionBridge>(*m_reactor, peerId);
+			if (peerId >= m_networkBridges.size())
+				m_networkBridges.resize(peerId + 1);
+
+			m_networkBridges[peerId] = networkBridge;
+			bridge = std::move(networkBridge);
+		}
+
+		// Seeding with the bot index keeps runs reproducible
+		BotInputController inputController(m_settings.behavior, static_cast<Nz::UInt32>(botIndex));
+		m_bots.emplace_back(std::make_unique<BotClient>(GetLogger(), m_commandStore, botIndex, std::move(bridge), std::move(inputController)));
+	}
+
+	void LoadTestApp::HostMatch()
+	{
+		Match::GamemodeSettings gamemodeSettings;
+		gamemodeSettings.name = m_configFile.GetStringValue("GameSettings.Gamemode");
+
+		Match::MatchSettings matchSettings;
+		matchSettings.fileHashCache = std::make_shared<FileHashCache>(m_configFile.GetStringValue("Resources.HashCacheFile"));
+		matchSettings.fileHashCache->Load();
+		matchSettings.fileTransferRate = m_configFile.GetIntegerValue<Nz::UInt64>("Network.FileTransferRate");
+		matchSettings.layerWorkerCount = m_configFile.GetIntegerValue<std::size_t>("GameSettings.LayerWorkerCount");
+		matchSettings.map = Map::LoadFromBinary(m_configFile.GetStringValue("GameSettings.MapFile"));
+		matchSettings.maxPlayerCount = m_settings.botCount;
+		matchSettings.name = "loadtest";
+		matchSettings.scriptBytecodeCache = std::make_shared<ScriptBytecodeCache>(m_configFile.GetStringValue("Resources.BytecodeCacheDirectory"));
+		matchSettings.tickDuration = 1.f / m_configFile.GetFloatValue<float>("GameSettings.TickRate");
+
+		if (float interestRadius = m_configFile.GetFloatValue<float>("Network.InterestRadius"); interestRadius > 0.f)
+			matchSettings.interestRadius = interestRadius;
+
+		if (m_settings.quantizeMatchState.value_or(m_configFile.GetBoolValue("Network.QuantizeMatchState")))
+		{
+			auto& quantizationSettings = matchSettings.matchStateQuantization.emplace();
+			quantizationSettings.angularVelocityPrecision = m_configFile.GetFloatValue<float>("Network.AngularVelocityPrecision");
+			quantizationSettings.linearVelocityPrecision = m_configFile.GetFloatValue<float>("Network.LinearVelocityPrecision");
+			quantizationSettings.positionPrecision = m_configFile.GetFloatValue<float>("Network.PositionPrecision");
+			quantizationSettings.rotationBits = m_configFile.GetIntegerValue<Nz::UInt8>("Network.RotationBits");
+		}
+
+		m_match = std::make_unique<Match>(*this, std::move(matchSettings), std::move(gamemodeSettings));
+
+		if (m_settings.mode == ConnectionMode::Local)
+			m_localSessionManager = m_match->GetSessions().CreateSessionManager<LocalSessionManager>();
+		else
+		{
+			m_match->GetSessions().CreateSessionManager<NetworkSessionManager>(m_settings.serverPort, m_settings.botCount);
+			bwLog(GetLogger(), LogLevel::Info, "Match listening on port {0}", m_settings.serverPort);
+		}
+	}
+
+	void LoadTestApp::PollReactor()
+	{
+		m_reactor->Poll([&](bool /*outgoing*/, std::size_t peerId, Nz::UInt32 data)
+		{
+			m_networkBridges[peerId]->HandleConnection(data);
+		},
+		[&](std::size_t peerId, Nz::UInt32 data, DisconnectionCause cause)
+		{
+			if (cause == DisconnectionCause::ConnectionFailed)
+				bwLog(GetLogger(), LogLevel::Warning, "Peer #{0} failed to connect", peerId);
+
+			m_networkBridges[peerId]->HandleDisconnection(data);
+			m_networkBridges[peerId].reset();
+		},
+		[&](std::size_t peerId, Nz::NetPacket&& packet)
+		{
+			m_networkBridges[peerId]->HandleIncomingPacket(packet);
+		});
+	}
+
+	void LoadTestApp::PrintReport(bool finalReport)
+	{
+		float elapsedTime = (Nz::GetElapsedMicroseconds() - m_startTime) / 1'000'000.f;
+
+		std::array<std::size_t, 5> statusCount = {};
+		BotClient::Statistics total;
+		Nz::UInt64 maxDownloadDuration = 0;
+		Nz::UInt64 maxReceivedBytes = 0;
+
+		for (const auto& botPtr : m_bots)
+		{
+			statusCount[static_cast<std::size_t>(botPtr->GetStatus())]++;
+
+			const BotClient::Statistics& stats = botPtr->GetStatistics();
+			total.downloadedBytes += stats.downloadedBytes;
+			total.inputDelayCount += stats.inputDelayCount;
+			total.inputDelaySum += stats.inputDelaySum;
+			total.matchStateBytes += stats.matchStateBytes;
+			total.matchStateCount += stats.matchStateCount;
+			total.quantizedMatchStateCount += stats.quantizedMatchStateCount;
+			total.receivedBytes += stats.receivedBytes;
+			total.receivedPackets += stats.receivedPackets;
+			total.sentBytes += stats.sentBytes;
+			total.sentPackets += stats.sentPackets;
+			total.tickErrorCount += stats.tickErrorCount;
+			total.tickErrorSum += stats.tickErrorSum;
+			total.maxInputDelay = std::max(total.maxInputDelay, stats.maxInputDelay);
+			total.maxTickError = std::max(total.maxTickError, stats.maxTickError);
+
+			maxDownloadDuration = std::max(maxDownloadDuration, stats.downloadDuration);
+			maxReceivedBytes = std::max(maxReceivedBytes, stats.receivedBytes);
+		}
+
+		std::size_t botCount = std::max<std::size_t>(m_bots.size(), 1);
+		auto PerBotPerSecond = [&](Nz::UInt64 value)
+		{
+			return value / botCount / std::max(elapsedTime, 0.001f);
+		};
+
+		fmt::print("=== {0} report after {1:.1f}s ===\n", (finalReport) ? "Final" : "Intermediate", elapsedTime);
+		fmt::print("Bots: {0} connecting, {1} authenticating, {2} downloading, {3} playing, {4} disconnected\n", statusCount[0], statusCount[1], statusCount[2], statusCount[3], statusCount[4]);
+		fmt::print("Download: {0} total, slowest bot took {1}ms\n", ByteToString(total.downloadedBytes), maxDownloadDuration);
+		fmt::print("Per bot: {0} down ({1:.1f} packets/s), {2} up ({3:.1f} packets/s), max received {4}\n", ByteToString(Nz::UInt64(PerBotPerSecond(total.receivedBytes)), true), PerBotPerSecond(total.receivedPackets), ByteToString(Nz::UInt64(PerBotPerSecond(total.sentBytes)), true), PerBotPerSecond(total.sentPackets), ByteToString(maxReceivedBytes));
+
+		float avgTickError = (total.tickErrorCount > 0) ? float(total.tickErrorSum) / total.tickErrorCount : 0.f;
+		float avgInputDelay = (total.inputDelayCount > 0) ? float(total.inputDelaySum) / total.inputDelayCount : 0.f;
+		// Server ticks elapsed during the test, to compare MatchState bandwidth with and without quantization (--quantize)
+		float tickCount = std::max(elapsedTime * m_configFile.GetFloatValue<float>("GameSettings.TickRate"), 1.f);
+		float avgMatchStateSize = (total.matchStateCount > 0) ? float(total.matchStateBytes) / total.matchStateCount : 0.f;
+		fmt::print("Match states: {0:.1f} bytes per tick per bot, {1:.1f} bytes per packet on average, {2}/{3} quantized\n", total.matchStateBytes / botCount / tickCount, avgMatchStateSize, total.quantizedMatchStateCount, total.matchStateCount);
+
+		fmt::print("Input timing: {0} corrections (avg error {1:.2f} ticks, max {2}), input delay avg {3:.2f} ticks (max {4}), {5} match states\n", total.tickErrorCount, avgTickError, total.maxTickError, avgInputDelay, total.maxInputDelay, total.matchStateCount);
+
+		if (!m_tickTimings.durations.empty())
+		{
+			std::vector<Nz::UInt64> durations = m_tickTimings.durations;
+			std::sort(durations.begin(), durations.end());
+
+			auto Percentile = [&](std::size_t percent)
+			{
+				return durations[(durations.size() - 1) * percent / 100] / 1000.f;
+			};
+
+			const auto& tickStatistics = m_match->GetTickStatistics();
+			fmt::print("Server ticks: {0} (late: {1}, dropped: {2}), tick time p50 {3:.3f}ms, p90 {4:.3f}ms, p99 {5:.3f}ms, max {6:.3f}ms\n", m_tickTimings.tickCount, tickStatistics.lateTickCount, tickStatistics.droppedTickCount, Percentile(50), Percentile(90), Percentile(99), durations.back() / 1000.f);
+		}
+	}
+
+	bool LoadTestApp::SetupReactor()
+	{
+		if (m_settings.mode == ConnectionMode::Loopback)
+			m_serverAddress = Nz::IpAddress::LoopbackIpV4;
+		else
+		{
+			Nz::ResolveError resolveError;
+			std::vector<Nz::HostnameInfo> serverAddresses = Nz::IpAddress::ResolveHostname(Nz::NetProtocol_Any, m_settings.serverHostname, Nz::String::Number(m_settings.serverPort), &resolveError);
+			if (serverAddresses.empty())
+			{
+				bwLog(GetLogger(), LogLevel::Error, "Failed to resolve {0}: {1}", m_settings.serverHostname, Nz::ErrorToString(resolveError));
+				return false;
+			}
+
+			m_serverAddress = serverAddresses.front().address;
+		}
+
+		m_serverAddress.SetPort(m_settings.serverPort);
+
+		// A single reactor handles every bot connection
+		m_reactor = std::make_unique<NetworkReactor>(0, m_serverAddress.GetProtocol(), Nz::UInt16(0), m_settings.botCount);
+
+		return true;
+	}
+}
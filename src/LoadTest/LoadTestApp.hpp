@@ -0,0 +1,93 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_LOADTESTAPP_HPP
+#define BURGWAR_LOADTESTAPP_HPP
+
+#include <CoreLib/BurgApp.hpp>
+#include <CoreLib/Match.hpp>
+#include <LoadTest/BotClient.hpp>
+#include <LoadTest/BotCommandStore.hpp>
+#include <LoadTest/BotInputController.hpp>
+#include <LoadTest/LoadTestAppConfig.hpp>
+#include <Nazara/Network/IpAddress.hpp>
+#include <NDK/Application.hpp>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bw
+{
+	class LocalSessionManager;
+	class NetworkReactor;
+	class NetworkSessionBridge;
+
+	/*!
+	* \brief Connects a number of headless bots to a match and reports how the server and the connections behave
+	*/
+	class LoadTestApp : public Ndk::Application, public BurgApp
+	{
+		public:
+			enum class ConnectionMode
+			{
+				Local,    //< Hosts a match and connects bots through in-process session bridges
+				Loopback, //< Hosts a match and connects bots through ENet on the loopback interface
+				Remote    //< Connects bots to an existing server
+			};
+
+			struct Settings;
+
+			LoadTestApp(int argc, char* argv[], Settings settings);
+			~LoadTestApp();
+
+			int Run();
+
+			struct Settings
+			{
+				BotInputController::Behavior behavior = BotInputController::Behavior::Random;
+				ConnectionMode mode = ConnectionMode::Local;
+				std::optional<float> maxTickTime; //< Milliseconds, the test fails if the 99th percentile tick time is above this
+				std::optional<bool> quantizeMatchState; //< Overrides Network.QuantizeMatchState for hosted matches
+				std::string serverHostname = "localhost";
+				Nz::UInt16 serverPort = 0; //< 0 to use the config port
+				std::size_t botCount = 16;
+				float connectionInterval = 0.05f; //< Seconds between two bot connections
+				float duration = 60.f;
+				float reportInterval = 5.f;
+				bool verbose = false;
+			};
+
+		private:
+			void ConnectBot();
+			void HostMatch();
+			void PollReactor();
+			void PrintReport(bool finalReport);
+			bool SetupReactor();
+
+			struct TickTimings
+			{
+				std::vector<Nz::UInt64> durations; //< Microseconds
+				Nz::UInt64 tickCount = 0;
+			};
+
+			LoadTestAppConfig m_configFile;
+			BotCommandStore m_commandStore;
+			Settings m_settings;
+			Nz::IpAddress m_serverAddress;
+			Nz::UInt64 m_startTime;
+			LocalSessionManager* m_localSessionManager;
+			TickTimings m_tickTimings;
+			std::unique_ptr<Match> m_match;
+			std::unique_ptr<NetworkReactor> m_reactor;
+			std::vector<std::shared_ptr<NetworkSessionBridge>> m_networkBridges; //< Indexed by peer id
+			std::vector<std::unique_ptr<BotClient>> m_bots; //< Destroyed first, bots disconnect from the match and the reactor
+	};
+}
+
+#include <LoadTest/LoadTestApp.inl>
+
+#endif
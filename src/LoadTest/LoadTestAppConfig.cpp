@@ -0,0 +1,28 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadTest/LoadTestAppConfig.hpp>
+#include <LoadTest/LoadTestApp.hpp>
+
+namespace bw
+{
+	LoadTestAppConfig::LoadTestAppConfig(LoadTestApp& app) :
+	SharedAppConfig(app)
+	{
+		// Load tests use the server config so hosted matches behave like the real server
+		RegisterStringOption("GameSettings.Gamemode");
+		RegisterIntegerOption("GameSettings.LayerWorkerCount", 0, 64, 0);
+		RegisterStringOption("GameSettings.MapFile");
+		RegisterBoolOption("Network.QuantizeMatchState", false);
+		RegisterIntegerOption("Network.FileTransferRate", 16 * 1024, 1024 * 1024 * 1024, 1024 * 1024);
+		RegisterFloatOption("Network.AngularVelocityPrecision", 0.00001, 1.0, 1.0 / 1024.0);
+		RegisterFloatOption("Network.InterestRadius", 0.0, 1'000'000.0, 0.0);
+		RegisterFloatOption("Network.LinearVelocityPrecision", 0.00001, 16.0, 1.0 / 16.0);
+		RegisterFloatOption("Network.PositionPrecision", 0.00001, 16.0, 1.0 / 32.0);
+		RegisterIntegerOption("Network.RotationBits", 12, 16, 16);
+		RegisterStringOption("Resources.BytecodeCacheDirectory", "");
+		RegisterStringOption("Resources.HashCacheFile", ".hashcache.json");
+		RegisterIntegerOption("Server.Port", 0, 0xFFFF, 14768);
+	}
+}
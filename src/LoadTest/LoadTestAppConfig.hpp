@@ -0,0 +1,26 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_LOADTESTAPPCONFIG_HPP
+#define BURGWAR_LOADTESTAPPCONFIG_HPP
+
+#include <CoreLib/SharedAppConfig.hpp>
+
+namespace bw
+{
+	class LoadTestApp;
+
+	class LoadTestAppConfig : public SharedAppConfig
+	{
+		public:
+			LoadTestAppConfig(LoadTestApp& app);
+			~LoadTestAppConfig() = default;
+	};
+}
+
+#include <LoadTest/LoadTestAppConfig.inl>
+
+#endif
@@ -0,0 +1,96 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadTest/LoadTestApp.hpp>
+#include <Main/Main.hpp>
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <cxxopts.hpp>
+#include <iostream>
+#include <stdexcept>
+
+int BurgWarLoadTest(int argc, char* argv[])
+{
+	cxxopts::Options options("BurgWarLoadTest", "Connects headless bots to a match and reports server and network statistics");
+	options.add_options()
+		("b,bots", "Bot count", cxxopts::value<std::size_t>()->default_value("16"))
+		("m,mode", "Connection mode (local, loopback or remote)", cxxopts::value<std::string>()->default_value("local"))
+		("s,server", "Server hostname (remote mode)", cxxopts::value<std::string>()->default_value("localhost"))
+		("p,port", "Server port (defaults to the config port)", cxxopts::value<Nz::UInt16>()->default_value("0"))
+		("behavior", "Bot inputs (idle, random or scripted)", cxxopts::value<std::string>()->default_value("random"))
+		("d,duration", "Test duration in seconds", cxxopts::value<float>()->default_value("60"))
+		("connection-interval", "Seconds between two bot connections", cxxopts::value<float>()->default_value("0.05"))
+		("report-interval", "Seconds between two intermediate reports", cxxopts::value<float>()->default_value("5"))
+		("quantize", "Quantize and delta-encode match states of the hosted match (overrides Network.QuantizeMatchState)", cxxopts::value<bool>())
+		("max-tick-time", "Fails if the 99th percentile tick time (in milliseconds) is above this", cxxopts::value<float>())
+		("v,verbose", "Show match logs")
+		("h,help", "Print usage")
+	;
+
+	try
+	{
+		auto result = options.parse(argc, argv);
+		if (result.count("help") > 0)
+		{
+			std::cout << options.help() << std::endl;
+			return EXIT_SUCCESS;
+		}
+
+		bw::LoadTestApp::Settings settings;
+		settings.botCount = result["bots"].as<std::size_t>();
+		settings.connectionInterval = result["connection-interval"].as<float>();
+		settings.duration = result["duration"].as<float>();
+		settings.reportInterval = result["report-interval"].as<float>();
+		settings.serverHostname = result["server"].as<std::string>();
+		settings.serverPort = result["port"].as<Nz::UInt16>();
+		settings.verbose = result.count("verbose") > 0;
+
+		if (result.count("max-tick-time") > 0)
+			settings.maxTickTime = result["max-tick-time"].as<float>();
+
+		if (result.count("quantize") > 0)
+			settings.quantizeMatchState = result["quantize"].as<bool>();
+
+		const std::string& mode = result["mode"].as<std::string>();
+		if (mode == "local")
+			settings.mode = bw::LoadTestApp::ConnectionMode::Local;
+		else if (mode == "loopback")
+			settings.mode = bw::LoadTestApp::ConnectionMode::Loopback;
+		else if (mode == "remote")
+			settings.mode = bw::LoadTestApp::ConnectionMode::Remote;
+		else
+			throw std::runtime_error("unknown mode " + mode + " (expected local, loopback or remote)");
+
+		const std::string& behavior = result["behavior"].as<std::string>();
+		if (behavior == "idle")
+			settings.behavior = bw::BotInputController::Behavior::Idle;
+		else if (behavior == "random")
+			settings.behavior = bw::BotInputController::Behavior::Random;
+		else if (behavior == "scripted")
+			settings.behavior = bw::BotInputController::Behavior::Scripted;
+		else
+			throw std::runtime_error("unknown behavior " + behavior + " (expected idle, random or scripted)");
+
+		if (settings.botCount == 0)
+			throw std::runtime_error("bot count must be at least 1");
+
+		Nz::Initializer<Nz::Network> network;
+		bw::LoadTestApp app(argc, argv, std::move(settings));
+
+		return app.Run();
+	}
+	catch (const cxxopts::OptionException& e)
+	{
+		std::cout << e.what() << "\n";
+		std::cout << options.help() << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+	}
+
+	return EXIT_FAILURE;
+}
+
+BurgWarMain(BurgWarLoadTest)
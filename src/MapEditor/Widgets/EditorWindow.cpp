@@ -3,10 +3,10 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <MapEditor/Widgets/EditorWindow.hpp>
+#include <CoreLib/LocalSessionBridge.hpp>
+#include <CoreLib/LocalSessionManager.hpp>
 #include <CoreLib/Scripting/ScriptingContext.hpp>
 #include <ClientLib/ClientSession.hpp>
-#include <ClientLib/LocalSessionBridge.hpp>
-#include <ClientLib/LocalSessionManager.hpp>
 #include <ClientLib/Components/VisualComponent.hpp>
 #include <ClientLib/Components/LocalMatchComponent.hpp>
 #include <ClientLib/Components/SoundEmitterComponent.hpp>
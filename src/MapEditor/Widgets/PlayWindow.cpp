@@ -3,11 +3,11 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <MapEditor/Widgets/PlayWindow.hpp>
+#include <CoreLib/LocalSessionBridge.hpp>
+#include <CoreLib/LocalSessionManager.hpp>
 #include <CoreLib/NetworkSessionManager.hpp>
 #include <ClientLib/ClientEditorApp.hpp>
 #include <ClientLib/ClientSession.hpp>
-#include <ClientLib/LocalSessionBridge.hpp>
-#include <ClientLib/LocalSessionManager.hpp>
 #include <NDK/Components/CameraComponent.hpp>
 #include <NDK/Components/NodeComponent.hpp>
 #include <NDK/Systems/RenderSystem.hpp>
@@ -74,6 +74,7 @@ namespace bw
 		Packets::Auth authPacket;
 		auto& playerData = authPacket.players.emplace_back();
 		playerData.nickname = "Mapper";
+		authPacket.supportedFeatures = ProtocolFeature::BatchedEntityEvents | ProtocolFeature::QuantizedMatchState;
 
 		m_session->SendPacket(authPacket);
 	}
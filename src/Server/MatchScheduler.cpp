@@ -0,0 +1,140 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/MatchScheduler.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace bw
+{
+	/*!
+	* \brief Creates a scheduler updating its matches on threadCount threads
+	*
+	* With a thread count of zero, matches are updated by the thread calling Update
+	*/
+	MatchScheduler::MatchScheduler(std::size_t threadCount) :
+	m_running(false),
+	m_matchCount(0),
+	m_threadCount(threadCount),
+	m_minTickDuration(IdleUpdateInterval)
+	{
+		m_groups.resize(std::max<std::size_t>(threadCount, 1));
+	}
+
+	MatchScheduler::~MatchScheduler()
+	{
+		Stop();
+	}
+
+	void MatchScheduler::AddMatch(std::unique_ptr<Match> match)
+	{
+		assert(!m_running.load(std::memory_order_relaxed));
+
+		// Matches are spread evenly between threads, each match being always updated by the same thread
+		MatchGroup& group = m_groups[m_matchCount % m_groups.size()];
+
+		m_minTickDuration = std::min(m_minTickDuration, static_cast<Nz::UInt64>(match->GetTickDuration() * 1'000'000.f));
+
+		auto& scheduledMatch = group.matches.emplace_back();
+		scheduledMatch.lastUpdateTime = Nz::GetElapsedMicroseconds();
+		scheduledMatch.match = std::move(match);
+
+		m_matchCount++;
+	}
+
+	void MatchScheduler::Start()
+	{
+		if (m_running.exchange(true, std::memory_order_acq_rel))
+			return;
+
+		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+		for (MatchGroup& group : m_groups)
+		{
+			for (ScheduledMatch& scheduledMatch : group.matches)
+				scheduledMatch.lastUpdateTime = now;
+		}
+
+		if (m_threadCount == 0)
+			return;
+
+		m_threads.reserve(m_threadCount);
+		for (std::size_t i = 0; i < m_threadCount; ++i)
+		{
+			MatchGroup& group = m_groups[i];
+
+			Nz::Thread& thread = m_threads.emplace_back([this, &group] { WorkerThread(group); });
+			thread.SetName("MatchWorker #" + std::to_string(i));
+		}
+	}
+
+	void MatchScheduler::Stop()
+	{
+		if (!m_running.exchange(false, std::memory_order_acq_rel))
+			return;
+
+		for (Nz::Thread& thread : m_threads)
+			thread.Join();
+
+		m_threads.clear();
+	}
+
+	/*!
+	* \brief Updates matches handled by the calling thread (when the scheduler has no thread of its own)
+	* \return Time (as returned by Nz::GetElapsedMicroseconds) at which Update should be called again
+	*/
+	Nz::UInt64 MatchScheduler::Update()
+	{
+		if (m_threadCount > 0 || !m_running.load(std::memory_order_relaxed))
+			return Nz::GetElapsedMicroseconds() + m_minTickDuration;
+
+		return UpdateGroup(m_groups.front());
+	}
+
+	/*!
+	* \brief Blocks the calling thread until deadline
+	*
+	* The thread sleeps until shortly before deadline and then spins for the remaining time, as sleeping is not precise enough to keep a steady tick rate
+	*/
+	void MatchScheduler::WaitUntil(Nz::UInt64 deadline)
+	{
+		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+		if (deadline > now + SpinDuration)
+			std::this_thread::sleep_for(std::chrono::microseconds(deadline - now - SpinDuration));
+
+		while (Nz::GetElapsedMicroseconds() < deadline)
+			std::this_thread::yield();
+	}
+
+	Nz::UInt64 MatchScheduler::UpdateGroup(MatchGroup& group)
+	{
+		Nz::UInt64 nextDeadline = Nz::GetElapsedMicroseconds() + IdleUpdateInterval;
+		for (ScheduledMatch& scheduledMatch : group.matches)
+		{
+			Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+			float elapsedTime = (now - scheduledMatch.lastUpdateTime) / 1'000'000.f;
+			scheduledMatch.lastUpdateTime = now;
+
+			scheduledMatch.match->Update(elapsedTime);
+
+			Nz::UInt64 matchDeadline = now + static_cast<Nz::UInt64>(scheduledMatch.match->GetTimeUntilNextTick() * 1'000'000.f);
+			nextDeadline = std::min(nextDeadline, matchDeadline);
+		}
+
+		return nextDeadline;
+	}
+
+	void MatchScheduler::WorkerThread(MatchGroup& group)
+	{
+		while (m_running.load(std::memory_order_relaxed))
+		{
+			Nz::UInt64 nextDeadline = UpdateGroup(group);
+
+			WaitUntil(nextDeadline);
+		}
+	}
+}
@@ -0,0 +1,72 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_MATCHSCHEDULER_HPP
+#define BURGWAR_MATCHSCHEDULER_HPP
+
+#include <CoreLib/Match.hpp>
+#include <Nazara/Core/Thread.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace bw
+{
+	class MatchScheduler
+	{
+		public:
+			MatchScheduler(std::size_t threadCount);
+			MatchScheduler(const MatchScheduler&) = delete;
+			MatchScheduler(MatchScheduler&&) = delete;
+			~MatchScheduler();
+
+			void AddMatch(std::unique_ptr<Match> match);
+
+			inline std::size_t GetMatchCount() const;
+			inline std::size_t GetThreadCount() const;
+
+			void Start();
+			void Stop();
+
+			Nz::UInt64 Update();
+
+			static void WaitUntil(Nz::UInt64 deadline);
+
+			MatchScheduler& operator=(const MatchScheduler&) = delete;
+			MatchScheduler& operator=(MatchScheduler&&) = delete;
+
+		private:
+			struct MatchGroup;
+
+			static Nz::UInt64 UpdateGroup(MatchGroup& group);
+			void WorkerThread(MatchGroup& group);
+
+			struct ScheduledMatch
+			{
+				std::unique_ptr<Match> match;
+				Nz::UInt64 lastUpdateTime;
+			};
+
+			struct MatchGroup
+			{
+				std::vector<ScheduledMatch> matches;
+			};
+
+			std::atomic_bool m_running;
+			std::size_t m_matchCount;
+			std::vector<MatchGroup> m_groups;
+			std::vector<Nz::Thread> m_threads;
+			std::size_t m_threadCount;
+			Nz::UInt64 m_minTickDuration;
+
+			static constexpr Nz::UInt64 IdleUpdateInterval = 100'000;
+			static constexpr Nz::UInt64 SpinDuration = 500;
+	};
+}
+
+#include <Server/MatchScheduler.inl>
+
+#endif
@@ -0,0 +1,18 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/MatchScheduler.hpp>
+
+namespace bw
+{
+	inline std::size_t MatchScheduler::GetMatchCount() const
+	{
+		return m_matchCount;
+	}
+
+	inline std::size_t MatchScheduler::GetThreadCount() const
+	{
+		return m_threadCount;
+	}
+}
@@ -3,8 +3,13 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/ServerApp.hpp>
+#include <CoreLib/LogSystem/AsyncSink.hpp>
+#include <CoreLib/LogSystem/FileSink.hpp>
+#include <CoreLib/LogSystem/StdSink.hpp>
 #include <CoreLib/NetworkSessionManager.hpp>
-#include <Nazara/Core/Thread.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace bw
 {
@@ -16,17 +21,65 @@ namespace bw
 		if (!m_configFile.LoadFromFile("serverconfig.lua"))
 			throw std::runtime_error("failed to load config file");
 
-		Match::GamemodeSettings gamemodeSettings;
-		gamemodeSettings.name = m_configFile.GetStringValue("GameSettings.Gamemode");
+		SetupLogging();
 
-		Match::MatchSettings matchSettings;
-		matchSettings.map = Map::LoadFromBinary(m_configFile.GetStringValue("GameSettings.MapFile"));
-		matchSettings.maxPlayerCount = 64;
-		matchSettings.name = "local";
-		matchSettings.tickDuration = 1.f / m_configFile.GetFloatValue<float>("GameSettings.TickRate");
+		std::size_t matchCount = m_configFile.GetIntegerValue<std::size_t>("Server.MatchCount");
+		std::size_t maxPlayerCount = m_configFile.GetIntegerValue<std::size_t>("Server.MaxPlayerCount");
+		Nz::UInt16 port = m_configFile.GetIntegerValue<Nz::UInt16>("Server.Port");
 
-		m_match = std::make_unique<Match>(*this, std::move(matchSettings), std::move(gamemodeSettings));
-		m_match->GetSessions().CreateSessionManager<NetworkSessionManager>(Nz::UInt16(14768), 64);
+		if (std::size_t(port) + matchCount > 0x10000)
+			throw std::runtime_error("not enough ports for " + std::to_string(matchCount) + " matches starting at port " + std::to_string(port));
+
+		Map map = Map::LoadFromBinary(m_configFile.GetStringValue("GameSettings.MapFile"));
+
+		// Every match shares the same client files, only hash them once
+		auto fileHashCache = std::make_shared<FileHashCache>(m_configFile.GetStringValue("Resources.HashCacheFile"));
+		if (!fileHashCache->Load())
+			bwLog(GetLogger(), LogLevel::Warning, "Failed to load hash cache from {}, it will be rebuilt", fileHashCache->GetManifestPath().generic_u8string());
+
+		auto scriptBytecodeCache = std::make_shared<ScriptBytecodeCache>(m_configFile.GetStringValue("Resources.BytecodeCacheDirectory"));
+
+		m_matchScheduler.emplace(m_configFile.GetIntegerValue<std::size_t>("Server.MatchThreadCount"));
+		for (std::size_t i = 0; i < matchCount; ++i)
+		{
+			Match::GamemodeSettings gamemodeSettings;
+			gamemodeSettings.name = m_configFile.GetStringValue("GameSettings.Gamemode");
+
+			Match::MatchSettings matchSettings;
+			matchSettings.fileHashCache = fileHashCache;
+			matchSettings.fileTransferRate = m_configFile.GetIntegerValue<Nz::UInt64>("Network.FileTransferRate");
+			matchSettings.layerWorkerCount = m_configFile.GetIntegerValue<std::size_t>("GameSettings.LayerWorkerCount");
+			matchSettings.map = map;
+			matchSettings.maxPlayerCount = maxPlayerCount;
+			matchSettings.name = (matchCount > 1) ? "match #" + std::to_string(i) : "local";
+			matchSettings.scriptBytecodeCache = scriptBytecodeCache;
+			matchSettings.tickDuration = 1.f / m_configFile.GetFloatValue<float>("GameSettings.TickRate");
+			matchSettings.tickProfiler.dumpFolder = m_configFile.GetStringValue("Debug.TickProfilerFolder");
+			matchSettings.tickProfiler.dumpInterval = m_configFile.GetFloatValue<float>("Debug.TickProfilerDumpInterval");
+			matchSettings.tickProfiler.enable = m_configFile.GetBoolValue("Debug.TickProfiler");
+
+			if (float interestRadius = m_configFile.GetFloatValue<float>("Network.InterestRadius"); interestRadius > 0.f)
+				matchSettings.interestRadius = interestRadius;
+
+			if (m_configFile.GetBoolValue("Network.QuantizeMatchState"))
+			{
+				auto& quantizationSettings = matchSettings.matchStateQuantization.emplace();
+				quantizationSettings.angularVelocityPrecision = m_configFile.GetFloatValue<float>("Network.AngularVelocityPrecision");
+				quantizationSettings.linearVelocityPrecision = m_configFile.GetFloatValue<float>("Network.LinearVelocityPrecision");
+				quantizationSettings.positionPrecision = m_configFile.GetFloatValue<float>("Network.PositionPrecision");
+				quantizationSettings.rotationBits = m_configFile.GetIntegerValue<Nz::UInt8>("Network.RotationBits");
+			}
+
+			// Each match has its own scripting context and network reactor (one port per match)
+			auto match = std::make_unique<Match>(*this, std::move(matchSettings), std::move(gamemodeSettings));
+			match->GetSessions().CreateSessionManager<NetworkSessionManager>(Nz::UInt16(port + i), maxPlayerCount);
+
+			bwLog(GetLogger(), LogLevel::Info, "Match #{0} listening on port {1}", i, port + i);
+
+			m_matchScheduler->AddMatch(std::move(match));
+		}
+
+		m_matchScheduler->Start();
 	}
 
 	int ServerApp::Run()
@@ -35,12 +88,63 @@ namespace bw
 		{
 			BurgApp::Update();
 
-			m_match->Update(GetUpdateTime());
-
-			//TODO: Sleep only when server is not overloaded
-			Nz::Thread::Sleep(1);
+			// Sleep until the next tick is due, an overloaded server doesn't sleep at all
+			Nz::UInt64 nextUpdate = m_matchScheduler->Update();
+			MatchScheduler::WaitUntil(nextUpdate);
 		}
 
 		return 0;
 	}
+
+	void ServerApp::SetupLogging()
+	{
+		Logger& logger = GetLogger();
+
+		const std::string& logLevel = m_configFile.GetStringValue("Debug.LogLevel");
+		if (logLevel == "debug")
+			logger.SetMinimumLogLevel(LogLevel::Debug);
+		else if (logLevel == "info")
+			logger.SetMinimumLogLevel(LogLevel::Info);
+		else if (logLevel == "warning")
+			logger.SetMinimumLogLevel(LogLevel::Warning);
+		else if (logLevel == "error")
+			logger.SetMinimumLogLevel(LogLevel::Error);
+		else
+			bwLog(logger, LogLevel::Warning, "Unknown log level \"{0}\" (expected debug, info, warning or error)", logLevel);
+
+		std::vector<std::shared_ptr<LogSink>> sinks;
+		sinks.push_back(std::make_shared<StdSink>());
+
+		if (const std::string& logFile = m_configFile.GetStringValue("Debug.LogFile"); !logFile.empty())
+		{
+			auto fileSink = std::make_shared<FileSink>(logFile, m_configFile.GetIntegerValue<Nz::UInt64>("Debug.LogFileMaxSize"), m_configFile.GetIntegerValue<std::size_t>("Debug.LogFileBackupCount"));
+			if (fileSink->IsOpen())
+				sinks.push_back(std::move(fileSink));
+			else
+				bwLog(logger, LogLevel::Error, "Failed to open log file {0}", logFile);
+		}
+
+		// Sinks are moved to a background thread so match threads never wait on stdout or disk
+		if (m_configFile.GetBoolValue("Debug.AsyncLogging"))
+		{
+			AsyncSink::OverflowPolicy overflowPolicy = AsyncSink::OverflowPolicy::Block;
+
+			const std::string& overflowPolicyStr = m_configFile.GetStringValue("Debug.LogOverflowPolicy");
+			if (overflowPolicyStr == "drop")
+				overflowPolicy = AsyncSink::OverflowPolicy::Drop;
+			else if (overflowPolicyStr != "block")
+				bwLog(logger, LogLevel::Warning, "Unknown log overflow policy \"{0}\" (expected block or drop), defaulting to block", overflowPolicyStr);
+
+			// A single AsyncSink (and thus a single writer thread) for every sink
+			std::size_t bufferSize = m_configFile.GetIntegerValue<std::size_t>("Debug.LogBufferSize");
+			auto asyncSink = std::make_shared<AsyncSink>(std::move(sinks), bufferSize, overflowPolicy);
+
+			sinks.clear();
+			sinks.push_back(std::move(asyncSink));
+		}
+
+		logger.ClearSinks();
+		for (auto& sinkPtr : sinks)
+			logger.RegisterSink(std::move(sinkPtr));
+	}
 }
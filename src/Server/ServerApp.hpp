@@ -9,9 +9,10 @@
 
 #include <CoreLib/BurgApp.hpp>
 #include <CoreLib/Match.hpp>
+#include <Server/MatchScheduler.hpp>
 #include <Server/ServerAppConfig.hpp>
 #include <NDK/Application.hpp>
-#include <memory>
+#include <optional>
 
 namespace bw
 {
@@ -24,8 +25,10 @@ namespace bw
 			int Run();
 
 		private:
+			void SetupLogging();
+
 			ServerAppConfig m_configFile;
-			std::unique_ptr<Match> m_match;
+			std::optional<MatchScheduler> m_matchScheduler;
 	};
 }
 
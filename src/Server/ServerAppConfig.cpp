@@ -10,7 +10,31 @@ namespace bw
 	ServerAppConfig::ServerAppConfig(ServerApp& app) :
 	SharedAppConfig(app)
 	{
+		RegisterBoolOption("Debug.AsyncLogging", true);
+		RegisterIntegerOption("Debug.LogBufferSize", 16, 1024 * 1024, 4096);
+		RegisterStringOption("Debug.LogFile", "");
+		RegisterIntegerOption("Debug.LogFileBackupCount", 0, 100, 3);
+		RegisterIntegerOption("Debug.LogFileMaxSize", 0, 1024LL * 1024 * 1024 * 1024, 16 * 1024 * 1024);
+		RegisterStringOption("Debug.LogLevel", "debug");
+		RegisterStringOption("Debug.LogOverflowPolicy", "block");
+		RegisterBoolOption("Debug.TickProfiler", false);
+		RegisterFloatOption("Debug.TickProfilerDumpInterval", 0.0, 86'400.0, 0.0);
+		RegisterStringOption("Debug.TickProfilerFolder", "profiles");
 		RegisterStringOption("GameSettings.Gamemode");
+		RegisterIntegerOption("GameSettings.LayerWorkerCount", 0, 64, 0);
 		RegisterStringOption("GameSettings.MapFile");
+		RegisterBoolOption("Network.QuantizeMatchState", false);
+		RegisterIntegerOption("Network.FileTransferRate", 16 * 1024, 1024 * 1024 * 1024, 1024 * 1024);
+		RegisterFloatOption("Network.AngularVelocityPrecision", 0.00001, 1.0, 1.0 / 1024.0);
+		RegisterFloatOption("Network.InterestRadius", 0.0, 1'000'000.0, 0.0);
+		RegisterFloatOption("Network.LinearVelocityPrecision", 0.00001, 16.0, 1.0 / 16.0);
+		RegisterFloatOption("Network.PositionPrecision", 0.00001, 16.0, 1.0 / 32.0);
+		RegisterIntegerOption("Network.RotationBits", 12, 16, 16);
+		RegisterStringOption("Resources.BytecodeCacheDirectory", "");
+		RegisterStringOption("Resources.HashCacheFile", ".hashcache.json");
+		RegisterIntegerOption("Server.MatchCount", 1, 1024, 1);
+		RegisterIntegerOption("Server.MatchThreadCount", 0, 256, 0);
+		RegisterIntegerOption("Server.MaxPlayerCount", 1, 0xFFFF, 64);
+		RegisterIntegerOption("Server.Port", 0, 0xFFFF, 14768);
 	}
 }
@@ -293,6 +293,38 @@ target("BurgWarServer")
 		os.vcp("serverconfig.lua", path.join(target:installdir(), "bin"))
 	end)
 
+target("BurgWarLoadTest")
+	set_group("Executable")
+	set_basename("loadtest")
+
+	set_kind("binary")
+	add_rules("install_symbolfile", "install_nazara")
+
+	add_defines("NDK_SERVER")
+
+	add_deps("Main", "CoreLib")
+	add_headerfiles("src/LoadTest/**.hpp", "src/LoadTest/**.inl")
+	add_files("src/LoadTest/**.cpp")
+	add_packages("cxxopts", "nazaraserver")
+
+	after_install(function (target)
+		os.vcp("serverconfig.lua", path.join(target:installdir(), "bin"))
+	end)
+
+target("BurgWarBenchmark")
+	set_group("Executable")
+	set_basename("benchmark")
+
+	set_kind("binary")
+	add_rules("install_symbolfile", "install_nazara")
+
+	add_defines("NDK_SERVER")
+
+	add_deps("Main", "CoreLib")
+	add_headerfiles("src/Benchmark/**.hpp", "src/Benchmark/**.inl")
+	add_files("src/Benchmark/**.cpp")
+	add_packages("cxxopts", "nazaraserver")
+
 target("BurgWarMapTool")
 	set_group("Executable")
 	set_basename("maptool")